@@ -8,8 +8,13 @@
 
 import { ipcMain, app } from 'electron'
 import path from 'node:path'
+import fs from 'node:fs'
+import zlib from 'node:zlib'
+import { pipeline } from 'node:stream/promises'
 import { createRequire } from 'node:module'
 import { getMainWindow } from '../app/lifecycle'
+import { appStore, type SipConfig, type Contact, type CallHistoryEntry } from '../store'
+import { createStateMirrorReader, type LiveState } from './stateMirror'
 
 // Criar require para ES modules
 const require = createRequire(import.meta.url)
@@ -36,7 +41,212 @@ interface NativeSipSnapshot {
     displayName: string
     user: string
     uri: string
+    contactName?: string
   }
+  timings?: {
+    postDialDelayMs: number
+    setupTimeMs: number
+    answerToMediaMs: number
+    alertingDelayMs: number
+  }
+}
+
+// Resumo de um histograma de latência (ms)
+interface LatencySummary {
+  count: number
+  minMs: number
+  maxMs: number
+  meanMs: number
+  p50Ms: number
+  p90Ms: number
+  p99Ms: number
+}
+
+// Histogramas de estabelecimento de chamada
+interface CallTimingStats {
+  postDialDelay: LatencySummary
+  setupTime: LatencySummary
+  answerToMedia: LatencySummary
+  alertingDelay: LatencySummary
+}
+
+// Opções do destino de log nativo
+interface NativeLogOptions {
+  directory?: string
+  maxFileSize?: number
+  maxFiles?: number
+  rateLimits?: number[]
+  level?: number
+}
+
+// Estatísticas do destino de log nativo
+interface NativeLogStats {
+  written: number
+  dropped: number
+  rateLimited: number
+  rotations: number
+  level: number
+}
+
+// Linha do tempo da inicialização (ms desde a carga do addon, -1 = não ocorreu)
+interface StartupTimeline {
+  pjsuaCreatedMs: number
+  pjsuaInitializedMs: number
+  pjsuaStartedMs: number
+  transportReadyMs: number
+  soundDeviceOpenMs: number
+  registeredMs: number
+}
+
+// Política de energia do dispositivo de som
+interface AudioPowerPolicy {
+  idleCloseSeconds?: number
+  nullDeviceWhenIdle?: boolean
+}
+
+// Processamento do microfone (campos ausentes ficam ligados)
+interface CaptureProcessingOptions {
+  highPass?: boolean
+  noiseSuppression?: boolean
+  agc?: boolean
+  budgetPercent?: number
+}
+
+// Opus: FEC/DTX e faixa do controlador de bitrate (bps)
+interface OpusOptions {
+  fec?: boolean
+  dtx?: boolean
+  minBitrate?: number
+  maxBitrate?: number
+  startBitrate?: number
+}
+
+// VAD do microfone: hangover (ms), limiar sobre o piso de ruído (dB) e codecs
+interface VadOptions {
+  enabled?: boolean
+  hangoverMs?: number
+  thresholdDb?: number
+  codecs?: string[]
+}
+
+interface CallVadStats {
+  callId: number
+  codec: string
+  active: boolean
+  suppressedPackets: number
+}
+
+// BLF: lista no RLS (vazio = um SUBSCRIBE por ramal), intervalo entre lotes e expires
+interface BlfOptions {
+  listUri?: string
+  batchIntervalMs?: number
+  expiresSeconds?: number
+}
+
+interface BlfEntry {
+  extension: string
+  state: 'unknown' | 'idle' | 'ringing' | 'busy'
+}
+
+interface BlfStats {
+  extensions: number
+  subscriptions: number
+  active: number
+  resourceList: boolean
+  notifies: number
+  batches: number
+}
+
+interface CaptureStages {
+  highPass: boolean
+  noiseSuppression: boolean
+  agc: boolean
+}
+
+interface CaptureStats {
+  requested: CaptureStages
+  active: CaptureStages
+  budgetMicros: number
+  frames: number
+  overruns: number
+  downgrades: number
+  lastFrameMicros: number
+}
+
+// Método e durações do DTMF (ms; limitados pelo engine a 40..2000)
+interface DtmfOptions {
+  method?: 'rfc2833' | 'info' | 'inband'
+  toneMs?: number
+  gapMs?: number
+  pauseMs?: number
+}
+
+// Consumo acumulado do processo
+interface ResourceUsage {
+  userCpuMs: number
+  systemCpuMs: number
+  voluntaryContextSwitches: number
+  involuntaryContextSwitches: number
+  timestampMs: number
+}
+
+// Entrada do diretório de contatos nativo
+interface ContactDirectoryEntry {
+  name: string
+  number: string
+}
+
+// Plano de numeração (padrão: Brasil)
+interface NumberPlan {
+  countryCode?: string
+  internationalPrefix?: string
+  trunkPrefix?: string
+  carrierCodeLength?: number
+  minNationalLength?: number
+  maxNationalLength?: number
+}
+
+// Resultado da carga do diretório
+interface ContactIndexStats {
+  entries: number
+  skipped: number
+  capacity: number
+  maxProbe: number
+  bytes: number
+}
+
+// Registro do histórico nativo (mesmo formato de CallHistoryEntry)
+interface CallLogRecord extends CallHistoryEntry {
+  answerTime?: number
+  sipStatus?: number
+  ringTime?: number
+  codec?: string
+  account?: string
+  transfer?: 'blind' | 'attended'
+  transferStatus?: number
+}
+
+// Consulta paginada do histórico (mais recentes primeiro)
+interface CallLogQuery {
+  before?: string
+  limit?: number
+  number?: string
+  since?: number
+  until?: number
+}
+
+interface CallLogPage {
+  entries: CallLogRecord[]
+  nextCursor: string | null
+  total: number
+}
+
+interface CallLogStats {
+  records: number
+  deleted: number
+  capacity: number
+  fileBytes: number
+  compactions: number
 }
 
 // Tipo para dispositivo de áudio
@@ -59,23 +269,105 @@ interface PjsipAddon {
   answerCall(): boolean
   rejectCall(): boolean
   hangupCall(): boolean
-  sendDtmf(digits: string): boolean
+  sendDtmf(digits: string, options?: DtmfOptions): boolean
+  cancelDtmf(): boolean
+  setDtmfOptions(options: DtmfOptions): void
+  setInbandDtmfDetection(enabled: boolean): void
   transferBlind(target: string): boolean
   transferAttended(target: string): boolean
+  startConsult(target: string): boolean
+  swapTransferLegs(): boolean
+  completeTransfer(): boolean
+  cancelTransfer(): boolean
+  hold(callId: number): boolean
+  resume(callId: number): boolean
+  setHoldMusic(path: string): boolean
   setMuted(muted: boolean): void
   toggleMuted(): boolean
   isMuted(): boolean
   getAudioDevices(): AudioDevice[]
   setAudioDevices(captureId: number, playbackId: number): boolean
+  setAudioPowerPolicy(policy: AudioPowerPolicy): void
+  setCaptureProcessing(options: CaptureProcessingOptions): boolean
+  getCaptureStats(): CaptureStats
+  setOpusOptions(options: OpusOptions): boolean
+  setVadOptions(options: VadOptions): boolean
+  getVadStats(): CallVadStats[]
+  getResourceUsage(): ResourceUsage
+  loadContacts(entries: ContactDirectoryEntry[], plan?: NumberPlan): ContactIndexStats
+  lookupContact(number: string): string | null
+  watchExtensions(extensions: string[], options?: BlfOptions): boolean
+  getBlfStates(): BlfEntry[]
+  getBlfStats(): BlfStats
+  openCallLog(path: string): boolean
+  queryCallLog(query?: CallLogQuery): CallLogPage
+  appendCallRecord(entry: Omit<CallLogRecord, 'id'>): string | null
+  removeCallRecord(id: string): boolean
+  clearCallLog(): boolean
+  getCallLogStats(): CallLogStats
   getSnapshot(): NativeSipSnapshot
+  getStateMirror(): ArrayBuffer
+  getCallTimingStats(): CallTimingStats
+  getMetrics(): string
+  setTraceEnabled(enabled: boolean): void
+  dumpTrace(): string
+  clearTrace(): void
+  configureLogging(options: NativeLogOptions): void
+  setLogLevel(level: number): boolean
+  getLogStats(): NativeLogStats
   setEventCallback(callback: (event: string, payload: string) => void): void
   clearEventCallback(): void
   processEvents(): void
+
+  // Inicialização antecipada
+  prewarm(options: { transport?: 'udp' | 'tcp'; openSoundDevice?: boolean }): Promise<boolean>
+  getStartupTimeline(): StartupTimeline
+
+  // Variantes assíncronas: executadas no thread de comandos SIP
+  initAsync(): Promise<boolean>
+  destroyAsync(): Promise<boolean>
+  registerAsync(credentials: NativeSipCredentials): Promise<boolean>
+  unregisterAsync(): Promise<boolean>
+  makeCallAsync(target: string): Promise<boolean>
+  answerCallAsync(): Promise<boolean>
+  rejectCallAsync(): Promise<boolean>
+  hangupCallAsync(): Promise<boolean>
+  sendDtmfAsync(digits: string, options?: DtmfOptions): Promise<boolean>
+  transferBlindAsync(target: string): Promise<boolean>
+  transferAttendedAsync(target: string): Promise<boolean>
+  startConsultAsync(target: string): Promise<boolean>
+  holdAsync(callId: number): Promise<boolean>
+  resumeAsync(callId: number): Promise<boolean>
+  setAudioDevicesAsync(captureId: number, playbackId: number): Promise<boolean>
+  cancelDtmfAsync(): Promise<boolean>
+  setDtmfOptionsAsync(options: DtmfOptions): Promise<boolean>
+  setInbandDtmfDetectionAsync(enabled: boolean): Promise<boolean>
+  swapTransferLegsAsync(): Promise<boolean>
+  completeTransferAsync(): Promise<boolean>
+  cancelTransferAsync(): Promise<boolean>
+  setHoldMusicAsync(path: string): Promise<boolean>
+  setMutedAsync(muted: boolean): Promise<boolean>
+  toggleMutedAsync(): Promise<boolean>
+  getAudioDevicesAsync(): Promise<AudioDevice[]>
+  setAudioPowerPolicyAsync(policy: AudioPowerPolicy): Promise<boolean>
+  setCaptureProcessingAsync(options: CaptureProcessingOptions): Promise<boolean>
+  setOpusOptionsAsync(options: OpusOptions): Promise<boolean>
+  setVadOptionsAsync(options: VadOptions): Promise<boolean>
+  loadContactsAsync(entries: ContactDirectoryEntry[], plan?: NumberPlan): Promise<ContactIndexStats>
+  watchExtensionsAsync(extensions: string[], options?: BlfOptions): Promise<boolean>
+  configureLoggingAsync(options: NativeLogOptions): Promise<boolean>
+  setLogLevelAsync(level: number): Promise<boolean>
 }
 
 // Instância do addon nativo (carregado sob demanda)
 let sipAddon: PjsipAddon | null = null
 
+// Leitor do espelho de estado (o buffer do addon não muda)
+let readLiveState: (() => LiveState) | null = null
+
+// Diretório da empresa enviado pelo renderer (somado aos contatos salvos)
+let companyDirectory: ContactDirectoryEntry[] = []
+
 /**
  * Carrega o módulo nativo PJSIP
  */
@@ -101,6 +393,26 @@ function loadNativeAddon(): PjsipAddon | null {
     console.log('[SIP Native] Carregando addon de:', addonPath)
     
     sipAddon = require(addonPath) as PjsipAddon
+
+    // Antecipa a inicialização com base nas credenciais salvas; também toma
+    // a posse do PJSUA para este processo (o addon não a toma ao ser carregado)
+    const sip = appStore.get('sip') as Partial<SipConfig> | undefined
+    const transport = sip?.server ? (sip.protocol === 'tcp' ? 'tcp' : 'udp') : undefined
+    sipAddon.prewarm({ transport, openSoundDevice: false }).catch((error) => {
+      console.error('[SIP Native] Erro na inicialização antecipada:', error)
+    })
+    
+    // Log do PJSIP em arquivos rotativos no diretório de logs do app
+    sipAddon.configureLoggingAsync({ directory: path.join(app.getPath('logs'), 'pjsip') }).catch((error) => {
+      console.error('[SIP Native] Erro ao configurar log:', error)
+    })
+
+    // Histórico de chamadas gravado pelo engine, ao lado do arquivo do store
+    if (sipAddon.openCallLog(path.join(path.dirname(appStore.path), 'call-history.log'))) {
+      migrateLegacyCallHistory(sipAddon)
+    } else {
+      console.error('[SIP Native] Histórico nativo indisponível:', sipAddon.getSnapshot().lastError)
+    }
     
     console.log('[SIP Native] Addon carregado com sucesso')
     return sipAddon
@@ -110,10 +422,90 @@ function loadNativeAddon(): PjsipAddon | null {
   }
 }
 
+/**
+ * Move o histórico antigo (array JSON no store) para o histórico nativo
+ *
+ * Só importa para um histórico nativo vazio, preservando a ordem por id.
+ */
+function migrateLegacyCallHistory(addon: PjsipAddon): void {
+  const legacy = (appStore.get('callHistory') as CallHistoryEntry[] | undefined) ?? []
+  if (legacy.length === 0 || addon.getCallLogStats().records > 0) {
+    return
+  }
+
+  try {
+    // O array antigo está do mais recente para o mais antigo
+    for (const entry of [...legacy].reverse()) {
+      const { id: _id, ...record } = entry
+      addon.appendCallRecord(record)
+    }
+    appStore.set('callHistory', [])
+    console.log(`[SIP Native] ${legacy.length} chamadas migradas para o histórico nativo`)
+  } catch (error) {
+    console.error('[SIP Native] Erro ao migrar histórico:', error)
+  }
+}
+
+/**
+ * Comprime um arquivo de log rotacionado pelo addon (<arquivo>.gz)
+ */
+async function compressRotatedLog(filePath: string): Promise<void> {
+  try {
+    await pipeline(
+      fs.createReadStream(filePath),
+      zlib.createGzip(),
+      fs.createWriteStream(`${filePath}.gz`)
+    )
+    await fs.promises.unlink(filePath)
+  } catch (error) {
+    console.error('[SIP Native] Erro ao comprimir log:', error)
+  }
+}
+
+/**
+ * Recarrega o índice nativo de identificação de chamadas
+ *
+ * Contatos salvos vêm depois do diretório da empresa e prevalecem
+ * em números repetidos.
+ */
+async function syncContactIndex(): Promise<void> {
+  if (!sipAddon) return
+
+  const contacts = (appStore.get('contacts') as Contact[] | undefined) ?? []
+  const entries: ContactDirectoryEntry[] = [
+    ...companyDirectory,
+    ...contacts.map((contact) => ({ name: contact.name, number: contact.number })),
+  ]
+
+  try {
+    const stats = await sipAddon.loadContactsAsync(entries)
+    console.log(`[SIP Native] Diretório de contatos: ${stats.entries} números (${stats.skipped} ignorados)`)
+  } catch (error) {
+    console.error('[SIP Native] Erro ao carregar contatos:', error)
+  }
+}
+
+/**
+ * Carrega o addon (que antecipa a inicialização) sem esperar o renderer
+ *
+ * O transporte SIP fica pronto antes do primeiro registro.
+ */
+function prewarmNativeAddon(): void {
+  const addon = loadNativeAddon()
+  if (!addon) return
+
+  // Nome do chamador resolvido no addon já no evento incomingCall
+  void syncContactIndex()
+  appStore.onDidChange('contacts', () => void syncContactIndex())
+}
+
 /**
  * Configura os handlers IPC para o módulo nativo
  */
 export function setupSipIPC(): void {
+  // Carregar o addon assim que o app estiver pronto, sem esperar o renderer
+  app.whenReady().then(prewarmNativeAddon)
+
   // Inicialização
   ipcMain.handle('sip-native:init', async () => {
     const addon = loadNativeAddon()
@@ -122,7 +514,7 @@ export function setupSipIPC(): void {
     }
 
     try {
-      const result = addon.init()
+      const result = await addon.initAsync()
       return { success: result }
     } catch (error) {
       return { success: false, error: String(error) }
@@ -134,7 +526,7 @@ export function setupSipIPC(): void {
     if (sipAddon) {
       try {
         sipAddon.clearEventCallback()
-        sipAddon.destroy()
+        await sipAddon.destroyAsync()
       } catch (error) {
         console.error('[SIP Native] Erro ao destruir:', error)
       }
@@ -156,7 +548,7 @@ export function setupSipIPC(): void {
     }
 
     try {
-      const result = addon.register(credentials)
+      const result = await addon.registerAsync(credentials)
       return { success: result }
     } catch (error) {
       return { success: false, error: String(error) }
@@ -170,7 +562,7 @@ export function setupSipIPC(): void {
     }
 
     try {
-      const result = sipAddon.unregister()
+      const result = await sipAddon.unregisterAsync()
       return { success: result }
     } catch (error) {
       return { success: false, error: String(error) }
@@ -184,7 +576,7 @@ export function setupSipIPC(): void {
     }
 
     try {
-      const result = sipAddon.makeCall(target)
+      const result = await sipAddon.makeCallAsync(target)
       return { success: result }
     } catch (error) {
       return { success: false, error: String(error) }
@@ -198,7 +590,7 @@ export function setupSipIPC(): void {
     }
 
     try {
-      const result = sipAddon.answerCall()
+      const result = await sipAddon.answerCallAsync()
       return { success: result }
     } catch (error) {
       return { success: false, error: String(error) }
@@ -212,7 +604,7 @@ export function setupSipIPC(): void {
     }
 
     try {
-      const result = sipAddon.rejectCall()
+      const result = await sipAddon.rejectCallAsync()
       return { success: result }
     } catch (error) {
       return { success: false, error: String(error) }
@@ -226,7 +618,7 @@ export function setupSipIPC(): void {
     }
 
     try {
-      const result = sipAddon.hangupCall()
+      const result = await sipAddon.hangupCallAsync()
       return { success: result }
     } catch (error) {
       return { success: false, error: String(error) }
@@ -234,19 +626,62 @@ export function setupSipIPC(): void {
   })
 
   // Enviar DTMF
-  ipcMain.handle('sip-native:sendDtmf', async (_, digits: string) => {
+  ipcMain.handle('sip-native:sendDtmf', async (_, digits: string, options?: DtmfOptions) => {
     if (!sipAddon) {
       return { success: false, error: 'Módulo não inicializado' }
     }
 
     try {
-      const result = sipAddon.sendDtmf(digits)
+      const result = options
+        ? await sipAddon.sendDtmfAsync(digits, options)
+        : await sipAddon.sendDtmfAsync(digits)
       return { success: result }
     } catch (error) {
       return { success: false, error: String(error) }
     }
   })
 
+  // Interromper sequência de DTMF
+  ipcMain.handle('sip-native:cancelDtmf', async () => {
+    if (!sipAddon) {
+      return { success: false, error: 'Módulo não inicializado' }
+    }
+
+    try {
+      return { success: await sipAddon.cancelDtmfAsync() }
+    } catch (error) {
+      return { success: false, error: String(error) }
+    }
+  })
+
+  // Detecção de DTMF in-band no áudio recebido
+  ipcMain.handle('sip-native:setInbandDtmfDetection', async (_, enabled: boolean) => {
+    if (!sipAddon) {
+      return { success: false, error: 'Módulo não inicializado' }
+    }
+
+    try {
+      await sipAddon.setInbandDtmfDetectionAsync(enabled)
+      return { success: true }
+    } catch (error) {
+      return { success: false, error: String(error) }
+    }
+  })
+
+  // Método e durações padrão do DTMF
+  ipcMain.handle('sip-native:setDtmfOptions', async (_, options: DtmfOptions) => {
+    if (!sipAddon) {
+      return { success: false, error: 'Módulo não inicializado' }
+    }
+
+    try {
+      await sipAddon.setDtmfOptionsAsync(options)
+      return { success: true }
+    } catch (error) {
+      return { success: false, error: String(error) }
+    }
+  })
+
   // Transferência cega
   ipcMain.handle('sip-native:transferBlind', async (_, target: string) => {
     if (!sipAddon) {
@@ -254,7 +689,7 @@ export function setupSipIPC(): void {
     }
 
     try {
-      const result = sipAddon.transferBlind(target)
+      const result = await sipAddon.transferBlindAsync(target)
       return { success: result }
     } catch (error) {
       return { success: false, error: String(error) }
@@ -268,19 +703,117 @@ export function setupSipIPC(): void {
     }
 
     try {
-      const result = sipAddon.transferAttended(target)
+      const result = await sipAddon.transferAttendedAsync(target)
+      return { success: result }
+    } catch (error) {
+      return { success: false, error: String(error) }
+    }
+  })
+
+  // Consulta de transferência assistida (a original sai da ponte, sem re-INVITE)
+  ipcMain.handle('sip-native:startConsult', async (_, target: string) => {
+    if (!sipAddon) {
+      return { success: false, error: 'Módulo não inicializado' }
+    }
+
+    try {
+      const result = await sipAddon.startConsultAsync(target)
+      return { success: result }
+    } catch (error) {
+      return { success: false, error: String(error) }
+    }
+  })
+
+  // Alterna o áudio entre a original e a consulta
+  ipcMain.handle('sip-native:swapTransferLegs', async () => {
+    if (!sipAddon) {
+      return { success: false, error: 'Módulo não inicializado' }
+    }
+
+    try {
+      const success = await sipAddon.swapTransferLegsAsync()
+      return { success }
+    } catch (error) {
+      return { success: false, error: String(error) }
+    }
+  })
+
+  // Completa a transferência (REFER com Replaces); o resultado chega em transferState
+  ipcMain.handle('sip-native:completeTransfer', async () => {
+    if (!sipAddon) {
+      return { success: false, error: 'Módulo não inicializado' }
+    }
+
+    try {
+      const success = await sipAddon.completeTransferAsync()
+      return { success }
+    } catch (error) {
+      return { success: false, error: String(error) }
+    }
+  })
+
+  // Desiste da transferência: encerra a consulta e volta à original
+  ipcMain.handle('sip-native:cancelTransfer', async () => {
+    if (!sipAddon) {
+      return { success: false, error: 'Módulo não inicializado' }
+    }
+
+    try {
+      const success = await sipAddon.cancelTransferAsync()
+      return { success }
+    } catch (error) {
+      return { success: false, error: String(error) }
+    }
+  })
+
+  // Espera: a chamada sai da ponte de conferência (música de espera, se configurada)
+  ipcMain.handle('sip-native:hold', async (_, callId: number) => {
+    if (!sipAddon) {
+      return { success: false, error: 'Módulo não inicializado' }
+    }
+
+    try {
+      const result = await sipAddon.holdAsync(callId)
+      return { success: result }
+    } catch (error) {
+      return { success: false, error: String(error) }
+    }
+  })
+
+  // Retomar: religada à ponte antes da resposta do re-INVITE
+  ipcMain.handle('sip-native:resume', async (_, callId: number) => {
+    if (!sipAddon) {
+      return { success: false, error: 'Módulo não inicializado' }
+    }
+
+    try {
+      const result = await sipAddon.resumeAsync(callId)
       return { success: result }
     } catch (error) {
       return { success: false, error: String(error) }
     }
   })
 
+  // Música de espera (WAV PCM 16 bits; caminho vazio desliga)
+  ipcMain.handle('sip-native:setHoldMusic', async (_, path: string) => {
+    if (!sipAddon) {
+      return { success: false, error: 'Módulo não inicializado' }
+    }
+
+    try {
+      const success = await sipAddon.setHoldMusicAsync(path)
+      return { success }
+    } catch (error) {
+      return { success: false, error: String(error) }
+    }
+  })
+
   // Definir mute
   ipcMain.handle('sip-native:setMuted', async (_, muted: boolean) => {
     if (!sipAddon) return
 
     try {
-      sipAddon.setMuted(muted)
+      await sipAddon.setMutedAsync(muted)
     } catch (error) {
       console.error('[SIP Native] Erro ao definir mute:', error)
     }
@@ -291,7 +824,7 @@ export function setupSipIPC(): void {
     if (!sipAddon) return false
 
     try {
-      return sipAddon.toggleMuted()
+      return await sipAddon.toggleMutedAsync()
     } catch (error) {
       console.error('[SIP Native] Erro ao alternar mute:', error)
       return false
@@ -309,7 +842,7 @@ export function setupSipIPC(): void {
     if (!sipAddon) return []
 
     try {
-      return sipAddon.getAudioDevices()
+      return await sipAddon.getAudioDevicesAsync()
     } catch (error) {
       console.error('[SIP Native] Erro ao obter dispositivos:', error)
       return []
@@ -323,7 +856,7 @@ export function setupSipIPC(): void {
     }
 
     try {
-      const result = sipAddon.setAudioDevices(captureId, playbackId)
+      const result = await sipAddon.setAudioDevicesAsync(captureId, playbackId)
       return { success: result }
     } catch (error) {
       return { success: false, error: String(error) }
@@ -354,6 +887,248 @@ export function setupSipIPC(): void {
     }
   })
 
+  // Obter histogramas de estabelecimento de chamada
+  ipcMain.handle('sip-native:getCallTimingStats', async () => {
+    if (!sipAddon) return null
+
+    try {
+      return sipAddon.getCallTimingStats()
+    } catch (error) {
+      console.error('[SIP Native] Erro ao obter métricas de chamada:', error)
+      return null
+    }
+  })
+
+  // Política de energia do dispositivo de som
+  ipcMain.handle('sip-native:setAudioPowerPolicy', async (_, policy: AudioPowerPolicy) => {
+    if (!sipAddon) {
+      return { success: false, error: 'Módulo não inicializado' }
+    }
+
+    try {
+      await sipAddon.setAudioPowerPolicyAsync(policy)
+      return { success: true }
+    } catch (error) {
+      return { success: false, error: String(error) }
+    }
+  })
+
+  // Processamento do microfone (passa-altas, supressão de ruído, AGC)
+  ipcMain.handle('sip-native:setCaptureProcessing', async (_, options: CaptureProcessingOptions) => {
+    if (!sipAddon) {
+      return { success: false, error: 'Módulo não inicializado' }
+    }
+
+    try {
+      const success = await sipAddon.setCaptureProcessingAsync(options)
+      return { success }
+    } catch (error) {
+      return { success: false, error: String(error) }
+    }
+  })
+
+  // Opus (FEC, DTX e faixa de bitrate)
+  ipcMain.handle('sip-native:setOpusOptions', async (_, options: OpusOptions) => {
+    if (!sipAddon) {
+      return { success: false, error: 'Módulo não inicializado' }
+    }
+
+    try {
+      const success = await sipAddon.setOpusOptionsAsync(options)
+      return { success }
+    } catch (error) {
+      return { success: false, error: String(error) }
+    }
+  })
+
+  ipcMain.handle('sip-native:getCaptureStats', async () => {
+    if (!sipAddon) return null
+
+    try {
+      return sipAddon.getCaptureStats()
+    } catch (error) {
+      console.error('[SIP Native] Erro ao obter estatísticas de captura:', error)
+      return null
+    }
+  })
+
+  // VAD do microfone (supressão de silêncio por codec)
+  ipcMain.handle('sip-native:setVadOptions', async (_, options: VadOptions) => {
+    if (!sipAddon) {
+      return { success: false, error: 'Módulo não inicializado' }
+    }
+
+    try {
+      const success = await sipAddon.setVadOptionsAsync(options)
+      return { success }
+    } catch (error) {
+      return { success: false, error: String(error) }
+    }
+  })
+
+  ipcMain.handle('sip-native:getVadStats', async () => {
+    if (!sipAddon) return null
+
+    try {
+      return sipAddon.getVadStats()
+    } catch (error) {
+      console.error('[SIP Native] Erro ao obter estatísticas do VAD:', error)
+      return null
+    }
+  })
+
+  // Histórico de chamadas (null quando o módulo nativo não está disponível)
+  ipcMain.handle('sip-native:queryCallHistory', async (_, query?: CallLogQuery) => {
+    const addon = loadNativeAddon()
+    if (!addon) return null
+
+    try {
+      return addon.queryCallLog(query ?? {})
+    } catch (error) {
+      console.error('[SIP Native] Erro ao consultar histórico:', error)
+      return null
+    }
+  })
+
+  ipcMain.handle('sip-native:appendCallHistory', async (_, entry: Omit<CallLogRecord, 'id'>) => {
+    const addon = loadNativeAddon()
+    if (!addon) return null
+
+    try {
+      return addon.appendCallRecord(entry)
+    } catch (error) {
+      console.error('[SIP Native] Erro ao gravar histórico:', error)
+      return null
+    }
+  })
+
+  ipcMain.handle('sip-native:deleteCallHistory', async (_, id: string) => {
+    if (!sipAddon) return false
+    return sipAddon.removeCallRecord(id)
+  })
+
+  ipcMain.handle('sip-native:clearCallHistory', async () => {
+    if (!sipAddon) return false
+    return sipAddon.clearCallLog()
+  })
+
+  // Diretório de contatos da empresa (identificação de chamadas)
+  ipcMain.handle('sip-native:setContactDirectory', async (_, entries: ContactDirectoryEntry[]) => {
+    companyDirectory = Array.isArray(entries) ? entries : []
+    if (!sipAddon) {
+      return { success: false, error: 'Módulo não inicializado' }
+    }
+
+    syncContactIndex()
+    return { success: true }
+  })
+
+  // Consultar o diretório de contatos
+  ipcMain.handle('sip-native:lookupContact', async (_, number: string) => {
+    if (!sipAddon) return null
+
+    try {
+      return sipAddon.lookupContact(number)
+    } catch (error) {
+      console.error('[SIP Native] Erro ao consultar contato:', error)
+      return null
+    }
+  })
+
+  // BLF: monitorar ramais (estado chega no evento blfUpdate)
+  ipcMain.handle('sip-native:watchExtensions', async (_, extensions: string[], options?: BlfOptions) => {
+    if (!sipAddon) {
+      return { success: false, error: 'Módulo não inicializado' }
+    }
+
+    try {
+      const success = await sipAddon.watchExtensionsAsync(Array.isArray(extensions) ? extensions : [], options ?? {})
+      return { success }
+    } catch (error) {
+      return { success: false, error: String(error) }
+    }
+  })
+
+  ipcMain.handle('sip-native:getBlfStates', async () => {
+    if (!sipAddon) return null
+
+    try {
+      return sipAddon.getBlfStates()
+    } catch (error) {
+      console.error('[SIP Native] Erro ao obter estados BLF:', error)
+      return null
+    }
+  })
+
+  ipcMain.handle('sip-native:getBlfStats', async () => {
+    if (!sipAddon) return null
+
+    try {
+      return sipAddon.getBlfStats()
+    } catch (error) {
+      console.error('[SIP Native] Erro ao obter estatísticas do BLF:', error)
+      return null
+    }
+  })
+
+  // Estado corrente lido do espelho (sem chamar o módulo nativo)
+  ipcMain.handle('sip-native:getLiveState', async () => {
+    if (!sipAddon) return null
+
+    try {
+      if (!readLiveState) {
+        readLiveState = createStateMirrorReader(sipAddon.getStateMirror())
+      }
+      return readLiveState ? readLiveState() : null
+    } catch (error) {
+      console.error('[SIP Native] Erro ao ler o espelho de estado:', error)
+      return null
+    }
+  })
+
+  // Medir consumo ocioso (CPU e despertares por segundo)
+  ipcMain.handle('sip-native:measureIdleUsage', async (_, durationMs?: number) => {
+    return measureNativeIdleUsage(durationMs)
+  })
+
+  // Obter linha do tempo da inicialização
+  ipcMain.handle('sip-native:getStartupTimeline', async () => {
+    if (!sipAddon) return null
+
+    try {
+      return sipAddon.getStartupTimeline()
+    } catch (error) {
+      console.error('[SIP Native] Erro ao obter linha do tempo:', error)
+      return null
+    }
+  })
+
+  // Alterar nível de log do PJSIP
+  ipcMain.handle('sip-native:setLogLevel', async (_, level: number) => {
+    if (!sipAddon) {
+      return { success: false, error: 'Módulo não inicializado' }
+    }
+
+    try {
+      const result = await sipAddon.setLogLevelAsync(level)
+      return { success: result }
+    } catch (error) {
+      return { success: false, error: String(error) }
+    }
+  })
+
+  // Obter estatísticas do log nativo
+  ipcMain.handle('sip-native:getLogStats', async () => {
+    if (!sipAddon) return null
+
+    try {
+      return sipAddon.getLogStats()
+    } catch (error) {
+      console.error('[SIP Native] Erro ao obter estatísticas de log:', error)
+      return null
+    }
+  })
+
   // Registrar callback de eventos
   ipcMain.handle('sip-native:setEventCallback', async () => {
     if (!sipAddon) {
@@ -362,6 +1137,12 @@ export function setupSipIPC(): void {
 
     try {
       sipAddon.setEventCallback((event: string, payload: string) => {
+        // Rotação de log é tratada no main process
+        if (event === 'logRotated') {
+          void compressRotatedLog(JSON.parse(payload).path)
+          return
+        }
+
         // Enviar evento para o renderer via IPC
         const mainWindow = getMainWindow()
         if (mainWindow && !mainWindow.isDestroyed()) {
@@ -389,6 +1170,52 @@ export function setupSipIPC(): void {
   console.log('[SIP Native] IPC handlers configurados')
 }
 
+/**
+ * Exporta as métricas nativas no formato texto OpenMetrics
+ *
+ * Usado pelo agente local de coleta no main process (sem passar pelo renderer).
+ */
+export function getNativeMetrics(): string | null {
+  if (!sipAddon) return null
+
+  try {
+    return sipAddon.getMetrics()
+  } catch (error) {
+    console.error('[SIP Native] Erro ao exportar métricas:', error)
+    return null
+  }
+}
+
+/**
+ * Mede o consumo do processo principal com o addon carregado
+ *
+ * Deve ser chamado sem chamadas ativas. Trocas de contexto voluntárias são
+ * usadas como aproximação de despertares (indisponíveis no Windows).
+ */
+export async function measureNativeIdleUsage(durationMs = 10000): Promise<{
+  cpuPercent: number
+  wakeupsPerSecond: number
+  durationMs: number
+} | null> {
+  if (!sipAddon) return null
+
+  const start = sipAddon.getResourceUsage()
+  await new Promise((resolve) => setTimeout(resolve, durationMs))
+  const end = sipAddon.getResourceUsage()
+
+  const elapsedMs = end.timestampMs - start.timestampMs
+  if (elapsedMs <= 0) return null
+
+  const cpuMs = (end.userCpuMs - start.userCpuMs) + (end.systemCpuMs - start.systemCpuMs)
+  const wakeups = end.voluntaryContextSwitches - start.voluntaryContextSwitches
+
+  return {
+    cpuPercent: (cpuMs / elapsedMs) * 100,
+    wakeupsPerSecond: wakeups / (elapsedMs / 1000),
+    durationMs: elapsedMs
+  }
+}
+
 /**
  * Limpa recursos do módulo nativo
  */
@@ -0,0 +1,128 @@
+/**
+ * @file stateMirror.ts
+ * @brief Leitura do espelho de estado do módulo nativo
+ *
+ * O addon escreve o estado do engine em um ArrayBuffer de layout fixo
+ * (native/src/state_mirror.h). Aqui ele é lido com um Int32Array, sem
+ * chamar o módulo nativo: a sequência fica ímpar durante cada escrita e a
+ * leitura é repetida se ela estava ímpar ou mudou.
+ */
+
+// Layout (índices no Int32Array), igual a state_mirror.h
+const MAGIC = 0x4543484f
+const LAYOUT_VERSION = 1
+const MAX_CALLS = 8
+
+const Slot = {
+  Magic: 0,
+  LayoutVersion: 1,
+  Sequence: 2,
+  Connection: 3,
+  CallStatus: 4,
+  CallDirection: 5,
+  Muted: 6,
+  CurrentCall: 7,
+  TxLevel: 8,
+  RxLevel: 9,
+  Registrations: 10,
+  RegistrationFailures: 11,
+  CallsStarted: 12,
+  CallsEnded: 13,
+  CallCount: 14,
+  Calls: 16,
+} as const
+
+const CALL_WORDS = 4
+const CALL_INCOMING = 1 << 0
+const CALL_HELD = 1 << 1
+const CALL_CURRENT = 1 << 2
+
+// Nomes na ordem dos enums do engine (os mesmos de getSnapshot)
+const CONNECTION_NAMES = ['idle', 'connecting', 'connected', 'registered', 'unregistered', 'error']
+const CALL_STATE_NAMES = [
+  'idle', 'dialing', 'ringing', 'incoming', 'establishing', 'established', 'terminating', 'terminated', 'failed',
+]
+const DIRECTION_NAMES = ['none', 'outgoing', 'incoming']
+
+export interface LiveCallState {
+  callId: number
+  state: string
+  incoming: boolean
+  held: boolean
+  current: boolean
+  lastStatus: number
+}
+
+export interface LiveState {
+  connection: string
+  callStatus: string
+  callDirection: string
+  muted: boolean
+  currentCallId: number | null
+  /** Níveis da chamada atual (0..255), null sem chamada */
+  txLevel: number | null
+  rxLevel: number | null
+  registrations: number
+  registrationFailures: number
+  callsStarted: number
+  callsEnded: number
+  calls: LiveCallState[]
+  /** Publicações desde a criação do espelho */
+  version: number
+}
+
+/**
+ * Cria um leitor para o buffer do addon (null se o layout não é o esperado)
+ */
+export function createStateMirrorReader(buffer: ArrayBuffer): (() => LiveState) | null {
+  const view = new Int32Array(buffer)
+  if (view.length < Slot.Calls + MAX_CALLS * CALL_WORDS ||
+      view[Slot.Magic] !== MAGIC || view[Slot.LayoutVersion] !== LAYOUT_VERSION) {
+    return null
+  }
+
+  // Cópia estável: as palavras são lidas entre duas leituras iguais e pares da sequência
+  const words = new Int32Array(view.length)
+  return () => {
+    let sequence: number
+    do {
+      sequence = Atomics.load(view, Slot.Sequence)
+      if (sequence & 1) continue
+      words.set(view)
+    } while ((sequence & 1) !== 0 || Atomics.load(view, Slot.Sequence) !== sequence)
+
+    const calls: LiveCallState[] = []
+    const count = Math.min(words[Slot.CallCount], MAX_CALLS)
+    for (let i = 0; i < count; i++) {
+      const base = Slot.Calls + i * CALL_WORDS
+      const flags = words[base + 2]
+      calls.push({
+        callId: words[base],
+        state: CALL_STATE_NAMES[words[base + 1]] ?? 'idle',
+        incoming: (flags & CALL_INCOMING) !== 0,
+        held: (flags & CALL_HELD) !== 0,
+        current: (flags & CALL_CURRENT) !== 0,
+        lastStatus: words[base + 3],
+      })
+    }
+
+    const currentCall = words[Slot.CurrentCall]
+    const txLevel = words[Slot.TxLevel]
+    const rxLevel = words[Slot.RxLevel]
+    return {
+      connection: CONNECTION_NAMES[words[Slot.Connection]] ?? 'idle',
+      callStatus: CALL_STATE_NAMES[words[Slot.CallStatus]] ?? 'idle',
+      callDirection: DIRECTION_NAMES[words[Slot.CallDirection]] ?? 'none',
+      muted: words[Slot.Muted] !== 0,
+      currentCallId: currentCall >= 0 ? currentCall : null,
+      txLevel: txLevel >= 0 ? txLevel : null,
+      rxLevel: rxLevel >= 0 ? rxLevel : null,
+      registrations: words[Slot.Registrations] >>> 0,
+      registrationFailures: words[Slot.RegistrationFailures] >>> 0,
+      callsStarted: words[Slot.CallsStarted] >>> 0,
+      callsEnded: words[Slot.CallsEnded] >>> 0,
+      calls,
+      version: (sequence >>> 0) / 2,
+    }
+  }
+}
@@ -81,8 +81,17 @@ contextBridge.exposeInMainWorld('sipNative', {
   },
 
   // DTMF
-  sendDtmf(digits: string) {
-    return ipcRenderer.invoke('sip-native:sendDtmf', digits)
+  sendDtmf(digits: string, options?: { method?: 'rfc2833' | 'info' | 'inband'; toneMs?: number; gapMs?: number; pauseMs?: number }) {
+    return ipcRenderer.invoke('sip-native:sendDtmf', digits, options)
+  },
+  cancelDtmf() {
+    return ipcRenderer.invoke('sip-native:cancelDtmf')
+  },
+  setDtmfOptions(options: { method?: 'rfc2833' | 'info' | 'inband'; toneMs?: number; gapMs?: number; pauseMs?: number }) {
+    return ipcRenderer.invoke('sip-native:setDtmfOptions', options)
+  },
+  setInbandDtmfDetection(enabled: boolean) {
+    return ipcRenderer.invoke('sip-native:setInbandDtmfDetection', enabled)
   },
 
   // Transfer
@@ -92,6 +101,29 @@ contextBridge.exposeInMainWorld('sipNative', {
   transferAttended(target: string) {
     return ipcRenderer.invoke('sip-native:transferAttended', target)
   },
+  startConsult(target: string) {
+    return ipcRenderer.invoke('sip-native:startConsult', target)
+  },
+  swapTransferLegs() {
+    return ipcRenderer.invoke('sip-native:swapTransferLegs')
+  },
+  completeTransfer() {
+    return ipcRenderer.invoke('sip-native:completeTransfer')
+  },
+  cancelTransfer() {
+    return ipcRenderer.invoke('sip-native:cancelTransfer')
+  },
+
+  // Hold
+  hold(callId: number) {
+    return ipcRenderer.invoke('sip-native:hold', callId)
+  },
+  resume(callId: number) {
+    return ipcRenderer.invoke('sip-native:resume', callId)
+  },
+  setHoldMusic(path: string) {
+    return ipcRenderer.invoke('sip-native:setHoldMusic', path)
+  },
 
   // Audio
   setMuted(muted: boolean) {
@@ -114,6 +146,69 @@ contextBridge.exposeInMainWorld('sipNative', {
   getSnapshot() {
     return ipcRenderer.invoke('sip-native:getSnapshot')
   },
+  getCallTimingStats() {
+    return ipcRenderer.invoke('sip-native:getCallTimingStats')
+  },
+  setAudioPowerPolicy(policy: { idleCloseSeconds?: number; nullDeviceWhenIdle?: boolean }) {
+    return ipcRenderer.invoke('sip-native:setAudioPowerPolicy', policy)
+  },
+  setCaptureProcessing(options: { highPass?: boolean; noiseSuppression?: boolean; agc?: boolean; budgetPercent?: number }) {
+    return ipcRenderer.invoke('sip-native:setCaptureProcessing', options)
+  },
+  getCaptureStats() {
+    return ipcRenderer.invoke('sip-native:getCaptureStats')
+  },
+  setOpusOptions(options: { fec?: boolean; dtx?: boolean; minBitrate?: number; maxBitrate?: number; startBitrate?: number }) {
+    return ipcRenderer.invoke('sip-native:setOpusOptions', options)
+  },
+  setVadOptions(options: { enabled?: boolean; hangoverMs?: number; thresholdDb?: number; codecs?: string[] }) {
+    return ipcRenderer.invoke('sip-native:setVadOptions', options)
+  },
+  getVadStats() {
+    return ipcRenderer.invoke('sip-native:getVadStats')
+  },
+  queryCallHistory(query?: { before?: string; limit?: number; number?: string; since?: number; until?: number }) {
+    return ipcRenderer.invoke('sip-native:queryCallHistory', query)
+  },
+  appendCallHistory(entry: Record<string, unknown>) {
+    return ipcRenderer.invoke('sip-native:appendCallHistory', entry)
+  },
+  deleteCallHistory(id: string) {
+    return ipcRenderer.invoke('sip-native:deleteCallHistory', id)
+  },
+  clearCallHistory() {
+    return ipcRenderer.invoke('sip-native:clearCallHistory')
+  },
+  setContactDirectory(entries: Array<{ name: string; number: string }>) {
+    return ipcRenderer.invoke('sip-native:setContactDirectory', entries)
+  },
+  lookupContact(number: string) {
+    return ipcRenderer.invoke('sip-native:lookupContact', number)
+  },
+  watchExtensions(extensions: string[], options?: { listUri?: string; batchIntervalMs?: number; expiresSeconds?: number }) {
+    return ipcRenderer.invoke('sip-native:watchExtensions', extensions, options)
+  },
+  getBlfStates() {
+    return ipcRenderer.invoke('sip-native:getBlfStates')
+  },
+  getBlfStats() {
+    return ipcRenderer.invoke('sip-native:getBlfStats')
+  },
+  getLiveState() {
+    return ipcRenderer.invoke('sip-native:getLiveState')
+  },
+  measureIdleUsage(durationMs?: number) {
+    return ipcRenderer.invoke('sip-native:measureIdleUsage', durationMs)
+  },
+  getStartupTimeline() {
+    return ipcRenderer.invoke('sip-native:getStartupTimeline')
+  },
+  setLogLevel(level: number) {
+    return ipcRenderer.invoke('sip-native:setLogLevel', level)
+  },
+  getLogStats() {
+    return ipcRenderer.invoke('sip-native:getLogStats')
+  },
 
   // Events
   setEventCallback() {
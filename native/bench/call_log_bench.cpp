@@ -0,0 +1,126 @@
+/**
+ * @file call_log_bench.cpp
+ * @brief Benchmark do histórico de chamadas mapeado em memória
+ *
+ * Grava N registros em um arquivo temporário e mede o custo de inserção
+ * no início e no fim (deve ser o mesmo: não há reescrita), a consulta
+ * paginada, a consulta por número e a compactação.
+ *
+ * Uso: call_log_bench [registros] [arquivo]
+ */
+
+#include "call_log.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedNs(Clock::time_point start) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+echo::CallRecord makeRecord(long i) {
+    echo::CallRecord record;
+    record.startTimeMs = 1700000000000LL + i * 60000;
+    record.answerTimeMs = record.startTimeMs + 5000;
+    record.endTimeMs = record.startTimeMs + 45000;
+    record.sipStatus = 200;
+    record.direction = (i % 2) ? echo::CallLogDirection::Incoming : echo::CallLogDirection::Outgoing;
+    record.status = (i % 2) ? echo::CallLogStatus::Answered : echo::CallLogStatus::Completed;
+    record.number = "+55 11 9" + std::to_string(10000000 + i % 20000);
+    record.displayName = "Contato " + std::to_string(i % 20000);
+    return record;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    long count = argc > 1 ? std::atol(argv[1]) : 1000000;
+    std::string path = argc > 2 ? argv[2] : "call_log_bench.log";
+    if (count < 10) {
+        std::fprintf(stderr, "uso: %s [registros >= 10] [arquivo]\n", argv[0]);
+        return 2;
+    }
+
+    std::remove(path.c_str());
+
+    echo::CallLog log;
+    std::string error;
+    if (!log.open(path, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    // Registros prontos: mede apenas a inserção
+    std::vector<echo::CallRecord> records;
+    records.reserve(static_cast<size_t>(count));
+    for (long i = 0; i < count; ++i) {
+        records.push_back(makeRecord(i));
+    }
+
+    long tenth = count / 10;
+    auto start = Clock::now();
+    for (long i = 0; i < tenth; ++i) {
+        log.append(records[static_cast<size_t>(i)]);
+    }
+    double firstNs = elapsedNs(start) / static_cast<double>(tenth);
+
+    for (long i = tenth; i < count - tenth; ++i) {
+        log.append(records[static_cast<size_t>(i)]);
+    }
+
+    start = Clock::now();
+    for (long i = count - tenth; i < count; ++i) {
+        log.append(records[static_cast<size_t>(i)]);
+    }
+    double lastNs = elapsedNs(start) / static_cast<double>(tenth);
+
+    // Páginas de 50 a partir de cursores espalhados
+    const int pages = 10000;
+    size_t rows = 0;
+    start = Clock::now();
+    for (int i = 0; i < pages; ++i) {
+        echo::CallLogQuery query;
+        query.limit = 50;
+        query.beforeId = static_cast<uint64_t>(1 + (static_cast<long>(i) * 7919) % count);
+        rows += log.query(query).records.size();
+    }
+    double pageUs = elapsedNs(start) / 1000.0 / pages;
+
+    // Número presente em count/20000 registros, em formato diferente do gravado
+    start = Clock::now();
+    echo::CallLogQuery byNumber;
+    byNumber.number = "011910000042";
+    byNumber.limit = 50;
+    size_t numberRows = log.query(byNumber).records.size();
+    double numberUs = elapsedNs(start) / 1000.0;
+
+    // Exclui metade e compacta
+    for (long i = 1; i <= count; i += 2) {
+        log.remove(static_cast<uint64_t>(i));
+    }
+    log.close();
+    log.open(path, &error);
+    start = Clock::now();
+    log.compact();
+    double compactMs = elapsedNs(start) / 1e6;
+
+    echo::CallLogStats stats = log.getStats();
+    std::printf("%ld registros (%zu linhas lidas)\n", count, rows);
+    std::printf("inserção (primeiros 10%%): %8.1f ns/registro\n", firstNs);
+    std::printf("inserção (últimos 10%%):   %8.1f ns/registro\n", lastNs);
+    std::printf("página de 50:             %8.1f us\n", pageUs);
+    std::printf("consulta por número:      %8.1f us (%zu registros)\n", numberUs, numberRows);
+    std::printf("compactação (50%% excl.):  %8.1f ms -> %llu registros, %llu bytes\n", compactMs,
+                static_cast<unsigned long long>(stats.records), static_cast<unsigned long long>(stats.fileBytes));
+
+    log.close();
+    std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file engine_events.h
+ * @brief Fila dos eventos emitidos pelo SipEngine nos benchmarks
+ *
+ * Recebe os eventos pelo JsonEventSink (threads do engine) e os entrega ao
+ * thread do benchmark na ordem de emissão.
+ */
+
+#ifndef ENGINE_EVENTS_H
+#define ENGINE_EVENTS_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+
+namespace echo {
+namespace bench {
+
+/**
+ * @brief Evento do engine com o payload JSON
+ */
+struct EngineEvent {
+    std::string name;
+    std::string json;
+};
+
+/**
+ * @brief Fila de eventos do engine
+ */
+class EngineEventQueue {
+public:
+    /**
+     * @brief Enfileira um evento (compatível com SipEngine::JsonEventSink)
+     */
+    void push(const std::string& name, const std::string& json) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_events.push_back(EngineEvent{name, json});
+        }
+        m_cv.notify_all();
+    }
+
+    /**
+     * @brief Retira o próximo evento
+     * @return false em caso de timeout
+     */
+    bool next(EngineEvent& event, int timeoutMs) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!m_cv.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() { return !m_events.empty(); })) {
+            return false;
+        }
+        event = std::move(m_events.front());
+        m_events.pop_front();
+        return true;
+    }
+
+    /**
+     * @brief Aguarda um evento pelo nome, descartando os anteriores
+     * @return false em caso de timeout
+     */
+    bool waitFor(const std::string& name, int timeoutMs) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        EngineEvent event;
+        for (;;) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (left < 0 || !next(event, static_cast<int>(left))) {
+                return false;
+            }
+            if (event.name == name) {
+                return true;
+            }
+        }
+    }
+
+    /**
+     * @brief Descarta os eventos pendentes
+     */
+    void clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_events.clear();
+    }
+
+private:
+    std::deque<EngineEvent> m_events;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+
+} // namespace bench
+} // namespace echo
+
+#endif // ENGINE_EVENTS_H
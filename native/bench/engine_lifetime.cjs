@@ -0,0 +1,62 @@
+/**
+ * @file engine_lifetime.cjs
+ * @brief Estado do ambiente que sobrevive ao destroy/init de uma reconexão
+ *
+ * Cada destroy descarta o engine e o init seguinte cria outro. O histórico
+ * de chamadas é aberto uma vez, quando o addon é carregado, e o diretório
+ * de contatos só é recarregado quando os contatos mudam: os dois precisam
+ * continuar disponíveis para o engine novo.
+ *
+ * Uso: node bench/engine_lifetime.cjs [caminho do addon]
+ */
+
+const assert = require('node:assert/strict')
+const fs = require('node:fs')
+const os = require('node:os')
+const path = require('node:path')
+
+const addonPath = process.argv[2] ?? path.join(__dirname, '..', 'build', 'Release', 'pjsip_addon.node')
+
+function record(number) {
+  const now = Date.now()
+  return { number, direction: 'outgoing', status: 'completed', startTime: now - 1000, endTime: now }
+}
+
+async function main() {
+  const addon = require(addonPath)
+  const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'echo-lifetime-'))
+
+  try {
+    assert.equal(await addon.initAsync(), true)
+    assert.equal(addon.openCallLog(path.join(directory, 'call-history.log')), true)
+    assert.notEqual(addon.appendCallRecord(record('1001')), null)
+    assert.equal((await addon.loadContactsAsync([{ name: 'Recepção', number: '2000' }])).entries, 1)
+
+    // Reconexão: destroy → init cria um engine novo
+    assert.equal(await addon.destroyAsync(), true)
+    assert.equal(await addon.initAsync(), true)
+
+    const page = addon.queryCallLog({})
+    assert.equal(page.total, 1, 'histórico deveria continuar aberto após destroy/init')
+    assert.equal(page.entries[0].number, '1001')
+    assert.notEqual(addon.appendCallRecord(record('1002')), null, 'histórico deveria aceitar gravações após destroy/init')
+    assert.equal(addon.getCallLogStats().records, 2)
+    assert.equal(addon.lookupContact('2000'), 'Recepção', 'contatos deveriam continuar carregados após destroy/init')
+
+    // Contatos alterados entre destroy e init valem para o próximo engine
+    assert.equal(await addon.destroyAsync(), true)
+    assert.equal((await addon.loadContactsAsync([{ name: 'Suporte', number: '3000' }])).entries, 1)
+    assert.equal(await addon.initAsync(), true)
+    assert.equal(addon.lookupContact('3000'), 'Suporte')
+
+    assert.equal(await addon.destroyAsync(), true)
+    console.log('OK   histórico e contatos após destroy/init')
+  } finally {
+    fs.rmSync(directory, { recursive: true, force: true })
+  }
+}
+
+main().catch((error) => {
+  console.error('FALHA', error.message)
+  process.exit(1)
+})
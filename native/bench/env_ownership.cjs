@@ -0,0 +1,98 @@
+/**
+ * @file env_ownership.cjs
+ * @brief Posse do PJSUA entre ambientes (thread principal e worker_threads)
+ *
+ * O PJSUA é único no processo: o addon pode ser carregado em vários
+ * ambientes, mas só o primeiro que chamar init/prewarm fica com o engine.
+ * Verifica que carregar o addon não toma a posse, que os outros ambientes
+ * recebem false enquanto ela está tomada e que ela é devolvida por destroy
+ * e pelo encerramento do worker dono (cleanup hook do ambiente).
+ *
+ * Uso: node bench/env_ownership.cjs [caminho do addon]
+ */
+
+const assert = require('node:assert/strict')
+const path = require('node:path')
+const { Worker, isMainThread, parentPort, workerData } = require('node:worker_threads')
+
+const addonPath = process.argv[2] ?? path.join(__dirname, '..', 'build', 'Release', 'pjsip_addon.node')
+
+if (!isMainThread) {
+  // Executa os comandos pedidos pelo thread principal
+  const addon = require(workerData.addonPath)
+  parentPort.on('message', async (command) => {
+    switch (command) {
+      case 'init':
+        parentPort.postMessage(await addon.initAsync())
+        break
+      case 'isInitialized':
+        parentPort.postMessage(addon.isInitialized())
+        break
+      case 'destroy':
+        parentPort.postMessage(await addon.destroyAsync())
+        break
+      case 'exit':
+        process.exit(0)
+    }
+  })
+  parentPort.postMessage('ready')
+  return
+}
+
+function startWorker() {
+  const worker = new Worker(__filename, { workerData: { addonPath } })
+  const replies = []
+  const waiting = []
+  worker.on('message', (message) => {
+    const resolve = waiting.shift()
+    if (resolve) resolve(message)
+    else replies.push(message)
+  })
+  const next = () => (replies.length > 0 ? Promise.resolve(replies.shift()) : new Promise((r) => waiting.push(r)))
+  return {
+    ready: next,
+    send(command) {
+      worker.postMessage(command)
+      return next()
+    },
+    exited: new Promise((resolve) => worker.once('exit', resolve)),
+    worker,
+  }
+}
+
+async function main() {
+  const addon = require(addonPath)
+
+  // 1. Carregar não toma a posse: o worker inicializa mesmo com o addon
+  //    já carregado no thread principal
+  const first = startWorker()
+  assert.equal(await first.ready(), 'ready')
+  assert.equal(await first.send('init'), true, 'worker deveria tomar a posse')
+  assert.equal(await first.send('isInitialized'), true)
+
+  // 2. Com o worker dono, o thread principal não tem engine
+  assert.equal(await addon.initAsync(), false, 'thread principal não deveria inicializar')
+  assert.equal(addon.isInitialized(), false)
+
+  // 3. O fim do worker (cleanup hook) encerra o PJSUA e devolve a posse
+  first.send('exit')
+  await first.exited
+  assert.equal(await addon.initAsync(), true, 'posse deveria voltar após o fim do worker')
+
+  // 4. Worker terminado à força também devolve; destroy devolve explicitamente
+  const second = startWorker()
+  assert.equal(await second.ready(), 'ready')
+  assert.equal(await second.send('init'), false, 'worker não deveria tomar a posse do thread principal')
+  assert.equal(await addon.destroyAsync(), true)
+  assert.equal(await second.send('init'), true, 'posse deveria passar ao worker após destroy')
+  await second.worker.terminate()
+  assert.equal(await addon.initAsync(), true, 'posse deveria voltar após terminate')
+  assert.equal(await addon.destroyAsync(), true)
+
+  console.log('OK   posse do PJSUA entre ambientes')
+}
+
+main().catch((error) => {
+  console.error('FALHA', error.message)
+  process.exit(1)
+})
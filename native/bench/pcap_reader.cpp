@@ -0,0 +1,164 @@
+/**
+ * @file pcap_reader.cpp
+ * @brief Implementação da leitura de pcap
+ */
+
+#include "pcap_reader.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace echo {
+namespace bench {
+
+namespace {
+
+constexpr uint32_t kMagicMicros = 0xa1b2c3d4;
+constexpr uint32_t kMagicNanos = 0xa1b23c4d;
+
+constexpr uint32_t kLinkEthernet = 1;
+constexpr uint32_t kLinkRaw = 101;
+constexpr uint32_t kLinkLinuxSll = 113;
+
+uint32_t swap32(uint32_t v) {
+    return ((v & 0xff) << 24) | ((v & 0xff00) << 8) | ((v >> 8) & 0xff00) | (v >> 24);
+}
+
+uint16_t readBe16(const unsigned char* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+bool fail(std::string* error, const std::string& message) {
+    if (error) *error = message;
+    return false;
+}
+
+// Extrai o datagrama UDP de um pacote IPv4 (a partir do cabeçalho IP)
+bool extractUdp(const unsigned char* ip, size_t length, PcapPacket& packet) {
+    if (length < 20 || (ip[0] >> 4) != 4) {
+        return false;
+    }
+
+    size_t headerLength = static_cast<size_t>(ip[0] & 0x0f) * 4;
+    uint16_t totalLength = readBe16(ip + 2);
+    uint16_t fragment = readBe16(ip + 6);
+    if (headerLength < 20 || totalLength < headerLength || totalLength > length) {
+        return false;
+    }
+    // Fragmentos (offset != 0 ou mais fragmentos) não são remontados
+    if ((fragment & 0x3fff) != 0 || ip[9] != 17) {
+        return false;
+    }
+
+    const unsigned char* udp = ip + headerLength;
+    size_t udpSpace = totalLength - headerLength;
+    if (udpSpace < 8) {
+        return false;
+    }
+
+    uint16_t udpLength = readBe16(udp + 4);
+    if (udpLength < 8 || udpLength > udpSpace) {
+        return false;
+    }
+
+    packet.sourcePort = readBe16(udp);
+    packet.destinationPort = readBe16(udp + 2);
+    packet.payload.assign(reinterpret_cast<const char*>(udp + 8), udpLength - 8);
+    return true;
+}
+
+} // namespace
+
+bool readPcapUdp(const std::string& path, std::vector<PcapPacket>& packets, std::string* error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return fail(error, "não foi possível abrir " + path);
+    }
+
+    unsigned char header[24];
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        return fail(error, "cabeçalho pcap incompleto");
+    }
+
+    uint32_t magic;
+    std::memcpy(&magic, header, sizeof(magic));
+    bool swapped = magic == swap32(kMagicMicros) || magic == swap32(kMagicNanos);
+    if (swapped) {
+        magic = swap32(magic);
+    }
+    if (magic != kMagicMicros && magic != kMagicNanos) {
+        return fail(error, "formato não suportado (apenas pcap clássico)");
+    }
+    bool nanos = magic == kMagicNanos;
+
+    auto field = [swapped](const unsigned char* p) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return swapped ? swap32(v) : v;
+    };
+
+    uint32_t linkType = field(header + 20);
+    if (linkType != kLinkEthernet && linkType != kLinkRaw && linkType != kLinkLinuxSll) {
+        return fail(error, "tipo de enlace não suportado: " + std::to_string(linkType));
+    }
+
+    int64_t firstTimestamp = -1;
+    std::vector<unsigned char> data;
+
+    for (;;) {
+        unsigned char record[16];
+        if (!file.read(reinterpret_cast<char*>(record), sizeof(record))) {
+            break;
+        }
+
+        uint32_t seconds = field(record);
+        uint32_t fraction = field(record + 4);
+        uint32_t capturedLength = field(record + 8);
+        if (capturedLength > 262144) {
+            return fail(error, "registro pcap corrompido");
+        }
+
+        data.resize(capturedLength);
+        if (!file.read(reinterpret_cast<char*>(data.data()), capturedLength)) {
+            return fail(error, "registro pcap truncado");
+        }
+
+        int64_t timestamp = static_cast<int64_t>(seconds) * 1000000 + (nanos ? fraction / 1000 : fraction);
+        if (firstTimestamp < 0) {
+            firstTimestamp = timestamp;
+        }
+
+        const unsigned char* p = data.data();
+        size_t length = capturedLength;
+
+        if (linkType == kLinkEthernet) {
+            if (length < 14) continue;
+            uint16_t etherType = readBe16(p + 12);
+            size_t offset = 14;
+            // VLAN 802.1Q
+            if (etherType == 0x8100 && length >= 18) {
+                etherType = readBe16(p + 16);
+                offset = 18;
+            }
+            if (etherType != 0x0800) continue;
+            p += offset;
+            length -= offset;
+        } else if (linkType == kLinkLinuxSll) {
+            if (length < 16 || readBe16(p + 14) != 0x0800) continue;
+            p += 16;
+            length -= 16;
+        }
+
+        PcapPacket packet;
+        if (!extractUdp(p, length, packet)) {
+            continue;
+        }
+        packet.timestampMicros = timestamp - firstTimestamp;
+        packets.push_back(std::move(packet));
+    }
+
+    return true;
+}
+
+} // namespace bench
+} // namespace echo
@@ -0,0 +1,42 @@
+/**
+ * @file pcap_reader.h
+ * @brief Leitura de datagramas UDP de arquivos pcap
+ *
+ * Suporta o formato pcap clássico (micro e nanossegundos, ambas as ordens
+ * de bytes) com enlace Ethernet, Linux cooked (SLL) ou IPv4 cru. Pacotes
+ * que não são UDP/IPv4 ou que estão fragmentados são ignorados.
+ */
+
+#ifndef PCAP_READER_H
+#define PCAP_READER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace echo {
+namespace bench {
+
+/**
+ * @brief Datagrama UDP extraído do pcap
+ */
+struct PcapPacket {
+    int64_t timestampMicros = 0;    // Relativo ao primeiro pacote do arquivo
+    uint16_t sourcePort = 0;
+    uint16_t destinationPort = 0;
+    std::string payload;
+};
+
+/**
+ * @brief Lê os datagramas UDP de um arquivo pcap
+ * @param path Caminho do arquivo
+ * @param packets Recebe os datagramas na ordem do arquivo
+ * @param error Recebe a descrição do erro (opcional)
+ * @return false se o arquivo não puder ser lido
+ */
+bool readPcapUdp(const std::string& path, std::vector<PcapPacket>& packets, std::string* error);
+
+} // namespace bench
+} // namespace echo
+
+#endif // PCAP_READER_H
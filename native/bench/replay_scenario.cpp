@@ -0,0 +1,126 @@
+/**
+ * @file replay_scenario.cpp
+ * @brief Implementação da leitura de roteiros de replay
+ */
+
+#include "replay_scenario.h"
+
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace echo {
+namespace bench {
+
+namespace {
+
+struct CommandSpec {
+    ReplayStepType type;
+    size_t minArgs;
+};
+
+const std::map<std::string, CommandSpec>& commands() {
+    static const std::map<std::string, CommandSpec> specs = {
+        {"timeout", {ReplayStepType::Timeout, 1}},
+        {"ignore-event", {ReplayStepType::IgnoreEvent, 1}},
+        {"at", {ReplayStepType::At, 1}},
+        {"action", {ReplayStepType::Action, 1}},
+        {"expect-sip", {ReplayStepType::ExpectSip, 1}},
+        {"respond", {ReplayStepType::Respond, 1}},
+        {"respond-sdp", {ReplayStepType::RespondSdp, 1}},
+        {"send", {ReplayStepType::Send, 0}},
+        {"expect-event", {ReplayStepType::ExpectEvent, 1}},
+        {"expect-snapshot", {ReplayStepType::ExpectSnapshot, 2}},
+        {"rtp", {ReplayStepType::Rtp, 1}},
+    };
+    return specs;
+}
+
+std::string stripCr(std::string line) {
+    if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+    }
+    return line;
+}
+
+std::string trim(const std::string& value) {
+    size_t begin = value.find_first_not_of(" \t");
+    if (begin == std::string::npos) return "";
+    size_t end = value.find_last_not_of(" \t");
+    return value.substr(begin, end - begin + 1);
+}
+
+} // namespace
+
+bool loadReplayScenario(const std::string& path, ReplayScenario& scenario, std::string* error) {
+    std::ifstream file(path);
+    if (!file) {
+        if (error) *error = path + ": não foi possível abrir";
+        return false;
+    }
+
+    scenario = ReplayScenario();
+    scenario.path = path;
+    size_t slash = path.find_last_of('/');
+    scenario.directory = slash == std::string::npos ? "." : path.substr(0, slash);
+
+    auto failAt = [&](int line, const std::string& message) {
+        if (error) *error = path + ":" + std::to_string(line) + ": " + message;
+        return false;
+    };
+
+    std::string raw;
+    int lineNumber = 0;
+    while (std::getline(file, raw)) {
+        ++lineNumber;
+        std::string line = trim(stripCr(raw));
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        size_t space = line.find_first_of(" \t");
+        std::string name = line.substr(0, space);
+        auto spec = commands().find(name);
+        if (spec == commands().end()) {
+            return failAt(lineNumber, "comando desconhecido: " + name);
+        }
+
+        ReplayStep step;
+        step.type = spec->second.type;
+        step.line = lineNumber;
+        step.rest = space == std::string::npos ? "" : trim(line.substr(space));
+
+        std::istringstream words(step.rest);
+        std::string word;
+        while (words >> word) {
+            step.args.push_back(word);
+        }
+        if (step.args.size() < spec->second.minArgs) {
+            return failAt(lineNumber, name + ": argumentos insuficientes");
+        }
+
+        if (step.type == ReplayStepType::Send) {
+            // Mensagem literal até uma linha com apenas "."
+            bool terminated = false;
+            while (std::getline(file, raw)) {
+                ++lineNumber;
+                std::string blockLine = stripCr(raw);
+                if (blockLine == ".") {
+                    terminated = true;
+                    break;
+                }
+                step.block += blockLine + "\n";
+            }
+            if (!terminated) {
+                return failAt(step.line, "send sem linha final \".\"");
+            }
+        }
+
+        scenario.steps.push_back(std::move(step));
+    }
+
+    return true;
+}
+
+} // namespace bench
+} // namespace echo
@@ -0,0 +1,91 @@
+/**
+ * @file replay_scenario.h
+ * @brief Roteiros de replay SIP/RTP
+ *
+ * Um roteiro é um arquivo texto com um comando por linha, executado em
+ * ordem contra um SipEngine. O lado remoto (registrar, PBX, outro
+ * telefone) é interpretado pelo próprio roteiro:
+ *
+ *   # comentário
+ *   timeout 2000                  Timeout (ms, relógio real) dos expect-*
+ *   ignore-event mediaActive      Evento fora da sequência verificada
+ *   at 150                        Avança o relógio virtual para 150 ms
+ *   action register 1000 secret   Chama o engine (register, call, answer,
+ *                                 reject, hangup, dtmf, transfer-blind,
+ *                                 transfer-attended, consult, swap-transfer,
+ *                                 complete-transfer, cancel-transfer)
+ *   expect-sip INVITE             Próxima mensagem do engine (método ou código)
+ *   respond 200 OK                Responde à última requisição do engine
+ *   respond-sdp 200 OK            Idem, com resposta SDP (PCMU + telephone-event)
+ *   send                          Envia a mensagem literal que segue, até
+ *   ...                           uma linha contendo apenas "."
+ *   .
+ *   expect-event incomingCall [contains <texto>]
+ *   expect-snapshot callStatus established
+ *                                 Campo do snapshot (connection, callStatus,
+ *                                 callDirection, remoteUri) após o thread SIP
+ *                                 processar o que já recebeu *   rtp chamada.pcap              Envia o RTP do pcap para o engine
+ *
+ * Nas mensagens e argumentos, ${variavel} é substituída (veja ReplayRunner).
+ */
+
+#ifndef REPLAY_SCENARIO_H
+#define REPLAY_SCENARIO_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace echo {
+namespace bench {
+
+/**
+ * @brief Tipo de passo do roteiro
+ */
+enum class ReplayStepType {
+    Timeout,
+    IgnoreEvent,
+    At,
+    Action,
+    ExpectSip,
+    Respond,
+    RespondSdp,
+    Send,
+    ExpectEvent,
+    ExpectSnapshot,
+    Rtp
+};
+
+/**
+ * @brief Passo do roteiro
+ */
+struct ReplayStep {
+    ReplayStepType type;
+    int line = 0;                   // Linha no arquivo (para mensagens de erro)
+    std::vector<std::string> args;  // Argumentos separados por espaço
+    std::string rest;               // Texto após o comando (sem separação)
+    std::string block;              // Mensagem literal (send)
+};
+
+/**
+ * @brief Roteiro carregado
+ */
+struct ReplayScenario {
+    std::string path;
+    std::string directory;          // Base para caminhos relativos (rtp)
+    std::vector<ReplayStep> steps;
+};
+
+/**
+ * @brief Carrega um roteiro
+ * @param path Caminho do arquivo
+ * @param scenario Recebe o roteiro
+ * @param error Recebe "arquivo:linha: descrição" em caso de erro
+ * @return false se o arquivo não puder ser lido ou tiver comandos inválidos
+ */
+bool loadReplayScenario(const std::string& path, ReplayScenario& scenario, std::string* error);
+
+} // namespace bench
+} // namespace echo
+
+#endif // REPLAY_SCENARIO_H
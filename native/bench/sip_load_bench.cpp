@@ -0,0 +1,365 @@
+/**
+ * @file sip_load_bench.cpp
+ * @brief Benchmark de carga do SipEngine sem Node
+ *
+ * Sobe um SipStandIn em loopback e dispara N processos filhos, cada um com
+ * um SipEngine (o pjsua é um singleton por processo) usando o dispositivo
+ * de áudio nulo. Cada filho executa o ciclo registro → chamada → DTMF →
+ * transferência/desligamento e reporta as medições ao pai por um pipe.
+ *
+ * Uso: sip_load_bench [--instances N] [--calls M] [--transfer-every K] [--timeout-ms T]
+ */
+
+#include "engine_events.h"
+#include "sip_standin.h"
+
+#include "call_timing.h"
+#include "resource_usage.h"
+#include "sip_engine.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern "C" {
+#include <pjsua-lib/pjsua.h>
+}
+
+namespace {
+
+using echo::bench::EngineEventQueue;
+using echo::bench::SipStandIn;
+using echo::bench::SipStandInStats;
+
+struct BenchOptions {
+    int instances = 4;
+    int calls = 50;
+    int transferEvery = 5;      // 0 desativa as transferências
+    int timeoutMs = 5000;
+};
+
+long maxRssKb() {
+    rusage usage;
+    std::memset(&usage, 0, sizeof(usage));
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;  // Bytes no macOS
+#else
+    return usage.ru_maxrss;         // KB no Linux
+#endif
+}
+
+void writeLine(int fd, const std::string& line) {
+    std::string data = line + "\n";
+    const char* p = data.data();
+    size_t left = data.size();
+    while (left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n <= 0) return;
+        p += n;
+        left -= static_cast<size_t>(n);
+    }
+}
+
+/**
+ * @brief Corpo de um processo filho: um softphone simulado
+ *
+ * Linhas enviadas ao pai:
+ *   call <setup_us> <total_us>
+ *   fail <etapa>
+ *   usage <cpu_ms> <maxrss_kb> <calls>
+ */
+int runInstance(int index, int port, const BenchOptions& options, int out) {
+    EngineEventQueue events;
+
+    echo::SipEngine engine;
+    engine.setLogLevel(0);
+    engine.setJsonEventSink([&events](const std::string& event, const std::string& json) {
+        events.push(event, json);
+    });
+
+    if (!engine.init()) {
+        writeLine(out, "fail init");
+        return 1;
+    }
+
+    // Sem hardware de áudio: a ponte de conferência é cadenciada pelo dispositivo nulo
+    engine.execute([]() { return pjsua_set_null_snd_dev() == PJ_SUCCESS; });
+
+    echo::SipCredentials credentials;
+    credentials.username = "bench" + std::to_string(index);
+    credentials.password = "bench";
+    credentials.server = "127.0.0.1";
+    credentials.port = port;
+    credentials.transport = "udp";
+
+    if (!engine.registerAccount(credentials) || !events.waitFor("registered", options.timeoutMs)) {
+        writeLine(out, "fail register");
+        engine.destroy();
+        return 1;
+    }
+
+    const std::string target = "sip:uas@127.0.0.1:" + std::to_string(port);
+    const std::string transferTarget = "sip:transfer@127.0.0.1:" + std::to_string(port);
+
+    echo::ResourceUsage before = echo::sampleResourceUsage();
+    int completed = 0;
+
+    for (int i = 0; i < options.calls; ++i) {
+        events.clear();
+        int64_t start = echo::monotonicMicros();
+
+        if (!engine.makeCall(target) || !events.waitFor("established", options.timeoutMs)) {
+            writeLine(out, "fail call");
+            engine.hangupCall();
+            events.waitFor("terminated", options.timeoutMs);
+            continue;
+        }
+
+        double setupMs = engine.getSnapshot().timings.setupTimeMs();
+
+        engine.sendDtmf("123");
+
+        bool transfer = options.transferEvery > 0 && (i + 1) % options.transferEvery == 0;
+        if (transfer) {
+            if (!engine.transferBlind(transferTarget) || !events.waitFor("transferSuccess", options.timeoutMs)) {
+                writeLine(out, "fail transfer");
+                engine.hangupCall();
+            }
+        } else {
+            engine.hangupCall();
+        }
+
+        if (!events.waitFor("terminated", options.timeoutMs)) {
+            writeLine(out, "fail hangup");
+            continue;
+        }
+
+        int64_t total = echo::monotonicMicros() - start;
+        writeLine(out, "call " + std::to_string(static_cast<int64_t>(setupMs * 1000.0)) + " " +
+                       std::to_string(total));
+        ++completed;
+    }
+
+    echo::ResourceUsage after = echo::sampleResourceUsage();
+    double cpuMs = (after.userCpuMs + after.systemCpuMs) - (before.userCpuMs + before.systemCpuMs);
+
+    engine.unregister();
+    engine.destroy();
+
+    writeLine(out, "usage " + std::to_string(cpuMs) + " " + std::to_string(maxRssKb()) + " " +
+                   std::to_string(completed));
+    return 0;
+}
+
+bool parseOptions(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        int value = std::atoi(argv[++i]);
+        if (arg == "--instances") {
+            options.instances = value;
+        } else if (arg == "--calls") {
+            options.calls = value;
+        } else if (arg == "--transfer-every") {
+            options.transferEvery = value;
+        } else if (arg == "--timeout-ms") {
+            options.timeoutMs = value;
+        } else {
+            return false;
+        }
+    }
+    return options.instances > 0 && options.calls > 0 && options.timeoutMs > 0;
+}
+
+struct Child {
+    pid_t pid = -1;
+    int fd = -1;
+    std::string pending;
+};
+
+struct Totals {
+    uint64_t calls = 0;
+    uint64_t failures = 0;
+    double cpuMs = 0;
+    long maxRssKb = 0;
+    long sumRssKb = 0;
+    int instancesReported = 0;
+};
+
+void consumeLine(const std::string& line, echo::LatencyHistogram& setup,
+                 echo::LatencyHistogram& total, Totals& totals) {
+    char kind[16] = {0};
+    if (std::sscanf(line.c_str(), "%15s", kind) != 1) {
+        return;
+    }
+
+    if (std::strcmp(kind, "call") == 0) {
+        long long setupUs = 0;
+        long long totalUs = 0;
+        if (std::sscanf(line.c_str(), "call %lld %lld", &setupUs, &totalUs) == 2) {
+            setup.record(setupUs);
+            total.record(totalUs);
+            ++totals.calls;
+        }
+    } else if (std::strcmp(kind, "fail") == 0) {
+        ++totals.failures;
+        std::fprintf(stderr, "%s\n", line.c_str());
+    } else if (std::strcmp(kind, "usage") == 0) {
+        double cpuMs = 0;
+        long rssKb = 0;
+        int calls = 0;
+        if (std::sscanf(line.c_str(), "usage %lf %ld %d", &cpuMs, &rssKb, &calls) == 3) {
+            totals.cpuMs += cpuMs;
+            totals.sumRssKb += rssKb;
+            if (rssKb > totals.maxRssKb) totals.maxRssKb = rssKb;
+            ++totals.instancesReported;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "uso: %s [--instances N] [--calls M] [--transfer-every K] [--timeout-ms T]\n", argv[0]);
+        return 2;
+    }
+
+    SipStandIn standIn;
+    if (!standIn.start()) {
+        std::perror("stand-in");
+        return 1;
+    }
+
+    std::printf("stand-in em 127.0.0.1:%d, %d instâncias x %d chamadas\n",
+                standIn.port(), options.instances, options.calls);
+    std::fflush(stdout);
+
+    int64_t benchStart = echo::monotonicMicros();
+    std::vector<Child> children;
+
+    for (int i = 0; i < options.instances; ++i) {
+        int fds[2];
+        if (::pipe(fds) != 0) {
+            std::perror("pipe");
+            break;
+        }
+
+        pid_t pid = ::fork();
+        if (pid < 0) {
+            std::perror("fork");
+            ::close(fds[0]);
+            ::close(fds[1]);
+            break;
+        }
+
+        if (pid == 0) {
+            ::close(fds[0]);
+            for (const Child& other : children) {
+                ::close(other.fd);
+            }
+            int rc = runInstance(i, standIn.port(), options, fds[1]);
+            ::close(fds[1]);
+            // _exit: não executa destrutores herdados do pai (thread do stand-in)
+            ::_exit(rc);
+        }
+
+        ::close(fds[1]);
+        Child child;
+        child.pid = pid;
+        child.fd = fds[0];
+        children.push_back(child);
+    }
+
+    echo::LatencyHistogram setup;
+    echo::LatencyHistogram total;
+    Totals totals;
+
+    size_t open = children.size();
+    while (open > 0) {
+        std::vector<pollfd> pfds;
+        std::vector<Child*> owners;
+        for (Child& child : children) {
+            if (child.fd >= 0) {
+                pfds.push_back(pollfd{child.fd, POLLIN, 0});
+                owners.push_back(&child);
+            }
+        }
+
+        if (::poll(pfds.data(), pfds.size(), -1) < 0) {
+            break;
+        }
+
+        for (size_t i = 0; i < pfds.size(); ++i) {
+            if (pfds[i].revents == 0) continue;
+
+            Child& child = *owners[i];
+            char buffer[4096];
+            ssize_t n = ::read(child.fd, buffer, sizeof(buffer));
+            if (n <= 0) {
+                ::close(child.fd);
+                child.fd = -1;
+                --open;
+                continue;
+            }
+
+            child.pending.append(buffer, static_cast<size_t>(n));
+            size_t newline;
+            while ((newline = child.pending.find('\n')) != std::string::npos) {
+                consumeLine(child.pending.substr(0, newline), setup, total, totals);
+                child.pending.erase(0, newline + 1);
+            }
+        }
+    }
+
+    int crashed = 0;
+    for (const Child& child : children) {
+        int status = 0;
+        ::waitpid(child.pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            ++crashed;
+        }
+    }
+
+    double elapsedSec = static_cast<double>(echo::monotonicMicros() - benchStart) / 1e6;
+    standIn.stop();
+    SipStandInStats stats = standIn.stats();
+
+    echo::LatencyHistogram::Summary setupSummary = setup.summary();
+    echo::LatencyHistogram::Summary totalSummary = total.summary();
+
+    std::printf("\nchamadas concluídas: %llu (falhas: %llu, instâncias com erro: %d)\n",
+                static_cast<unsigned long long>(totals.calls),
+                static_cast<unsigned long long>(totals.failures), crashed);
+    std::printf("chamadas/s:          %.2f\n", elapsedSec > 0 ? totals.calls / elapsedSec : 0.0);
+    std::printf("setup (ms):          p50 %.2f  p90 %.2f  p99 %.2f  max %.2f\n",
+                setupSummary.p50Ms, setupSummary.p90Ms, setupSummary.p99Ms, setupSummary.maxMs);
+    std::printf("ciclo completo (ms): p50 %.2f  p90 %.2f  p99 %.2f  max %.2f\n",
+                totalSummary.p50Ms, totalSummary.p90Ms, totalSummary.p99Ms, totalSummary.maxMs);
+    std::printf("CPU por chamada:     %.3f ms\n", totals.calls > 0 ? totals.cpuMs / totals.calls : 0.0);
+    if (totals.instancesReported > 0) {
+        std::printf("memória (max RSS):   média %ld KB  máx %ld KB por instância\n",
+                    totals.sumRssKb / totals.instancesReported, totals.maxRssKb);
+    }
+    std::printf("stand-in:            REGISTER %llu  INVITE %llu  INFO %llu  REFER %llu  BYE %llu  NOTIFY %llu  malformadas %llu\n",
+                static_cast<unsigned long long>(stats.registers),
+                static_cast<unsigned long long>(stats.invites),
+                static_cast<unsigned long long>(stats.infos),
+                static_cast<unsigned long long>(stats.refers),
+                static_cast<unsigned long long>(stats.byes),
+                static_cast<unsigned long long>(stats.notifiesSent),
+                static_cast<unsigned long long>(stats.malformed));
+
+    return (totals.failures == 0 && crashed == 0) ? 0 : 1;
+}
@@ -0,0 +1,809 @@
+/**
+ * @file sip_replay.cpp
+ * @brief Replay determinístico de roteiros SIP/RTP contra o SipEngine
+ *
+ * Executa roteiros (veja replay_scenario.h) contra um SipEngine real usando
+ * apenas sockets UDP em loopback, sem rede e sem hardware de áudio. O lado
+ * remoto segue o roteiro passo a passo: cada mensagem só é enviada depois
+ * que a reação anterior do engine foi verificada, e o tempo do roteiro
+ * ("at", timestamps do pcap) corre em um relógio virtual que por padrão não
+ * espera o tempo real. Com --realtime o relógio virtual é cadenciado pelo
+ * relógio real (útil para RTP e jitter buffer).
+ *
+ * Para cada mensagem enviada é medido o tempo até a reação verificada do
+ * engine (próximo expect-sip/expect-event), agregado por tipo de mensagem.
+ *
+ * Uso: sip_replay [--realtime] [--repeat N] [--verbose] roteiro.sip...
+ *
+ * Variáveis disponíveis nas mensagens e argumentos:
+ *   ${peer_port} ${peer_rtp_port}   Portas do lado remoto (este processo)
+ *   ${engine_port}                  Porta SIP do engine (aprendida do 1º pacote)
+ *   ${engine_rtp_port}              Porta RTP do último SDP enviado pelo engine
+ *   ${engine_contact}               URI do último Contact enviado pelo engine
+ *   ${call_id} ${tag}               Call-ID da última requisição do engine e a
+ *                                   tag local usada nesse diálogo
+ *   ${branch}                       Novo branch de Via (único por mensagem)
+ *   ${req.Header} ${last.Header}    Header da última requisição / mensagem do engine
+ */
+
+#include "engine_events.h"
+#include "pcap_reader.h"
+#include "replay_scenario.h"
+#include "sip_standin.h"
+
+#include "call_timing.h"
+#include "resource_usage.h"
+#include "sip_engine.h"
+
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+extern "C" {
+#include <pjsua-lib/pjsua.h>
+}
+
+namespace {
+
+using namespace echo::bench;
+
+struct ReplayOptions {
+    bool realtime = false;
+    bool verbose = false;
+    int repeat = 1;
+};
+
+/**
+ * @brief Custo por tipo de mensagem (envio → reação verificada do engine)
+ */
+class CostTable {
+public:
+    void record(const std::string& label, int64_t micros) {
+        auto& histogram = m_histograms[label];
+        if (!histogram) {
+            histogram.reset(new echo::LatencyHistogram());
+        }
+        histogram->record(micros);
+    }
+
+    void print() const {
+        std::printf("\n%-28s %8s %10s %10s %10s\n", "mensagem", "n", "p50 (us)", "p99 (us)", "max (us)");
+        for (const auto& entry : m_histograms) {
+            echo::LatencyHistogram::Summary s = entry.second->summary();
+            std::printf("%-28s %8llu %10.0f %10.0f %10.0f\n", entry.first.c_str(),
+                        static_cast<unsigned long long>(s.count),
+                        s.p50Ms * 1000.0, s.p99Ms * 1000.0, s.maxMs * 1000.0);
+        }
+    }
+
+private:
+    std::map<std::string, std::unique_ptr<echo::LatencyHistogram>> m_histograms;
+};
+
+int openLoopbackSocket(int* port) {
+    int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    socklen_t len = sizeof(addr);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        ::close(fd);
+        return -1;
+    }
+
+    *port = ntohs(addr.sin_port);
+    return fd;
+}
+
+std::string uriOf(const std::string& nameAddr) {
+    size_t lt = nameAddr.find('<');
+    size_t gt = nameAddr.find('>', lt);
+    if (lt != std::string::npos && gt != std::string::npos) {
+        return nameAddr.substr(lt + 1, gt - lt - 1);
+    }
+    return nameAddr.substr(0, nameAddr.find(';'));
+}
+
+int sdpAudioPort(const std::string& sdp) {
+    size_t pos = sdp.find("m=audio ");
+    return pos == std::string::npos ? 0 : std::atoi(sdp.c_str() + pos + 8);
+}
+
+/**
+ * @brief Executa um roteiro contra uma instância do SipEngine
+ */
+class ReplayRunner {
+public:
+    ReplayRunner(const ReplayScenario& scenario, const ReplayOptions& options, CostTable& costs)
+        : m_scenario(scenario), m_options(options), m_costs(costs) {
+    }
+
+    ~ReplayRunner() {
+        if (m_sipSocket >= 0) ::close(m_sipSocket);
+        if (m_rtpSocket >= 0) ::close(m_rtpSocket);
+    }
+
+    bool run(std::string* error);
+
+    int64_t virtualMicros() const { return m_virtualMicros; }
+
+private:
+    bool execute(const ReplayStep& step);
+    bool runAction(const ReplayStep& step);
+    bool expectSip(const ReplayStep& step);
+    bool expectEvent(const ReplayStep& step);
+    bool expectSnapshot(const ReplayStep& step);
+    bool respond(const ReplayStep& step, bool withSdp);
+    bool sendBlock(const ReplayStep& step);
+    bool sendRtp(const ReplayStep& step);
+
+    bool substitute(const std::string& text, std::string& out);
+    std::string finalizeMessage(const std::string& text) const;
+    bool sendToEngine(const std::string& message, const std::string& label);
+    void advanceClock(int64_t virtualMicros);
+    void settle(const std::string& reaction);
+    std::string localTag(const std::string& callId);
+    std::string answerSdp() const;
+
+    bool fail(const ReplayStep& step, const std::string& message) {
+        m_error = m_scenario.path + ":" + std::to_string(step.line) + ": " + message;
+        return false;
+    }
+
+    const ReplayScenario& m_scenario;
+    const ReplayOptions& m_options;
+    CostTable& m_costs;
+
+    echo::SipEngine* m_engine = nullptr;
+    EngineEventQueue m_events;
+    std::set<std::string> m_ignoredEvents;
+    int m_timeoutMs = 2000;
+
+    int m_sipSocket = -1;
+    int m_rtpSocket = -1;
+    int m_peerPort = 0;
+    int m_peerRtpPort = 0;
+    sockaddr_in m_engineAddr{};
+    bool m_engineKnown = false;
+    int m_engineRtpPort = 0;
+    std::string m_engineContact;
+
+    SipMessage m_lastRequest;
+    SipMessage m_lastMessage;
+    bool m_haveRequest = false;
+    std::set<std::string> m_seen;           // Chaves de mensagens já recebidas (retransmissões)
+    std::map<std::string, std::string> m_tags;
+    uint64_t m_branch = 0;
+
+    int64_t m_virtualMicros = 0;
+    int64_t m_wallStart = 0;
+
+    std::string m_pendingLabel;             // Mensagem aguardando reação do engine
+    int64_t m_pendingSince = 0;
+
+    std::string m_error;
+};
+
+bool ReplayRunner::run(std::string* error) {
+    m_sipSocket = openLoopbackSocket(&m_peerPort);
+    m_rtpSocket = openLoopbackSocket(&m_peerRtpPort);
+    if (m_sipSocket < 0 || m_rtpSocket < 0) {
+        if (error) *error = "falha ao abrir sockets de loopback";
+        return false;
+    }
+
+    echo::SipEngine engine;
+    m_engine = &engine;
+    engine.setLogLevel(0);
+    engine.setJsonEventSink([this](const std::string& event, const std::string& json) {
+        m_events.push(event, json);
+    });
+
+    bool ok = engine.init();
+    if (!ok) {
+        m_error = "falha em SipEngine::init";
+    } else {
+        engine.execute([]() { return pjsua_set_null_snd_dev() == PJ_SUCCESS; });
+        m_wallStart = echo::monotonicMicros();
+
+        for (const ReplayStep& step : m_scenario.steps) {
+            if (!execute(step)) {
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    engine.destroy();
+    m_engine = nullptr;
+
+    if (!ok && error) {
+        *error = m_error;
+    }
+    return ok;
+}
+
+bool ReplayRunner::execute(const ReplayStep& step) {
+    switch (step.type) {
+        case ReplayStepType::Timeout:
+            m_timeoutMs = std::atoi(step.args[0].c_str());
+            return m_timeoutMs > 0 || fail(step, "timeout inválido");
+
+        case ReplayStepType::IgnoreEvent:
+            for (const std::string& name : step.args) {
+                m_ignoredEvents.insert(name);
+            }
+            return true;
+
+        case ReplayStepType::At: {
+            int64_t target = static_cast<int64_t>(std::atof(step.args[0].c_str()) * 1000.0);
+            if (target < m_virtualMicros) {
+                return fail(step, "at volta no tempo");
+            }
+            advanceClock(target);
+            return true;
+        }
+
+        case ReplayStepType::Action:
+            return runAction(step);
+
+        case ReplayStepType::ExpectSip:
+            return expectSip(step);
+
+        case ReplayStepType::Respond:
+            return respond(step, false);
+
+        case ReplayStepType::RespondSdp:
+            return respond(step, true);
+
+        case ReplayStepType::Send:
+            return sendBlock(step);
+
+        case ReplayStepType::ExpectEvent:
+            return expectEvent(step);
+
+        case ReplayStepType::ExpectSnapshot:
+            return expectSnapshot(step);
+
+        case ReplayStepType::Rtp:
+            return sendRtp(step);
+    }
+    return fail(step, "passo desconhecido");
+}
+
+bool ReplayRunner::runAction(const ReplayStep& step) {
+    std::vector<std::string> args;
+    for (const std::string& arg : step.args) {
+        std::string value;
+        if (!substitute(arg, value)) {
+            return fail(step, m_error);
+        }
+        args.push_back(value);
+    }
+
+    const std::string& name = args[0];
+    auto need = [&](size_t count) {
+        return args.size() >= count + 1;
+    };
+
+    bool result = false;
+    if (name == "register" && need(2)) {
+        echo::SipCredentials credentials;
+        credentials.username = args[1];
+        credentials.password = args[2];
+        credentials.server = "127.0.0.1";
+        credentials.port = m_peerPort;
+        credentials.transport = "udp";
+        result = m_engine->registerAccount(credentials);
+    } else if (name == "unregister") {
+        result = m_engine->unregister();
+    } else if (name == "call" && need(1)) {
+        result = m_engine->makeCall(args[1]);
+    } else if (name == "answer") {
+        result = m_engine->answerCall();
+    } else if (name == "reject") {
+        result = m_engine->rejectCall();
+    } else if (name == "hangup") {
+        result = m_engine->hangupCall();
+    } else if (name == "dtmf" && need(1)) {
+        result = m_engine->sendDtmf(args[1]);
+    } else if (name == "transfer-blind" && need(1)) {
+        result = m_engine->transferBlind(args[1]);
+    } else if (name == "transfer-attended" && need(1)) {
+        result = m_engine->transferAttended(args[1]);
+    } else if (name == "consult" && need(1)) {
+        result = m_engine->startConsult(args[1]);
+    } else if (name == "swap-transfer") {
+        result = m_engine->swapTransferLegs();
+    } else if (name == "complete-transfer") {
+        result = m_engine->completeTransfer();
+    } else if (name == "cancel-transfer") {
+        result = m_engine->cancelTransfer();
+    } else {
+        return fail(step, "ação inválida: " + step.rest);
+    }
+
+    if (!result) {
+        return fail(step, "ação falhou: " + step.rest + " (" + m_engine->getSnapshot().lastError.str() + ")");
+    }
+    return true;
+}
+
+bool ReplayRunner::expectSip(const ReplayStep& step) {
+    const std::string& expected = step.args[0];
+    bool expectResponse = !expected.empty() && std::isdigit(static_cast<unsigned char>(expected[0]));
+
+    auto deadline = echo::monotonicMicros() + static_cast<int64_t>(m_timeoutMs) * 1000;
+    std::vector<char> buffer(65536);
+
+    for (;;) {
+        int64_t left = (deadline - echo::monotonicMicros()) / 1000;
+        pollfd pfd{m_sipSocket, POLLIN, 0};
+        if (left <= 0 || ::poll(&pfd, 1, static_cast<int>(left)) <= 0) {
+            return fail(step, "timeout aguardando " + expected);
+        }
+
+        sockaddr_in from;
+        socklen_t fromLen = sizeof(from);
+        ssize_t n = ::recvfrom(m_sipSocket, buffer.data(), buffer.size(), 0,
+                               reinterpret_cast<sockaddr*>(&from), &fromLen);
+        if (n <= 0) {
+            continue;
+        }
+
+        std::string data(buffer.data(), static_cast<size_t>(n));
+        if (data.find_first_not_of("\r\n") == std::string::npos) {
+            continue;   // Keep-alive
+        }
+
+        SipMessage msg;
+        if (!parseSipMessage(data, msg)) {
+            return fail(step, "mensagem malformada do engine");
+        }
+
+        m_engineAddr = from;
+        m_engineKnown = true;
+
+        // Ignorar 100 Trying e retransmissões (mesma transação já vista)
+        if (!msg.isRequest && msg.statusCode == 100) {
+            continue;
+        }
+        std::string key = msg.header("Via") + "|" + msg.header("CSeq") + "|" +
+                          (msg.isRequest ? msg.method : std::to_string(msg.statusCode));
+        if (!m_seen.insert(key).second) {
+            continue;
+        }
+
+        std::string got = msg.isRequest ? msg.method : std::to_string(msg.statusCode);
+        if (m_options.verbose) {
+            std::printf("  <- %s\n", got.c_str());
+        }
+        if (msg.isRequest == expectResponse || got != expected) {
+            return fail(step, "esperado " + expected + ", recebido " + got);
+        }
+
+        m_lastMessage = msg;
+        if (msg.isRequest) {
+            m_lastRequest = msg;
+            m_haveRequest = true;
+        }
+        std::string contact = msg.header("Contact");
+        if (!contact.empty()) {
+            m_engineContact = uriOf(contact);
+        }
+        if (int port = sdpAudioPort(msg.body)) {
+            m_engineRtpPort = port;
+        }
+
+        settle("sip");
+        return true;
+    }
+}
+
+bool ReplayRunner::expectEvent(const ReplayStep& step) {
+    const std::string& expected = step.args[0];
+
+    std::string contains;
+    if (step.args.size() >= 2) {
+        if (step.args[1] != "contains" || step.args.size() < 3) {
+            return fail(step, "uso: expect-event <evento> [contains <texto>]");
+        }
+        size_t pos = step.rest.find(step.args[2], step.rest.find("contains", expected.size()));
+        if (!substitute(step.rest.substr(pos), contains)) {
+            return fail(step, m_error);
+        }
+    }
+
+    EngineEvent event;
+    do {
+        if (!m_events.next(event, m_timeoutMs)) {
+            return fail(step, "timeout aguardando evento " + expected);
+        }
+        if (m_options.verbose) {
+            std::printf("  ** %s %s\n", event.name.c_str(), event.json.c_str());
+        }
+    } while (m_ignoredEvents.count(event.name) != 0 && event.name != expected);
+
+    if (event.name != expected) {
+        return fail(step, "evento esperado " + expected + ", emitido " + event.name);
+    }
+    if (!contains.empty() && event.json.find(contains) == std::string::npos) {
+        return fail(step, "evento " + expected + " sem \"" + contains + "\": " + event.json);
+    }
+
+    settle("event");
+    return true;
+}
+
+bool ReplayRunner::expectSnapshot(const ReplayStep& step) {
+    static const char* const kConnections[] = {"idle", "connecting", "connected", "registered", "unregistered", "error"};
+    static const char* const kCallStates[] = {
+        "idle", "dialing", "ringing", "incoming", "establishing", "established", "terminating", "terminated", "failed",
+    };
+    static const char* const kDirections[] = {"none", "outgoing", "incoming"};
+
+    // Tarefa vazia no thread SIP: callbacks já entregues a ele terminam antes
+    m_engine->execute([]() { return true; });
+    echo::SipSnapshot snap = m_engine->getSnapshot();
+
+    const std::string& field = step.args[0];
+    std::string expected;
+    if (!substitute(step.rest.substr(field.size() + 1), expected)) {
+        return fail(step, m_error);
+    }
+
+    std::string got;
+    if (field == "connection") {
+        got = kConnections[static_cast<int>(snap.connection)];
+    } else if (field == "callStatus") {
+        got = kCallStates[static_cast<int>(snap.callStatus)];
+    } else if (field == "callDirection") {
+        got = kDirections[static_cast<int>(snap.callDirection)];
+    } else if (field == "remoteUri") {
+        got = snap.remoteUri.str();
+    } else {
+        return fail(step, "campo de snapshot inválido: " + field);
+    }
+
+    if (got != expected) {
+        return fail(step, "snapshot " + field + " esperado " + expected + ", atual " + got);
+    }
+    return true;
+}
+
+bool ReplayRunner::respond(const ReplayStep& step, bool withSdp) {
+    if (!m_haveRequest) {
+        return fail(step, "respond sem requisição do engine");
+    }
+
+    int code = std::atoi(step.args[0].c_str());
+    if (code < 100 || code > 699) {
+        return fail(step, "código inválido: " + step.args[0]);
+    }
+    std::string reason = step.rest.size() > step.args[0].size() ? step.rest.substr(step.args[0].size() + 1) : "";
+
+    const SipMessage& request = m_lastRequest;
+    std::string callId = request.header("Call-ID");
+    std::string to = request.header("To");
+    if (to.find(";tag=") == std::string::npos && code > 100) {
+        to += ";tag=" + localTag(callId);
+    }
+
+    std::ostringstream out;
+    out << "SIP/2.0 " << code << " " << reason << "\r\n";
+    for (const std::string& via : request.headerValues("Via")) {
+        out << "Via: " << via << "\r\n";
+    }
+    out << "From: " << request.header("From") << "\r\n";
+    out << "To: " << to << "\r\n";
+    out << "Call-ID: " << callId << "\r\n";
+    out << "CSeq: " << request.header("CSeq") << "\r\n";
+    if (request.method != "REGISTER") {
+        out << "Contact: <sip:peer@127.0.0.1:" << m_peerPort << ">\r\n";
+    } else if (!request.header("Contact").empty()) {
+        out << "Contact: " << request.header("Contact") << "\r\n";
+        out << "Expires: 300\r\n";
+    }
+
+    std::string body = withSdp ? answerSdp() : "";
+    if (withSdp) {
+        out << "Content-Type: application/sdp\r\n";
+    }
+    out << "Content-Length: " << body.size() << "\r\n\r\n" << body;
+
+    std::string cseq = request.header("CSeq");
+    std::string method = cseq.substr(cseq.find(' ') + 1);
+    return sendToEngine(out.str(), std::to_string(code) + " " + method) || fail(step, m_error);
+}
+
+bool ReplayRunner::sendBlock(const ReplayStep& step) {
+    std::string text;
+    if (!substitute(step.block, text)) {
+        return fail(step, m_error);
+    }
+
+    std::string message = finalizeMessage(text);
+    SipMessage parsed;
+    if (!parseSipMessage(message, parsed)) {
+        return fail(step, "mensagem do roteiro malformada");
+    }
+
+    std::string label;
+    if (parsed.isRequest) {
+        label = parsed.method;
+    } else {
+        std::string cseq = parsed.header("CSeq");
+        label = std::to_string(parsed.statusCode) + " " + cseq.substr(cseq.find(' ') + 1);
+    }
+    return sendToEngine(message, label) || fail(step, m_error);
+}
+
+bool ReplayRunner::sendRtp(const ReplayStep& step) {
+    if (m_engineRtpPort == 0) {
+        return fail(step, "rtp antes de o engine enviar SDP");
+    }
+
+    std::string path = step.args[0];
+    if (!path.empty() && path[0] != '/') {
+        path = m_scenario.directory + "/" + path;
+    }
+
+    std::vector<PcapPacket> packets;
+    std::string error;
+    if (!readPcapUdp(path, packets, &error)) {
+        return fail(step, error);
+    }
+
+    size_t limit = step.args.size() >= 2 ? static_cast<size_t>(std::atol(step.args[1].c_str())) : packets.size();
+
+    sockaddr_in to;
+    std::memset(&to, 0, sizeof(to));
+    to.sin_family = AF_INET;
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    to.sin_port = htons(static_cast<uint16_t>(m_engineRtpPort));
+
+    int64_t base = m_virtualMicros;
+    size_t sent = 0;
+    for (const PcapPacket& packet : packets) {
+        if (sent >= limit) break;
+        // RTCP (portas ímpares) fica de fora: o engine o gera por conta própria
+        if (packet.destinationPort % 2 != 0 || packet.payload.size() < 12) {
+            continue;
+        }
+        advanceClock(base + packet.timestampMicros);
+        ::sendto(m_rtpSocket, packet.payload.data(), packet.payload.size(), 0,
+                 reinterpret_cast<const sockaddr*>(&to), sizeof(to));
+        ++sent;
+    }
+
+    if (m_options.verbose) {
+        std::printf("  -> RTP %zu pacotes\n", sent);
+    }
+    return true;
+}
+
+bool ReplayRunner::substitute(const std::string& text, std::string& out) {
+    out.clear();
+    size_t pos = 0;
+    for (;;) {
+        size_t start = text.find("${", pos);
+        if (start == std::string::npos) {
+            out.append(text, pos, std::string::npos);
+            return true;
+        }
+        size_t end = text.find('}', start);
+        if (end == std::string::npos) {
+            m_error = "variável sem '}'";
+            return false;
+        }
+        out.append(text, pos, start - pos);
+
+        std::string name = text.substr(start + 2, end - start - 2);
+        if (name == "peer_port") {
+            out += std::to_string(m_peerPort);
+        } else if (name == "peer_rtp_port") {
+            out += std::to_string(m_peerRtpPort);
+        } else if (name == "engine_port" && m_engineKnown) {
+            out += std::to_string(ntohs(m_engineAddr.sin_port));
+        } else if (name == "engine_rtp_port" && m_engineRtpPort != 0) {
+            out += std::to_string(m_engineRtpPort);
+        } else if (name == "engine_contact" && !m_engineContact.empty()) {
+            out += m_engineContact;
+        } else if (name == "call_id" && m_haveRequest) {
+            out += m_lastRequest.header("Call-ID");
+        } else if (name == "tag" && m_haveRequest) {
+            out += localTag(m_lastRequest.header("Call-ID"));
+        } else if (name == "branch") {
+            out += "z9hG4bK-replay-" + std::to_string(++m_branch);
+        } else if (name.compare(0, 4, "req.") == 0 && m_haveRequest && !m_lastRequest.header(name.substr(4)).empty()) {
+            out += m_lastRequest.header(name.substr(4));
+        } else if (name.compare(0, 5, "last.") == 0 && !m_lastMessage.header(name.substr(5)).empty()) {
+            out += m_lastMessage.header(name.substr(5));
+        } else {
+            m_error = "variável indisponível: ${" + name + "}";
+            return false;
+        }
+        pos = end + 1;
+    }
+}
+
+std::string ReplayRunner::finalizeMessage(const std::string& text) const {
+    // Roteiros usam "\n"; SIP exige CRLF. Content-Length é sempre recalculado.
+    size_t split = text.find("\n\n");
+    std::string head = text.substr(0, split);
+    std::string body = split == std::string::npos ? "" : text.substr(split + 2);
+
+    std::string message;
+    std::istringstream lines(head);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.empty()) continue;
+        std::string lower = line.substr(0, line.find(':'));
+        for (char& c : lower) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        if (lower == "content-length" || lower == "l") continue;
+        message += line + "\r\n";
+    }
+
+    std::string crlfBody;
+    std::istringstream bodyLines(body);
+    while (std::getline(bodyLines, line)) {
+        crlfBody += line + "\r\n";
+    }
+
+    message += "Content-Length: " + std::to_string(crlfBody.size()) + "\r\n\r\n" + crlfBody;
+    return message;
+}
+
+bool ReplayRunner::sendToEngine(const std::string& message, const std::string& label) {
+    if (!m_engineKnown) {
+        m_error = "porta do engine desconhecida (nenhuma mensagem recebida ainda)";
+        return false;
+    }
+
+    if (m_options.verbose) {
+        std::printf("  -> %s\n", label.c_str());
+    }
+
+    // Uma mensagem sem reação verificada ainda não é medida
+    m_pendingLabel = label;
+    m_pendingSince = echo::monotonicMicros();
+
+    ::sendto(m_sipSocket, message.data(), message.size(), 0,
+             reinterpret_cast<const sockaddr*>(&m_engineAddr), sizeof(m_engineAddr));
+    return true;
+}
+
+void ReplayRunner::advanceClock(int64_t virtualMicros) {
+    m_virtualMicros = virtualMicros;
+    if (!m_options.realtime) {
+        return;
+    }
+
+    int64_t wait = m_wallStart + virtualMicros - echo::monotonicMicros();
+    if (wait > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(wait));
+    }
+}
+
+void ReplayRunner::settle(const std::string& reaction) {
+    if (m_pendingLabel.empty()) {
+        return;
+    }
+    m_costs.record(m_pendingLabel + " -> " + reaction, echo::monotonicMicros() - m_pendingSince);
+    m_pendingLabel.clear();
+}
+
+std::string ReplayRunner::localTag(const std::string& callId) {
+    auto it = m_tags.find(callId);
+    if (it != m_tags.end()) {
+        return it->second;
+    }
+    std::string tag = "replay" + std::to_string(m_tags.size() + 1);
+    m_tags[callId] = tag;
+    return tag;
+}
+
+std::string ReplayRunner::answerSdp() const {
+    std::ostringstream sdp;
+    sdp << "v=0\r\n";
+    sdp << "o=replay 1 1 IN IP4 127.0.0.1\r\n";
+    sdp << "s=echo-replay\r\n";
+    sdp << "c=IN IP4 127.0.0.1\r\n";
+    sdp << "t=0 0\r\n";
+    sdp << "m=audio " << m_peerRtpPort << " RTP/AVP 0 101\r\n";
+    sdp << "a=rtpmap:0 PCMU/8000\r\n";
+    sdp << "a=rtpmap:101 telephone-event/8000\r\n";
+    sdp << "a=fmtp:101 0-16\r\n";
+    sdp << "a=sendrecv\r\n";
+    return sdp.str();
+}
+
+bool parseOptions(int argc, char** argv, ReplayOptions& options, std::vector<std::string>& files) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--realtime") {
+            options.realtime = true;
+        } else if (arg == "--verbose" || arg == "-v") {
+            options.verbose = true;
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            options.repeat = std::atoi(argv[++i]);
+        } else if (!arg.empty() && arg[0] == '-') {
+            return false;
+        } else {
+            files.push_back(arg);
+        }
+    }
+    return !files.empty() && options.repeat > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    ReplayOptions options;
+    std::vector<std::string> files;
+    if (!parseOptions(argc, argv, options, files)) {
+        std::fprintf(stderr, "uso: %s [--realtime] [--repeat N] [--verbose] roteiro.sip...\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<ReplayScenario> scenarios;
+    for (const std::string& file : files) {
+        ReplayScenario scenario;
+        std::string error;
+        if (!loadReplayScenario(file, scenario, &error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 2;
+        }
+        scenarios.push_back(std::move(scenario));
+    }
+
+    CostTable costs;
+    int failures = 0;
+
+    for (const ReplayScenario& scenario : scenarios) {
+        for (int run = 0; run < options.repeat; ++run) {
+            echo::ResourceUsage before = echo::sampleResourceUsage();
+            int64_t start = echo::monotonicMicros();
+
+            ReplayRunner runner(scenario, options, costs);
+            std::string error;
+            bool ok = runner.run(&error);
+
+            echo::ResourceUsage after = echo::sampleResourceUsage();
+            double wallMs = static_cast<double>(echo::monotonicMicros() - start) / 1000.0;
+            double cpuMs = (after.userCpuMs + after.systemCpuMs) - (before.userCpuMs + before.systemCpuMs);
+
+            std::printf("%s %s (%zu passos, real %.1f ms, virtual %.1f ms, CPU %.1f ms)\n",
+                        ok ? "OK  " : "FALHA", scenario.path.c_str(), scenario.steps.size(),
+                        wallMs, static_cast<double>(runner.virtualMicros()) / 1000.0, cpuMs);
+            if (!ok) {
+                std::printf("      %s\n", error.c_str());
+                ++failures;
+            }
+        }
+    }
+
+    costs.print();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,488 @@
+/**
+ * @file sip_standin.cpp
+ * @brief Implementação do registrar/UAS SIP em loopback
+ */
+
+#include "sip_standin.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace echo {
+namespace bench {
+
+namespace {
+
+// Formas compactas dos headers (RFC 3261, seção 7.3.3)
+const char* compactName(const std::string& lowerName) {
+    if (lowerName == "call-id") return "i";
+    if (lowerName == "contact") return "m";
+    if (lowerName == "from") return "f";
+    if (lowerName == "to") return "t";
+    if (lowerName == "via") return "v";
+    if (lowerName == "content-type") return "c";
+    if (lowerName == "content-length") return "l";
+    if (lowerName == "event") return "o";
+    if (lowerName == "refer-to") return "r";
+    return nullptr;
+}
+
+std::string toLower(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return value;
+}
+
+std::string trim(const std::string& value) {
+    size_t begin = value.find_first_not_of(" \t");
+    if (begin == std::string::npos) return "";
+    size_t end = value.find_last_not_of(" \t\r");
+    return value.substr(begin, end - begin + 1);
+}
+
+bool headerMatches(const std::string& candidate, const std::string& name) {
+    std::string lowerCandidate = toLower(candidate);
+    std::string lowerName = toLower(name);
+    if (lowerCandidate == lowerName) return true;
+
+    const char* compact = compactName(lowerName);
+    return compact != nullptr && lowerCandidate == compact;
+}
+
+// Extrai a URI de um valor name-addr ("Nome" <sip:x@y>;tag=z) ou addr-spec
+std::string extractUri(const std::string& value) {
+    size_t lt = value.find('<');
+    if (lt != std::string::npos) {
+        size_t gt = value.find('>', lt);
+        if (gt != std::string::npos) {
+            return value.substr(lt + 1, gt - lt - 1);
+        }
+    }
+    size_t semi = value.find(';');
+    return trim(value.substr(0, semi));
+}
+
+// Payload types RTP estáticos relevantes para o benchmark
+bool offerHasPayload(const std::string& offer, int payload, std::string* rtpmap) {
+    std::istringstream lines(offer);
+    std::string line;
+    std::string prefix = "a=rtpmap:" + std::to_string(payload) + " ";
+    while (std::getline(lines, line)) {
+        if (line.compare(0, prefix.size(), prefix) == 0) {
+            if (rtpmap) *rtpmap = trim(line);
+            return true;
+        }
+    }
+    return false;
+}
+
+int findTelephoneEvent(const std::string& offer, std::string* rtpmap) {
+    std::istringstream lines(offer);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.compare(0, 9, "a=rtpmap:") == 0 && line.find("telephone-event/8000") != std::string::npos) {
+            if (rtpmap) *rtpmap = trim(line);
+            return std::atoi(line.c_str() + 9);
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+std::string SipMessage::header(const std::string& name) const {
+    for (const auto& entry : headers) {
+        if (headerMatches(entry.first, name)) {
+            return entry.second;
+        }
+    }
+    return "";
+}
+
+std::vector<std::string> SipMessage::headerValues(const std::string& name) const {
+    std::vector<std::string> values;
+    for (const auto& entry : headers) {
+        if (headerMatches(entry.first, name)) {
+            values.push_back(entry.second);
+        }
+    }
+    return values;
+}
+
+bool parseSipMessage(const std::string& data, SipMessage& out) {
+    size_t headerEnd = data.find("\r\n\r\n");
+    if (headerEnd == std::string::npos) {
+        return false;
+    }
+
+    out = SipMessage();
+    out.body = data.substr(headerEnd + 4);
+
+    std::istringstream lines(data.substr(0, headerEnd));
+    std::string line;
+    if (!std::getline(lines, line)) {
+        return false;
+    }
+    line = trim(line);
+
+    if (line.compare(0, 8, "SIP/2.0 ") == 0) {
+        out.isRequest = false;
+        out.statusCode = std::atoi(line.c_str() + 8);
+        if (out.statusCode < 100 || out.statusCode > 699) {
+            return false;
+        }
+    } else {
+        size_t sp1 = line.find(' ');
+        size_t sp2 = line.rfind(' ');
+        if (sp1 == std::string::npos || sp2 == sp1 || line.compare(sp2 + 1, std::string::npos, "SIP/2.0") != 0) {
+            return false;
+        }
+        out.isRequest = true;
+        out.method = line.substr(0, sp1);
+        out.requestUri = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    }
+
+    while (std::getline(lines, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+
+        // Continuação de linha (folding)
+        if ((line[0] == ' ' || line[0] == '\t') && !out.headers.empty()) {
+            out.headers.back().second += " " + trim(line);
+            continue;
+        }
+
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            return false;
+        }
+        out.headers.emplace_back(trim(line.substr(0, colon)), trim(line.substr(colon + 1)));
+    }
+
+    std::string contentLength = out.header("Content-Length");
+    if (!contentLength.empty()) {
+        size_t length = static_cast<size_t>(std::atol(contentLength.c_str()));
+        if (length > out.body.size()) {
+            return false;
+        }
+        out.body.resize(length);
+    }
+
+    return !out.header("Call-ID").empty() && !out.header("CSeq").empty();
+}
+
+SipStandIn::SipStandIn() {
+}
+
+SipStandIn::~SipStandIn() {
+    stop();
+}
+
+bool SipStandIn::start() {
+    if (m_running) {
+        return true;
+    }
+
+    m_socket = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (m_socket < 0) {
+        return false;
+    }
+
+    sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    socklen_t len = sizeof(addr);
+    if (::bind(m_socket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::getsockname(m_socket, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        ::close(m_socket);
+        m_socket = -1;
+        return false;
+    }
+    m_port = ntohs(addr.sin_port);
+
+    m_running = true;
+    m_thread = std::thread(&SipStandIn::run, this);
+    return true;
+}
+
+void SipStandIn::stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    ::close(m_socket);
+    m_socket = -1;
+}
+
+int SipStandIn::port() const {
+    return m_port;
+}
+
+SipStandInStats SipStandIn::stats() const {
+    SipStandInStats s;
+    s.registers = m_registers.load(std::memory_order_relaxed);
+    s.invites = m_invites.load(std::memory_order_relaxed);
+    s.infos = m_infos.load(std::memory_order_relaxed);
+    s.refers = m_refers.load(std::memory_order_relaxed);
+    s.byes = m_byes.load(std::memory_order_relaxed);
+    s.notifiesSent = m_notifiesSent.load(std::memory_order_relaxed);
+    s.malformed = m_malformed.load(std::memory_order_relaxed);
+    return s;
+}
+
+void SipStandIn::run() {
+    std::vector<char> buffer(65536);
+
+    while (m_running) {
+        pollfd pfd;
+        pfd.fd = m_socket;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        // Timeout curto apenas para observar m_running
+        if (::poll(&pfd, 1, 50) <= 0) {
+            continue;
+        }
+
+        sockaddr_in from;
+        socklen_t fromLen = sizeof(from);
+        ssize_t n = ::recvfrom(m_socket, buffer.data(), buffer.size(), 0,
+                               reinterpret_cast<sockaddr*>(&from), &fromLen);
+        if (n <= 0) {
+            continue;
+        }
+
+        std::string data(buffer.data(), static_cast<size_t>(n));
+
+        // Keep-alive CRLF
+        if (data.find_first_not_of("\r\n") == std::string::npos) {
+            continue;
+        }
+
+        SipMessage msg;
+        if (!parseSipMessage(data, msg)) {
+            m_malformed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        // Respostas (200 do NOTIFY) não exigem tratamento
+        if (msg.isRequest) {
+            handleRequest(msg, from);
+        }
+    }
+}
+
+void SipStandIn::handleRequest(const SipMessage& msg, const sockaddr_in& from) {
+    const std::string callId = msg.header("Call-ID");
+    std::string to = msg.header("To");
+
+    if (msg.method == "REGISTER") {
+        m_registers.fetch_add(1, std::memory_order_relaxed);
+
+        std::string expires = msg.header("Expires");
+        std::string extra;
+        std::string contact = msg.header("Contact");
+        if (!contact.empty()) {
+            extra += "Contact: " + contact + (expires.empty() ? "" : ";expires=" + expires) + "\r\n";
+        }
+        if (!expires.empty()) {
+            extra += "Expires: " + expires + "\r\n";
+        }
+        if (to.find(";tag=") == std::string::npos) {
+            to += ";tag=" + makeTag();
+        }
+        sendResponse(msg, from, 200, "OK", to, extra);
+        return;
+    }
+
+    if (msg.method == "INVITE") {
+        auto it = m_dialogs.find(callId);
+        if (it != m_dialogs.end()) {
+            // re-INVITE (hold/resume/refresh): mesma resposta SDP
+            sendResponse(msg, from, 200, "OK", it->second.localTo, contactHeader(),
+                         "application/sdp", it->second.sdp);
+            return;
+        }
+
+        m_invites.fetch_add(1, std::memory_order_relaxed);
+
+        Dialog dialog;
+        dialog.localTo = to + ";tag=" + makeTag();
+        dialog.remoteFrom = msg.header("From");
+        dialog.remoteTarget = extractUri(msg.header("Contact"));
+        dialog.sdp = answerSdp(msg.body);
+        m_dialogs[callId] = dialog;
+
+        sendResponse(msg, from, 180, "Ringing", dialog.localTo, contactHeader());
+        sendResponse(msg, from, 200, "OK", dialog.localTo, contactHeader(), "application/sdp", dialog.sdp);
+        return;
+    }
+
+    if (msg.method == "ACK") {
+        return;
+    }
+
+    auto it = m_dialogs.find(callId);
+    const std::string& dialogTo = it != m_dialogs.end() ? it->second.localTo : to;
+
+    if (msg.method == "INFO") {
+        m_infos.fetch_add(1, std::memory_order_relaxed);
+        sendResponse(msg, from, 200, "OK", dialogTo);
+        return;
+    }
+
+    if (msg.method == "REFER") {
+        m_refers.fetch_add(1, std::memory_order_relaxed);
+        if (it == m_dialogs.end()) {
+            sendResponse(msg, from, 481, "Call/Transaction Does Not Exist", to);
+            return;
+        }
+        sendResponse(msg, from, 202, "Accepted", dialogTo, contactHeader());
+        sendNotify(callId, from);
+        return;
+    }
+
+    if (msg.method == "BYE") {
+        m_byes.fetch_add(1, std::memory_order_relaxed);
+        sendResponse(msg, from, it != m_dialogs.end() ? 200 : 481,
+                     it != m_dialogs.end() ? "OK" : "Call/Transaction Does Not Exist", dialogTo);
+        if (it != m_dialogs.end()) {
+            m_dialogs.erase(it);
+        }
+        return;
+    }
+
+    if (msg.method == "OPTIONS" || msg.method == "UPDATE" || msg.method == "NOTIFY") {
+        sendResponse(msg, from, 200, "OK", dialogTo);
+        return;
+    }
+
+    if (msg.method == "CANCEL") {
+        sendResponse(msg, from, 200, "OK", dialogTo);
+        return;
+    }
+
+    sendResponse(msg, from, 501, "Not Implemented", dialogTo);
+}
+
+void SipStandIn::sendResponse(const SipMessage& request, const sockaddr_in& to, int code, const char* reason,
+                              const std::string& toHeader, const std::string& extraHeaders,
+                              const std::string& contentType, const std::string& body) {
+    std::ostringstream out;
+    out << "SIP/2.0 " << code << " " << reason << "\r\n";
+    for (const auto& via : request.headerValues("Via")) {
+        out << "Via: " << via << "\r\n";
+    }
+    out << "From: " << request.header("From") << "\r\n";
+    out << "To: " << toHeader << "\r\n";
+    out << "Call-ID: " << request.header("Call-ID") << "\r\n";
+    out << "CSeq: " << request.header("CSeq") << "\r\n";
+    out << extraHeaders;
+    if (!contentType.empty()) {
+        out << "Content-Type: " << contentType << "\r\n";
+    }
+    out << "Content-Length: " << body.size() << "\r\n\r\n";
+    out << body;
+
+    sendRaw(out.str(), to);
+}
+
+void SipStandIn::sendNotify(const std::string& callId, const sockaddr_in& to) {
+    auto it = m_dialogs.find(callId);
+    if (it == m_dialogs.end()) {
+        return;
+    }
+
+    Dialog& dialog = it->second;
+    const std::string body = "SIP/2.0 200 OK\r\n";
+    const std::string target = dialog.remoteTarget.empty() ? extractUri(dialog.remoteFrom) : dialog.remoteTarget;
+
+    std::ostringstream out;
+    out << "NOTIFY " << target << " SIP/2.0\r\n";
+    out << "Via: SIP/2.0/UDP 127.0.0.1:" << m_port << ";rport;branch=z9hG4bK-standin-" << makeTag() << "\r\n";
+    out << "Max-Forwards: 70\r\n";
+    out << "From: " << dialog.localTo << "\r\n";
+    out << "To: " << dialog.remoteFrom << "\r\n";
+    out << "Call-ID: " << callId << "\r\n";
+    out << "CSeq: " << ++dialog.localCseq << " NOTIFY\r\n";
+    out << contactHeader();
+    out << "Event: refer\r\n";
+    out << "Subscription-State: terminated;reason=noresource\r\n";
+    out << "Content-Type: message/sipfrag;version=2.0\r\n";
+    out << "Content-Length: " << body.size() << "\r\n\r\n";
+    out << body;
+
+    sendRaw(out.str(), to);
+    m_notifiesSent.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SipStandIn::sendRaw(const std::string& data, const sockaddr_in& to) {
+    ::sendto(m_socket, data.data(), data.size(), 0, reinterpret_cast<const sockaddr*>(&to), sizeof(to));
+}
+
+std::string SipStandIn::makeTag() {
+    return "si" + std::to_string(m_nextTag++);
+}
+
+std::string SipStandIn::contactHeader() const {
+    return "Contact: <sip:uas@127.0.0.1:" + std::to_string(m_port) + ">\r\n";
+}
+
+std::string SipStandIn::answerSdp(const std::string& offer) {
+    // Preferir G.711 (sem custo de codec no stand-in)
+    int payload = -1;
+    std::string rtpmap;
+    if (offerHasPayload(offer, 0, &rtpmap)) {
+        payload = 0;
+    } else if (offerHasPayload(offer, 8, &rtpmap)) {
+        payload = 8;
+    } else {
+        payload = 0;
+        rtpmap = "a=rtpmap:0 PCMU/8000";
+    }
+
+    std::string eventRtpmap;
+    int eventPayload = findTelephoneEvent(offer, &eventRtpmap);
+
+    uint32_t rtpPort = m_nextRtpPort;
+    m_nextRtpPort = m_nextRtpPort >= 60000 ? 40000 : m_nextRtpPort + 2;
+
+    std::ostringstream sdp;
+    sdp << "v=0\r\n";
+    sdp << "o=standin " << m_nextTag << " 1 IN IP4 127.0.0.1\r\n";
+    sdp << "s=echo-bench\r\n";
+    sdp << "c=IN IP4 127.0.0.1\r\n";
+    sdp << "t=0 0\r\n";
+    sdp << "m=audio " << rtpPort << " RTP/AVP " << payload;
+    if (eventPayload >= 0) {
+        sdp << " " << eventPayload;
+    }
+    sdp << "\r\n";
+    sdp << rtpmap << "\r\n";
+    if (eventPayload >= 0) {
+        sdp << eventRtpmap << "\r\n";
+        sdp << "a=fmtp:" << eventPayload << " 0-16\r\n";
+    }
+    sdp << "a=sendrecv\r\n";
+    return sdp.str();
+}
+
+} // namespace bench
+} // namespace echo
@@ -0,0 +1,141 @@
+/**
+ * @file sip_standin.h
+ * @brief Registrar/UAS SIP mínimo em loopback para benchmarks
+ *
+ * Este arquivo define o SipStandIn, um servidor SIP sobre UDP que aceita
+ * REGISTER, atende INVITEs (180 + 200 com SDP), aceita INFO, responde REFER
+ * com 202 + NOTIFY 200 e encerra com BYE. Não implementa autenticação nem
+ * retransmissões: roda apenas em loopback, onde não há perda.
+ */
+
+#ifndef SIP_STANDIN_H
+#define SIP_STANDIN_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <netinet/in.h>
+
+namespace echo {
+namespace bench {
+
+/**
+ * @brief Mensagem SIP decodificada (apenas o necessário para o stand-in)
+ */
+struct SipMessage {
+    bool isRequest = false;
+    std::string method;         // Requisições
+    std::string requestUri;     // Requisições
+    int statusCode = 0;         // Respostas
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+
+    /**
+     * @brief Primeiro valor do header (nome completo ou compacto)
+     */
+    std::string header(const std::string& name) const;
+
+    /**
+     * @brief Todos os valores do header, na ordem da mensagem
+     */
+    std::vector<std::string> headerValues(const std::string& name) const;
+};
+
+/**
+ * @brief Decodifica uma mensagem SIP
+ * @return false se a mensagem estiver malformada
+ */
+bool parseSipMessage(const std::string& data, SipMessage& out);
+
+/**
+ * @brief Contadores do stand-in
+ */
+struct SipStandInStats {
+    uint64_t registers = 0;
+    uint64_t invites = 0;
+    uint64_t infos = 0;
+    uint64_t refers = 0;
+    uint64_t byes = 0;
+    uint64_t notifiesSent = 0;
+    uint64_t malformed = 0;
+};
+
+/**
+ * @brief Registrar/UAS SIP em loopback
+ */
+class SipStandIn {
+public:
+    SipStandIn();
+    ~SipStandIn();
+
+    /**
+     * @brief Abre o socket em 127.0.0.1 (porta efêmera) e inicia o thread
+     */
+    bool start();
+
+    /**
+     * @brief Encerra o thread e fecha o socket
+     */
+    void stop();
+
+    /**
+     * @brief Porta UDP em uso
+     */
+    int port() const;
+
+    /**
+     * @brief Obtém os contadores (válido após stop() ou aproximado durante)
+     */
+    SipStandInStats stats() const;
+
+private:
+    SipStandIn(const SipStandIn&) = delete;
+    SipStandIn& operator=(const SipStandIn&) = delete;
+
+    struct Dialog {
+        std::string localTo;        // Nosso To (com tag), From das nossas requisições
+        std::string remoteFrom;     // From do UAC, To das nossas requisições
+        std::string remoteTarget;   // Contact do UAC
+        std::string sdp;            // Resposta SDP (reenviada em re-INVITE)
+        uint32_t localCseq = 0;
+    };
+
+    void run();
+    void handleRequest(const SipMessage& msg, const sockaddr_in& from);
+    void sendResponse(const SipMessage& request, const sockaddr_in& to, int code, const char* reason,
+                      const std::string& toHeader, const std::string& extraHeaders = "",
+                      const std::string& contentType = "", const std::string& body = "");
+    void sendNotify(const std::string& callId, const sockaddr_in& to);
+    void sendRaw(const std::string& data, const sockaddr_in& to);
+    std::string makeTag();
+    std::string contactHeader() const;
+    std::string answerSdp(const std::string& offer);
+
+    int m_socket{-1};
+    int m_port{0};
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+
+    // Acessados apenas pelo thread do stand-in
+    std::map<std::string, Dialog> m_dialogs;
+    uint64_t m_nextTag{1};
+    uint32_t m_nextRtpPort{40000};
+
+    std::atomic<uint64_t> m_registers{0};
+    std::atomic<uint64_t> m_invites{0};
+    std::atomic<uint64_t> m_infos{0};
+    std::atomic<uint64_t> m_refers{0};
+    std::atomic<uint64_t> m_byes{0};
+    std::atomic<uint64_t> m_notifiesSent{0};
+    std::atomic<uint64_t> m_malformed{0};
+};
+
+} // namespace bench
+} // namespace echo
+
+#endif // SIP_STANDIN_H
@@ -0,0 +1,148 @@
+/**
+ * @file sip_uri_bench.cpp
+ * @brief Benchmark do parser de identidades SIP (ns/URI)
+ *
+ * Compara parseSipNameAddr com a extração anterior por find/substr/erase
+ * usada em onIncomingCall e onCallState, sobre o mesmo conjunto de
+ * remote_info. A versão anterior é reproduzida aqui apenas como referência.
+ *
+ * Uso: sip_uri_bench [iterações]
+ */
+
+#include "sip_uri.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::vector<std::string>& corpus() {
+    static const std::vector<std::string> values = {
+        "\"John Smith\" <sip:2000@pbx.example.com>;tag=as4f5d6e7",
+        "<sip:1001@10.0.0.15:5060;transport=udp>;tag=1928301774",
+        "\"Recepção\" <sip:9000@pbx.example.com;user=phone>",
+        "sip:3000@pbx.example.com",
+        "Maria <sips:maria@secure.example.com:5061>",
+        "<tel:+5511999998888;phone-context=example.com>",
+        "\"Suporte \\\"N2\\\"\" <sip:suporte@[2001:db8::1]:5070;lr>;tag=x1",
+        "sip:pbx.example.com",
+    };
+    return values;
+}
+
+struct Identity {
+    std::string displayName;
+    std::string user;
+    std::string remoteUri;
+};
+
+// Extração anterior (onIncomingCall + lambda de onCallState)
+void legacyParse(const std::string& remoteInfo, Identity& out) {
+    out.displayName.clear();
+    out.user.clear();
+    out.remoteUri.clear();
+
+    size_t ltPos = remoteInfo.find('<');
+    if (ltPos != std::string::npos) {
+        out.displayName = remoteInfo.substr(0, ltPos);
+        out.displayName.erase(std::remove(out.displayName.begin(), out.displayName.end(), '"'), out.displayName.end());
+        out.displayName.erase(std::remove(out.displayName.begin(), out.displayName.end(), ' '), out.displayName.end());
+    }
+
+    size_t sipPos = remoteInfo.find("sip:");
+    size_t atPos = remoteInfo.find('@');
+    if (sipPos != std::string::npos && atPos != std::string::npos) {
+        out.user = remoteInfo.substr(sipPos + 4, atPos - sipPos - 4);
+    }
+
+    size_t gtPos = remoteInfo.find('>');
+    std::string uriPart = remoteInfo;
+    if (ltPos != std::string::npos && gtPos != std::string::npos && gtPos > ltPos) {
+        uriPart = remoteInfo.substr(ltPos + 1, gtPos - ltPos - 1);
+    }
+    size_t uriSipPos = uriPart.find("sip:");
+    size_t uriAtPos = uriPart.find('@');
+    if (uriSipPos != std::string::npos) {
+        if (uriAtPos != std::string::npos && uriAtPos > uriSipPos) {
+            out.remoteUri = uriPart.substr(uriSipPos + 4, uriAtPos - uriSipPos - 4);
+        } else {
+            out.remoteUri = uriPart.substr(uriSipPos + 4);
+        }
+    } else {
+        out.remoteUri = uriPart;
+    }
+}
+
+// Mesma saída com o parser atual
+void currentParse(const std::string& remoteInfo, Identity& out) {
+    echo::SipUriView parsed;
+    if (echo::parseSipNameAddr(remoteInfo, parsed)) {
+        out.displayName = echo::decodeDisplayName(parsed.displayName);
+        out.user.assign(parsed.identity().data(), parsed.identity().size());
+        out.remoteUri = out.user;
+    } else {
+        out.displayName.clear();
+        out.user.clear();
+        out.remoteUri = remoteInfo;
+    }
+}
+
+// Apenas a análise (views), sem materializar strings
+size_t viewOnlyParse(const std::string& remoteInfo) {
+    echo::SipUriView parsed;
+    echo::parseSipNameAddr(remoteInfo, parsed);
+    return parsed.identity().size() + parsed.displayName.size();
+}
+
+template <typename Function>
+double nsPerUri(long iterations, Function function) {
+    const auto& values = corpus();
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; ++i) {
+        for (const std::string& value : values) {
+            function(value);
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    return ns / (static_cast<double>(iterations) * static_cast<double>(values.size()));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? std::atol(argv[1]) : 200000;
+    if (iterations <= 0) {
+        std::fprintf(stderr, "uso: %s [iterações]\n", argv[0]);
+        return 2;
+    }
+
+    // Resultados lado a lado (mostra a diferença de comportamento)
+    for (const std::string& value : corpus()) {
+        Identity legacy;
+        Identity current;
+        legacyParse(value, legacy);
+        currentParse(value, current);
+        std::printf("%-64s\n  anterior: nome=\"%s\" user=\"%s\" remoteUri=\"%s\"\n  atual:    nome=\"%s\" user=\"%s\" remoteUri=\"%s\"\n",
+                    value.c_str(), legacy.displayName.c_str(), legacy.user.c_str(), legacy.remoteUri.c_str(),
+                    current.displayName.c_str(), current.user.c_str(), current.remoteUri.c_str());
+    }
+
+    Identity sink;
+    size_t viewSink = 0;
+
+    double legacyNs = nsPerUri(iterations, [&](const std::string& value) { legacyParse(value, sink); });
+    double currentNs = nsPerUri(iterations, [&](const std::string& value) { currentParse(value, sink); });
+    double viewNs = nsPerUri(iterations, [&](const std::string& value) { viewSink += viewOnlyParse(value); });
+
+    std::printf("\n%ld iterações x %zu URIs\n", iterations, corpus().size());
+    std::printf("anterior (find/substr/erase): %8.1f ns/URI\n", legacyNs);
+    std::printf("atual (parse + strings):      %8.1f ns/URI\n", currentNs);
+    std::printf("atual (apenas views):         %8.1f ns/URI\n", viewNs);
+
+    return viewSink == 0 ? 1 : 0;
+}
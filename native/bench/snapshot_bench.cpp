@@ -0,0 +1,225 @@
+/**
+ * @file snapshot_bench.cpp
+ * @brief Leituras de snapshot por segundo com atualizações concorrentes
+ *
+ * Reproduz o polling da UI (getSnapshot) contra as atualizações dos
+ * callbacks do PJSUA (updateSnapshot) e compara o snapshot anterior
+ * (mutex + std::string, reproduzido aqui apenas como referência) com o
+ * atual (SeqLock + FixedString). Para cada ritmo do escritor mostra
+ * leituras/s somadas dos leitores, escritas/s, o tempo máximo de uma
+ * escrita (inclui a espera pela trava) e as leituras rasgadas (campos de
+ * atualizações diferentes; precisam ser zero).
+ *
+ * Uso: snapshot_bench [segundos por caso] [leitores]
+ */
+
+#include "sip_engine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Layout anterior do SipSnapshot
+struct LegacyIncoming {
+    std::string displayName;
+    std::string user;
+    std::string uri;
+    std::string contactName;
+    int callId = -1;
+};
+
+struct LegacySnapshot {
+    echo::SipConnectionState connection = echo::SipConnectionState::Idle;
+    echo::CallState callStatus = echo::CallState::Idle;
+    echo::CallDirection callDirection = echo::CallDirection::None;
+    LegacyIncoming incoming;
+    std::string lastError;
+    std::string username;
+    std::string domain;
+    std::string remoteUri;
+    bool muted = false;
+    echo::CallTimings timings;
+};
+
+class LegacyStore {
+public:
+    template <typename Updater>
+    void update(Updater updater) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        updater(m_snapshot);
+    }
+
+    LegacySnapshot get() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_snapshot;
+    }
+
+private:
+    LegacySnapshot m_snapshot;
+    mutable std::mutex m_mutex;
+};
+
+class SeqLockStore {
+public:
+    template <typename Updater>
+    void update(Updater updater) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        updater(m_snapshot);
+        m_published.store(m_snapshot);
+    }
+
+    echo::SipSnapshot get() const { return m_published.load(); }
+
+private:
+    echo::SipSnapshot m_snapshot;
+    std::mutex m_mutex;
+    echo::SeqLock<echo::SipSnapshot> m_published;
+};
+
+const char* const kRemotes[] = {
+    "sip:2000@pbx.example.com",
+    "sip:+5511999998888@trunk.example.com;user=phone",
+    "sip:suporte@[2001:db8::1]:5070",
+};
+
+// Uma atualização típica de onCallState: estado, direção, remoteUri e marcas
+template <typename Snapshot>
+void applyUpdate(Snapshot& s, uint64_t n) {
+    s.callStatus = n % 2 ? echo::CallState::Established : echo::CallState::Ringing;
+    s.callDirection = echo::CallDirection::Outgoing;
+    s.connection = echo::SipConnectionState::Registered;
+    s.username = "1001";
+    s.domain = "pbx.example.com";
+    s.remoteUri = kRemotes[n % 3];
+    s.incoming.displayName = "Recepção";
+    s.incoming.user = "9000";
+    s.incoming.uri = kRemotes[(n + 1) % 3];
+    s.lastError = n % 16 == 0 ? "Registro falhou: 408" : "";
+    s.timings.confirmed = static_cast<int64_t>(n);
+}
+
+struct Result {
+    double readsPerSecond = 0;
+    double writesPerSecond = 0;
+    double maxWriteMicros = 0;
+    uint64_t torn = 0;              // Leituras com campos de atualizações diferentes
+};
+
+// writesPerSecond: 0 = sem escritor, < 0 = contínuo
+template <typename Store>
+Result run(double seconds, unsigned readers, int writesPerSecond) {
+    Store store;
+    store.update([](auto& s) { applyUpdate(s, 0); });
+
+    std::atomic<bool> stop{false};
+    std::vector<uint64_t> reads(readers, 0);
+    std::atomic<size_t> sink{0};
+    std::atomic<uint64_t> torn{0};
+    std::vector<std::thread> threads;
+
+    for (unsigned r = 0; r < readers; ++r) {
+        threads.emplace_back([&, r] {
+            uint64_t count = 0;
+            uint64_t mismatches = 0;
+            size_t local = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto snap = store.get();
+                if (snap.remoteUri != kRemotes[snap.timings.confirmed % 3]) {
+                    ++mismatches;
+                }
+                local += snap.remoteUri.size() + static_cast<size_t>(snap.callStatus);
+                ++count;
+            }
+            reads[r] = count;
+            sink.fetch_add(local, std::memory_order_relaxed);
+            torn.fetch_add(mismatches, std::memory_order_relaxed);
+        });
+    }
+
+    uint64_t writes = 0;
+    double maxWrite = 0;
+    std::thread writer;
+    if (writesPerSecond != 0) {
+        writer = std::thread([&] {
+            auto period = writesPerSecond > 0 ? std::chrono::nanoseconds(1000000000LL / writesPerSecond)
+                                              : std::chrono::nanoseconds(0);
+            auto next = Clock::now();
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto start = Clock::now();
+                store.update([&](auto& s) { applyUpdate(s, writes); });
+                auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+                maxWrite = std::max(maxWrite, elapsed);
+                ++writes;
+                if (period.count() > 0) {
+                    next += period;
+                    std::this_thread::sleep_until(next);
+                }
+            }
+        });
+    }
+
+    auto start = Clock::now();
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto& t : threads) t.join();
+    if (writer.joinable()) writer.join();
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    Result result;
+    uint64_t total = 0;
+    for (uint64_t count : reads) total += count;
+    result.readsPerSecond = static_cast<double>(total) / elapsed;
+    result.writesPerSecond = static_cast<double>(writes) / elapsed;
+    result.maxWriteMicros = maxWrite;
+    result.torn = torn.load();
+    if (sink.load() == 0) {
+        std::fprintf(stderr, "nenhuma leitura\n");
+    }
+    return result;
+}
+
+void print(const char* name, const char* rate, const Result& r) {
+    std::printf("%-28s %-10s %14.0f %12.0f %12.1f %10llu\n", name, rate, r.readsPerSecond, r.writesPerSecond,
+                r.maxWriteMicros, static_cast<unsigned long long>(r.torn));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 1.0;
+    int readers = argc > 2 ? std::atoi(argv[2]) : 2;
+    if (seconds <= 0 || readers <= 0) {
+        std::fprintf(stderr, "uso: %s [segundos por caso] [leitores]\n", argv[0]);
+        return 2;
+    }
+
+    std::printf("sizeof(SipSnapshot) = %zu bytes, %d leitores\n\n", sizeof(echo::SipSnapshot), readers);
+    std::printf("%-28s %-10s %14s %12s %12s %10s\n", "snapshot", "escritor", "leituras/s", "escritas/s",
+                "max esc. us", "rasgadas");
+
+    struct Rate {
+        const char* name;
+        int perSecond;
+    };
+    const Rate rates[] = {{"nenhum", 0}, {"1000/s", 1000}, {"contínuo", -1}};
+
+    uint64_t torn = 0;
+    for (const Rate& rate : rates) {
+        Result legacy = run<LegacyStore>(seconds, readers, rate.perSecond);
+        Result current = run<SeqLockStore>(seconds, readers, rate.perSecond);
+        print("anterior (mutex + string)", rate.name, legacy);
+        print("atual (seqlock)", rate.name, current);
+        torn += legacy.torn + current.torn;
+    }
+    return torn == 0 ? 0 : 1;
+}
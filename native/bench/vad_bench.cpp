@@ -0,0 +1,172 @@
+/**
+ * @file vad_bench.cpp
+ * @brief Economia de banda do VAD em uma conversa sintética via loopback
+ *
+ * Gera uma conversa de um lado (rajadas de voz sintética com modulação de
+ * amplitude, pausas com ruído de fundo de -50 dBFS) e envia quadros G.711
+ * de 20 ms como pacotes RTP (cabeçalho de 12 bytes, marker na retomada)
+ * por um par de sockets UDP em 127.0.0.1. Compara o envio contínuo com o
+ * VAD em alguns hangovers: pacotes e bytes recebidos, kbps economizados e
+ * quadros de voz cortados (rajadas que começaram antes do detector abrir).
+ *
+ * Uso: vad_bench [segundos de conversa]
+ */
+
+#include "voice_activity.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr unsigned kRate = 8000;
+constexpr size_t kFrame = kRate / 50;          // 20 ms
+constexpr size_t kRtpHeader = 12;
+constexpr size_t kPayload = kFrame;            // G.711: 1 byte por amostra
+
+double dbfs(double db) {
+    return 32767.0 * std::pow(10.0, db / 20.0);
+}
+
+struct Conversation {
+    std::vector<int16_t> pcm;
+    std::vector<bool> speech;                  // Verdade de cada quadro
+};
+
+// Rajadas de 0,4 a 3 s (harmônicos de 100..220 Hz, sílabas a ~4 Hz) e pausas de 0,3 a 4 s
+Conversation buildConversation(double seconds) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_real_distribution<double> noise(-1.0, 1.0);
+
+    Conversation c;
+    size_t total = static_cast<size_t>(seconds * kRate) / kFrame * kFrame;
+    size_t t = 0;
+    bool talking = false;
+    while (t < total) {
+        double length = talking ? 0.4 + 2.6 * unit(rng) : 0.3 + 3.7 * unit(rng);
+        size_t n = std::min(total - t, static_cast<size_t>(length * kRate) / kFrame * kFrame);
+        double pitch = 100.0 + 120.0 * unit(rng);
+        double level = dbfs(-26.0 + 10.0 * unit(rng));
+        for (size_t i = 0; i < n; ++i, ++t) {
+            double time = static_cast<double>(t) / kRate;
+            double value = dbfs(-50.0) * noise(rng);
+            if (talking) {
+                double envelope = 0.55 + 0.45 * std::sin(2 * kPi * 4.0 * time);
+                for (int h = 1; h <= 8; ++h) {
+                    value += level * envelope / h * std::sin(2 * kPi * pitch * h * time);
+                }
+            }
+            c.pcm.push_back(static_cast<int16_t>(std::max(-32768.0, std::min(32767.0, value))));
+        }
+        for (size_t f = 0; f < n / kFrame; ++f) c.speech.push_back(talking);
+        talking = !talking;
+    }
+    return c;
+}
+
+struct Result {
+    size_t packets = 0;
+    size_t bytes = 0;
+    size_t clipped = 0;
+};
+
+// hangoverMs == 0: VAD desligado (um pacote por quadro)
+Result run(const Conversation& c, int tx, int rx, const sockaddr_in& to, unsigned hangoverMs) {
+    echo::VoiceActivityDetector vad(kRate, kFrame);
+    if (hangoverMs) vad.configure(hangoverMs, echo::VadOptions().thresholdDb);
+
+    Result r;
+    uint8_t packet[kRtpHeader + kPayload];
+    uint8_t buffer[2048];
+    uint16_t seq = 0;
+    bool sending = false;
+    for (size_t f = 0; f < c.speech.size(); ++f) {
+        const int16_t* frame = c.pcm.data() + f * kFrame;
+        bool send = hangoverMs == 0 || vad.process(frame, kFrame);
+        if (!send) {
+            if (c.speech[f]) r.clipped++;
+            sending = false;
+            continue;
+        }
+
+        std::memset(packet, 0, sizeof(packet));
+        packet[0] = 0x80;
+        packet[1] = sending ? 0 : 0x80;        // Marker: início de rajada
+        packet[2] = static_cast<uint8_t>(seq >> 8);
+        packet[3] = static_cast<uint8_t>(seq);
+        uint32_t ts = static_cast<uint32_t>(f * kFrame);
+        packet[4] = static_cast<uint8_t>(ts >> 24);
+        packet[5] = static_cast<uint8_t>(ts >> 16);
+        packet[6] = static_cast<uint8_t>(ts >> 8);
+        packet[7] = static_cast<uint8_t>(ts);
+        for (size_t i = 0; i < kPayload; ++i) packet[kRtpHeader + i] = static_cast<uint8_t>(frame[i] >> 8);
+        seq++;
+        sending = true;
+
+        sendto(tx, packet, sizeof(packet), 0, reinterpret_cast<const sockaddr*>(&to), sizeof(to));
+        ssize_t got = recv(rx, buffer, sizeof(buffer), 0);
+        if (got > 0) {
+            r.packets++;
+            r.bytes += static_cast<size_t>(got);
+        }
+    }
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 300.0;
+    if (seconds <= 0) {
+        std::fprintf(stderr, "uso: %s [segundos > 0]\n", argv[0]);
+        return 2;
+    }
+
+    int rx = socket(AF_INET, SOCK_DGRAM, 0);
+    int tx = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (rx < 0 || tx < 0 || bind(rx, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        getsockname(rx, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        std::perror("socket");
+        return 1;
+    }
+
+    Conversation c = buildConversation(seconds);
+    size_t speechFrames = 0;
+    for (bool s : c.speech) speechFrames += s;
+    std::printf("conversa: %.0f s, %zu quadros, %.1f%% com voz\n", seconds, c.speech.size(),
+                100.0 * speechFrames / c.speech.size());
+
+    Result off = run(c, tx, rx, addr, 0);
+    double offKbps = off.bytes * 8.0 / seconds / 1000.0;
+    std::printf("  %-14s %7zu pacotes %9zu bytes %6.1f kbps\n", "VAD desligado", off.packets, off.bytes, offKbps);
+
+    for (unsigned hangover : {100u, 300u, 600u}) {
+        Result on = run(c, tx, rx, addr, hangover);
+        double kbps = on.bytes * 8.0 / seconds / 1000.0;
+        char label[32];
+        std::snprintf(label, sizeof(label), "hangover %u ms", hangover);
+        std::printf("  %-14s %7zu pacotes %9zu bytes %6.1f kbps (-%.1f kbps, %.1f%%); %zu quadros de voz cortados (%.2f%%)\n",
+                    label, on.packets, on.bytes, kbps, offKbps - kbps, 100.0 * (1.0 - kbps / offKbps),
+                    on.clipped, 100.0 * on.clipped / std::max<size_t>(1, speechFrames));
+    }
+
+    close(tx);
+    close(rx);
+    return 0;
+}
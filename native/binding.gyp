@@ -6,7 +6,28 @@
         "src/pjsip_addon.cpp",
         "src/sip_engine.cpp",
         "src/audio_device.cpp",
-        "src/event_emitter.cpp"
+        "src/event_emitter.cpp",
+        "src/call_timing.cpp",
+        "src/metrics.cpp",
+        "src/trace.cpp",
+        "src/log_sink.cpp",
+        "src/command_thread.cpp",
+        "src/resource_usage.cpp",
+        "src/sip_uri.cpp",
+        "src/contact_index.cpp",
+        "src/call_log.cpp",
+        "src/dtmf_sequence.cpp",
+        "src/dtmf_detector.cpp",
+        "src/inband_dtmf_port.cpp",
+        "src/capture_processor.cpp",
+        "src/capture_port.cpp",
+        "src/opus_rate_controller.cpp",
+        "src/voice_activity.cpp",
+        "src/hold_music.cpp",
+        "src/dialog_info.cpp",
+        "src/blf_table.cpp",
+        "src/blf_watcher.cpp",
+        "src/state_mirror.cpp"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
@@ -14,7 +35,8 @@
         "deps/pjproject/pjlib-util/include",
         "deps/pjproject/pjnath/include",
         "deps/pjproject/pjmedia/include",
-        "deps/pjproject/pjsip/include"
+        "deps/pjproject/pjsip/include",
+        "deps/pjproject/third_party/speex/include"
       ],
       "defines": [
         "NAPI_VERSION=8",
@@ -103,6 +125,7 @@
             "-lg7221codec-x86_64-unknown-linux-gnu",
             "-lilbccodec-x86_64-unknown-linux-gnu",
             "-Wl,--end-group",
+            "-lopus",
             "-lasound",
             "-lpthread",
             "-lm"
@@ -135,6 +158,8 @@
             "-lpj-arm-apple-darwin",
             "-lsrtp-arm-apple-darwin",
             "-lresample-arm-apple-darwin",
+            "-lspeex-arm-apple-darwin",
+            "-lopus",
             "-framework CoreAudio",
             "-framework AudioToolbox",
             "-framework AudioUnit",
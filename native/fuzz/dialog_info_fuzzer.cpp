@@ -0,0 +1,78 @@
+/**
+ * @file dialog_info_fuzzer.cpp
+ * @brief Alvo libFuzzer dos parsers de corpos de NOTIFY do BLF
+ *
+ * O primeiro byte escolhe o Content-Type (dialog-info, RLMI ou multipart);
+ * o resto é o corpo. Verifica que as partes do multipart apontam para
+ * dentro da entrada e aplica os documentos a uma BlfTable.
+ */
+
+#include "blf_table.h"
+#include "dialog_info.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+
+namespace {
+
+void checkInside(std::string_view input, std::string_view part) {
+    if (part.empty()) {
+        return;
+    }
+    if (part.data() < input.data() || part.data() + part.size() > input.data() + input.size()) {
+        std::abort();
+    }
+}
+
+void applyDialogInfo(echo::BlfTable& table, std::string_view body) {
+    echo::DialogInfo info;
+    if (echo::parseDialogInfo(body, &info)) {
+        table.apply(0, info);
+        echo::blfStateName(table.state(0));
+    }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size < 1) {
+        return 0;
+    }
+    std::string_view input(reinterpret_cast<const char*>(data) + 1, size - 1);
+
+    echo::BlfTable table;
+    table.reset({"201"});
+
+    switch (data[0] % 3) {
+        case 0:
+            applyDialogInfo(table, input);
+            break;
+        case 1: {
+            std::vector<echo::RlmiResource> resources;
+            bool fullState = false;
+            echo::parseRlmi(input, &resources, &fullState);
+            break;
+        }
+        default: {
+            std::vector<echo::BodyPart> parts;
+            if (!echo::splitMultipart(input, std::string_view(), &parts)) {
+                break;
+            }
+            for (const echo::BodyPart& part : parts) {
+                checkInside(input, part.contentType);
+                checkInside(input, part.boundary);
+                checkInside(input, part.body);
+                if (echo::sameMediaType(part.contentType, "application/dialog-info+xml")) {
+                    applyDialogInfo(table, part.body);
+                }
+            }
+            break;
+        }
+    }
+
+    std::vector<uint32_t> changes;
+    table.takeChanges(&changes);
+    return 0;
+}
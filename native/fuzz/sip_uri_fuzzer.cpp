@@ -0,0 +1,60 @@
+/**
+ * @file sip_uri_fuzzer.cpp
+ * @brief Alvo libFuzzer do parser de identidades SIP
+ *
+ * Verifica que parseSipNameAddr nunca lê fora da entrada e que todas as
+ * views retornadas apontam para dentro dela.
+ */
+
+#include "sip_uri.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+
+namespace {
+
+void checkInside(std::string_view input, std::string_view part) {
+    if (part.empty()) {
+        return;
+    }
+    if (part.data() < input.data() || part.data() + part.size() > input.data() + input.size()) {
+        std::abort();
+    }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    std::string_view input(reinterpret_cast<const char*>(data), size);
+
+    echo::SipUriView parsed;
+    if (!echo::parseSipNameAddr(input, parsed)) {
+        return 0;
+    }
+
+    checkInside(input, parsed.displayName);
+    checkInside(input, parsed.uri);
+    checkInside(input, parsed.scheme);
+    checkInside(input, parsed.user);
+    checkInside(input, parsed.password);
+    checkInside(input, parsed.host);
+    checkInside(input, parsed.port);
+    checkInside(input, parsed.uriParams);
+    checkInside(input, parsed.uriHeaders);
+    checkInside(input, parsed.headerParams);
+
+    // Partes da URI ficam dentro do addr-spec
+    checkInside(parsed.uri, parsed.user);
+    checkInside(parsed.uri, parsed.host);
+
+    std::string_view value;
+    echo::findSipParam(parsed.uriParams, "transport", &value);
+    checkInside(input, value);
+    echo::findSipParam(parsed.headerParams, "tag", &value);
+    checkInside(input, value);
+
+    echo::decodeDisplayName(parsed.displayName);
+    return 0;
+}
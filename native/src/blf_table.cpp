@@ -0,0 +1,112 @@
+/**
+ * @file blf_table.cpp
+ * @brief Implementação da tabela de estados BLF
+ */
+
+#include "blf_table.h"
+
+#include <algorithm>
+
+namespace echo {
+
+void BlfTable::reset(const std::vector<std::string>& extensions) {
+    m_extensions.clear();
+    m_index.clear();
+    m_dialogs.clear();
+    m_dirty.clear();
+
+    for (const std::string& extension : extensions) {
+        if (extension.empty() || m_index.count(extension)) {
+            continue;
+        }
+        m_index.emplace(extension, static_cast<uint32_t>(m_extensions.size()));
+        m_extensions.push_back(extension);
+    }
+
+    size_t count = m_extensions.size();
+    m_states.assign(count, static_cast<uint8_t>(BlfState::Unknown));
+    m_emitted.assign(count, static_cast<uint8_t>(BlfState::Unknown));
+    m_dirtyFlags.assign(count, 0);
+    m_versions.assign(count, 0);
+}
+
+int BlfTable::indexOf(std::string_view extension) const {
+    auto it = m_index.find(std::string(extension));
+    return it == m_index.end() ? -1 : static_cast<int>(it->second);
+}
+
+bool BlfTable::apply(size_t index, const DialogInfo& info) {
+    if (index >= m_extensions.size()) {
+        return false;
+    }
+    if (m_versions[index] != 0 && info.version + 1 < m_versions[index]) {
+        return false;
+    }
+    m_versions[index] = info.version + 1;
+
+    auto key = static_cast<uint32_t>(index);
+    std::vector<DialogEntry> dialogs;
+    auto it = m_dialogs.find(key);
+    if (!info.full && it != m_dialogs.end()) {
+        dialogs = std::move(it->second);
+    }
+    for (const DialogEntry& entry : info.dialogs) {
+        auto existing = std::find_if(dialogs.begin(), dialogs.end(),
+                                     [&entry](const DialogEntry& d) { return d.id == entry.id; });
+        if (existing != dialogs.end()) {
+            *existing = entry;
+        } else {
+            dialogs.push_back(entry);
+        }
+    }
+    dialogs.erase(std::remove_if(dialogs.begin(), dialogs.end(),
+                                 [](const DialogEntry& d) { return d.phase == DialogPhase::Terminated; }),
+                  dialogs.end());
+
+    BlfState state = blfStateFromDialogs(dialogs);
+    if (dialogs.empty()) {
+        if (it != m_dialogs.end()) m_dialogs.erase(it);
+    } else {
+        m_dialogs[key] = std::move(dialogs);
+    }
+
+    if (m_states[index] != static_cast<uint8_t>(state)) {
+        m_states[index] = static_cast<uint8_t>(state);
+        markDirty(index);
+    }
+    return true;
+}
+
+void BlfTable::setState(size_t index, BlfState state) {
+    if (index >= m_extensions.size()) {
+        return;
+    }
+    m_dialogs.erase(static_cast<uint32_t>(index));
+    m_versions[index] = 0;
+    if (m_states[index] != static_cast<uint8_t>(state)) {
+        m_states[index] = static_cast<uint8_t>(state);
+        markDirty(index);
+    }
+}
+
+bool BlfTable::takeChanges(std::vector<uint32_t>* indices) {
+    indices->clear();
+    for (uint32_t index : m_dirty) {
+        m_dirtyFlags[index] = 0;
+        if (m_states[index] != m_emitted[index]) {
+            m_emitted[index] = m_states[index];
+            indices->push_back(index);
+        }
+    }
+    m_dirty.clear();
+    return !indices->empty();
+}
+
+void BlfTable::markDirty(size_t index) {
+    if (!m_dirtyFlags[index]) {
+        m_dirtyFlags[index] = 1;
+        m_dirty.push_back(static_cast<uint32_t>(index));
+    }
+}
+
+} // namespace echo
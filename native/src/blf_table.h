@@ -0,0 +1,94 @@
+/**
+ * @file blf_table.h
+ * @brief Estado BLF dos ramais monitorados, em arranjos indexados por ramal
+ *
+ * Este arquivo define a BlfTable: o estado de cada ramal ocupa um byte em
+ * um vetor indexado pela posição do ramal na lista monitorada (centenas
+ * de ramais cabem em poucas linhas de cache). Apenas ramais com diálogos
+ * em andamento guardam a lista de diálogos, necessária para aplicar
+ * documentos parciais.
+ *
+ * As mudanças são acumuladas até takeChanges(): um ramal que muda várias
+ * vezes entre duas coletas aparece uma vez, com o último estado, e um
+ * ramal que volta ao estado já entregue não aparece.
+ */
+
+#ifndef BLF_TABLE_H
+#define BLF_TABLE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "dialog_info.h"
+
+namespace echo {
+
+class BlfTable {
+public:
+    /**
+     * @brief Substitui os ramais monitorados (duplicados e vazios são ignorados)
+     *
+     * Todos começam em Unknown, já entregue: a primeira coleta traz apenas
+     * os ramais que receberam NOTIFY.
+     */
+    void reset(const std::vector<std::string>& extensions);
+
+    size_t size() const { return m_extensions.size(); }
+    const std::string& extension(size_t index) const { return m_extensions[index]; }
+    BlfState state(size_t index) const { return static_cast<BlfState>(m_states[index]); }
+
+    /**
+     * @brief Índice do ramal, ou -1 se não monitorado
+     */
+    int indexOf(std::string_view extension) const;
+
+    /**
+     * @brief Aplica um documento dialog-info ao ramal
+     *
+     * Documentos com versão anterior à última aplicada são descartados
+     * (RFC 4235); documentos parciais alteram apenas os diálogos citados.
+     *
+     * @return false se o documento foi descartado
+     */
+    bool apply(size_t index, const DialogInfo& info);
+
+    /**
+     * @brief Define o estado sem documento (assinatura encerrada, por exemplo)
+     *
+     * Esquece os diálogos e a versão: a próxima assinatura recomeça do zero.
+     */
+    void setState(size_t index, BlfState state);
+
+    /**
+     * @brief Há mudanças ainda não coletadas
+     */
+    bool hasChanges() const { return !m_dirty.empty(); }
+
+    /**
+     * @brief Coleta os ramais cujo estado difere do último entregue
+     * @param indices Recebe os índices, em ordem de primeira mudança
+     * @return true se há algo a entregar
+     */
+    bool takeChanges(std::vector<uint32_t>* indices);
+
+private:
+    void markDirty(size_t index);
+
+    std::vector<std::string> m_extensions;
+    std::unordered_map<std::string, uint32_t> m_index;
+    std::vector<uint8_t> m_states;          // BlfState atual
+    std::vector<uint8_t> m_emitted;         // BlfState da última coleta
+    std::vector<uint8_t> m_dirtyFlags;      // Já está em m_dirty
+    std::vector<uint32_t> m_versions;       // Versão + 1 do último documento (0 = nenhum)
+    std::vector<uint32_t> m_dirty;
+
+    // Diálogos em andamento, só dos ramais que os têm
+    std::unordered_map<uint32_t, std::vector<DialogEntry>> m_dialogs;
+};
+
+} // namespace echo
+
+#endif // BLF_TABLE_H
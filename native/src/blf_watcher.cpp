@@ -0,0 +1,610 @@
+/**
+ * @file blf_watcher.cpp
+ * @brief Implementação das assinaturas de BLF
+ */
+
+#include "blf_watcher.h"
+#include "call_timing.h"
+#include "metrics.h"
+#include "sip_uri.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace echo {
+
+namespace {
+
+constexpr int64_t kSubscribeTickMicros = 100 * 1000;    // Ritmo dos SUBSCRIBE individuais
+constexpr size_t kSubscribesPerTick = 25;
+constexpr int64_t kRetryMicros = 60 * 1000 * 1000;      // Nova tentativa após término
+constexpr int kAcquireAttempts = 50;
+constexpr int kMaxMultipartDepth = 3;
+constexpr size_t kMaxNotifyBody = 1 << 20;
+
+// Métricas do BLF
+struct BlfMetrics {
+    metrics::Gauge& subscriptions;
+    metrics::Counter& notifies;
+    metrics::Counter& batches;
+};
+
+BlfMetrics& blfMetrics() {
+    auto& registry = metrics::Registry::getInstance();
+    static BlfMetrics m{
+        registry.gauge("echo_blf_subscriptions", "Assinaturas de BLF abertas"),
+        registry.counter("echo_blf_notifies", "NOTIFY de BLF recebidos"),
+        registry.counter("echo_blf_batches", "Lotes blfUpdate entregues"),
+    };
+    return m;
+}
+
+pj_str_t kDialogEvent = {const_cast<char*>("dialog"), 6};
+
+// Módulo dono do mod_data das assinaturas (registrado a cada inicialização do PJSUA)
+pjsip_module s_module;
+bool s_moduleRegistered = false;
+bool s_packageOwned = false;        // Pacote "dialog" registrado por nós (Accept completo)
+pjsip_evsub_user s_callbacks;
+
+void* tokenData(uint32_t token) {
+    return reinterpret_cast<void*>(static_cast<uintptr_t>(token));
+}
+
+uint32_t subscriptionToken(pjsip_evsub* sub) {
+    if (!s_moduleRegistered) return 0;
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pjsip_evsub_get_mod_data(sub, s_module.id)));
+}
+
+void addHeader(pjsip_tx_data* tdata, const char* name, const char* value) {
+    pj_str_t hname = pj_str(const_cast<char*>(name));
+    pj_str_t hvalue = pj_str(const_cast<char*>(value));
+    auto* header = pjsip_generic_string_hdr_create(tdata->pool, &hname, &hvalue);
+    pjsip_msg_add_hdr(tdata->msg, reinterpret_cast<pjsip_hdr*>(header));
+}
+
+} // namespace
+
+BlfWatcher* BlfWatcher::s_instance = nullptr;
+
+BlfOptions clampBlfOptions(const BlfOptions& options) {
+    BlfOptions clamped = options;
+    clamped.batchIntervalMs = std::clamp(options.batchIntervalMs, kBlfMinBatchIntervalMs, kBlfMaxBatchIntervalMs);
+    clamped.expiresSeconds = std::clamp(options.expiresSeconds, kBlfMinExpiresSeconds, kBlfMaxExpiresSeconds);
+    return clamped;
+}
+
+BlfWatcher::BlfWatcher(Poster post, BatchSink sink)
+    : m_post(std::move(post)), m_sink(std::move(sink)) {
+    s_instance = this;
+}
+
+BlfWatcher::~BlfWatcher() {
+    if (s_instance == this) {
+        s_instance = nullptr;
+    }
+}
+
+bool BlfWatcher::ensureModule() {
+    if (s_moduleRegistered) {
+        return true;
+    }
+
+    std::memset(&s_module, 0, sizeof(s_module));
+    s_module.name = pj_str(const_cast<char*>("mod-echo-blf"));
+    s_module.id = -1;
+    s_module.priority = PJSIP_MOD_PRIORITY_APPLICATION;
+
+    std::memset(&s_callbacks, 0, sizeof(s_callbacks));
+    s_callbacks.on_evsub_state = &BlfWatcher::onEvsubState;
+    s_callbacks.on_rx_notify = &BlfWatcher::onRxNotify;
+
+    pjsip_endpoint* endpoint = pjsua_get_pjsip_endpt();
+    if (!endpoint || pjsip_endpt_register_module(endpoint, &s_module) != PJ_SUCCESS) {
+        return false;
+    }
+
+    // O PJSUA pode já ter registrado o pacote (só com dialog-info no Accept)
+    pj_str_t accept[] = {
+        pj_str(const_cast<char*>("application/dialog-info+xml")),
+        pj_str(const_cast<char*>("application/rlmi+xml")),
+        pj_str(const_cast<char*>("multipart/related")),
+    };
+    pj_status_t status = pjsip_evsub_register_pkg(&s_module, &kDialogEvent, BlfOptions().expiresSeconds,
+                                                  PJ_ARRAY_SIZE(accept), accept);
+    if (status != PJ_SUCCESS && status != PJSIP_SIMPLE_EPKGEXISTS) {
+        pjsip_endpt_unregister_module(endpoint, &s_module);
+        return false;
+    }
+    s_packageOwned = status == PJ_SUCCESS;
+    s_moduleRegistered = true;
+    return true;
+}
+
+void BlfWatcher::watch(const std::vector<std::string>& extensions, const BlfOptions& options) {
+    unsubscribeAll();
+    m_pending.clear();
+    m_options = clampBlfOptions(options);
+    m_listRejected = false;
+    m_table.reset(extensions);
+    subscribeAll();
+}
+
+void BlfWatcher::setAccount(const BlfAccount& account) {
+    // Cada registro bem sucedido (inclusive renovações) chega aqui
+    if (account == m_account) {
+        return;
+    }
+    unsubscribeAll();
+    m_pending.clear();
+    m_account = account;
+    m_listRejected = false;
+    subscribeAll();
+}
+
+void BlfWatcher::clearAccount() {
+    unsubscribeAll();
+    m_pending.clear();
+    m_account = BlfAccount();
+    for (size_t i = 0; i < m_table.size(); ++i) {
+        m_table.setState(i, BlfState::Unknown);
+    }
+    scheduleTick(monotonicMicros());
+}
+
+void BlfWatcher::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_subscriptions.clear();
+    }
+    m_pending.clear();
+    m_account = BlfAccount();
+    m_timerGeneration++;
+    m_timerActive = false;
+    s_moduleRegistered = false;
+    blfMetrics().subscriptions.set(0);
+}
+
+std::vector<BlfEntry> BlfWatcher::entries() const {
+    std::vector<BlfEntry> result;
+    result.reserve(m_table.size());
+    for (size_t i = 0; i < m_table.size(); ++i) {
+        result.push_back({m_table.extension(i), m_table.state(i)});
+    }
+    return result;
+}
+
+BlfStats BlfWatcher::stats() const {
+    BlfStats stats;
+    stats.extensions = m_table.size();
+    stats.resourceList = !m_options.listUri.empty() && !m_listRejected;
+    stats.notifies = m_notifies;
+    stats.batches = m_batches;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stats.subscriptions = m_subscriptions.size();
+    for (const auto& entry : m_subscriptions) {
+        if (entry.second.active) stats.active++;
+    }
+    return stats;
+}
+
+void BlfWatcher::subscribeAll() {
+    if (m_account.accountId == PJSUA_INVALID_ID || m_table.size() == 0) {
+        return;
+    }
+
+    int64_t now = monotonicMicros();
+    if (!m_options.listUri.empty() && !m_listRejected) {
+        enqueue(-1, now);
+    } else {
+        for (size_t i = 0; i < m_table.size(); ++i) {
+            enqueue(static_cast<int>(i), now);
+        }
+    }
+    scheduleTick(now);
+}
+
+void BlfWatcher::unsubscribeAll() {
+    std::vector<uint32_t> tokens;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& entry : m_subscriptions) {
+            tokens.push_back(entry.first);
+        }
+    }
+    for (uint32_t token : tokens) {
+        unsubscribe(token);
+    }
+    blfMetrics().subscriptions.set(0);
+}
+
+bool BlfWatcher::subscribe(int index) {
+    if (!ensureModule()) {
+        return false;
+    }
+
+    std::string target = index < 0 ? m_options.listUri
+                                   : "sip:" + m_table.extension(index) + "@" + m_account.domain + m_account.uriParams;
+    pj_str_t local = pj_str(const_cast<char*>(m_account.localUri.c_str()));
+    pj_str_t remote = pj_str(const_cast<char*>(target.c_str()));
+
+    // O diálogo copia as URIs; o pool só guarda o Contact até lá
+    pj_pool_t* pool = pjsua_pool_create("echo-blf", 256, 256);
+    if (!pool) {
+        return false;
+    }
+    pj_str_t contact;
+    pjsip_dialog* dialog = nullptr;
+    pj_status_t status = pjsua_acc_create_uac_contact(pool, &contact, m_account.accountId, &remote);
+    if (status == PJ_SUCCESS) {
+        status = pjsip_dlg_create_uac(pjsip_ua_instance(), &local, &contact, &remote, nullptr, &dialog);
+    }
+    pj_pool_release(pool);
+    if (status != PJ_SUCCESS) {
+        return false;
+    }
+
+    // Lock extra: se a assinatura não for criada, o dec_lock destrói o diálogo
+    pjsip_dlg_inc_lock(dialog);
+    pjsip_evsub* evsub = nullptr;
+    status = pjsip_evsub_create_uac(dialog, &s_callbacks, &kDialogEvent, PJSIP_EVSUB_NO_EVENT_ID, &evsub);
+    if (status != PJ_SUCCESS) {
+        pjsip_dlg_dec_lock(dialog);
+        return false;
+    }
+
+    uint32_t token = m_nextToken++;
+    if (m_nextToken == 0) m_nextToken = 1;
+    pjsip_evsub_set_mod_data(evsub, s_module.id, tokenData(token));
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Subscription& subscription = m_subscriptions[token];
+        subscription.evsub = evsub;
+        subscription.dialog = dialog;
+        subscription.index = index;
+        blfMetrics().subscriptions.set(static_cast<int64_t>(m_subscriptions.size()));
+    }
+
+    pjsip_cred_info cred;
+    std::memset(&cred, 0, sizeof(cred));
+    cred.realm = pj_str(const_cast<char*>("*"));
+    cred.scheme = pj_str(const_cast<char*>("digest"));
+    cred.username = pj_str(const_cast<char*>(m_account.username.c_str()));
+    cred.data_type = PJSIP_CRED_DATA_PLAIN_PASSWD;
+    cred.data = pj_str(const_cast<char*>(m_account.password.c_str()));
+    pjsip_auth_clt_set_credentials(&dialog->auth_sess, 1, &cred);
+
+    pjsip_tx_data* tdata = nullptr;
+    status = pjsip_evsub_initiate(evsub, nullptr, m_options.expiresSeconds, &tdata);
+    if (status == PJ_SUCCESS && index < 0) {
+        addHeader(tdata, "Supported", "eventlist");
+        if (!s_packageOwned) {
+            addHeader(tdata, "Accept", "application/rlmi+xml, multipart/related");
+        }
+    }
+    if (status == PJ_SUCCESS) {
+        status = pjsip_evsub_send_request(evsub, tdata);
+    }
+    if (status != PJ_SUCCESS) {
+        pjsip_evsub_set_mod_data(evsub, s_module.id, nullptr);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_subscriptions.erase(token);
+        }
+        pjsip_evsub_terminate(evsub, PJ_FALSE);
+    }
+    pjsip_dlg_dec_lock(dialog);
+    return status == PJ_SUCCESS;
+}
+
+void BlfWatcher::unsubscribe(uint32_t token) {
+    // Mesmo protocolo do acquire_buddy do PJSUA: o callback de término tem o
+    // lock do diálogo e pede m_mutex, então aqui o lock do diálogo é só tentado
+    pjsip_evsub* evsub = nullptr;
+    pjsip_dialog* dialog = nullptr;
+    for (int attempt = 0; attempt < kAcquireAttempts && !evsub; ++attempt) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_subscriptions.find(token);
+            if (it == m_subscriptions.end()) {
+                return;
+            }
+            if (!it->second.evsub) {
+                m_subscriptions.erase(it);
+                return;
+            }
+            if (pjsip_dlg_try_inc_lock(it->second.dialog) == PJ_SUCCESS) {
+                evsub = it->second.evsub;
+                dialog = it->second.dialog;
+                m_subscriptions.erase(it);
+                break;
+            }
+        }
+        pj_thread_sleep(1);
+    }
+
+    if (!evsub) {
+        // Diálogo ocupado demais: a assinatura expira sozinha e os callbacks
+        // não acham mais o token
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_subscriptions.erase(token);
+        return;
+    }
+
+    pjsip_evsub_set_mod_data(evsub, s_module.id, nullptr);
+    pjsip_tx_data* tdata = nullptr;
+    if (pjsip_evsub_initiate(evsub, nullptr, 0, &tdata) != PJ_SUCCESS ||
+        pjsip_evsub_send_request(evsub, tdata) != PJ_SUCCESS) {
+        pjsip_evsub_terminate(evsub, PJ_FALSE);
+    }
+    pjsip_dlg_dec_lock(dialog);
+}
+
+void BlfWatcher::enqueue(int index, int64_t notBefore) {
+    m_pending.push_back({index, notBefore});
+}
+
+void BlfWatcher::scheduleTick(int64_t now) {
+    int64_t due = -1;
+    if (!m_pending.empty()) {
+        int64_t earliest = m_pending.front().notBefore;
+        for (const PendingSubscribe& pending : m_pending) {
+            earliest = std::min(earliest, pending.notBefore);
+        }
+        due = std::max(earliest, now + (earliest <= now ? kSubscribeTickMicros : 0));
+    }
+    if (m_table.hasChanges()) {
+        int64_t flushAt = std::max(now, m_lastFlush + static_cast<int64_t>(m_options.batchIntervalMs) * 1000);
+        due = due < 0 ? flushAt : std::min(due, flushAt);
+    }
+    if (due < 0 || (m_timerActive && m_timerDue <= due)) {
+        return;
+    }
+
+    m_timerGeneration++;
+    m_timerActive = true;
+    m_timerDue = due;
+    pjsua_schedule_timer2(&BlfWatcher::onTimer,
+                          reinterpret_cast<void*>(static_cast<uintptr_t>(m_timerGeneration)),
+                          static_cast<unsigned>((due - now) / 1000));
+}
+
+void BlfWatcher::handleTick(unsigned generation) {
+    if (generation != m_timerGeneration) {
+        return;
+    }
+    m_timerActive = false;
+
+    int64_t now = monotonicMicros();
+    if (m_account.accountId == PJSUA_INVALID_ID) {
+        m_pending.clear();
+    }
+    size_t sent = 0;
+    std::deque<PendingSubscribe> waiting;
+    while (!m_pending.empty()) {
+        PendingSubscribe pending = m_pending.front();
+        m_pending.pop_front();
+        if (pending.notBefore > now || sent == kSubscribesPerTick) {
+            waiting.push_back(pending);
+            continue;
+        }
+        sent++;
+        if (!subscribe(pending.index)) {
+            waiting.push_back({pending.index, now + kRetryMicros});
+        }
+    }
+    m_pending.swap(waiting);
+
+    flush(now);
+    scheduleTick(now);
+}
+
+void BlfWatcher::flush(int64_t now) {
+    if (!m_table.hasChanges() || now < m_lastFlush + static_cast<int64_t>(m_options.batchIntervalMs) * 1000) {
+        return;
+    }
+
+    std::vector<uint32_t> indices;
+    if (!m_table.takeChanges(&indices)) {
+        return;
+    }
+
+    std::vector<BlfEntry> changes;
+    changes.reserve(indices.size());
+    for (uint32_t index : indices) {
+        changes.push_back({m_table.extension(index), m_table.state(index)});
+    }
+    m_lastFlush = now;
+    m_batches++;
+    blfMetrics().batches.inc();
+    if (m_sink) {
+        m_sink(changes);
+    }
+}
+
+void BlfWatcher::handleNotify(uint32_t token, const std::string& contentType, const std::string& body) {
+    int index;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_subscriptions.find(token);
+        if (it == m_subscriptions.end()) {
+            return;
+        }
+        it->second.notified = true;
+        index = it->second.index;
+    }
+
+    m_notifies++;
+    blfMetrics().notifies.inc();
+    applyBody(index, contentType, std::string_view(), body, 0);
+    if (m_table.hasChanges()) {
+        scheduleTick(monotonicMicros());
+    }
+}
+
+void BlfWatcher::applyBody(int index, std::string_view contentType, std::string_view boundary,
+                           std::string_view body, int depth) {
+    if (sameMediaType(contentType, "application/dialog-info+xml")) {
+        DialogInfo info;
+        if (!parseDialogInfo(body, &info)) {
+            return;
+        }
+        int target = index >= 0 ? index : indexOfUri(info.entity);
+        if (target >= 0) {
+            m_table.apply(static_cast<size_t>(target), info);
+        }
+        return;
+    }
+
+    if (contentType.size() < 10 || !sameMediaType(contentType.substr(0, 10), "multipart/") ||
+        depth >= kMaxMultipartDepth) {
+        return;
+    }
+
+    std::vector<BodyPart> parts;
+    if (!splitMultipart(body, boundary, &parts)) {
+        return;
+    }
+    for (const BodyPart& part : parts) {
+        if (sameMediaType(part.contentType, "application/rlmi+xml")) {
+            // Ramais que o RLS deixou de acompanhar (sem dialog-info na lista)
+            std::vector<RlmiResource> resources;
+            bool fullState = false;
+            parseRlmi(part.body, &resources, &fullState);
+            for (const RlmiResource& resource : resources) {
+                int target = resource.terminated ? indexOfUri(resource.uri) : -1;
+                if (target >= 0) {
+                    m_table.setState(static_cast<size_t>(target), BlfState::Unknown);
+                }
+            }
+        } else {
+            applyBody(index, part.contentType, part.boundary, part.body, depth + 1);
+        }
+    }
+}
+
+void BlfWatcher::handleState(uint32_t token, bool active, bool terminated, int statusCode) {
+    int index;
+    bool notified;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_subscriptions.find(token);
+        if (it == m_subscriptions.end()) {
+            return;
+        }
+        if (active) {
+            it->second.active = true;
+        }
+        if (!terminated) {
+            return;
+        }
+        index = it->second.index;
+        notified = it->second.notified;
+        m_subscriptions.erase(it);
+        blfMetrics().subscriptions.set(static_cast<int64_t>(m_subscriptions.size()));
+    }
+
+    int64_t now = monotonicMicros();
+    if (index >= 0) {
+        m_table.setState(static_cast<size_t>(index), BlfState::Unknown);
+    } else {
+        for (size_t i = 0; i < m_table.size(); ++i) {
+            m_table.setState(i, BlfState::Unknown);
+        }
+    }
+
+    if (m_account.accountId != PJSUA_INVALID_ID) {
+        if (index < 0 && !notified && statusCode >= 400) {
+            // O servidor não tem a lista (ou não é um RLS): um SUBSCRIBE por ramal
+            m_listRejected = true;
+            for (size_t i = 0; i < m_table.size(); ++i) {
+                enqueue(static_cast<int>(i), now);
+            }
+        } else {
+            enqueue(index, now + kRetryMicros);
+        }
+    }
+    scheduleTick(now);
+}
+
+int BlfWatcher::indexOfUri(std::string_view uri) const {
+    SipUriView view;
+    if (!parseSipNameAddr(uri, view) || view.user.empty()) {
+        return -1;
+    }
+    return m_table.indexOf(view.user);
+}
+
+// Callbacks do PJSIP (threads do PJSUA, com o lock do diálogo)
+
+void BlfWatcher::onEvsubState(pjsip_evsub* sub, pjsip_event* event) {
+    BlfWatcher* watcher = s_instance;
+    uint32_t token = subscriptionToken(sub);
+    if (!watcher || !token) return;
+
+    pjsip_evsub_state state = pjsip_evsub_get_state(sub);
+    bool active = state == PJSIP_EVSUB_STATE_ACTIVE;
+    bool terminated = state == PJSIP_EVSUB_STATE_TERMINATED;
+    int statusCode = 0;
+    if (terminated) {
+        // Código da resposta ao nosso SUBSCRIBE (404, 489...), se foi ela que encerrou
+        if (event && event->type == PJSIP_EVENT_TSX_STATE && event->body.tsx_state.tsx &&
+            event->body.tsx_state.tsx->role == PJSIP_ROLE_UAC) {
+            statusCode = event->body.tsx_state.tsx->status_code;
+        }
+        // A evsub é destruída ao retornar
+        pjsip_evsub_set_mod_data(sub, s_module.id, nullptr);
+        std::lock_guard<std::mutex> lock(watcher->m_mutex);
+        auto it = watcher->m_subscriptions.find(token);
+        if (it != watcher->m_subscriptions.end()) {
+            it->second.evsub = nullptr;
+            it->second.dialog = nullptr;
+        }
+    }
+
+    watcher->m_post([watcher, token, active, terminated, statusCode]() {
+        watcher->handleState(token, active, terminated, statusCode);
+    });
+}
+
+void BlfWatcher::onRxNotify(pjsip_evsub* sub, pjsip_rx_data* rdata, int* p_st_code, pj_str_t** p_st_text,
+                            pjsip_hdr* res_hdr, pjsip_msg_body** p_body) {
+    (void)p_st_code;
+    (void)p_st_text;
+    (void)res_hdr;
+    (void)p_body;
+
+    BlfWatcher* watcher = s_instance;
+    uint32_t token = subscriptionToken(sub);
+    pjsip_msg_body* body = rdata->msg_info.msg->body;
+    if (!watcher || !token || !body) return;
+
+    std::string contentType(body->content_type.type.ptr, static_cast<size_t>(body->content_type.type.slen));
+    contentType += '/';
+    contentType.append(body->content_type.subtype.ptr, static_cast<size_t>(body->content_type.subtype.slen));
+
+    // Impressão do corpo: texto original, ou o multipart já interpretado pelo PJSIP
+    std::string text(4096, '\0');
+    int length = -1;
+    while ((length = body->print_body(body, &text[0], text.size())) < 0 && text.size() < kMaxNotifyBody) {
+        text.resize(text.size() * 2);
+    }
+    if (length < 0) return;
+    text.resize(static_cast<size_t>(length));
+
+    watcher->m_post([watcher, token, contentType = std::move(contentType), text = std::move(text)]() {
+        watcher->handleNotify(token, contentType, text);
+    });
+}
+
+void BlfWatcher::onTimer(void* user_data) {
+    BlfWatcher* watcher = s_instance;
+    if (!watcher) return;
+
+    unsigned generation = static_cast<unsigned>(reinterpret_cast<uintptr_t>(user_data));
+    watcher->m_post([watcher, generation]() {
+        watcher->handleTick(generation);
+    });
+}
+
+} // namespace echo
@@ -0,0 +1,211 @@
+/**
+ * @file blf_watcher.h
+ * @brief Assinaturas do pacote "dialog" (BLF) para centenas de ramais
+ *
+ * Este arquivo define o BlfWatcher, que mantém as assinaturas SUBSCRIBE
+ * (Event: dialog, RFC 4235) dos ramais monitorados e o estado de cada um
+ * em uma BlfTable.
+ *
+ * Com uma URI de lista configurada, uma única assinatura com
+ * "Supported: eventlist" (RFC 4662) cobre todos os ramais: o servidor de
+ * listas (RLS) envia NOTIFY multipart/related com um documento RLMI e um
+ * dialog-info por ramal. Se o servidor recusa a lista, ou sem lista, cada
+ * ramal tem a sua assinatura; os SUBSCRIBE saem em lotes por ciclo do
+ * timer, não todos de uma vez.
+ *
+ * As mudanças de estado são entregues em lotes, no máximo um a cada
+ * batchIntervalMs: rajadas de NOTIFY (hora de pico) viram poucos eventos.
+ *
+ * Tudo roda no thread SIP; os callbacks do PJSIP apenas copiam o NOTIFY e
+ * enfileiram o tratamento nele, como os do engine.
+ */
+
+#ifndef BLF_WATCHER_H
+#define BLF_WATCHER_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "blf_table.h"
+
+extern "C" {
+#include <pjsua-lib/pjsua.h>
+}
+
+namespace echo {
+
+/**
+ * @brief Configuração do BLF
+ */
+struct BlfOptions {
+    std::string listUri;                // Lista no RLS; vazio = um SUBSCRIBE por ramal
+    unsigned batchIntervalMs = 250;     // Intervalo mínimo entre lotes (eventos blfUpdate)
+    unsigned expiresSeconds = 600;      // Expires dos SUBSCRIBE
+};
+
+// Limites aceitos
+constexpr unsigned kBlfMinBatchIntervalMs = 50;
+constexpr unsigned kBlfMaxBatchIntervalMs = 5000;
+constexpr unsigned kBlfMinExpiresSeconds = 60;
+constexpr unsigned kBlfMaxExpiresSeconds = 3600;
+
+/**
+ * @brief Ajusta intervalo e expires aos limites
+ */
+BlfOptions clampBlfOptions(const BlfOptions& options);
+
+/**
+ * @brief Conta usada nas assinaturas
+ */
+struct BlfAccount {
+    pjsua_acc_id accountId = PJSUA_INVALID_ID;
+    std::string localUri;       // From (id da conta)
+    std::string domain;         // host[:porta] das URIs dos ramais
+    std::string uriParams;      // Ex.: ";transport=tcp"
+    std::string username;
+    std::string password;
+
+    bool operator==(const BlfAccount& other) const {
+        return accountId == other.accountId && localUri == other.localUri && domain == other.domain &&
+               uriParams == other.uriParams && username == other.username && password == other.password;
+    }
+};
+
+/**
+ * @brief Estado de um ramal
+ */
+struct BlfEntry {
+    std::string extension;
+    BlfState state;
+};
+
+/**
+ * @brief Contadores do BLF
+ */
+struct BlfStats {
+    size_t extensions = 0;
+    size_t subscriptions = 0;       // Assinaturas abertas (inclui as aguardando resposta)
+    size_t active = 0;              // Aceitas pelo servidor
+    bool resourceList = false;      // Usando a lista (RLS)
+    uint64_t notifies = 0;
+    uint64_t batches = 0;
+};
+
+class BlfWatcher {
+public:
+    using Poster = std::function<bool(std::function<void()>)>;
+    using BatchSink = std::function<void(const std::vector<BlfEntry>& changes)>;
+
+    /**
+     * @param post Enfileira uma função no thread SIP
+     * @param sink Recebe cada lote de mudanças (thread SIP)
+     */
+    BlfWatcher(Poster post, BatchSink sink);
+    ~BlfWatcher();
+
+    BlfWatcher(const BlfWatcher&) = delete;
+    BlfWatcher& operator=(const BlfWatcher&) = delete;
+
+    /**
+     * @brief Substitui os ramais monitorados e refaz as assinaturas
+     *
+     * Sem conta as assinaturas ficam para setAccount. Lista vazia encerra
+     * todas.
+     */
+    void watch(const std::vector<std::string>& extensions, const BlfOptions& options);
+
+    /**
+     * @brief Define a conta; se mudou, refaz as assinaturas com ela
+     */
+    void setAccount(const BlfAccount& account);
+
+    /**
+     * @brief Encerra as assinaturas (SUBSCRIBE com Expires: 0) e esquece a conta
+     *
+     * Os ramais voltam a Unknown.
+     */
+    void clearAccount();
+
+    /**
+     * @brief Esquece assinaturas e timers após pjsua_destroy
+     */
+    void shutdown();
+
+    /**
+     * @brief Estado atual de todos os ramais, na ordem da lista
+     */
+    std::vector<BlfEntry> entries() const;
+
+    BlfStats stats() const;
+
+private:
+    struct Subscription {
+        pjsip_evsub* evsub = nullptr;       // Nulo após o término (m_mutex)
+        pjsip_dialog* dialog = nullptr;
+        int index = -1;                     // Ramal na tabela; -1 = lista
+        bool active = false;
+        bool notified = false;
+    };
+
+    struct PendingSubscribe {
+        int index;
+        int64_t notBefore;                  // monotonicMicros
+    };
+
+    static bool ensureModule();
+    void subscribeAll();
+    void unsubscribeAll();
+    bool subscribe(int index);
+    void unsubscribe(uint32_t token);
+    void enqueue(int index, int64_t notBefore);
+    void scheduleTick(int64_t now);
+    void handleTick(unsigned generation);
+    void flush(int64_t now);
+    void handleNotify(uint32_t token, const std::string& contentType, const std::string& body);
+    void handleState(uint32_t token, bool active, bool terminated, int statusCode);
+    void applyBody(int index, std::string_view contentType, std::string_view boundary, std::string_view body,
+                   int depth);
+    int indexOfUri(std::string_view uri) const;
+
+    static void onEvsubState(pjsip_evsub* sub, pjsip_event* event);
+    static void onRxNotify(pjsip_evsub* sub, pjsip_rx_data* rdata, int* p_st_code, pj_str_t** p_st_text,
+                           pjsip_hdr* res_hdr, pjsip_msg_body** p_body);
+    static void onTimer(void* user_data);
+
+    static BlfWatcher* s_instance;
+
+    Poster m_post;
+    BatchSink m_sink;
+
+    BlfOptions m_options;
+    BlfAccount m_account;
+    BlfTable m_table;
+    bool m_listRejected{false};         // RLS recusou a lista: um SUBSCRIBE por ramal
+
+    // Assinaturas por token (guardado no mod_data da evsub). O callback de
+    // término zera evsub/dialog com m_mutex; o resto é do thread SIP
+    std::map<uint32_t, Subscription> m_subscriptions;
+    mutable std::mutex m_mutex;
+    uint32_t m_nextToken{1};
+
+    std::deque<PendingSubscribe> m_pending;
+
+    // Um timer por vez; gerações antigas são ignoradas ao disparar
+    unsigned m_timerGeneration{0};
+    bool m_timerActive{false};
+    int64_t m_timerDue{0};
+    int64_t m_lastFlush{0};
+
+    uint64_t m_notifies{0};
+    uint64_t m_batches{0};
+};
+
+} // namespace echo
+
+#endif // BLF_WATCHER_H
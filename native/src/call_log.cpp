@@ -0,0 +1,761 @@
+/**
+ * @file call_log.cpp
+ * @brief Implementação do histórico de chamadas mapeado em memória
+ */
+
+#include "call_log.h"
+#include "contact_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <string_view>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace echo {
+
+namespace {
+
+constexpr char kMagic[8] = {'E', 'C', 'H', 'O', 'C', 'L', 'O', 'G'};
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kHeaderSize = 64;
+constexpr uint64_t kRecordSize = 256;
+constexpr uint64_t kInitialCapacity = 4096;         // 1 MB
+constexpr uint64_t kMaxGrowth = 65536;              // Crescimento máximo por vez (16 MB)
+constexpr uint64_t kCompactChunk = 4096;            // Registros copiados por trecho
+constexpr uint64_t kMinDeletedToCompact = 1024;
+constexpr size_t kMaxPage = 1000;
+
+constexpr uint8_t kFlagDeleted = 1;
+
+char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Chave de índice: número normalizado ou, para usuários SIP alfanuméricos,
+// FNV-1a sem distinção de caixa com o bit 63 ligado (não colide com números)
+uint64_t numberKey(std::string_view number) {
+    static const NumberPlan plan;
+    uint64_t key;
+    if (normalizePhoneNumber(number, plan, &key)) {
+        return key;
+    }
+
+    uint64_t hash = 1469598103934665603ULL;
+    for (char c : number) {
+        hash ^= static_cast<uint8_t>(lower(c));
+        hash *= 1099511628211ULL;
+    }
+    return hash | (1ULL << 63);
+}
+
+// Tamanho que cabe em max bytes sem cortar um caractere UTF-8
+size_t fitUtf8(const std::string& value, size_t max) {
+    if (value.size() <= max) {
+        return value.size();
+    }
+    size_t length = max;
+    while (length > 0 && (static_cast<uint8_t>(value[length]) & 0xC0) == 0x80) {
+        --length;
+    }
+    return length;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Formato em disco (little-endian, como gravado pelo processo)
+// ---------------------------------------------------------------------------
+
+struct CallLog::DiskHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t count;             // Registros gravados (inclui excluídos)
+    uint64_t nextId;
+    uint64_t deleted;
+    uint8_t reserved[24];
+};
+
+struct CallLog::DiskRecord {
+    uint64_t id;
+    int64_t startTimeMs;
+    int64_t answerTimeMs;
+    int64_t endTimeMs;
+    int32_t sipStatus;
+    uint8_t direction;
+    uint8_t status;
+    uint8_t flags;
+    uint8_t numberLength;
+    uint8_t displayNameLength;
+    uint8_t padding[3];
+    char number[64];
+    char displayName[96];
+    // Campos do CDR (antes reservados; zero = ausente em arquivos antigos)
+    int16_t transferStatus;
+    uint8_t transfer;
+    uint8_t codecLength;
+    int64_t ringTimeMs;
+    uint8_t accountLength;
+    char codec[8];
+    char account[31];
+};
+
+static_assert(sizeof(CallLog::DiskHeader) == kHeaderSize, "cabeçalho do histórico deve ter 64 bytes");
+static_assert(sizeof(CallLog::DiskRecord) == kRecordSize, "registro do histórico deve ter 256 bytes");
+
+namespace {
+
+void storeRecord(CallLog::DiskRecord* out, const CallRecord& record, uint64_t id) {
+    std::memset(out, 0, sizeof(*out));
+    out->id = id;
+    out->startTimeMs = record.startTimeMs;
+    out->answerTimeMs = record.answerTimeMs;
+    out->endTimeMs = record.endTimeMs;
+    out->sipStatus = record.sipStatus;
+    out->direction = static_cast<uint8_t>(record.direction);
+    out->status = static_cast<uint8_t>(record.status);
+
+    size_t numberLength = fitUtf8(record.number, sizeof(out->number) - 1);
+    std::memcpy(out->number, record.number.data(), numberLength);
+    out->numberLength = static_cast<uint8_t>(numberLength);
+
+    size_t nameLength = fitUtf8(record.displayName, sizeof(out->displayName) - 1);
+    std::memcpy(out->displayName, record.displayName.data(), nameLength);
+    out->displayNameLength = static_cast<uint8_t>(nameLength);
+
+    out->ringTimeMs = record.ringTimeMs;
+    out->transfer = static_cast<uint8_t>(record.transfer);
+    out->transferStatus = static_cast<int16_t>(record.transferStatus);
+
+    size_t codecLength = fitUtf8(record.codec, sizeof(out->codec));
+    std::memcpy(out->codec, record.codec.data(), codecLength);
+    out->codecLength = static_cast<uint8_t>(codecLength);
+
+    size_t accountLength = fitUtf8(record.account, sizeof(out->account));
+    std::memcpy(out->account, record.account.data(), accountLength);
+    out->accountLength = static_cast<uint8_t>(accountLength);
+}
+
+CallRecord loadRecord(const CallLog::DiskRecord& in) {
+    CallRecord record;
+    record.id = in.id;
+    record.startTimeMs = in.startTimeMs;
+    record.answerTimeMs = in.answerTimeMs;
+    record.endTimeMs = in.endTimeMs;
+    record.sipStatus = in.sipStatus;
+    record.direction = static_cast<CallLogDirection>(in.direction);
+    record.status = static_cast<CallLogStatus>(in.status);
+    record.number.assign(in.number, std::min<size_t>(in.numberLength, sizeof(in.number)));
+    record.displayName.assign(in.displayName, std::min<size_t>(in.displayNameLength, sizeof(in.displayName)));
+    record.ringTimeMs = in.ringTimeMs;
+    record.transfer = static_cast<CallTransfer>(in.transfer);
+    record.transferStatus = in.transferStatus;
+    record.codec.assign(in.codec, std::min<size_t>(in.codecLength, sizeof(in.codec)));
+    record.account.assign(in.account, std::min<size_t>(in.accountLength, sizeof(in.account)));
+    return record;
+}
+
+std::string_view recordNumber(const CallLog::DiskRecord& in) {
+    return std::string_view(in.number, std::min<size_t>(in.numberLength, sizeof(in.number)));
+}
+
+} // namespace
+
+const char* callLogStatusName(CallLogStatus status) {
+    switch (status) {
+        case CallLogStatus::Answered: return "answered";
+        case CallLogStatus::Completed: return "completed";
+        case CallLogStatus::Missed: return "missed";
+        case CallLogStatus::Rejected: return "rejected";
+        default: return "failed";
+    }
+}
+
+const char* callTransferName(CallTransfer transfer) {
+    switch (transfer) {
+        case CallTransfer::Blind: return "blind";
+        case CallTransfer::Attended: return "attended";
+        default: return "none";
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Arquivo mapeado
+// ---------------------------------------------------------------------------
+
+class CallLog::MappedFile {
+public:
+    ~MappedFile() {
+        close();
+    }
+
+    bool open(const std::string& path, std::string* error) {
+        close();
+#ifdef _WIN32
+        int wideLength = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+        std::wstring widePath(wideLength > 0 ? wideLength : 0, L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, widePath.data(), wideLength);
+        m_handle = CreateFileW(widePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                               OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_handle == INVALID_HANDLE_VALUE) {
+            if (error) *error = "Falha ao abrir " + path + " (erro " + std::to_string(GetLastError()) + ")";
+            return false;
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(m_handle, &size);
+        m_size = static_cast<uint64_t>(size.QuadPart);
+#else
+        m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (m_fd < 0) {
+            if (error) *error = "Falha ao abrir " + path + ": " + std::strerror(errno);
+            return false;
+        }
+        struct stat st;
+        if (fstat(m_fd, &st) != 0) {
+            if (error) *error = "Falha ao ler tamanho de " + path;
+            close();
+            return false;
+        }
+        m_size = static_cast<uint64_t>(st.st_size);
+#endif
+        return m_size == 0 || map(error);
+    }
+
+    // Redimensiona o arquivo e refaz o mapeamento (invalida ponteiros anteriores)
+    bool resize(uint64_t bytes, std::string* error) {
+        unmap();
+#ifdef _WIN32
+        LARGE_INTEGER size;
+        size.QuadPart = static_cast<LONGLONG>(bytes);
+        if (!SetFilePointerEx(m_handle, size, nullptr, FILE_BEGIN) || !SetEndOfFile(m_handle)) {
+            if (error) *error = "Falha ao redimensionar o histórico (erro " + std::to_string(GetLastError()) + ")";
+            map(nullptr);   // Mantém o mapeamento anterior
+            return false;
+        }
+#else
+        if (ftruncate(m_fd, static_cast<off_t>(bytes)) != 0) {
+            if (error) *error = std::string("Falha ao redimensionar o histórico: ") + std::strerror(errno);
+            map(nullptr);   // Mantém o mapeamento anterior
+            return false;
+        }
+#endif
+        m_size = bytes;
+        return map(error);
+    }
+
+    void flush() {
+        if (!m_data) return;
+#ifdef _WIN32
+        FlushViewOfFile(m_data, 0);
+#else
+        msync(m_data, m_size, MS_ASYNC);
+#endif
+    }
+
+    void close() {
+        unmap();
+#ifdef _WIN32
+        if (m_handle != INVALID_HANDLE_VALUE) {
+            CloseHandle(m_handle);
+            m_handle = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+#endif
+        m_size = 0;
+    }
+
+    uint8_t* data() const { return m_data; }
+    uint64_t size() const { return m_size; }
+
+private:
+    bool map(std::string* error) {
+#ifdef _WIN32
+        m_mapping = CreateFileMappingW(m_handle, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+        if (m_mapping) {
+            m_data = static_cast<uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+        }
+        if (!m_data) {
+            if (error) *error = "Falha ao mapear o histórico (erro " + std::to_string(GetLastError()) + ")";
+            unmap();
+            return false;
+        }
+#else
+        void* data = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        if (data == MAP_FAILED) {
+            if (error) *error = std::string("Falha ao mapear o histórico: ") + std::strerror(errno);
+            return false;
+        }
+        m_data = static_cast<uint8_t*>(data);
+#endif
+        return true;
+    }
+
+    void unmap() {
+#ifdef _WIN32
+        if (m_data) {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping) {
+            CloseHandle(m_mapping);
+            m_mapping = nullptr;
+        }
+#else
+        if (m_data) {
+            munmap(m_data, m_size);
+        }
+#endif
+        m_data = nullptr;
+    }
+
+#ifdef _WIN32
+    HANDLE m_handle = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+    uint8_t* m_data = nullptr;
+    uint64_t m_size = 0;
+};
+
+namespace {
+
+// Inicializa um arquivo vazio com capacidade para `capacity` registros
+bool initializeFile(CallLog::MappedFile& file, uint64_t capacity, uint64_t nextId, std::string* error) {
+    if (!file.resize(kHeaderSize + capacity * kRecordSize, error)) {
+        return false;
+    }
+    auto* header = reinterpret_cast<CallLog::DiskHeader*>(file.data());
+    std::memset(header, 0, sizeof(*header));
+    std::memcpy(header->magic, kMagic, sizeof(kMagic));
+    header->version = kVersion;
+    header->recordSize = static_cast<uint32_t>(kRecordSize);
+    header->nextId = nextId;
+    return true;
+}
+
+uint64_t capacityOf(const CallLog::MappedFile& file) {
+    return file.size() < kHeaderSize ? 0 : (file.size() - kHeaderSize) / kRecordSize;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// CallLog
+// ---------------------------------------------------------------------------
+
+CallLog::CallLog() {
+}
+
+CallLog::~CallLog() {
+    close();
+}
+
+CallLog::DiskHeader* CallLog::header() const {
+    return reinterpret_cast<DiskHeader*>(m_file->data());
+}
+
+CallLog::DiskRecord* CallLog::recordAt(uint64_t position) const {
+    return reinterpret_cast<DiskRecord*>(m_file->data() + kHeaderSize + position * kRecordSize);
+}
+
+bool CallLog::open(const std::string& path, std::string* error) {
+    close();
+
+    auto file = std::make_unique<MappedFile>();
+    if (!file->open(path, error)) {
+        return false;
+    }
+
+    if (file->size() == 0) {
+        if (!initializeFile(*file, kInitialCapacity, 1, error)) {
+            return false;
+        }
+    } else {
+        auto* header = reinterpret_cast<DiskHeader*>(file->data());
+        if (file->size() < kHeaderSize || std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 ||
+            header->version != kVersion || header->recordSize != kRecordSize) {
+            if (error) *error = "Arquivo de histórico inválido: " + path;
+            return false;
+        }
+        // Defensivo: nunca ler além do arquivo
+        header->count = std::min(header->count, capacityOf(*file));
+    }
+
+    // Restos de uma compactação interrompida
+    std::error_code ec;
+    std::filesystem::remove(path + ".compact", ec);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_path = path;
+    m_file = std::move(file);
+    m_byNumber.clear();
+    for (uint64_t position = 0; position < header()->count; ++position) {
+        if (!(recordAt(position)->flags & kFlagDeleted)) {
+            indexRecord(position);
+        }
+    }
+    return true;
+}
+
+void CallLog::close() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_file) {
+            m_file->flush();
+            m_file.reset();
+        }
+        m_byNumber.clear();
+        m_generation++;     // Interrompe uma compactação em andamento
+    }
+
+    std::lock_guard<std::mutex> lock(m_threadMutex);
+    if (m_compactThread.joinable()) {
+        m_compactThread.join();
+    }
+}
+
+bool CallLog::isOpen() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_file != nullptr;
+}
+
+bool CallLog::reserve(uint64_t records) {
+    uint64_t capacity = capacityOf(*m_file);
+    if (records <= capacity) {
+        return true;
+    }
+    uint64_t grown = capacity + std::min(std::max(capacity, kInitialCapacity), kMaxGrowth);
+    return m_file->resize(kHeaderSize + std::max(grown, records) * kRecordSize, nullptr);
+}
+
+void CallLog::indexRecord(uint64_t position) {
+    m_byNumber[numberKey(recordNumber(*recordAt(position)))].push_back(static_cast<uint32_t>(position));
+}
+
+uint64_t CallLog::append(const CallRecord& record) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file) {
+        return 0;
+    }
+
+    uint64_t position = header()->count;
+    if (!reserve(position + 1)) {
+        return 0;
+    }
+
+    uint64_t id = header()->nextId++;
+    storeRecord(recordAt(position), record, id);
+    // O contador só avança depois do registro completo
+    header()->count = position + 1;
+    indexRecord(position);
+    return id;
+}
+
+uint64_t CallLog::findPosition(uint64_t id) const {
+    uint64_t low = 0;
+    uint64_t high = header()->count;
+    while (low < high) {
+        uint64_t middle = low + (high - low) / 2;
+        if (recordAt(middle)->id < id) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+bool CallLog::remove(uint64_t id) {
+    bool compactNow = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_file) {
+            return false;
+        }
+
+        uint64_t position = findPosition(id);
+        if (position >= header()->count) {
+            return false;
+        }
+        DiskRecord* record = recordAt(position);
+        if (record->id != id || (record->flags & kFlagDeleted)) {
+            return false;
+        }
+
+        record->flags |= kFlagDeleted;
+        header()->deleted++;
+        if (m_compacting) {
+            m_pendingDeletes.push_back(id);
+        } else if (header()->deleted >= kMinDeletedToCompact && header()->deleted * 4 >= header()->count) {
+            m_compacting = true;
+            compactNow = true;
+        }
+    }
+
+    if (compactNow) {
+        scheduleCompaction();
+    }
+    return true;
+}
+
+bool CallLog::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file) {
+        return false;
+    }
+
+    // Ids continuam crescendo (cursores antigos não reaparecem)
+    uint64_t nextId = header()->nextId;
+    m_generation++;
+    m_byNumber.clear();
+    return initializeFile(*m_file, kInitialCapacity, nextId, nullptr);
+}
+
+CallLogPage CallLog::query(const CallLogQuery& query) const {
+    CallLogPage page;
+    size_t limit = std::min(std::max<size_t>(query.limit, 1), kMaxPage);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file) {
+        return page;
+    }
+
+    uint64_t end = header()->count;
+    if (query.beforeId != 0) {
+        end = std::min(end, findPosition(query.beforeId));
+    }
+    if (query.untilMs != 0) {
+        // Registros em ordem de término: busca binária pelo primeiro >= untilMs
+        uint64_t low = 0;
+        uint64_t high = end;
+        while (low < high) {
+            uint64_t middle = low + (high - low) / 2;
+            if (recordAt(middle)->endTimeMs < query.untilMs) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        end = low;
+    }
+
+    // Retorna false quando a página terminou
+    auto visit = [&](uint64_t position) {
+        const DiskRecord* record = recordAt(position);
+        if (record->flags & kFlagDeleted) {
+            return true;
+        }
+        if (query.sinceMs != 0 && record->endTimeMs < query.sinceMs) {
+            return false;
+        }
+        page.records.push_back(loadRecord(*record));
+        if (page.records.size() == limit) {
+            page.nextCursor = position > 0 ? record->id : 0;
+            return false;
+        }
+        return true;
+    };
+
+    if (!query.number.empty()) {
+        auto it = m_byNumber.find(numberKey(query.number));
+        if (it == m_byNumber.end()) {
+            return page;
+        }
+        const std::vector<uint32_t>& positions = it->second;
+        auto from = std::lower_bound(positions.begin(), positions.end(), end);
+        while (from != positions.begin()) {
+            --from;
+            if (!visit(*from)) break;
+        }
+        return page;
+    }
+
+    for (uint64_t position = end; position > 0; --position) {
+        if (!visit(position - 1)) break;
+    }
+    return page;
+}
+
+CallLogStats CallLog::getStats() const {
+    CallLogStats stats;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    stats.compactions = m_compactions;
+    if (!m_file) {
+        return stats;
+    }
+    stats.records = header()->count - header()->deleted;
+    stats.deleted = header()->deleted;
+    stats.capacity = capacityOf(*m_file);
+    stats.fileBytes = m_file->size();
+    return stats;
+}
+
+bool CallLog::compact() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_file || m_compacting) {
+            return false;
+        }
+        m_compacting = true;
+    }
+    return runCompaction();
+}
+
+void CallLog::scheduleCompaction() {
+    std::lock_guard<std::mutex> lock(m_threadMutex);
+    if (m_compactThread.joinable()) {
+        m_compactThread.join();
+    }
+    m_compactThread = std::thread([this]() { runCompaction(); });
+}
+
+bool CallLog::runCompaction() {
+    std::string tempPath;
+    uint64_t generation = 0;
+    uint64_t snapshotCount = 0;
+    uint64_t liveAtStart = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_file) {
+            m_compacting = false;
+            return false;
+        }
+        tempPath = m_path + ".compact";
+        generation = m_generation;
+        snapshotCount = header()->count;
+        liveAtStart = snapshotCount - header()->deleted;
+        m_pendingDeletes.clear();
+    }
+
+    MappedFile out;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> index;
+    uint64_t written = 0;
+
+    auto abort = [&]() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_compacting = false;
+            m_pendingDeletes.clear();
+        }
+        out.close();
+        std::error_code ec;
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    };
+
+    if (!out.open(tempPath, nullptr) || !initializeFile(out, std::max(liveAtStart, kInitialCapacity), 0, nullptr)) {
+        return abort();
+    }
+
+    auto copy = [&](const DiskRecord* record) {
+        auto* target = reinterpret_cast<DiskRecord*>(out.data() + kHeaderSize + written * kRecordSize);
+        std::memcpy(target, record, kRecordSize);
+        index[numberKey(recordNumber(*record))].push_back(static_cast<uint32_t>(written));
+        written++;
+    };
+
+    // Cópia em trechos: inserções e consultas seguem entre um trecho e outro
+    bool interrupted = false;
+    for (uint64_t start = 0; start < snapshotCount && !interrupted; start += kCompactChunk) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_file || m_generation != generation) {
+            interrupted = true;
+            break;
+        }
+        uint64_t stop = std::min(start + kCompactChunk, snapshotCount);
+        for (uint64_t position = start; position < stop; ++position) {
+            const DiskRecord* record = recordAt(position);
+            if (!(record->flags & kFlagDeleted)) {
+                copy(record);
+            }
+        }
+    }
+    if (interrupted) {
+        return abort();
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_file || m_generation != generation) {
+        lock.unlock();
+        return abort();
+    }
+
+    // Registros acrescentados durante a cópia
+    uint64_t count = header()->count;
+    if (written + (count - snapshotCount) > capacityOf(out) &&
+        !out.resize(kHeaderSize + (written + count - snapshotCount) * kRecordSize, nullptr)) {
+        lock.unlock();
+        return abort();
+    }
+    for (uint64_t position = snapshotCount; position < count; ++position) {
+        const DiskRecord* record = recordAt(position);
+        if (!(record->flags & kFlagDeleted)) {
+            copy(record);
+        }
+    }
+
+    auto* outHeader = reinterpret_cast<DiskHeader*>(out.data());
+    outHeader->count = written;
+    outHeader->nextId = header()->nextId;
+
+    // Exclusões feitas durante a cópia (registros já copiados)
+    for (uint64_t id : m_pendingDeletes) {
+        uint64_t low = 0;
+        uint64_t high = written;
+        while (low < high) {
+            uint64_t middle = low + (high - low) / 2;
+            auto* record = reinterpret_cast<DiskRecord*>(out.data() + kHeaderSize + middle * kRecordSize);
+            if (record->id < id) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        if (low < written) {
+            auto* record = reinterpret_cast<DiskRecord*>(out.data() + kHeaderSize + low * kRecordSize);
+            if (record->id == id && !(record->flags & kFlagDeleted)) {
+                record->flags |= kFlagDeleted;
+                outHeader->deleted++;
+            }
+        }
+    }
+    m_pendingDeletes.clear();
+
+    out.flush();
+    out.close();
+    m_file->close();
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, m_path, ec);
+    if (ec) {
+        // Mantém o arquivo original (as exclusões já estão marcadas nele)
+        std::error_code ignored;
+        std::filesystem::remove(tempPath, ignored);
+    }
+    bool reopened = m_file->open(m_path, nullptr) && m_file->size() >= kHeaderSize;
+    if (!reopened) {
+        // Sem arquivo utilizável: o histórico fica fechado
+        m_file.reset();
+        m_byNumber.clear();
+    } else if (!ec) {
+        m_byNumber = std::move(index);
+        m_compactions++;
+    }
+    m_compacting = false;
+    return reopened && !ec;
+}
+
+} // namespace echo
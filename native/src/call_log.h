@@ -0,0 +1,204 @@
+/**
+ * @file call_log.h
+ * @brief Histórico de chamadas em arquivo mapeado em memória
+ *
+ * Este arquivo define o CallLog, um log somente de acréscimo com registros
+ * de tamanho fixo:
+ *
+ *   [cabeçalho 64 bytes][registro 0][registro 1]...
+ *
+ * Inserir custa uma cópia para a região mapeada (o arquivo cresce em
+ * blocos, sem reescrever o que já foi gravado). Os registros ficam em ordem
+ * de término da chamada com ids crescentes, o que permite paginar por id e
+ * localizar períodos por busca binária. Um índice em memória por número
+ * normalizado é montado na abertura.
+ *
+ * Exclusões apenas marcam o registro; uma compactação em segundo plano
+ * reescreve o arquivo sem os excluídos quando eles passam de 25%.
+ */
+
+#ifndef CALL_LOG_H
+#define CALL_LOG_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace echo {
+
+/**
+ * @brief Direção gravada no histórico
+ */
+enum class CallLogDirection : uint8_t {
+    Outgoing = 1,
+    Incoming = 2
+};
+
+/**
+ * @brief Resultado gravado no histórico (mesmos valores do renderer)
+ */
+enum class CallLogStatus : uint8_t {
+    Answered = 1,   // Entrante atendida
+    Completed = 2,  // Saindo atendida
+    Missed = 3,     // Entrante não atendida
+    Rejected = 4,   // Entrante recusada localmente
+    Failed = 5      // Saindo não atendida
+};
+
+/**
+ * @brief Transferência feita a partir da chamada
+ */
+enum class CallTransfer : uint8_t {
+    None = 0,
+    Blind = 1,
+    Attended = 2
+};
+
+/**
+ * @brief Registro de chamada (horários em ms desde a época Unix, 0 = não ocorreu)
+ */
+struct CallRecord {
+    uint64_t id = 0;                // Atribuído em append
+    int64_t startTimeMs = 0;
+    int64_t ringTimeMs = 0;         // 180/183 recebido (saindo) ou enviado (entrante)
+    int64_t answerTimeMs = 0;
+    int64_t endTimeMs = 0;
+    int sipStatus = 0;              // last_status da chamada
+    CallLogDirection direction = CallLogDirection::Outgoing;
+    CallLogStatus status = CallLogStatus::Failed;
+    std::string number;             // Até 63 bytes
+    std::string displayName;        // Até 95 bytes
+    std::string codec;              // Codec de áudio negociado, até 8 bytes ("opus", "PCMA")
+    std::string account;            // usuario@dominio da conta, até 31 bytes
+    CallTransfer transfer = CallTransfer::None;
+    int transferStatus = 0;         // Código final do NOTIFY da transferência (0 = sem resposta)
+};
+
+/**
+ * @brief Nomes usados no renderer ("answered", "blind", ...)
+ */
+const char* callLogStatusName(CallLogStatus status);
+const char* callTransferName(CallTransfer transfer);
+
+/**
+ * @brief Consulta paginada (mais recentes primeiro)
+ */
+struct CallLogQuery {
+    uint64_t beforeId = 0;          // Cursor: registros com id menor (0 = do fim)
+    size_t limit = 50;              // Máximo de registros (limitado a 1000)
+    std::string number;             // Filtra pelo número normalizado (vazio = todos)
+    int64_t sinceMs = 0;            // Término a partir de (0 = sem limite)
+    int64_t untilMs = 0;            // Término antes de (0 = sem limite)
+};
+
+/**
+ * @brief Página de resultados
+ */
+struct CallLogPage {
+    std::vector<CallRecord> records;
+    uint64_t nextCursor = 0;        // beforeId da próxima página (0 = fim)
+};
+
+/**
+ * @brief Estatísticas do arquivo
+ */
+struct CallLogStats {
+    uint64_t records = 0;           // Registros válidos
+    uint64_t deleted = 0;           // Marcados como excluídos (aguardando compactação)
+    uint64_t capacity = 0;          // Registros que cabem no arquivo atual
+    uint64_t fileBytes = 0;
+    uint64_t compactions = 0;
+};
+
+/**
+ * @brief Histórico de chamadas persistente (thread-safe)
+ */
+class CallLog {
+public:
+    CallLog();
+    ~CallLog();
+
+    /**
+     * @brief Abre (ou cria) o arquivo do histórico
+     * @param error Recebe a descrição da falha
+     */
+    bool open(const std::string& path, std::string* error);
+
+    /**
+     * @brief Fecha o arquivo (aguarda uma compactação em andamento)
+     */
+    void close();
+
+    bool isOpen() const;
+
+    /**
+     * @brief Acrescenta um registro
+     * @return Id atribuído (0 se o histórico não está aberto)
+     */
+    uint64_t append(const CallRecord& record);
+
+    /**
+     * @brief Marca um registro como excluído
+     */
+    bool remove(uint64_t id);
+
+    /**
+     * @brief Remove todos os registros
+     */
+    bool clear();
+
+    /**
+     * @brief Consulta paginada
+     */
+    CallLogPage query(const CallLogQuery& query) const;
+
+    /**
+     * @brief Estatísticas atuais
+     */
+    CallLogStats getStats() const;
+
+    /**
+     * @brief Compacta imediatamente (no thread chamador)
+     */
+    bool compact();
+
+    // Formato em disco e mapeamento (definidos em call_log.cpp)
+    class MappedFile;
+    struct DiskHeader;
+    struct DiskRecord;
+
+private:
+    CallLog(const CallLog&) = delete;
+    CallLog& operator=(const CallLog&) = delete;
+
+    DiskHeader* header() const;
+    DiskRecord* recordAt(uint64_t position) const;
+    bool reserve(uint64_t records);
+    uint64_t findPosition(uint64_t id) const;
+    void indexRecord(uint64_t position);
+    void scheduleCompaction();
+    bool runCompaction();
+
+    std::string m_path;
+    std::unique_ptr<MappedFile> m_file;
+    mutable std::mutex m_mutex;
+
+    // Número normalizado -> posições (crescentes) no arquivo
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_byNumber;
+
+    // Compactação em segundo plano
+    std::thread m_compactThread;
+    std::mutex m_threadMutex;       // Protege m_compactThread
+    bool m_compacting = false;
+    uint64_t m_generation = 0;      // Incrementado por clear()
+    std::vector<uint64_t> m_pendingDeletes;
+    uint64_t m_compactions = 0;
+};
+
+} // namespace echo
+
+#endif // CALL_LOG_H
@@ -0,0 +1,188 @@
+/**
+ * @file call_timing.cpp
+ * @brief Implementação da medição de latência de chamadas
+ */
+
+#include "call_timing.h"
+#include <chrono>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace echo {
+
+namespace {
+
+// Posição do bit mais significativo (v > 0)
+inline int highestBit(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(v);
+#endif
+}
+
+inline double diffMs(int64_t from, int64_t to) {
+    if (from == 0 || to == 0 || to < from) {
+        return -1.0;
+    }
+    return static_cast<double>(to - from) / 1000.0;
+}
+
+} // anonymous namespace
+
+int64_t monotonicMicros() {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t wallClockMillis() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+// CallTimings
+
+double CallTimings::postDialDelayMs() const {
+    return diffMs(dialStart, firstProvisional);
+}
+
+double CallTimings::setupTimeMs() const {
+    int64_t start = dialStart != 0 ? dialStart : inviteReceived;
+    return diffMs(start, confirmed);
+}
+
+double CallTimings::answerToMediaMs() const {
+    int64_t start = answerRequested != 0 ? answerRequested : confirmed;
+    return diffMs(start, mediaActive);
+}
+
+double CallTimings::alertingDelayMs() const {
+    return diffMs(inviteReceived, ringingSent);
+}
+
+// LatencyHistogram
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+int LatencyHistogram::bucketIndex(uint64_t micros) {
+    if (micros < static_cast<uint64_t>(kSubBuckets)) {
+        return static_cast<int>(micros);
+    }
+    int exponent = highestBit(micros);
+    int sub = static_cast<int>((micros >> (exponent - kSubBucketBits)) & (kSubBuckets - 1));
+    return (exponent - kSubBucketBits + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(int index) {
+    if (index < kSubBuckets) {
+        return static_cast<uint64_t>(index);
+    }
+    int exponent = index / kSubBuckets + kSubBucketBits - 1;
+    uint64_t sub = static_cast<uint64_t>(index % kSubBuckets);
+    return (static_cast<uint64_t>(kSubBuckets) + sub) << (exponent - kSubBucketBits);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index < kSubBuckets) {
+        return static_cast<uint64_t>(index);
+    }
+    int exponent = index / kSubBuckets + kSubBucketBits - 1;
+    uint64_t sub = static_cast<uint64_t>(index % kSubBuckets);
+    int shift = exponent - kSubBucketBits;
+    uint64_t lower = (static_cast<uint64_t>(kSubBuckets) + sub) << shift;
+    return lower + ((uint64_t(1) << shift) - 1);
+}
+
+void LatencyHistogram::record(int64_t micros) {
+    if (micros < 0) {
+        return;
+    }
+    uint64_t v = static_cast<uint64_t>(micros);
+
+    m_buckets[bucketIndex(v)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(v, std::memory_order_relaxed);
+
+    uint64_t current = m_min.load(std::memory_order_relaxed);
+    while (v < current && !m_min.compare_exchange_weak(current, v, std::memory_order_relaxed)) {}
+
+    current = m_max.load(std::memory_order_relaxed);
+    while (v > current && !m_max.compare_exchange_weak(current, v, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_min.store(UINT64_MAX, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const {
+    return m_count.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::sumMicros() const {
+    return m_sum.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::cumulativeCount(uint64_t micros) const {
+    uint64_t total = 0;
+    for (int i = 0; i < kBucketCount; i++) {
+        if (bucketLowerBound(i) > micros) {
+            break;
+        }
+        total += m_buckets[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+int64_t LatencyHistogram::percentile(double p) const {
+    uint64_t total = m_count.load(std::memory_order_relaxed);
+    if (total == 0) {
+        return 0;
+    }
+
+    if (p < 0.0) p = 0.0;
+    if (p > 100.0) p = 100.0;
+
+    uint64_t target = static_cast<uint64_t>(p / 100.0 * static_cast<double>(total) + 0.5);
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    uint64_t maxValue = m_max.load(std::memory_order_relaxed);
+    for (int i = 0; i < kBucketCount; i++) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            uint64_t bound = bucketUpperBound(i);
+            return static_cast<int64_t>(bound < maxValue ? bound : maxValue);
+        }
+    }
+    return static_cast<int64_t>(maxValue);
+}
+
+LatencyHistogram::Summary LatencyHistogram::summary() const {
+    Summary s;
+    s.count = m_count.load(std::memory_order_relaxed);
+    if (s.count == 0) {
+        return s;
+    }
+
+    s.minMs = static_cast<double>(m_min.load(std::memory_order_relaxed)) / 1000.0;
+    s.maxMs = static_cast<double>(m_max.load(std::memory_order_relaxed)) / 1000.0;
+    s.meanMs = static_cast<double>(m_sum.load(std::memory_order_relaxed)) / static_cast<double>(s.count) / 1000.0;
+    s.p50Ms = static_cast<double>(percentile(50.0)) / 1000.0;
+    s.p90Ms = static_cast<double>(percentile(90.0)) / 1000.0;
+    s.p99Ms = static_cast<double>(percentile(99.0)) / 1000.0;
+    return s;
+}
+
+} // namespace echo
@@ -0,0 +1,192 @@
+/**
+ * @file call_timing.h
+ * @brief Medição de latência de estabelecimento de chamadas
+ *
+ * Este arquivo define as marcas temporais capturadas ao longo do ciclo de
+ * vida de uma chamada (post-dial delay, tempo até mídia, etc.) e um
+ * histograma de latência lock-free para agregá-las.
+ */
+
+#ifndef CALL_TIMING_H
+#define CALL_TIMING_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace echo {
+
+/**
+ * @brief Relógio monotônico de alta resolução
+ * @return Microssegundos desde uma origem arbitrária (fixa no processo)
+ */
+int64_t monotonicMicros();
+
+/**
+ * @brief Relógio de parede (horários gravados no histórico)
+ * @return Milissegundos desde a época Unix
+ */
+int64_t wallClockMillis();
+
+/**
+ * @brief Marcas temporais de uma chamada (microssegundos monotônicos, 0 = não ocorreu)
+ */
+struct CallTimings {
+    // Chamada saindo
+    int64_t dialStart = 0;          // Entrada em makeCall
+    int64_t inviteSent = 0;         // INVITE enviado (pjsua_call_make_call retornou)
+    int64_t firstProvisional = 0;   // Primeira resposta provisória (18x, estado EARLY)
+
+    // Chamada entrante
+    int64_t inviteReceived = 0;     // Entrada em onIncomingCall
+    int64_t ringingSent = 0;        // 180 Ringing enviado
+    int64_t answerRequested = 0;    // Entrada em answerCall
+
+    // Comum
+    int64_t confirmed = 0;          // onCallState CONFIRMED
+    int64_t mediaActive = 0;        // onCallMediaState ativo
+
+    /**
+     * @brief Post-dial delay: makeCall até a primeira resposta provisória
+     * @return Milissegundos ou -1 se indisponível
+     */
+    double postDialDelayMs() const;
+
+    /**
+     * @brief Tempo total de estabelecimento: makeCall/INVITE recebido até CONFIRMED
+     * @return Milissegundos ou -1 se indisponível
+     */
+    double setupTimeMs() const;
+
+    /**
+     * @brief Tempo entre o atendimento e a mídia ativa
+     *
+     * Para chamadas saindo parte do CONFIRMED; para entrantes, do answerCall.
+     * @return Milissegundos ou -1 se indisponível
+     */
+    double answerToMediaMs() const;
+
+    /**
+     * @brief Tempo entre receber o INVITE e enviar o 180 Ringing
+     * @return Milissegundos ou -1 se indisponível
+     */
+    double alertingDelayMs() const;
+};
+
+/**
+ * @brief Histograma de latência log-linear (estilo HDR), lock-free
+ *
+ * Cada potência de dois é dividida em 8 sub-buckets, o que garante erro
+ * relativo máximo de 12,5%. Valores são registrados em microssegundos.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 3;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kBucketCount = 64 * kSubBuckets;
+
+    /**
+     * @brief Resumo do histograma (em milissegundos)
+     */
+    struct Summary {
+        uint64_t count = 0;
+        double minMs = 0;
+        double maxMs = 0;
+        double meanMs = 0;
+        double p50Ms = 0;
+        double p90Ms = 0;
+        double p99Ms = 0;
+    };
+
+    LatencyHistogram();
+
+    // Impede cópia
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * @brief Registra uma amostra
+     * @param micros Valor em microssegundos (negativos são ignorados)
+     */
+    void record(int64_t micros);
+
+    /**
+     * @brief Zera todas as contagens
+     */
+    void reset();
+
+    /**
+     * @brief Calcula o resumo atual
+     */
+    Summary summary() const;
+
+    /**
+     * @brief Número total de amostras
+     */
+    uint64_t count() const;
+
+    /**
+     * @brief Soma de todas as amostras em microssegundos
+     */
+    uint64_t sumMicros() const;
+
+    /**
+     * @brief Contagem cumulativa até micros (bucket "le" do OpenMetrics)
+     *
+     * Soma os buckets com limite inferior <= micros: o bucket que contém
+     * micros entra inteiro, então nenhuma amostra <= micros fica de fora.
+     */
+    uint64_t cumulativeCount(uint64_t micros) const;
+
+    /**
+     * @brief Percentil aproximado
+     * @param p Percentil entre 0 e 100
+     * @return Valor em microssegundos
+     */
+    int64_t percentile(double p) const;
+
+    /**
+     * @brief Índice do bucket para um valor
+     */
+    static int bucketIndex(uint64_t micros);
+
+    /**
+     * @brief Limite inferior (inclusivo) de um bucket em microssegundos
+     */
+    static uint64_t bucketLowerBound(int index);
+
+    /**
+     * @brief Limite superior (inclusivo) de um bucket em microssegundos
+     */
+    static uint64_t bucketUpperBound(int index);
+
+private:
+    std::atomic<uint64_t> m_buckets[kBucketCount];
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_min{UINT64_MAX};
+    std::atomic<uint64_t> m_max{0};
+};
+
+/**
+ * @brief Histogramas agregados de estabelecimento de chamada
+ */
+struct CallTimingHistograms {
+    LatencyHistogram postDialDelay;
+    LatencyHistogram setupTime;
+    LatencyHistogram answerToMedia;
+    LatencyHistogram alertingDelay;
+};
+
+/**
+ * @brief Resumo dos histogramas de estabelecimento de chamada
+ */
+struct CallTimingStats {
+    LatencyHistogram::Summary postDialDelay;
+    LatencyHistogram::Summary setupTime;
+    LatencyHistogram::Summary answerToMedia;
+    LatencyHistogram::Summary alertingDelay;
+};
+
+} // namespace echo
+
+#endif // CALL_TIMING_H
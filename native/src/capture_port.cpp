@@ -0,0 +1,142 @@
+/**
+ * @file capture_port.cpp
+ * @brief Implementação da porta de processamento da captura
+ */
+
+#include "capture_port.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace echo {
+
+CapturePort::CapturePort(unsigned clockRate, unsigned samplesPerFrame, LatencyHistogram* frameTime)
+    : m_processor(clockRate, samplesPerFrame, frameTime),
+      m_vad(clockRate, samplesPerFrame),
+      m_frame(samplesPerFrame, 0) {
+    std::memset(&m_port, 0, sizeof(m_port));
+    std::memset(&m_gatedPort, 0, sizeof(m_gatedPort));
+}
+
+CapturePort::~CapturePort() {
+    detach();
+    if (m_pool) {
+        pj_pool_release(m_pool);
+    }
+}
+
+std::unique_ptr<CapturePort> CapturePort::create(LatencyHistogram* frameTime,
+                                                 CaptureProcessor::DowngradeCallback onDowngrade) {
+    // Mesma taxa e quadro do microfone: a ponte não precisa reamostrar
+    pjsua_conf_port_info info;
+    if (pjsua_conf_get_port_info(0, &info) != PJ_SUCCESS || info.channel_count != 1) {
+        return nullptr;
+    }
+
+    std::unique_ptr<CapturePort> port(new CapturePort(info.clock_rate, info.samples_per_frame, frameTime));
+    port->m_processor.setDowngradeCallback(std::move(onDowngrade));
+
+    pj_str_t name = pj_str(const_cast<char*>("echo-capture"));
+    pjmedia_port_info_init(&port->m_port.info, &name, PJMEDIA_SIG_CLASS_APP('C', 'A', 'P'),
+                           info.clock_rate, 1, 16, info.samples_per_frame);
+    port->m_port.port_data.pdata = port.get();
+    port->m_port.put_frame = &CapturePort::putFrame;
+    port->m_port.get_frame = &CapturePort::getFrame;
+
+    pj_str_t gatedName = pj_str(const_cast<char*>("echo-capture-vad"));
+    pjmedia_port_info_init(&port->m_gatedPort.info, &gatedName, PJMEDIA_SIG_CLASS_APP('C', 'A', 'V'),
+                           info.clock_rate, 1, 16, info.samples_per_frame);
+    port->m_gatedPort.port_data.pdata = port.get();
+    port->m_gatedPort.put_frame = &CapturePort::putGatedFrame;
+    port->m_gatedPort.get_frame = &CapturePort::getGatedFrame;
+
+    port->m_pool = pjsua_pool_create("echo-capture", 1024, 1024);
+    if (!port->m_pool) {
+        return nullptr;
+    }
+    if (pjsua_conf_add_port(port->m_pool, &port->m_port, &port->m_slot) != PJ_SUCCESS) {
+        port->m_slot = PJSUA_INVALID_ID;
+        return nullptr;
+    }
+    if (pjsua_conf_add_port(port->m_pool, &port->m_gatedPort, &port->m_gatedSlot) != PJ_SUCCESS) {
+        port->m_gatedSlot = PJSUA_INVALID_ID;
+        return nullptr;
+    }
+    return port;
+}
+
+void CapturePort::detach() {
+    if (m_gatedSlot != PJSUA_INVALID_ID) {
+        pjsua_conf_remove_port(m_gatedSlot);
+        m_gatedSlot = PJSUA_INVALID_ID;
+    }
+    if (m_slot != PJSUA_INVALID_ID) {
+        pjsua_conf_remove_port(m_slot);
+        m_slot = PJSUA_INVALID_ID;
+    }
+}
+
+pj_status_t CapturePort::putFrame(pjmedia_port* port, pjmedia_frame* frame) {
+    auto* self = static_cast<CapturePort*>(port->port_data.pdata);
+    if (frame->type != PJMEDIA_FRAME_TYPE_AUDIO || frame->size == 0) {
+        self->m_hasFrame = false;
+        return PJ_SUCCESS;
+    }
+
+    size_t count = std::min(frame->size / sizeof(int16_t), self->m_frame.size());
+    std::memcpy(self->m_frame.data(), frame->buf, count * sizeof(int16_t));
+    std::fill(self->m_frame.begin() + count, self->m_frame.end(), int16_t(0));
+    self->m_processor.process(self->m_frame.data(), count);
+
+    // VAD depois do processamento: a supressão de ruído melhora a decisão
+    self->m_voice = self->m_vad.process(self->m_frame.data(), count);
+    self->m_hasFrame = true;
+    self->m_sequence++;
+    return PJ_SUCCESS;
+}
+
+pj_status_t CapturePort::getFrame(pjmedia_port* port, pjmedia_frame* frame) {
+    auto* self = static_cast<CapturePort*>(port->port_data.pdata);
+    self->deliver(frame, &self->m_mainDelivered);
+    return PJ_SUCCESS;
+}
+
+pj_status_t CapturePort::putGatedFrame(pjmedia_port* port, pjmedia_frame* frame) {
+    (void)port;
+    (void)frame;
+    // A saída com VAD só transmite; o quadro chega pela porta principal
+    return PJ_SUCCESS;
+}
+
+pj_status_t CapturePort::getGatedFrame(pjmedia_port* port, pjmedia_frame* frame) {
+    auto* self = static_cast<CapturePort*>(port->port_data.pdata);
+    if (self->m_hasFrame && self->m_gatedDelivered != self->m_sequence && !self->m_voice) {
+        // Silêncio: nada para a ponte, o stream não envia RTP neste ciclo
+        self->m_gatedDelivered = self->m_sequence;
+        self->m_suppressedFrames.fetch_add(1, std::memory_order_relaxed);
+        frame->type = PJMEDIA_FRAME_TYPE_NONE;
+        frame->size = 0;
+        return PJ_SUCCESS;
+    }
+    if (self->deliver(frame, &self->m_gatedDelivered)) {
+        self->m_gatedFrames.fetch_add(1, std::memory_order_relaxed);
+    }
+    return PJ_SUCCESS;
+}
+
+bool CapturePort::deliver(pjmedia_frame* frame, uint64_t* delivered) {
+    size_t bytes = m_frame.size() * sizeof(int16_t);
+    if (!m_hasFrame || *delivered == m_sequence || frame->size < bytes) {
+        frame->type = PJMEDIA_FRAME_TYPE_NONE;
+        frame->size = 0;
+        return false;
+    }
+
+    std::memcpy(frame->buf, m_frame.data(), bytes);
+    frame->type = PJMEDIA_FRAME_TYPE_AUDIO;
+    frame->size = bytes;
+    *delivered = m_sequence;
+    return true;
+}
+
+} // namespace echo
@@ -0,0 +1,108 @@
+/**
+ * @file capture_port.h
+ * @brief Porta de conferência que aplica o CaptureProcessor ao microfone
+ *
+ * Este arquivo define a CapturePort, inserida na ponte entre o
+ * microfone (slot 0) e as chamadas: slot 0 → CapturePort → chamadas.
+ * A ponte entrega o quadro capturado em put_frame (processado ali mesmo,
+ * no thread de mídia) e o busca em get_frame no ciclo seguinte, o que
+ * acrescenta um quadro de atraso à captura.
+ *
+ * O mesmo quadro sai por duas portas: a principal e a saída com VAD,
+ * que não entrega quadros de silêncio (o stream da chamada deixa de
+ * enviar RTP). Cada chamada é ligada a uma ou outra conforme o codec.
+ */
+
+#ifndef CAPTURE_PORT_H
+#define CAPTURE_PORT_H
+
+#include <memory>
+#include <vector>
+
+#include "capture_processor.h"
+#include "voice_activity.h"
+
+extern "C" {
+#include <pjsua-lib/pjsua.h>
+}
+
+namespace echo {
+
+class CapturePort {
+public:
+    /**
+     * @brief Cria a porta na taxa e quadro do slot 0 e a adiciona à ponte
+     * @param frameTime Histograma do tempo de processamento (opcional)
+     * @return nullptr se a ponte recusou a porta
+     */
+    static std::unique_ptr<CapturePort> create(LatencyHistogram* frameTime,
+                                               CaptureProcessor::DowngradeCallback onDowngrade);
+
+    ~CapturePort();
+
+    /**
+     * @brief Remove a porta da conferência (desfaz todas as conexões)
+     */
+    void detach();
+
+    /**
+     * @brief Esquece o pool após pjsua_destroy (liberado junto com a biblioteca)
+     */
+    void abandonPool() { m_pool = nullptr; }
+
+    pjsua_conf_port_id slot() const { return m_slot; }
+    pjsua_conf_port_id gatedSlot() const { return m_gatedSlot; }
+    CaptureProcessor& processor() { return m_processor; }
+    const CaptureProcessor& processor() const { return m_processor; }
+
+    /**
+     * @brief Define hangover e limiar do VAD (qualquer thread)
+     */
+    void configureVad(unsigned hangoverMs, unsigned thresholdDb) { m_vad.configure(hangoverMs, thresholdDb); }
+
+    /**
+     * @brief Quadros de silêncio retidos pela saída com VAD desde a criação
+     */
+    uint64_t suppressedFrames() const { return m_suppressedFrames.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Quadros entregues pela saída com VAD desde a criação
+     */
+    uint64_t gatedFrames() const { return m_gatedFrames.load(std::memory_order_relaxed); }
+
+private:
+    CapturePort(unsigned clockRate, unsigned samplesPerFrame, LatencyHistogram* frameTime);
+    CapturePort(const CapturePort&) = delete;
+    CapturePort& operator=(const CapturePort&) = delete;
+
+    static pj_status_t putFrame(pjmedia_port* port, pjmedia_frame* frame);
+    static pj_status_t getFrame(pjmedia_port* port, pjmedia_frame* frame);
+    static pj_status_t putGatedFrame(pjmedia_port* port, pjmedia_frame* frame);
+    static pj_status_t getGatedFrame(pjmedia_port* port, pjmedia_frame* frame);
+
+    bool deliver(pjmedia_frame* frame, uint64_t* delivered);
+
+    pjmedia_port m_port;
+    pjmedia_port m_gatedPort;
+    pj_pool_t* m_pool = nullptr;    // Recursos da ponte para as duas portas
+    pjsua_conf_port_id m_slot = PJSUA_INVALID_ID;
+    pjsua_conf_port_id m_gatedSlot = PJSUA_INVALID_ID;
+    CaptureProcessor m_processor;
+    VoiceActivityDetector m_vad;
+
+    // Último quadro processado; put_frame e get_frame rodam no mesmo thread da
+    // ponte. Cada saída entrega cada quadro (m_sequence) uma única vez
+    std::vector<int16_t> m_frame;
+    bool m_hasFrame = false;
+    bool m_voice = false;
+    uint64_t m_sequence = 0;
+    uint64_t m_mainDelivered = 0;
+    uint64_t m_gatedDelivered = 0;
+
+    std::atomic<uint64_t> m_gatedFrames{0};
+    std::atomic<uint64_t> m_suppressedFrames{0};
+};
+
+} // namespace echo
+
+#endif // CAPTURE_PORT_H
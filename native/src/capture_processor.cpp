@@ -0,0 +1,198 @@
+/**
+ * @file capture_processor.cpp
+ * @brief Implementação do processamento do áudio capturado
+ */
+
+#include "capture_processor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <speex/speex_preprocess.h>
+
+namespace echo {
+
+namespace {
+
+constexpr uint8_t kHighPassBit = 1 << 0;
+constexpr uint8_t kNoiseSuppressionBit = 1 << 1;
+constexpr uint8_t kAgcBit = 1 << 2;
+constexpr uint8_t kSpeexBits = kNoiseSuppressionBit | kAgcBit;
+
+// Ordem de rebaixamento: do estágio mais caro para o mais barato
+constexpr uint8_t kDowngradeOrder[] = {kNoiseSuppressionBit, kAgcBit, kHighPassBit};
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kHighPassHz = 100.0;
+constexpr double kButterworthQ = 0.70710678118654752;
+
+constexpr int kNoiseSuppressDb = -25;   // Atenuação máxima do ruído
+constexpr float kAgcLevel = 24000.0f;   // Nível alvo (~-3 dBFS de pico)
+constexpr int kAgcMaxGainDb = 20;
+
+} // namespace
+
+CaptureProcessor::CaptureProcessor(unsigned clockRate, unsigned samplesPerFrame, LatencyHistogram* frameTime)
+    : m_clockRate(std::clamp(clockRate, 8000u, 48000u)),
+      m_samplesPerFrame(samplesPerFrame),
+      m_frameMicros(static_cast<unsigned>(uint64_t(samplesPerFrame) * 1000000 / m_clockRate)),
+      m_frameTime(frameTime),
+      m_requested(pack(CaptureStages{})),
+      m_active(pack(CaptureStages{})),
+      m_budgetMicros(m_frameMicros * kCaptureDefaultBudgetPercent / 100) {
+    // Passa-altas (RBJ cookbook)
+    double omega = 2.0 * kPi * kHighPassHz / m_clockRate;
+    double cosw = std::cos(omega);
+    double alpha = std::sin(omega) / (2.0 * kButterworthQ);
+    double a0 = 1.0 + alpha;
+    m_b0 = static_cast<float>((1.0 + cosw) / 2.0 / a0);
+    m_b1 = static_cast<float>(-(1.0 + cosw) / a0);
+    m_b2 = m_b0;
+    m_a1 = static_cast<float>(-2.0 * cosw / a0);
+    m_a2 = static_cast<float>((1.0 - alpha) / a0);
+
+    m_speex = speex_preprocess_state_init(static_cast<int>(m_samplesPerFrame), static_cast<int>(m_clockRate));
+    if (m_speex) {
+        int off = 0;
+        int suppress = kNoiseSuppressDb;
+        float level = kAgcLevel;
+        int maxGain = kAgcMaxGainDb;
+        speex_preprocess_ctl(m_speex, SPEEX_PREPROCESS_SET_VAD, &off);
+        speex_preprocess_ctl(m_speex, SPEEX_PREPROCESS_SET_DEREVERB, &off);
+        speex_preprocess_ctl(m_speex, SPEEX_PREPROCESS_SET_NOISE_SUPPRESS, &suppress);
+        speex_preprocess_ctl(m_speex, SPEEX_PREPROCESS_SET_AGC_LEVEL, &level);
+        speex_preprocess_ctl(m_speex, SPEEX_PREPROCESS_SET_AGC_MAX_GAIN, &maxGain);
+        applySpeexStages(m_active.load(std::memory_order_relaxed));
+    }
+}
+
+CaptureProcessor::~CaptureProcessor() {
+    if (m_speex) {
+        speex_preprocess_state_destroy(m_speex);
+    }
+}
+
+uint8_t CaptureProcessor::pack(const CaptureStages& stages) {
+    return static_cast<uint8_t>((stages.highPass ? kHighPassBit : 0) |
+                                (stages.noiseSuppression ? kNoiseSuppressionBit : 0) |
+                                (stages.agc ? kAgcBit : 0));
+}
+
+CaptureStages CaptureProcessor::unpack(uint8_t bits) {
+    CaptureStages stages;
+    stages.highPass = (bits & kHighPassBit) != 0;
+    stages.noiseSuppression = (bits & kNoiseSuppressionBit) != 0;
+    stages.agc = (bits & kAgcBit) != 0;
+    return stages;
+}
+
+void CaptureProcessor::setStages(const CaptureStages& stages) {
+    uint8_t bits = pack(stages);
+    m_requested.store(bits, std::memory_order_relaxed);
+    m_active.store(bits, std::memory_order_relaxed);
+}
+
+void CaptureProcessor::setBudgetPercent(unsigned percent) {
+    percent = std::clamp(percent, kCaptureMinBudgetPercent, kCaptureMaxBudgetPercent);
+    m_budgetMicros.store(m_frameMicros * percent / 100, std::memory_order_relaxed);
+}
+
+void CaptureProcessor::process(int16_t* samples, size_t count) {
+    uint8_t bits = m_active.load(std::memory_order_relaxed);
+    if (bits == 0 || count == 0) {
+        return;
+    }
+
+    int64_t start = monotonicMicros();
+
+    if (bits & kHighPassBit) {
+        highPass(samples, count);
+    }
+
+    // O Speex só é reconfigurado aqui, no thread de mídia que o executa
+    if (m_speex && count == m_samplesPerFrame) {
+        if ((bits & kSpeexBits) != m_speexBits) {
+            applySpeexStages(bits);
+        }
+        if (m_speexBits != 0) {
+            speex_preprocess_run(m_speex, reinterpret_cast<spx_int16_t*>(samples));
+        }
+    }
+
+    int64_t elapsed = monotonicMicros() - start;
+    m_frames.fetch_add(1, std::memory_order_relaxed);
+    m_lastFrameMicros.store(elapsed, std::memory_order_relaxed);
+    if (m_frameTime) {
+        m_frameTime->record(elapsed);
+    }
+    checkBudget(bits, elapsed);
+}
+
+void CaptureProcessor::highPass(int16_t* samples, size_t count) {
+    float x1 = m_x1, x2 = m_x2, y1 = m_y1, y2 = m_y2;
+    for (size_t i = 0; i < count; ++i) {
+        float x0 = static_cast<float>(samples[i]);
+        float y0 = m_b0 * x0 + m_b1 * x1 + m_b2 * x2 - m_a1 * y1 - m_a2 * y2;
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = y0;
+        samples[i] = static_cast<int16_t>(std::clamp(std::lround(y0), -32768L, 32767L));
+    }
+
+    // Evita denormais no silêncio prolongado
+    if (std::fabs(y1) < 1e-6f) y1 = 0.0f;
+    if (std::fabs(y2) < 1e-6f) y2 = 0.0f;
+    m_x1 = x1;
+    m_x2 = x2;
+    m_y1 = y1;
+    m_y2 = y2;
+}
+
+void CaptureProcessor::applySpeexStages(uint8_t bits) {
+    int denoise = (bits & kNoiseSuppressionBit) ? 1 : 0;
+    int agc = (bits & kAgcBit) ? 1 : 0;
+    speex_preprocess_ctl(m_speex, SPEEX_PREPROCESS_SET_DENOISE, &denoise);
+    speex_preprocess_ctl(m_speex, SPEEX_PREPROCESS_SET_AGC, &agc);
+    m_speexBits = bits & kSpeexBits;
+}
+
+void CaptureProcessor::checkBudget(uint8_t bits, int64_t elapsed) {
+    if (elapsed <= static_cast<int64_t>(m_budgetMicros.load(std::memory_order_relaxed))) {
+        m_overrunStreak = 0;
+        return;
+    }
+
+    m_overruns.fetch_add(1, std::memory_order_relaxed);
+    if (++m_overrunStreak < kCaptureOverrunFrames) {
+        return;
+    }
+    m_overrunStreak = 0;
+
+    for (uint8_t stage : kDowngradeOrder) {
+        if (!(bits & stage)) {
+            continue;
+        }
+        // setStages concorrente vence: só rebaixa se nada mudou desde a leitura
+        uint8_t downgraded = static_cast<uint8_t>(bits & ~stage);
+        if (m_active.compare_exchange_strong(bits, downgraded, std::memory_order_relaxed)) {
+            m_downgrades.fetch_add(1, std::memory_order_relaxed);
+            if (m_onDowngrade) m_onDowngrade(unpack(downgraded), elapsed);
+        }
+        return;
+    }
+}
+
+CaptureProcessorStats CaptureProcessor::stats() const {
+    CaptureProcessorStats stats;
+    stats.requested = unpack(m_requested.load(std::memory_order_relaxed));
+    stats.active = unpack(m_active.load(std::memory_order_relaxed));
+    stats.budgetMicros = m_budgetMicros.load(std::memory_order_relaxed);
+    stats.frames = m_frames.load(std::memory_order_relaxed);
+    stats.overruns = m_overruns.load(std::memory_order_relaxed);
+    stats.downgrades = m_downgrades.load(std::memory_order_relaxed);
+    stats.lastFrameMicros = m_lastFrameMicros.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace echo
@@ -0,0 +1,156 @@
+/**
+ * @file capture_processor.h
+ * @brief Processamento do áudio capturado (filtro passa-altas, supressão de ruído e AGC)
+ *
+ * Este arquivo define o CaptureProcessor, aplicado a cada quadro do
+ * microfone antes de ele chegar às chamadas. São três estágios,
+ * independentes e ligáveis em tempo de execução:
+ *
+ *   - passa-altas: biquad Butterworth de 2ª ordem em 100 Hz (remove
+ *     ruído de manuseio, vento e componente DC);
+ *   - supressão de ruído e AGC: pré-processador do Speex (o mesmo estado
+ *     atende aos dois; com ambos desligados ele nem é executado).
+ *
+ * Cada quadro é cronometrado. Se o processamento passa do orçamento
+ * (fração da duração do quadro) em vários quadros seguidos, o estágio
+ * mais caro ainda ativo é desligado: supressão de ruído, depois AGC,
+ * depois passa-altas. O rebaixamento vale até a próxima chamada a
+ * setStages.
+ */
+
+#ifndef CAPTURE_PROCESSOR_H
+#define CAPTURE_PROCESSOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "call_timing.h"
+
+struct SpeexPreprocessState_;
+
+namespace echo {
+
+/**
+ * @brief Estágios de processamento da captura
+ */
+struct CaptureStages {
+    bool highPass = true;
+    bool noiseSuppression = true;
+    bool agc = true;
+
+    bool any() const { return highPass || noiseSuppression || agc; }
+    bool operator==(const CaptureStages& other) const {
+        return highPass == other.highPass && noiseSuppression == other.noiseSuppression && agc == other.agc;
+    }
+    bool operator!=(const CaptureStages& other) const { return !(*this == other); }
+};
+
+// Orçamento por quadro, em porcentagem da duração do quadro
+constexpr unsigned kCaptureMinBudgetPercent = 5;
+constexpr unsigned kCaptureMaxBudgetPercent = 90;
+constexpr unsigned kCaptureDefaultBudgetPercent = 25;
+
+// Quadros seguidos acima do orçamento antes de rebaixar um estágio
+constexpr unsigned kCaptureOverrunFrames = 3;
+
+/**
+ * @brief Contadores do processamento (lidos de qualquer thread)
+ */
+struct CaptureProcessorStats {
+    CaptureStages requested;    // Configurado por setStages
+    CaptureStages active;       // Em uso (após rebaixamentos)
+    unsigned budgetMicros = 0;
+    uint64_t frames = 0;
+    uint64_t overruns = 0;      // Quadros acima do orçamento
+    uint64_t downgrades = 0;
+    int64_t lastFrameMicros = 0;
+};
+
+class CaptureProcessor {
+public:
+    /**
+     * @brief Chamado no thread de mídia após um rebaixamento
+     * @param active Estágios que continuam ativos
+     * @param frameMicros Tempo do quadro que disparou o rebaixamento
+     */
+    using DowngradeCallback = std::function<void(const CaptureStages& active, int64_t frameMicros)>;
+
+    /**
+     * @param clockRate Taxa de amostragem do áudio (8000 a 48000)
+     * @param samplesPerFrame Tamanho do quadro da ponte (o Speex exige quadro fixo)
+     * @param frameTime Histograma que recebe o tempo de cada quadro (opcional)
+     */
+    CaptureProcessor(unsigned clockRate, unsigned samplesPerFrame, LatencyHistogram* frameTime = nullptr);
+    ~CaptureProcessor();
+
+    // Impede cópia
+    CaptureProcessor(const CaptureProcessor&) = delete;
+    CaptureProcessor& operator=(const CaptureProcessor&) = delete;
+
+    /**
+     * @brief Define os estágios e desfaz rebaixamentos anteriores (qualquer thread)
+     */
+    void setStages(const CaptureStages& stages);
+
+    /**
+     * @brief Define o orçamento por quadro (qualquer thread)
+     * @param percent Porcentagem da duração do quadro (limitada a 5-90)
+     */
+    void setBudgetPercent(unsigned percent);
+
+    /**
+     * @brief Define o callback de rebaixamento (antes de o áudio começar a passar)
+     */
+    void setDowngradeCallback(DowngradeCallback callback) { m_onDowngrade = std::move(callback); }
+
+    /**
+     * @brief Processa um quadro PCM 16 bits mono no próprio buffer (thread de mídia)
+     *
+     * Quadros de tamanho diferente de samplesPerFrame passam apenas pelo
+     * passa-altas.
+     */
+    void process(int16_t* samples, size_t count);
+
+    CaptureStages activeStages() const { return unpack(m_active.load(std::memory_order_relaxed)); }
+    CaptureProcessorStats stats() const;
+
+    unsigned clockRate() const { return m_clockRate; }
+    unsigned samplesPerFrame() const { return m_samplesPerFrame; }
+
+private:
+    static uint8_t pack(const CaptureStages& stages);
+    static CaptureStages unpack(uint8_t bits);
+
+    void highPass(int16_t* samples, size_t count);
+    void applySpeexStages(uint8_t bits);
+    void checkBudget(uint8_t bits, int64_t elapsed);
+
+    unsigned m_clockRate;
+    unsigned m_samplesPerFrame;
+    unsigned m_frameMicros;
+    LatencyHistogram* m_frameTime;
+    DowngradeCallback m_onDowngrade;
+
+    SpeexPreprocessState_* m_speex = nullptr;
+    uint8_t m_speexBits = 0;        // Estágios já configurados no Speex (thread de mídia)
+
+    // Coeficientes normalizados (a0 = 1) e estado em forma direta I
+    float m_b0 = 1.0f, m_b1 = 0.0f, m_b2 = 0.0f, m_a1 = 0.0f, m_a2 = 0.0f;
+    float m_x1 = 0.0f, m_x2 = 0.0f, m_y1 = 0.0f, m_y2 = 0.0f;
+
+    std::atomic<uint8_t> m_requested;
+    std::atomic<uint8_t> m_active;
+    std::atomic<unsigned> m_budgetMicros;
+    unsigned m_overrunStreak = 0;
+
+    std::atomic<uint64_t> m_frames{0};
+    std::atomic<uint64_t> m_overruns{0};
+    std::atomic<uint64_t> m_downgrades{0};
+    std::atomic<int64_t> m_lastFrameMicros{0};
+};
+
+} // namespace echo
+
+#endif // CAPTURE_PROCESSOR_H
@@ -0,0 +1,125 @@
+/**
+ * @file command_thread.cpp
+ * @brief Implementação do thread de comandos PJSUA
+ */
+
+#include "command_thread.h"
+#include "trace.h"
+
+extern "C" {
+#include <pjsua-lib/pjsua.h>
+}
+
+namespace echo {
+
+CommandThread::CommandThread(const std::string& name) : m_name(name) {
+}
+
+CommandThread::~CommandThread() {
+    stop();
+}
+
+void CommandThread::start() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_running && !m_stopping) {
+            return;
+        }
+    }
+
+    // Conclui um encerramento pedido de dentro do thread anterior
+    join();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_running) {
+        return;
+    }
+
+    m_stopping = false;
+    m_running = true;
+    m_thread = std::thread(&CommandThread::run, this);
+}
+
+void CommandThread::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_running) {
+            m_stopping = true;
+        }
+    }
+    m_cv.notify_one();
+
+    // O thread pode ter encerrado sozinho após um stop() feito de dentro
+    // dele: ainda assim precisa do join
+    join();
+}
+
+void CommandThread::join() {
+    // stop() a partir de um comando: o thread encerra ao esvaziar a fila e
+    // continua usando m_mutex/m_queue até lá, então não pode ser desanexado
+    if (isCurrentThread()) {
+        return;
+    }
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool CommandThread::post(Command command) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_running || m_stopping) {
+            return false;
+        }
+        m_queue.push_back(std::move(command));
+    }
+    m_cv.notify_one();
+    return true;
+}
+
+bool CommandThread::isCurrentThread() const {
+    return m_threadId.load(std::memory_order_acquire) == std::this_thread::get_id();
+}
+
+bool CommandThread::isRunning() const {
+    return m_running;
+}
+
+void CommandThread::run() {
+    m_threadId.store(std::this_thread::get_id(), std::memory_order_release);
+
+    // pj_init é contado por referência: mantém o pjlib válido entre
+    // pjsua_destroy() e um novo pjsua_create()
+    pj_init();
+
+    pj_thread_desc desc;
+    pj_thread_t* thread = nullptr;
+    pj_bzero(desc, sizeof(desc));
+    pj_thread_register(m_name.c_str(), desc, &thread);
+
+    for (;;) {
+        Command command;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+
+            if (m_queue.empty()) {
+                break;
+            }
+            command = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        ECHO_TRACE_SCOPE("command.run");
+        command();
+    }
+
+    pj_shutdown();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_running = false;
+    m_threadId.store(std::thread::id(), std::memory_order_release);
+}
+
+} // namespace echo
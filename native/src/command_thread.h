@@ -0,0 +1,110 @@
+/**
+ * @file command_thread.h
+ * @brief Thread dedicado para executar comandos PJSUA
+ *
+ * Este arquivo define o CommandThread, um thread registrado no pjlib que
+ * executa em ordem os comandos enfileirados. Operações que podem bloquear
+ * (pjsua_init, troca de dispositivo de áudio, criação de transporte) rodam
+ * nele em vez de no thread principal do Node.
+ */
+
+#ifndef COMMAND_THREAD_H
+#define COMMAND_THREAD_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace echo {
+
+/**
+ * @brief Fila de comandos consumida por um único thread registrado no pjlib
+ */
+class CommandThread {
+public:
+    using Command = std::function<void()>;
+
+    explicit CommandThread(const std::string& name);
+
+    /**
+     * @brief Encerra e aguarda o thread (nunca destruir a partir dele)
+     */
+    ~CommandThread();
+
+    /**
+     * @brief Inicia o thread (idempotente)
+     */
+    void start();
+
+    /**
+     * @brief Executa os comandos pendentes e encerra o thread
+     *
+     * Chamado a partir de um comando, apenas pede o encerramento: o thread
+     * sai ao esvaziar a fila e o join fica para o dono (start/stop seguinte
+     * ou o destrutor, em outro thread).
+     */
+    void stop();
+
+    /**
+     * @brief Enfileira um comando
+     * @return false se o thread não está em execução
+     */
+    bool post(Command command);
+
+    /**
+     * @brief Executa uma função no thread e aguarda o resultado
+     *
+     * Se chamado a partir do próprio thread, executa imediatamente para
+     * evitar deadlock.
+     */
+    template <typename Result>
+    Result call(std::function<Result()> function, Result fallback) {
+        if (isCurrentThread()) {
+            return function();
+        }
+
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(function));
+        std::future<Result> result = task->get_future();
+        if (!post([task]() { (*task)(); })) {
+            return fallback;
+        }
+        return result.get();
+    }
+
+    /**
+     * @brief Verifica se o chamador é o próprio thread de comandos
+     */
+    bool isCurrentThread() const;
+
+    /**
+     * @brief Verifica se o thread está em execução
+     */
+    bool isRunning() const;
+
+private:
+    CommandThread(const CommandThread&) = delete;
+    CommandThread& operator=(const CommandThread&) = delete;
+
+    void run();
+    void join();
+
+    std::string m_name;
+    std::thread m_thread;
+    std::atomic<std::thread::id> m_threadId{};
+    std::atomic<bool> m_running{false};
+    bool m_stopping{false};
+
+    std::deque<Command> m_queue;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+
+} // namespace echo
+
+#endif // COMMAND_THREAD_H
@@ -0,0 +1,228 @@
+/**
+ * @file contact_index.cpp
+ * @brief Implementação do índice de contatos
+ */
+
+#include "contact_index.h"
+
+#include <atomic>
+
+namespace echo {
+
+namespace {
+
+// E.164 tem no máximo 15 dígitos; 17 cabem em 57 bits junto com o tamanho
+constexpr size_t kMaxDigits = 17;
+constexpr int kLengthShift = 57;
+
+bool isSeparator(char c) {
+    return c == ' ' || c == '-' || c == '.' || c == '(' || c == ')' || c == '/';
+}
+
+bool startsWith(std::string_view value, std::string_view prefix) {
+    return !prefix.empty() && value.size() >= prefix.size() && value.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool inNationalRange(size_t length, const NumberPlan& plan) {
+    return static_cast<int>(length) >= plan.minNationalLength && static_cast<int>(length) <= plan.maxNationalLength;
+}
+
+// Empacota os dígitos (até kMaxDigits) em uma chave não nula
+bool packDigits(std::string_view prefix, std::string_view digits, uint64_t* key) {
+    size_t length = prefix.size() + digits.size();
+    if (length == 0 || length > kMaxDigits) {
+        return false;
+    }
+
+    uint64_t value = 0;
+    for (char c : prefix) value = value * 10 + static_cast<uint64_t>(c - '0');
+    for (char c : digits) value = value * 10 + static_cast<uint64_t>(c - '0');
+
+    *key = (static_cast<uint64_t>(length) << kLengthShift) | value;
+    return true;
+}
+
+uint64_t mixHash(uint64_t key) {
+    // Finalizador do splitmix64
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+} // namespace
+
+bool normalizePhoneNumber(std::string_view number, const NumberPlan& plan, uint64_t* key) {
+    char buffer[32];
+    size_t length = 0;
+    bool plus = false;
+
+    for (size_t i = 0; i < number.size(); ++i) {
+        char c = number[i];
+        if (c >= '0' && c <= '9') {
+            if (length == sizeof(buffer)) return false;
+            buffer[length++] = c;
+        } else if (c == '+' && length == 0 && !plus) {
+            plus = true;
+        } else if (!isSeparator(c)) {
+            return false;   // Usuário SIP alfanumérico, não é número
+        }
+    }
+
+    std::string_view digits(buffer, length);
+    if (digits.empty()) {
+        return false;
+    }
+
+    if (plus) {
+        return packDigits("", digits, key);
+    }
+
+    if (startsWith(digits, plan.internationalPrefix)) {
+        return packDigits("", digits.substr(plan.internationalPrefix.size()), key);
+    }
+
+    if (startsWith(digits, plan.trunkPrefix)) {
+        std::string_view national = digits.substr(plan.trunkPrefix.size());
+        if (inNationalRange(national.size(), plan)) {
+            return packDigits(plan.countryCode, national, key);
+        }
+        // Prefixo de operadora: 0 + XX + número nacional
+        if (plan.carrierCodeLength > 0 && national.size() > static_cast<size_t>(plan.carrierCodeLength)) {
+            std::string_view withoutCarrier = national.substr(static_cast<size_t>(plan.carrierCodeLength));
+            if (inNationalRange(withoutCarrier.size(), plan)) {
+                return packDigits(plan.countryCode, withoutCarrier, key);
+            }
+        }
+    }
+
+    if (inNationalRange(digits.size(), plan)) {
+        return packDigits(plan.countryCode, digits, key);
+    }
+
+    // Ramais e números já em E.164 sem '+'
+    return packDigits("", digits, key);
+}
+
+/**
+ * @brief Tabela imutável (endereçamento aberto, sondagem linear)
+ */
+struct ContactIndex::Table {
+    struct Slot {
+        uint64_t key = 0;           // 0 = vazio
+        uint32_t nameOffset = 0;
+        uint32_t nameLength = 0;
+    };
+
+    NumberPlan plan;
+    std::vector<Slot> slots;
+    std::string names;              // Nomes concatenados
+    uint64_t mask = 0;
+    ContactIndexStats stats;
+
+    const Slot* find(uint64_t key) const {
+        if (slots.empty()) return nullptr;
+        for (uint64_t i = mixHash(key) & mask;; i = (i + 1) & mask) {
+            const Slot& slot = slots[i];
+            if (slot.key == key) return &slot;
+            if (slot.key == 0) return nullptr;
+        }
+    }
+};
+
+ContactIndex::ContactIndex() {
+}
+
+ContactIndex::~ContactIndex() {
+}
+
+ContactIndexStats ContactIndex::load(const std::vector<ContactEntry>& entries, const NumberPlan& plan) {
+    auto table = std::make_shared<Table>();
+    table->plan = plan;
+
+    // Ocupação máxima de 50%: sondagens curtas mesmo com chaves agrupadas
+    uint64_t capacity = 16;
+    while (capacity < entries.size() * 2) {
+        capacity <<= 1;
+    }
+    table->slots.resize(capacity);
+    table->mask = capacity - 1;
+
+    size_t nameBytes = 0;
+    for (const ContactEntry& entry : entries) {
+        nameBytes += entry.name.size();
+    }
+    table->names.reserve(nameBytes);
+
+    for (const ContactEntry& entry : entries) {
+        uint64_t key;
+        if (entry.name.empty() || !normalizePhoneNumber(entry.number, plan, &key) ||
+            table->names.size() + entry.name.size() > UINT32_MAX) {
+            table->stats.skipped++;
+            continue;
+        }
+
+        uint64_t probe = 0;
+        uint64_t i = mixHash(key) & table->mask;
+        while (table->slots[i].key != 0 && table->slots[i].key != key) {
+            i = (i + 1) & table->mask;
+            probe++;
+        }
+
+        Table::Slot& slot = table->slots[i];
+        if (slot.key == 0) {
+            slot.key = key;
+            table->stats.entries++;
+        }
+        // Duplicado: o nome anterior fica órfão no buffer (última entrada prevalece)
+        slot.nameOffset = static_cast<uint32_t>(table->names.size());
+        slot.nameLength = static_cast<uint32_t>(entry.name.size());
+        table->names += entry.name;
+
+        if (probe > table->stats.maxProbe) {
+            table->stats.maxProbe = probe;
+        }
+    }
+
+    table->stats.capacity = capacity;
+    table->stats.bytes = capacity * sizeof(Table::Slot) + table->names.capacity();
+
+    ContactIndexStats stats = table->stats;
+    std::atomic_store(&m_table, std::shared_ptr<const Table>(std::move(table)));
+    return stats;
+}
+
+void ContactIndex::clear() {
+    std::atomic_store(&m_table, std::shared_ptr<const Table>());
+}
+
+bool ContactIndex::lookup(std::string_view number, std::string* name) const {
+    std::shared_ptr<const Table> table = std::atomic_load(&m_table);
+    if (!table) {
+        return false;
+    }
+
+    uint64_t key;
+    if (!normalizePhoneNumber(number, table->plan, &key)) {
+        return false;
+    }
+
+    const Table::Slot* slot = table->find(key);
+    if (!slot) {
+        return false;
+    }
+
+    if (name) {
+        name->assign(table->names, slot->nameOffset, slot->nameLength);
+    }
+    return true;
+}
+
+ContactIndexStats ContactIndex::getStats() const {
+    std::shared_ptr<const Table> table = std::atomic_load(&m_table);
+    return table ? table->stats : ContactIndexStats();
+}
+
+} // namespace echo
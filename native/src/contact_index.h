@@ -0,0 +1,115 @@
+/**
+ * @file contact_index.h
+ * @brief Índice de contatos por número de telefone (identificação de chamador)
+ *
+ * Este arquivo define o ContactIndex, uma tabela hash de endereçamento
+ * aberto indexada pelo número normalizado (E.164 sem '+'). A tabela é
+ * imutável depois de carregada: uma nova carga monta outra tabela e a troca
+ * atomicamente, de modo que as consultas no thread SIP nunca bloqueiam e
+ * custam O(1) independentemente do tamanho do diretório.
+ */
+
+#ifndef CONTACT_INDEX_H
+#define CONTACT_INDEX_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace echo {
+
+/**
+ * @brief Plano de numeração usado na normalização
+ *
+ * Os valores padrão seguem o plano brasileiro: "0 XX 11 99999-8888"
+ * (prefixo de operadora), "011 99999-8888", "11 99999-8888",
+ * "+55 11 99999-8888" e "0055 11 99999-8888" resultam na mesma chave.
+ */
+struct NumberPlan {
+    std::string countryCode = "55";         // Código do país (sem '+')
+    std::string internationalPrefix = "00"; // Prefixo de discagem internacional
+    std::string trunkPrefix = "0";          // Prefixo de discagem nacional
+    int carrierCodeLength = 2;              // Dígitos de seleção de operadora após o trunkPrefix
+    int minNationalLength = 10;             // Tamanho do número nacional (com DDD)
+    int maxNationalLength = 11;
+};
+
+/**
+ * @brief Entrada do diretório
+ */
+struct ContactEntry {
+    std::string name;
+    std::string number;
+};
+
+/**
+ * @brief Estatísticas da última carga
+ */
+struct ContactIndexStats {
+    uint64_t entries = 0;       // Números indexados (duplicados contam uma vez)
+    uint64_t skipped = 0;       // Números que não puderam ser normalizados
+    uint64_t capacity = 0;      // Slots da tabela
+    uint64_t maxProbe = 0;      // Maior sequência de sondagem
+    uint64_t bytes = 0;         // Memória da tabela e dos nomes
+};
+
+/**
+ * @brief Normaliza um número de telefone
+ *
+ * Ignora separadores (espaço, '-', '.', '(', ')'). Números curtos (ramais)
+ * são mantidos como estão.
+ *
+ * @param number Número como discado ou recebido
+ * @param plan Plano de numeração
+ * @param key Recebe a chave compacta (dígitos + tamanho)
+ * @return false se o texto não é um número de telefone
+ */
+bool normalizePhoneNumber(std::string_view number, const NumberPlan& plan, uint64_t* key);
+
+/**
+ * @brief Índice de contatos por número
+ */
+class ContactIndex {
+public:
+    ContactIndex();
+    ~ContactIndex();
+
+    /**
+     * @brief Substitui o diretório inteiro
+     *
+     * Em números duplicados prevalece a última entrada.
+     */
+    ContactIndexStats load(const std::vector<ContactEntry>& entries, const NumberPlan& plan);
+
+    /**
+     * @brief Remove todas as entradas
+     */
+    void clear();
+
+    /**
+     * @brief Procura o nome do contato
+     * @param number Número (ou usuário SIP) a procurar
+     * @param name Recebe o nome quando encontrado
+     * @return true se o número está no diretório
+     */
+    bool lookup(std::string_view number, std::string* name) const;
+
+    /**
+     * @brief Estatísticas da carga atual
+     */
+    ContactIndexStats getStats() const;
+
+private:
+    ContactIndex(const ContactIndex&) = delete;
+    ContactIndex& operator=(const ContactIndex&) = delete;
+
+    struct Table;
+
+    std::shared_ptr<const Table> m_table;
+};
+
+} // namespace echo
+
+#endif // CONTACT_INDEX_H
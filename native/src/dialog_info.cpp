@@ -0,0 +1,398 @@
+/**
+ * @file dialog_info.cpp
+ * @brief Implementação dos parsers de dialog-info, RLMI e multipart
+ */
+
+#include "dialog_info.h"
+
+#include <cctype>
+
+namespace echo {
+
+namespace {
+
+struct XmlTag {
+    std::string_view name;          // Sem prefixo de namespace
+    std::string_view attributes;
+    bool closing = false;
+    bool selfClosing = false;
+    size_t end = 0;                 // Posição após o '>'
+};
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+std::string_view trim(std::string_view value) {
+    while (!value.empty() && isSpace(value.front())) value.remove_prefix(1);
+    while (!value.empty() && isSpace(value.back())) value.remove_suffix(1);
+    return value;
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Próxima tag a partir de pos; pula comentários, <?...?> e <!...>
+bool nextTag(std::string_view xml, size_t pos, XmlTag* tag) {
+    while (true) {
+        size_t open = xml.find('<', pos);
+        if (open == std::string_view::npos) return false;
+        if (xml.compare(open, 4, "<!--") == 0) {
+            size_t close = xml.find("-->", open + 4);
+            if (close == std::string_view::npos) return false;
+            pos = close + 3;
+            continue;
+        }
+
+        // '>' fora de aspas fecha a tag
+        size_t close = open + 1;
+        char quote = 0;
+        while (close < xml.size() && (quote || xml[close] != '>')) {
+            char c = xml[close];
+            if (quote) {
+                if (c == quote) quote = 0;
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+            }
+            ++close;
+        }
+        if (close >= xml.size()) return false;
+
+        std::string_view inner = xml.substr(open + 1, close - open - 1);
+        if (!inner.empty() && (inner[0] == '?' || inner[0] == '!')) {
+            pos = close + 1;
+            continue;
+        }
+
+        tag->closing = !inner.empty() && inner[0] == '/';
+        if (tag->closing) inner.remove_prefix(1);
+        tag->selfClosing = !inner.empty() && inner.back() == '/';
+        if (tag->selfClosing) inner.remove_suffix(1);
+
+        size_t nameEnd = 0;
+        while (nameEnd < inner.size() && !isSpace(inner[nameEnd])) ++nameEnd;
+        std::string_view name = inner.substr(0, nameEnd);
+        size_t colon = name.find(':');
+        if (colon != std::string_view::npos) name.remove_prefix(colon + 1);
+
+        tag->name = name;
+        tag->attributes = inner.substr(nameEnd);
+        tag->end = close + 1;
+        return true;
+    }
+}
+
+// Valor de um atributo (sem as aspas, entidades não decodificadas)
+bool attribute(std::string_view attributes, std::string_view name, std::string_view* value) {
+    size_t pos = 0;
+    while (pos < attributes.size()) {
+        while (pos < attributes.size() && isSpace(attributes[pos])) ++pos;
+        size_t nameStart = pos;
+        while (pos < attributes.size() && attributes[pos] != '=' && !isSpace(attributes[pos])) ++pos;
+        std::string_view attrName = attributes.substr(nameStart, pos - nameStart);
+        while (pos < attributes.size() && isSpace(attributes[pos])) ++pos;
+        if (pos >= attributes.size() || attributes[pos] != '=') {
+            if (attrName.empty()) return false;
+            continue;
+        }
+        ++pos;
+        while (pos < attributes.size() && isSpace(attributes[pos])) ++pos;
+        if (pos >= attributes.size() || (attributes[pos] != '"' && attributes[pos] != '\'')) return false;
+        char quote = attributes[pos++];
+        size_t valueEnd = attributes.find(quote, pos);
+        if (valueEnd == std::string_view::npos) return false;
+        if (attrName == name) {
+            *value = attributes.substr(pos, valueEnd - pos);
+            return true;
+        }
+        pos = valueEnd + 1;
+    }
+    return false;
+}
+
+std::string decodeXml(std::string_view text) {
+    std::string out;
+    out.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] != '&') {
+            out += text[i];
+            continue;
+        }
+        size_t semicolon = text.find(';', i);
+        if (semicolon == std::string_view::npos) {
+            out += text[i];
+            continue;
+        }
+        std::string_view entity = text.substr(i + 1, semicolon - i - 1);
+        if (entity == "amp") out += '&';
+        else if (entity == "lt") out += '<';
+        else if (entity == "gt") out += '>';
+        else if (entity == "quot") out += '"';
+        else if (entity == "apos") out += '\'';
+        else if (entity.size() > 1 && entity[0] == '#') {
+            // Referências numéricas: apenas ASCII (URIs)
+            bool hex = entity[1] == 'x' || entity[1] == 'X';
+            unsigned code = 0;
+            for (char c : entity.substr(hex ? 2 : 1)) {
+                int digit = std::isdigit(static_cast<unsigned char>(c)) ? c - '0'
+                          : hex && std::isxdigit(static_cast<unsigned char>(c))
+                              ? std::tolower(static_cast<unsigned char>(c)) - 'a' + 10 : -1;
+                if (digit < 0) { code = 0x100; break; }
+                code = code * (hex ? 16 : 10) + static_cast<unsigned>(digit);
+                if (code > 0x7F) break;
+            }
+            if (code == 0 || code > 0x7F) {
+                out.append(text.data() + i, semicolon - i + 1);
+            } else {
+                out += static_cast<char>(code);
+            }
+        } else {
+            out.append(text.data() + i, semicolon - i + 1);
+        }
+        i = semicolon;
+    }
+    return out;
+}
+
+uint32_t parseUnsigned(std::string_view text) {
+    uint32_t value = 0;
+    for (char c : trim(text)) {
+        if (c < '0' || c > '9') break;
+        value = value * 10 + static_cast<uint32_t>(c - '0');
+    }
+    return value;
+}
+
+DialogPhase parsePhase(std::string_view text) {
+    text = trim(text);
+    if (text == "trying") return DialogPhase::Trying;
+    if (text == "proceeding") return DialogPhase::Proceeding;
+    if (text == "early") return DialogPhase::Early;
+    if (text == "terminated") return DialogPhase::Terminated;
+    // "confirmed" e valores desconhecidos: há algo em andamento
+    return DialogPhase::Confirmed;
+}
+
+} // namespace
+
+const char* blfStateName(BlfState state) {
+    switch (state) {
+        case BlfState::Idle: return "idle";
+        case BlfState::Ringing: return "ringing";
+        case BlfState::Busy: return "busy";
+        case BlfState::Unknown: break;
+    }
+    return "unknown";
+}
+
+BlfState blfStateFromDialogs(const std::vector<DialogEntry>& dialogs) {
+    bool busy = false;
+    for (const DialogEntry& dialog : dialogs) {
+        if (dialog.phase == DialogPhase::Terminated) {
+            continue;
+        }
+        if (dialog.incoming && dialog.phase != DialogPhase::Confirmed) {
+            return BlfState::Ringing;
+        }
+        busy = true;
+    }
+    return busy ? BlfState::Busy : BlfState::Idle;
+}
+
+bool parseDialogInfo(std::string_view xml, DialogInfo* info) {
+    *info = DialogInfo();
+
+    bool root = false;
+    size_t current = 0;             // Índice + 1 do <dialog> aberto
+    size_t pos = 0;
+    XmlTag tag;
+    while (nextTag(xml, pos, &tag)) {
+        pos = tag.end;
+        std::string_view value;
+
+        if (tag.name == "dialog-info") {
+            if (tag.closing) break;
+            root = true;
+            if (attribute(tag.attributes, "entity", &value)) info->entity = decodeXml(value);
+            if (attribute(tag.attributes, "version", &value)) info->version = parseUnsigned(value);
+            info->full = !attribute(tag.attributes, "state", &value) || value != "partial";
+            continue;
+        }
+        if (!root) {
+            continue;
+        }
+
+        if (tag.name == "dialog") {
+            if (tag.closing) {
+                current = 0;
+                continue;
+            }
+            DialogEntry entry;
+            if (attribute(tag.attributes, "id", &value)) entry.id = decodeXml(value);
+            entry.incoming = attribute(tag.attributes, "direction", &value) && value == "recipient";
+            info->dialogs.push_back(std::move(entry));
+            current = tag.selfClosing ? 0 : info->dialogs.size();
+            continue;
+        }
+
+        if (current && tag.name == "state" && !tag.closing && !tag.selfClosing) {
+            size_t textEnd = xml.find('<', tag.end);
+            if (textEnd == std::string_view::npos) break;
+            info->dialogs[current - 1].phase = parsePhase(xml.substr(tag.end, textEnd - tag.end));
+            pos = textEnd;
+        }
+    }
+    return root;
+}
+
+bool parseRlmi(std::string_view xml, std::vector<RlmiResource>* resources, bool* fullState) {
+    resources->clear();
+    *fullState = false;
+
+    bool root = false;
+    size_t current = 0;             // Índice + 1 do <resource> aberto
+    unsigned instances = 0;
+    unsigned terminated = 0;
+    size_t pos = 0;
+    XmlTag tag;
+    while (nextTag(xml, pos, &tag)) {
+        pos = tag.end;
+        std::string_view value;
+
+        if (tag.name == "list" && !tag.closing) {
+            root = true;
+            *fullState = attribute(tag.attributes, "fullState", &value) && (value == "true" || value == "1");
+            continue;
+        }
+        if (!root) {
+            continue;
+        }
+
+        if (tag.name == "resource") {
+            if (tag.closing) {
+                if (current) resources->at(current - 1).terminated = instances > 0 && instances == terminated;
+                current = 0;
+                continue;
+            }
+            RlmiResource resource;
+            if (attribute(tag.attributes, "uri", &value)) resource.uri = decodeXml(value);
+            resources->push_back(std::move(resource));
+            current = tag.selfClosing ? 0 : resources->size();
+            instances = 0;
+            terminated = 0;
+            continue;
+        }
+
+        if (current && tag.name == "instance" && !tag.closing) {
+            instances++;
+            if (attribute(tag.attributes, "state", &value)) {
+                if (value == "active") resources->at(current - 1).active = true;
+                else if (value == "terminated") terminated++;
+            }
+        }
+    }
+    return root;
+}
+
+void parseContentType(std::string_view value, std::string_view* type, std::string_view* boundary) {
+    size_t semicolon = value.find(';');
+    *type = trim(value.substr(0, semicolon));
+    *boundary = std::string_view();
+
+    while (semicolon != std::string_view::npos) {
+        size_t next = value.find(';', semicolon + 1);
+        std::string_view param = trim(value.substr(semicolon + 1, next == std::string_view::npos
+                                                                       ? std::string_view::npos
+                                                                       : next - semicolon - 1));
+        size_t equals = param.find('=');
+        if (equals != std::string_view::npos && equalsIgnoreCase(trim(param.substr(0, equals)), "boundary")) {
+            std::string_view quoted = trim(param.substr(equals + 1));
+            if (quoted.size() >= 2 && quoted.front() == '"' && quoted.back() == '"') {
+                quoted = quoted.substr(1, quoted.size() - 2);
+            }
+            *boundary = quoted;
+            return;
+        }
+        semicolon = next;
+    }
+}
+
+bool sameMediaType(std::string_view a, std::string_view b) {
+    return equalsIgnoreCase(trim(a), trim(b));
+}
+
+bool splitMultipart(std::string_view body, std::string_view boundary, std::vector<BodyPart>* parts) {
+    parts->clear();
+
+    if (boundary.empty()) {
+        std::string_view rest = trim(body);
+        if (rest.size() < 3 || rest.compare(0, 2, "--") != 0) return false;
+        size_t lineEnd = rest.find('\n');
+        boundary = trim(rest.substr(2, lineEnd == std::string_view::npos ? std::string_view::npos : lineEnd - 2));
+        if (boundary.empty()) return false;
+    }
+
+    std::string delimiter = "--" + std::string(boundary);
+    std::string separator = "\n" + delimiter;
+
+    size_t pos = body.find(delimiter);
+    if (pos == std::string_view::npos) return false;
+    while (true) {
+        size_t after = pos + delimiter.size();
+        if (body.compare(after, 2, "--") == 0) break;           // Delimitador final
+        size_t lineEnd = body.find('\n', after);
+        if (lineEnd == std::string_view::npos) break;
+        size_t partStart = lineEnd + 1;
+
+        size_t next = body.find(separator, partStart);
+        if (next == std::string_view::npos) break;
+        size_t partEnd = next > partStart && body[next - 1] == '\r' ? next - 1 : next;
+        std::string_view part = body.substr(partStart, partEnd - partStart);
+
+        // Cabeçalhos até a linha vazia (parte sem cabeçalhos começa por ela)
+        BodyPart entry;
+        size_t headerEnd = 0;
+        size_t contentStart = 0;
+        if (part.compare(0, 2, "\r\n") == 0) {
+            contentStart = 2;
+        } else if (part.compare(0, 1, "\n") == 0) {
+            contentStart = 1;
+        } else if ((headerEnd = part.find("\r\n\r\n")) != std::string_view::npos) {
+            contentStart = headerEnd + 4;
+        } else if ((headerEnd = part.find("\n\n")) != std::string_view::npos) {
+            contentStart = headerEnd + 2;
+        } else {
+            headerEnd = part.size();
+            contentStart = part.size();
+        }
+
+        std::string_view headers = part.substr(0, headerEnd);
+        size_t lineStart = 0;
+        while (lineStart < headers.size()) {
+            size_t end = headers.find('\n', lineStart);
+            std::string_view line = trim(headers.substr(lineStart, end == std::string_view::npos
+                                                                      ? std::string_view::npos
+                                                                      : end - lineStart));
+            size_t colon = line.find(':');
+            if (colon != std::string_view::npos && equalsIgnoreCase(trim(line.substr(0, colon)), "Content-Type")) {
+                parseContentType(line.substr(colon + 1), &entry.contentType, &entry.boundary);
+            }
+            if (end == std::string_view::npos) break;
+            lineStart = end + 1;
+        }
+
+        entry.body = part.substr(contentStart);
+        parts->push_back(entry);
+        pos = next + 1;
+    }
+    return !parts->empty();
+}
+
+} // namespace echo
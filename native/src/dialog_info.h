@@ -0,0 +1,134 @@
+/**
+ * @file dialog_info.h
+ * @brief Parser dos corpos de NOTIFY do pacote "dialog" (BLF)
+ *
+ * Este arquivo define os parsers usados pelas assinaturas de BLF:
+ *
+ *   - application/dialog-info+xml (RFC 4235): diálogos de um ramal;
+ *   - application/rlmi+xml (RFC 4662): recursos de uma lista (RLS);
+ *   - multipart/related: o NOTIFY da lista traz o RLMI e um
+ *     dialog-info por ramal alterado.
+ *
+ * Não é um parser XML genérico: reconhece apenas os elementos e atributos
+ * desses documentos (com ou sem prefixo de namespace) e ignora o resto.
+ * Os resultados são std::string_view sobre a entrada, exceto o que
+ * precisa ser decodificado (entidades XML).
+ */
+
+#ifndef DIALOG_INFO_H
+#define DIALOG_INFO_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace echo {
+
+/**
+ * @brief Estado de um ramal no BLF
+ */
+enum class BlfState : uint8_t {
+    Unknown,    // Sem assinatura ativa ou sem NOTIFY ainda
+    Idle,       // Nenhum diálogo em andamento
+    Ringing,    // Chamada entrante tocando (captura possível)
+    Busy        // Em chamada ou discando
+};
+
+/**
+ * @brief Nome do estado nos eventos ("unknown", "idle", "ringing", "busy")
+ */
+const char* blfStateName(BlfState state);
+
+/**
+ * @brief Estado de um diálogo (elemento <state>)
+ */
+enum class DialogPhase : uint8_t {
+    Trying,
+    Proceeding,
+    Early,
+    Confirmed,
+    Terminated
+};
+
+/**
+ * @brief Um elemento <dialog>
+ */
+struct DialogEntry {
+    std::string id;
+    DialogPhase phase = DialogPhase::Terminated;
+    bool incoming = false;      // direction="recipient"
+};
+
+/**
+ * @brief Documento dialog-info de um ramal
+ */
+struct DialogInfo {
+    std::string entity;         // URI do ramal (atributo entity)
+    uint32_t version = 0;
+    bool full = true;           // state="full" (senão, só os diálogos alterados)
+    std::vector<DialogEntry> dialogs;
+};
+
+/**
+ * @brief Estado do ramal a partir dos diálogos em andamento
+ *
+ * Entrante ainda não atendida prevalece (o BLF serve para capturar);
+ * qualquer outro diálogo não encerrado é ocupado.
+ */
+BlfState blfStateFromDialogs(const std::vector<DialogEntry>& dialogs);
+
+/**
+ * @brief Interpreta um documento application/dialog-info+xml
+ * @return false se não há elemento <dialog-info>
+ */
+bool parseDialogInfo(std::string_view xml, DialogInfo* info);
+
+/**
+ * @brief Recurso de uma lista RLMI
+ */
+struct RlmiResource {
+    std::string uri;
+    bool active = false;        // Alguma instância com state="active"
+    bool terminated = false;    // Todas as instâncias encerradas
+};
+
+/**
+ * @brief Interpreta um documento application/rlmi+xml
+ * @param fullState Recebe o atributo fullState da lista
+ * @return false se não há elemento <list>
+ */
+bool parseRlmi(std::string_view xml, std::vector<RlmiResource>* resources, bool* fullState);
+
+/**
+ * @brief Parte de um corpo multipart
+ */
+struct BodyPart {
+    std::string_view contentType;   // Tipo/subtipo, sem parâmetros
+    std::string_view boundary;      // Parâmetro boundary (partes multipart aninhadas)
+    std::string_view body;
+};
+
+/**
+ * @brief Separa um corpo multipart
+ *
+ * O delimitador é deduzido da primeira linha "--..." quando boundary está
+ * vazio (o corpo vem da impressão do PJSIP, com o mesmo delimitador).
+ *
+ * @return false se o corpo não tem delimitadores
+ */
+bool splitMultipart(std::string_view body, std::string_view boundary, std::vector<BodyPart>* parts);
+
+/**
+ * @brief Separa um valor de Content-Type em tipo/subtipo e boundary
+ */
+void parseContentType(std::string_view value, std::string_view* type, std::string_view* boundary);
+
+/**
+ * @brief Compara tipos MIME sem distinção de caixa
+ */
+bool sameMediaType(std::string_view a, std::string_view b);
+
+} // namespace echo
+
+#endif // DIALOG_INFO_H
@@ -0,0 +1,211 @@
+/**
+ * @file dtmf_detector.cpp
+ * @brief Implementação do detector de DTMF in-band
+ */
+
+#include "dtmf_detector.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ECHO_DTMF_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define ECHO_DTMF_NEON 1
+#endif
+
+namespace echo {
+
+namespace {
+
+constexpr float kFrequencies[8] = {697.0f, 770.0f, 852.0f, 941.0f, 1209.0f, 1336.0f, 1477.0f, 1633.0f};
+
+constexpr char kDigits[4][4] = {
+    {'1', '2', '3', 'A'},
+    {'4', '5', '6', 'B'},
+    {'7', '8', '9', 'C'},
+    {'*', '0', '#', 'D'},
+};
+
+constexpr unsigned kBlockAt8k = 205;
+constexpr double kPi = 3.14159265358979323846;
+
+// Razões de potência (dB / 10)
+constexpr float kNormalTwist = 0.158f;      // Coluna até 8 dB abaixo da linha
+constexpr float kReverseTwist = 0.398f;     // Linha até 4 dB abaixo da coluna
+constexpr float kRelativePeak = 0.158f;     // Demais frequências 8 dB abaixo
+constexpr float kSignalRatio = 0.35f;       // Dois tons puros dão 0,5
+
+// Nível mínimo de cada tom: -34 dBFS (a Q.24 aceita a partir de ~-26 dBm0)
+constexpr float kMinAmplitude = 0.02f;
+
+constexpr float kSampleScale = 1.0f / 32768.0f;
+
+// Atualiza os 8 filtros com n amostras; devolve a energia das amostras
+float runFilters(const int16_t* samples, size_t n, const float* coeff, float* s1, float* s2) {
+    float energy = 0.0f;
+
+#if defined(ECHO_DTMF_SSE2)
+    __m128 c0 = _mm_load_ps(coeff);
+    __m128 c1 = _mm_load_ps(coeff + 4);
+    __m128 a1 = _mm_load_ps(s1);
+    __m128 b1 = _mm_load_ps(s1 + 4);
+    __m128 a2 = _mm_load_ps(s2);
+    __m128 b2 = _mm_load_ps(s2 + 4);
+    for (size_t i = 0; i < n; ++i) {
+        float x = static_cast<float>(samples[i]) * kSampleScale;
+        energy += x * x;
+        __m128 vx = _mm_set1_ps(x);
+        __m128 a0 = _mm_sub_ps(_mm_add_ps(vx, _mm_mul_ps(c0, a1)), a2);
+        __m128 b0 = _mm_sub_ps(_mm_add_ps(vx, _mm_mul_ps(c1, b1)), b2);
+        a2 = a1;
+        b2 = b1;
+        a1 = a0;
+        b1 = b0;
+    }
+    _mm_store_ps(s1, a1);
+    _mm_store_ps(s1 + 4, b1);
+    _mm_store_ps(s2, a2);
+    _mm_store_ps(s2 + 4, b2);
+#elif defined(ECHO_DTMF_NEON)
+    float32x4_t c0 = vld1q_f32(coeff);
+    float32x4_t c1 = vld1q_f32(coeff + 4);
+    float32x4_t a1 = vld1q_f32(s1);
+    float32x4_t b1 = vld1q_f32(s1 + 4);
+    float32x4_t a2 = vld1q_f32(s2);
+    float32x4_t b2 = vld1q_f32(s2 + 4);
+    for (size_t i = 0; i < n; ++i) {
+        float x = static_cast<float>(samples[i]) * kSampleScale;
+        energy += x * x;
+        float32x4_t vx = vdupq_n_f32(x);
+        float32x4_t a0 = vsubq_f32(vmlaq_f32(vx, c0, a1), a2);
+        float32x4_t b0 = vsubq_f32(vmlaq_f32(vx, c1, b1), b2);
+        a2 = a1;
+        b2 = b1;
+        a1 = a0;
+        b1 = b0;
+    }
+    vst1q_f32(s1, a1);
+    vst1q_f32(s1 + 4, b1);
+    vst1q_f32(s2, a2);
+    vst1q_f32(s2 + 4, b2);
+#else
+    for (size_t i = 0; i < n; ++i) {
+        float x = static_cast<float>(samples[i]) * kSampleScale;
+        energy += x * x;
+        for (int k = 0; k < 8; ++k) {
+            float s0 = x + coeff[k] * s1[k] - s2[k];
+            s2[k] = s1[k];
+            s1[k] = s0;
+        }
+    }
+#endif
+
+    return energy;
+}
+
+// Índice da maior potência em [first, first + 4) e se as demais ficam abaixo do pico relativo
+int strongest(const float* power, int first, bool* clearPeak) {
+    int best = first;
+    for (int k = first + 1; k < first + 4; ++k) {
+        if (power[k] > power[best]) best = k;
+    }
+    *clearPeak = true;
+    for (int k = first; k < first + 4; ++k) {
+        if (k != best && power[k] > power[best] * kRelativePeak) {
+            *clearPeak = false;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+DtmfDetector::DtmfDetector(unsigned clockRate)
+    : m_clockRate(std::clamp(clockRate, 8000u, 48000u)) {
+    // Mesmo tempo de bloco em qualquer taxa: as frequências caem nos mesmos "bins"
+    m_blockSize = (kBlockAt8k * m_clockRate + 4000) / 8000;
+
+    for (int k = 0; k < 8; ++k) {
+        double omega = 2.0 * kPi * kFrequencies[k] / m_clockRate;
+        m_coeff[k] = static_cast<float>(2.0 * std::cos(omega));
+    }
+
+    float peak = kMinAmplitude * static_cast<float>(m_blockSize) / 2.0f;
+    m_minPower = peak * peak;
+
+    reset();
+}
+
+void DtmfDetector::reset() {
+    std::fill(m_s1, m_s1 + 8, 0.0f);
+    std::fill(m_s2, m_s2 + 8, 0.0f);
+    m_energy = 0.0f;
+    m_filled = 0;
+    m_lastHit = 0;
+    m_current = 0;
+}
+
+void DtmfDetector::process(const int16_t* samples, size_t count, const DigitCallback& onDigit) {
+    while (count > 0) {
+        size_t n = std::min<size_t>(count, m_blockSize - m_filled);
+        m_energy += runFilters(samples, n, m_coeff, m_s1, m_s2);
+        samples += n;
+        count -= n;
+        m_filled += static_cast<unsigned>(n);
+
+        if (m_filled < m_blockSize) {
+            break;
+        }
+
+        char hit = analyzeBlock();
+        if (hit != 0 && hit == m_lastHit && hit != m_current) {
+            m_current = hit;
+            if (onDigit) onDigit(hit);
+        } else if (hit == 0 && m_lastHit == 0) {
+            m_current = 0;
+        }
+        m_lastHit = hit;
+    }
+}
+
+char DtmfDetector::analyzeBlock() {
+    float power[8];
+    for (int k = 0; k < 8; ++k) {
+        power[k] = m_s1[k] * m_s1[k] + m_s2[k] * m_s2[k] - m_coeff[k] * m_s1[k] * m_s2[k];
+    }
+
+    float energy = m_energy;
+    std::fill(m_s1, m_s1 + 8, 0.0f);
+    std::fill(m_s2, m_s2 + 8, 0.0f);
+    m_energy = 0.0f;
+    m_filled = 0;
+
+    bool rowClear;
+    bool colClear;
+    int row = strongest(power, 0, &rowClear);
+    int col = strongest(power, 4, &colClear);
+    float rowPower = power[row];
+    float colPower = power[col];
+
+    if (rowPower < m_minPower || colPower < m_minPower) return 0;
+    if (colPower < rowPower * kNormalTwist || rowPower < colPower * kReverseTwist) return 0;
+    if (!rowClear || !colClear) return 0;
+    if (rowPower + colPower < kSignalRatio * energy * static_cast<float>(m_blockSize)) return 0;
+
+    return kDigits[row][col - 4];
+}
+
+const char* DtmfDetector::implementation() {
+#if defined(ECHO_DTMF_SSE2)
+    return "sse2";
+#elif defined(ECHO_DTMF_NEON)
+    return "neon";
+#else
+    return "escalar";
+#endif
+}
+
+} // namespace echo
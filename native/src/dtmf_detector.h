@@ -0,0 +1,84 @@
+/**
+ * @file dtmf_detector.h
+ * @brief Detector de DTMF in-band (banco de filtros de Goertzel)
+ *
+ * Este arquivo define o DtmfDetector, usado no caminho de recepção das
+ * chamadas cujo tronco não envia telephone-event (RFC 2833). As 8
+ * frequências DTMF são filtradas juntas: cada amostra atualiza os 8
+ * filtros em dois registradores SIMD (SSE2 ou NEON; escalar nas demais
+ * arquiteturas).
+ *
+ * A análise é feita em blocos de 205 amostras a 8 kHz (25,6 ms; o mesmo
+ * tempo em outras taxas). Um bloco vale um dígito quando:
+ *
+ *   - a maior linha e a maior coluna passam do nível mínimo;
+ *   - o twist fica dentro do limite (8 dB normal, 4 dB reverso);
+ *   - as demais linhas/colunas ficam 8 dB abaixo da maior;
+ *   - as duas frequências concentram a maior parte da energia do bloco
+ *     (rejeita voz e música).
+ *
+ * O dígito é reportado após dois blocos seguidos iguais (~51 ms, acima do
+ * mínimo de 40 ms da Q.24) e só volta a ser reportado após dois blocos
+ * sem tom.
+ */
+
+#ifndef DTMF_DETECTOR_H
+#define DTMF_DETECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace echo {
+
+class DtmfDetector {
+public:
+    using DigitCallback = std::function<void(char digit)>;
+
+    /**
+     * @param clockRate Taxa de amostragem do áudio (8000 a 48000)
+     */
+    explicit DtmfDetector(unsigned clockRate);
+
+    /**
+     * @brief Processa amostras PCM 16 bits mono (qualquer tamanho de quadro)
+     * @param onDigit Chamado no thread chamador a cada dígito detectado
+     */
+    void process(const int16_t* samples, size_t count, const DigitCallback& onDigit);
+
+    /**
+     * @brief Descarta o bloco parcial e o estado do dígito atual
+     */
+    void reset();
+
+    unsigned clockRate() const { return m_clockRate; }
+    unsigned blockSize() const { return m_blockSize; }
+
+    /**
+     * @brief Implementação compilada ("sse2", "neon" ou "escalar")
+     */
+    static const char* implementation();
+
+private:
+    char analyzeBlock();
+
+    unsigned m_clockRate;
+    unsigned m_blockSize;
+    unsigned m_filled = 0;
+
+    // Linhas 697-941 Hz nos índices 0-3, colunas 1209-1633 Hz em 4-7
+    alignas(16) float m_coeff[8];
+    alignas(16) float m_s1[8];
+    alignas(16) float m_s2[8];
+    float m_energy = 0.0f;
+
+    // Limites em unidades do bloco (dependem de m_blockSize)
+    float m_minPower;
+
+    char m_lastHit = 0;     // Resultado do bloco anterior
+    char m_current = 0;     // Dígito já reportado (0 = nenhum)
+};
+
+} // namespace echo
+
+#endif // DTMF_DETECTOR_H
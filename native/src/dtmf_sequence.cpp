@@ -0,0 +1,92 @@
+/**
+ * @file dtmf_sequence.cpp
+ * @brief Implementação da conversão de sequências de DTMF
+ */
+
+#include "dtmf_sequence.h"
+
+#include <algorithm>
+
+namespace echo {
+
+namespace {
+
+bool isIgnored(char c) {
+    return c == ' ' || c == '-' || c == '(' || c == ')';
+}
+
+// Dígito normalizado (maiúsculo) ou 0 se não for DTMF
+char dtmfDigit(char c) {
+    if ((c >= '0' && c <= '9') || c == '*' || c == '#') return c;
+    if (c >= 'A' && c <= 'D') return c;
+    if (c >= 'a' && c <= 'd') return static_cast<char>(c - 'a' + 'A');
+    return 0;
+}
+
+} // namespace
+
+DtmfOptions clampDtmfOptions(const DtmfOptions& options) {
+    DtmfOptions clamped = options;
+    clamped.toneMs = std::clamp(options.toneMs, kDtmfMinToneMs, kDtmfMaxToneMs);
+    clamped.gapMs = std::clamp(options.gapMs, kDtmfMinGapMs, kDtmfMaxGapMs);
+    clamped.pauseMs = std::min(options.pauseMs, kDtmfMaxPauseMs);
+    return clamped;
+}
+
+bool parseDtmfSequence(std::string_view digits, const DtmfOptions& options, std::vector<DtmfStep>* steps) {
+    std::vector<DtmfStep> parsed;
+    for (char c : digits) {
+        if (isIgnored(c)) {
+            continue;
+        }
+
+        DtmfStep step;
+        if (c == ',' || c == 'p' || c == 'P') {
+            // Pausas seguidas se somam em um único passo
+            if (!parsed.empty() && parsed.back().digit == 0) {
+                parsed.back().durationMs += options.pauseMs;
+                continue;
+            }
+            step.durationMs = options.pauseMs;
+        } else {
+            step.digit = dtmfDigit(c);
+            if (step.digit == 0) {
+                return false;
+            }
+            step.method = options.method;
+            step.durationMs = options.toneMs;
+            step.gapMs = options.gapMs;
+        }
+
+        if (parsed.size() == kDtmfMaxSteps) {
+            return false;
+        }
+        parsed.push_back(step);
+    }
+
+    steps->insert(steps->end(), parsed.begin(), parsed.end());
+    return true;
+}
+
+const char* dtmfMethodName(DtmfMethod method) {
+    switch (method) {
+        case DtmfMethod::SipInfo: return "info";
+        case DtmfMethod::InBand: return "inband";
+        default: return "rfc2833";
+    }
+}
+
+bool dtmfMethodFromName(std::string_view name, DtmfMethod* method) {
+    if (name == "rfc2833") {
+        *method = DtmfMethod::Rfc2833;
+    } else if (name == "info") {
+        *method = DtmfMethod::SipInfo;
+    } else if (name == "inband") {
+        *method = DtmfMethod::InBand;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace echo
@@ -0,0 +1,89 @@
+/**
+ * @file dtmf_sequence.h
+ * @brief Sequências de DTMF (métodos de envio, durações e pausas)
+ *
+ * Este arquivo define as opções de envio de DTMF e a conversão de uma
+ * string discada ("1234#,,9") em passos de reprodução. O SipEngine
+ * reproduz os passos um a um em timers do PJSUA, sem bloquear o thread SIP.
+ *
+ * Caracteres aceitos: 0-9, *, #, A-D (também minúsculos), ',' e 'p'/'P'
+ * (pausa). Espaços, '-', '(' e ')' são ignorados para aceitar números
+ * colados da agenda.
+ */
+
+#ifndef DTMF_SEQUENCE_H
+#define DTMF_SEQUENCE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace echo {
+
+/**
+ * @brief Método de envio dos dígitos
+ */
+enum class DtmfMethod : uint8_t {
+    Rfc2833,    // Eventos telephone-event no RTP (padrão)
+    SipInfo,    // INFO application/dtmf-relay (troncos sem telephone-event)
+    InBand      // Tons no áudio (gateways analógicos)
+};
+
+/**
+ * @brief Opções de envio (durações em ms)
+ *
+ * Os limites mínimos seguem a ITU-T Q.24 (40 ms de tom e de silêncio),
+ * o que permite navegar em URAs tão rápido quanto o destino aceita.
+ */
+struct DtmfOptions {
+    DtmfMethod method = DtmfMethod::Rfc2833;
+    unsigned toneMs = 100;
+    unsigned gapMs = 60;
+    unsigned pauseMs = 2000;    // Duração de cada ',' ou 'p'
+};
+
+constexpr unsigned kDtmfMinToneMs = 40;
+constexpr unsigned kDtmfMaxToneMs = 2000;
+constexpr unsigned kDtmfMinGapMs = 40;
+constexpr unsigned kDtmfMaxGapMs = 2000;
+constexpr unsigned kDtmfMaxPauseMs = 10000;
+constexpr size_t kDtmfMaxSteps = 256;
+
+/**
+ * @brief Passo da sequência: um dígito ou uma pausa
+ */
+struct DtmfStep {
+    char digit = 0;             // 0 = pausa
+    DtmfMethod method = DtmfMethod::Rfc2833;
+    unsigned durationMs = 0;    // Tom (dígito) ou silêncio (pausa)
+    unsigned gapMs = 0;         // Silêncio após o dígito
+};
+
+/**
+ * @brief Limita as durações aos valores aceitos
+ */
+DtmfOptions clampDtmfOptions(const DtmfOptions& options);
+
+/**
+ * @brief Converte a string discada em passos
+ * @param digits Dígitos e pausas
+ * @param options Durações (já limitadas)
+ * @param steps Recebe os passos (acrescentados ao final)
+ * @return false se houver caractere inválido ou mais de kDtmfMaxSteps passos
+ */
+bool parseDtmfSequence(std::string_view digits, const DtmfOptions& options, std::vector<DtmfStep>* steps);
+
+/**
+ * @brief Nome do método ("rfc2833", "info", "inband")
+ */
+const char* dtmfMethodName(DtmfMethod method);
+
+/**
+ * @brief Converte o nome do método (false se desconhecido)
+ */
+bool dtmfMethodFromName(std::string_view name, DtmfMethod* method);
+
+} // namespace echo
+
+#endif // DTMF_SEQUENCE_H
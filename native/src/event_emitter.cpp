@@ -4,9 +4,31 @@
  */
 
 #include "event_emitter.h"
+#include "metrics.h"
 
 namespace echo {
 
+namespace {
+
+// Métricas da fila da ThreadSafeFunction
+struct EmitterMetrics {
+    metrics::Counter& eventsEmitted;
+    metrics::Counter& eventsDropped;
+    metrics::Gauge& queueDepth;
+};
+
+EmitterMetrics& emitterMetrics() {
+    auto& registry = metrics::Registry::getInstance();
+    static EmitterMetrics m{
+        registry.counter("echo_events_emitted", "Eventos enfileirados para o JavaScript"),
+        registry.counter("echo_events_dropped", "Eventos descartados pela ThreadSafeFunction"),
+        registry.gauge("echo_tsfn_queue_depth", "Eventos aguardando o thread principal do Node"),
+    };
+    return m;
+}
+
+} // anonymous namespace
+
 // EventEmitter implementation
 
 EventEmitter::EventEmitter(Napi::Env env, Napi::Function callback) {
@@ -38,6 +60,8 @@ void EventEmitter::emit(const std::string& eventName, const std::string& jsonPay
     auto callback = [](Napi::Env env, Napi::Function jsCallback, EventData* data) {
         if (data == nullptr) return;
         
+        emitterMetrics().queueDepth.sub(1);
+        
         // Chamar callback JavaScript com (eventName, payload)
         jsCallback.Call({
             Napi::String::New(env, data->eventName),
@@ -47,10 +71,17 @@ void EventEmitter::emit(const std::string& eventName, const std::string& jsonPay
         delete data;
     };
     
+    EmitterMetrics& m = emitterMetrics();
+    m.queueDepth.add(1);
+    
     napi_status status = m_tsfn.BlockingCall(data, callback);
     
     if (status != napi_ok) {
+        m.queueDepth.sub(1);
+        m.eventsDropped.inc();
         delete data;
+    } else {
+        m.eventsEmitted.inc();
     }
 }
 
@@ -71,11 +102,6 @@ bool EventEmitter::isActive() const {
 
 // EventEmitterManager implementation
 
-EventEmitterManager& EventEmitterManager::getInstance() {
-    static EventEmitterManager instance;
-    return instance;
-}
-
 void EventEmitterManager::setEmitter(std::shared_ptr<EventEmitter> emitter) {
     std::lock_guard<std::mutex> lock(m_mutex);
     m_emitter = emitter;
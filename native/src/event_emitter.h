@@ -78,25 +78,24 @@ private:
 };
 
 /**
- * @brief Gerenciador global de EventEmitter
+ * @brief Gerenciador do EventEmitter de um ambiente
  * 
- * Singleton para gerenciar o EventEmitter global usado pelo SipEngine.
+ * Cada ambiente Node (thread principal ou worker_thread) tem o seu, guardado
+ * nos dados de instância do addon; o SipEngine emite por ele.
  */
 class EventEmitterManager {
 public:
-    /**
-     * @brief Obtém a instância singleton
-     */
-    static EventEmitterManager& getInstance();
+    EventEmitterManager() = default;
+    ~EventEmitterManager() = default;
 
     /**
-     * @brief Define o emitter global
+     * @brief Define o emitter
      * @param emitter Ponteiro para o emitter
      */
     void setEmitter(std::shared_ptr<EventEmitter> emitter);
 
     /**
-     * @brief Obtém o emitter global
+     * @brief Obtém o emitter
      * @return Ponteiro para o emitter ou nullptr
      */
     std::shared_ptr<EventEmitter> getEmitter();
@@ -114,9 +113,6 @@ public:
     void clear();
 
 private:
-    EventEmitterManager() = default;
-    ~EventEmitterManager() = default;
-    
     EventEmitterManager(const EventEmitterManager&) = delete;
     EventEmitterManager& operator=(const EventEmitterManager&) = delete;
 
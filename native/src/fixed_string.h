@@ -0,0 +1,83 @@
+/**
+ * @file fixed_string.h
+ * @brief String de capacidade fixa armazenada inline
+ *
+ * Este arquivo define FixedString<N>: até N bytes guardados no próprio
+ * objeto, sem alocação. Tipos que a contêm continuam trivialmente
+ * copiáveis e podem ser publicados por SeqLock (snapshot do engine).
+ *
+ * Valores maiores que a capacidade são truncados sem partir uma sequência
+ * UTF-8 ao meio.
+ */
+
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace echo {
+
+template <size_t Capacity>
+class FixedString {
+    static_assert(Capacity > 0 && Capacity <= UINT16_MAX, "capacidade inválida");
+
+public:
+    FixedString() = default;
+    FixedString(std::string_view value) { assign(value); }
+    FixedString(const char* value) { assign(value ? std::string_view(value) : std::string_view()); }
+
+    FixedString& operator=(std::string_view value) {
+        assign(value);
+        return *this;
+    }
+
+    FixedString& operator=(const char* value) {
+        assign(value ? std::string_view(value) : std::string_view());
+        return *this;
+    }
+
+    void assign(std::string_view value) {
+        size_t length = value.size();
+        if (length > Capacity) {
+            length = Capacity;
+            // Recuar até o início da sequência UTF-8 cortada
+            while (length > 0 && (static_cast<unsigned char>(value[length]) & 0xC0) == 0x80) {
+                --length;
+            }
+        }
+        if (length > 0) {
+            std::memmove(m_data, value.data(), length);
+        }
+        m_data[length] = '\0';
+        m_size = static_cast<uint16_t>(length);
+    }
+
+    void clear() {
+        m_data[0] = '\0';
+        m_size = 0;
+    }
+
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+    static constexpr size_t capacity() { return Capacity; }
+
+    const char* c_str() const { return m_data; }
+    std::string_view view() const { return std::string_view(m_data, m_size); }
+    std::string str() const { return std::string(m_data, m_size); }
+    operator std::string_view() const { return view(); }
+
+    bool operator==(std::string_view other) const { return view() == other; }
+    bool operator!=(std::string_view other) const { return view() != other; }
+
+private:
+    uint16_t m_size = 0;
+    char m_data[Capacity + 1] = {};
+};
+
+} // namespace echo
+
+#endif // FIXED_STRING_H
@@ -0,0 +1,263 @@
+/**
+ * @file hold_music.cpp
+ * @brief Implementação da porta de música de espera
+ */
+
+#include "hold_music.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace echo {
+
+namespace {
+
+uint16_t readU16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t readU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+} // namespace
+
+/**
+ * @brief WAV mapeado somente leitura; amostras lidas direto do mapeamento
+ */
+class HoldMusicPort::MappedWav {
+public:
+    ~MappedWav() {
+        close();
+    }
+
+    bool open(const std::string& path, std::string* error) {
+#ifdef _WIN32
+        int wideLength = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+        std::wstring widePath(wideLength > 0 ? wideLength : 0, L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, widePath.data(), wideLength);
+        m_handle = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_handle == INVALID_HANDLE_VALUE) {
+            if (error) *error = "Falha ao abrir " + path + " (erro " + std::to_string(GetLastError()) + ")";
+            return false;
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(m_handle, &size);
+        m_size = static_cast<uint64_t>(size.QuadPart);
+        m_mapping = m_size ? CreateFileMappingW(m_handle, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+        if (m_mapping) {
+            m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (!m_data) {
+            if (error) *error = "Falha ao mapear " + path;
+            return false;
+        }
+#else
+        m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (m_fd < 0) {
+            if (error) *error = "Falha ao abrir " + path + ": " + std::strerror(errno);
+            return false;
+        }
+        struct stat st;
+        if (fstat(m_fd, &st) != 0 || st.st_size == 0) {
+            if (error) *error = "Arquivo vazio ou ilegível: " + path;
+            return false;
+        }
+        m_size = static_cast<uint64_t>(st.st_size);
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+        if (data == MAP_FAILED) {
+            if (error) *error = "Falha ao mapear " + path + ": " + std::strerror(errno);
+            return false;
+        }
+        m_data = static_cast<const uint8_t*>(data);
+        // Leitura sequencial em loop: o sistema pode adiantar as páginas
+        madvise(data, m_size, MADV_SEQUENTIAL);
+#endif
+        return parse(path, error);
+    }
+
+    // Amostra mono (média dos canais) do quadro de amostra `index`
+    int32_t sample(uint64_t index) const {
+        const uint8_t* p = m_samples + index * m_channels * 2;
+        if (m_channels == 1) {
+            return static_cast<int16_t>(readU16(p));
+        }
+        return (static_cast<int16_t>(readU16(p)) + static_cast<int16_t>(readU16(p + 2))) / 2;
+    }
+
+    uint64_t frames() const { return m_frames; }
+    unsigned sampleRate() const { return m_sampleRate; }
+
+private:
+    // RIFF/WAVE: exige os chunks "fmt " (PCM 16 bits, 1 ou 2 canais) e "data"
+    bool parse(const std::string& path, std::string* error) {
+        if (m_size < 12 || std::memcmp(m_data, "RIFF", 4) != 0 || std::memcmp(m_data + 8, "WAVE", 4) != 0) {
+            if (error) *error = "Não é um arquivo WAV: " + path;
+            return false;
+        }
+
+        bool hasFormat = false;
+        uint64_t offset = 12;
+        while (offset + 8 <= m_size) {
+            const uint8_t* chunk = m_data + offset;
+            uint64_t length = readU32(chunk + 4);
+            uint64_t available = std::min<uint64_t>(length, m_size - offset - 8);
+            if (std::memcmp(chunk, "fmt ", 4) == 0 && available >= 16) {
+                uint16_t format = readU16(chunk + 8);
+                m_channels = readU16(chunk + 10);
+                m_sampleRate = readU32(chunk + 12);
+                uint16_t bits = readU16(chunk + 22);
+                if (format != 1 || bits != 16 || m_channels < 1 || m_channels > 2 || m_sampleRate < 8000 ||
+                    m_sampleRate > 192000) {
+                    if (error) *error = "WAV deve ser PCM 16 bits, mono ou estéreo: " + path;
+                    return false;
+                }
+                hasFormat = true;
+            } else if (std::memcmp(chunk, "data", 4) == 0 && hasFormat) {
+                m_samples = chunk + 8;
+                m_frames = available / (m_channels * 2u);
+                break;
+            }
+            offset += 8 + length + (length & 1);
+        }
+
+        if (m_frames < 2) {
+            if (error) *error = "WAV sem áudio: " + path;
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_handle != INVALID_HANDLE_VALUE) CloseHandle(m_handle);
+        m_mapping = nullptr;
+        m_handle = INVALID_HANDLE_VALUE;
+#else
+        if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+        if (m_fd >= 0) ::close(m_fd);
+        m_fd = -1;
+#endif
+        m_data = nullptr;
+    }
+
+#ifdef _WIN32
+    HANDLE m_handle = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+    const uint8_t* m_data = nullptr;
+    uint64_t m_size = 0;
+    const uint8_t* m_samples = nullptr;
+    uint64_t m_frames = 0;
+    unsigned m_channels = 0;
+    unsigned m_sampleRate = 0;
+};
+
+HoldMusicPort::HoldMusicPort() {
+    std::memset(&m_port, 0, sizeof(m_port));
+}
+
+HoldMusicPort::~HoldMusicPort() {
+    detach();
+    if (m_pool) {
+        pj_pool_release(m_pool);
+    }
+}
+
+std::unique_ptr<HoldMusicPort> HoldMusicPort::create(const std::string& path, std::string* error) {
+    pjsua_conf_port_info info;
+    if (pjsua_conf_get_port_info(0, &info) != PJ_SUCCESS || info.channel_count != 1) {
+        if (error) *error = "Ponte de conferência indisponível";
+        return nullptr;
+    }
+
+    std::unique_ptr<HoldMusicPort> port(new HoldMusicPort());
+    port->m_path = path;
+    port->m_wav.reset(new MappedWav());
+    if (!port->m_wav->open(path, error)) {
+        return nullptr;
+    }
+    port->m_step = (static_cast<uint64_t>(port->m_wav->sampleRate()) << 32) / info.clock_rate;
+    port->m_samplesPerFrame = info.samples_per_frame;
+
+    pj_str_t name = pj_str(const_cast<char*>("echo-hold-music"));
+    pjmedia_port_info_init(&port->m_port.info, &name, PJMEDIA_SIG_CLASS_APP('H', 'L', 'D'),
+                           info.clock_rate, 1, 16, info.samples_per_frame);
+    port->m_port.port_data.pdata = port.get();
+    port->m_port.put_frame = &HoldMusicPort::putFrame;
+    port->m_port.get_frame = &HoldMusicPort::getFrame;
+
+    port->m_pool = pjsua_pool_create("echo-hold", 512, 512);
+    if (!port->m_pool) {
+        if (error) *error = "Sem memória para a música de espera";
+        return nullptr;
+    }
+    if (pjsua_conf_add_port(port->m_pool, &port->m_port, &port->m_slot) != PJ_SUCCESS) {
+        port->m_slot = PJSUA_INVALID_ID;
+        if (error) *error = "Ponte recusou a música de espera";
+        return nullptr;
+    }
+    return port;
+}
+
+void HoldMusicPort::detach() {
+    if (m_slot != PJSUA_INVALID_ID) {
+        pjsua_conf_remove_port(m_slot);
+        m_slot = PJSUA_INVALID_ID;
+    }
+}
+
+pj_status_t HoldMusicPort::putFrame(pjmedia_port* port, pjmedia_frame* frame) {
+    (void)port;
+    (void)frame;
+    // Só transmite
+    return PJ_SUCCESS;
+}
+
+pj_status_t HoldMusicPort::getFrame(pjmedia_port* port, pjmedia_frame* frame) {
+    auto* self = static_cast<HoldMusicPort*>(port->port_data.pdata);
+    const MappedWav& wav = *self->m_wav;
+    size_t count = self->m_samplesPerFrame;
+    if (frame->size < count * sizeof(int16_t)) {
+        frame->type = PJMEDIA_FRAME_TYPE_NONE;
+        frame->size = 0;
+        return PJ_SUCCESS;
+    }
+
+    // Interpolação linear entre amostras vizinhas (o fim emenda no início)
+    auto* out = static_cast<int16_t*>(frame->buf);
+    uint64_t end = wav.frames() << 32;
+    uint64_t position = self->m_position;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t index = position >> 32;
+        int64_t fraction = static_cast<int64_t>(position & 0xFFFFFFFFu);
+        int32_t a = wav.sample(index);
+        int32_t b = wav.sample(index + 1 < wav.frames() ? index + 1 : 0);
+        out[i] = static_cast<int16_t>(a + (((b - a) * fraction) >> 32));
+        position += self->m_step;
+        if (position >= end) position -= end;
+    }
+    self->m_position = position;
+
+    frame->type = PJMEDIA_FRAME_TYPE_AUDIO;
+    frame->size = count * sizeof(int16_t);
+    return PJ_SUCCESS;
+}
+
+} // namespace echo
@@ -0,0 +1,77 @@
+/**
+ * @file hold_music.h
+ * @brief Música de espera lida de um WAV mapeado em memória
+ *
+ * Este arquivo define a HoldMusicPort, uma porta de conferência que só
+ * transmite: toca em loop um WAV PCM 16 bits (mono ou estéreo, qualquer
+ * taxa) mapeado somente leitura, reamostrado por interpolação linear para
+ * a taxa da ponte. O arquivo não é copiado nem decodificado: as páginas
+ * são lidas sob demanda pelo sistema.
+ *
+ * Uma única porta atende todas as chamadas em espera (a ponte chama
+ * get_frame uma vez por ciclo, independente do número de ouvintes); sem
+ * ouvintes ela não é lida.
+ */
+
+#ifndef HOLD_MUSIC_H
+#define HOLD_MUSIC_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+extern "C" {
+#include <pjsua-lib/pjsua.h>
+}
+
+namespace echo {
+
+class HoldMusicPort {
+public:
+    /**
+     * @brief Mapeia o arquivo e adiciona a porta à ponte (taxa e quadro do slot 0)
+     * @param error Recebe a causa da falha
+     * @return nullptr se o arquivo não é um WAV PCM 16 bits ou a ponte recusou a porta
+     */
+    static std::unique_ptr<HoldMusicPort> create(const std::string& path, std::string* error);
+
+    ~HoldMusicPort();
+
+    /**
+     * @brief Remove a porta da conferência (desfaz todas as conexões)
+     */
+    void detach();
+
+    /**
+     * @brief Esquece o pool após pjsua_destroy (liberado junto com a biblioteca)
+     */
+    void abandonPool() { m_pool = nullptr; }
+
+    pjsua_conf_port_id slot() const { return m_slot; }
+    const std::string& path() const { return m_path; }
+
+private:
+    class MappedWav;
+
+    HoldMusicPort();
+    HoldMusicPort(const HoldMusicPort&) = delete;
+    HoldMusicPort& operator=(const HoldMusicPort&) = delete;
+
+    static pj_status_t putFrame(pjmedia_port* port, pjmedia_frame* frame);
+    static pj_status_t getFrame(pjmedia_port* port, pjmedia_frame* frame);
+
+    pjmedia_port m_port;
+    pj_pool_t* m_pool = nullptr;
+    pjsua_conf_port_id m_slot = PJSUA_INVALID_ID;
+    std::string m_path;
+    std::unique_ptr<MappedWav> m_wav;
+
+    // Posição no arquivo em quadros de amostra, ponto fixo 32.32 (thread da ponte)
+    uint64_t m_position = 0;
+    uint64_t m_step = 0;
+    unsigned m_samplesPerFrame = 0;
+};
+
+} // namespace echo
+
+#endif // HOLD_MUSIC_H
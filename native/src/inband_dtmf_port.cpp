@@ -0,0 +1,88 @@
+/**
+ * @file inband_dtmf_port.cpp
+ * @brief Implementação da porta de detecção de DTMF in-band
+ */
+
+#include "inband_dtmf_port.h"
+
+#include <cstring>
+
+namespace echo {
+
+InbandDtmfPort::InbandDtmfPort(pjsua_call_id callId, unsigned clockRate, DigitCallback onDigit)
+    : m_callId(callId), m_detector(clockRate), m_onDigit(std::move(onDigit)) {
+    std::memset(&m_port, 0, sizeof(m_port));
+}
+
+InbandDtmfPort::~InbandDtmfPort() {
+    detach();
+    if (m_pool) {
+        pj_pool_release(m_pool);
+    }
+}
+
+std::unique_ptr<InbandDtmfPort> InbandDtmfPort::attach(pjsua_call_id callId, DigitCallback onDigit) {
+    pjsua_conf_port_id callSlot = pjsua_call_get_conf_port(callId);
+    if (callSlot == PJSUA_INVALID_ID) {
+        return nullptr;
+    }
+
+    // Mesma taxa e quadro da porta da chamada: a ponte não precisa reamostrar
+    pjsua_conf_port_info info;
+    if (pjsua_conf_get_port_info(callSlot, &info) != PJ_SUCCESS || info.channel_count != 1) {
+        return nullptr;
+    }
+
+    std::unique_ptr<InbandDtmfPort> port(new InbandDtmfPort(callId, info.clock_rate, std::move(onDigit)));
+
+    pj_str_t name = pj_str(const_cast<char*>("echo-dtmf-rx"));
+    pjmedia_port_info_init(&port->m_port.info, &name, PJMEDIA_SIG_CLASS_APP('D', 'T', 'D'),
+                           info.clock_rate, 1, 16, info.samples_per_frame);
+    port->m_port.port_data.pdata = port.get();
+    port->m_port.put_frame = &InbandDtmfPort::putFrame;
+    port->m_port.get_frame = &InbandDtmfPort::getFrame;
+
+    port->m_pool = pjsua_pool_create("echo-dtmf-rx", 1024, 1024);
+    if (!port->m_pool) {
+        return nullptr;
+    }
+    if (pjsua_conf_add_port(port->m_pool, &port->m_port, &port->m_slot) != PJ_SUCCESS) {
+        port->m_slot = PJSUA_INVALID_ID;
+        return nullptr;
+    }
+    if (pjsua_conf_connect(callSlot, port->m_slot) != PJ_SUCCESS) {
+        return nullptr;
+    }
+    return port;
+}
+
+void InbandDtmfPort::detach() {
+    if (m_slot != PJSUA_INVALID_ID) {
+        pjsua_conf_remove_port(m_slot);
+        m_slot = PJSUA_INVALID_ID;
+    }
+}
+
+pj_status_t InbandDtmfPort::putFrame(pjmedia_port* port, pjmedia_frame* frame) {
+    auto* self = static_cast<InbandDtmfPort*>(port->port_data.pdata);
+    if (frame->type != PJMEDIA_FRAME_TYPE_AUDIO || frame->size == 0) {
+        return PJ_SUCCESS;
+    }
+
+    // Thread de mídia: o callback apenas repassa o dígito
+    self->m_detector.process(static_cast<const int16_t*>(frame->buf), frame->size / sizeof(int16_t),
+                             [self](char digit) {
+        if (self->m_onDigit) self->m_onDigit(self->m_callId, digit);
+    });
+    return PJ_SUCCESS;
+}
+
+pj_status_t InbandDtmfPort::getFrame(pjmedia_port* port, pjmedia_frame* frame) {
+    (void)port;
+    // Porta só de recepção: nada a entregar para a ponte
+    frame->type = PJMEDIA_FRAME_TYPE_NONE;
+    frame->size = 0;
+    return PJ_SUCCESS;
+}
+
+} // namespace echo
@@ -0,0 +1,71 @@
+/**
+ * @file inband_dtmf_port.h
+ * @brief Porta de conferência que detecta DTMF in-band no áudio recebido
+ *
+ * Este arquivo define a InbandDtmfPort: uma porta passiva (só recebe
+ * quadros) ligada à saída da porta da chamada na ponte de conferência.
+ * Cada quadro passa pelo DtmfDetector no thread de mídia; os dígitos são
+ * entregues ao callback, que deve apenas repassá-los ao thread SIP.
+ */
+
+#ifndef INBAND_DTMF_PORT_H
+#define INBAND_DTMF_PORT_H
+
+#include <functional>
+#include <memory>
+
+#include "dtmf_detector.h"
+
+extern "C" {
+#include <pjsua-lib/pjsua.h>
+}
+
+namespace echo {
+
+class InbandDtmfPort {
+public:
+    using DigitCallback = std::function<void(pjsua_call_id callId, char digit)>;
+
+    /**
+     * @brief Cria a porta na taxa da chamada e conecta a chamada a ela
+     * @return nullptr se a chamada não tem porta de conferência ou a ponte recusou a porta
+     */
+    static std::unique_ptr<InbandDtmfPort> attach(pjsua_call_id callId, DigitCallback onDigit);
+
+    ~InbandDtmfPort();
+
+    /**
+     * @brief Remove a porta da conferência
+     *
+     * A ponte pode ainda entregar um quadro já em andamento: o objeto só
+     * deve ser destruído depois de alguns ciclos de mídia (ou após
+     * pjsua_destroy).
+     */
+    void detach();
+
+    /**
+     * @brief Esquece o pool após pjsua_destroy (liberado junto com a biblioteca)
+     */
+    void abandonPool() { m_pool = nullptr; }
+
+    pjsua_call_id callId() const { return m_callId; }
+
+private:
+    InbandDtmfPort(pjsua_call_id callId, unsigned clockRate, DigitCallback onDigit);
+    InbandDtmfPort(const InbandDtmfPort&) = delete;
+    InbandDtmfPort& operator=(const InbandDtmfPort&) = delete;
+
+    static pj_status_t putFrame(pjmedia_port* port, pjmedia_frame* frame);
+    static pj_status_t getFrame(pjmedia_port* port, pjmedia_frame* frame);
+
+    pjmedia_port m_port;
+    pj_pool_t* m_pool = nullptr;    // Recursos da ponte para esta porta
+    pjsua_call_id m_callId;
+    pjsua_conf_port_id m_slot = PJSUA_INVALID_ID;
+    DtmfDetector m_detector;
+    DigitCallback m_onDigit;
+};
+
+} // namespace echo
+
+#endif // INBAND_DTMF_PORT_H
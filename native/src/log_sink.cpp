@@ -0,0 +1,323 @@
+/**
+ * @file log_sink.cpp
+ * @brief Implementação do destino assíncrono de log do PJSIP
+ */
+
+#include "log_sink.h"
+#include "call_timing.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+namespace echo {
+
+namespace {
+
+constexpr int kMaxLevel = 6;
+
+int clampLevel(int level) {
+    if (level < 0) return 0;
+    if (level > kMaxLevel) return kMaxLevel;
+    return level;
+}
+
+} // anonymous namespace
+
+LogSink& LogSink::getInstance() {
+    static LogSink instance;
+    return instance;
+}
+
+LogSink::LogSink() : m_queue(new Record[kQueueSize]) {
+    for (size_t i = 0; i < kQueueSize; i++) {
+        m_queue[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < m_rateWindows.size(); i++) {
+        m_rateWindows[i].limit.store(m_config.rateLimits[i], std::memory_order_relaxed);
+    }
+}
+
+LogSink::~LogSink() {
+    stop();
+}
+
+void LogSink::write(int level, const char* data, int len) {
+    LogSink& sink = getInstance();
+
+    if (len <= 0 || data == nullptr) {
+        return;
+    }
+
+    // Antes de start() (ou após stop()) escrever direto, como o writer padrão
+    if (!sink.m_running.load(std::memory_order_acquire)) {
+        fwrite(data, 1, static_cast<size_t>(len), stderr);
+        return;
+    }
+
+    if (!sink.allow(level)) {
+        sink.m_rateLimited.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Mensagens longas (ex.: SIP com SDP) ocupam vários registros
+    size_t remaining = static_cast<size_t>(len);
+    while (remaining > 0) {
+        size_t chunk = remaining < kRecordPayload ? remaining : kRecordPayload;
+        if (!sink.push(level, data, chunk)) {
+            sink.m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        data += chunk;
+        remaining -= chunk;
+    }
+
+    if (sink.m_waiting.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(sink.m_wakeMutex);
+        sink.m_wakeCv.notify_one();
+    }
+}
+
+bool LogSink::allow(int level) {
+    RateWindow& window = m_rateWindows[static_cast<size_t>(clampLevel(level))];
+    uint32_t limit = window.limit.load(std::memory_order_relaxed);
+    if (limit == 0) {
+        return true;
+    }
+
+    int64_t now = monotonicMicros();
+    int64_t start = window.windowStart.load(std::memory_order_relaxed);
+
+    if (now - start >= 1000000) {
+        if (window.windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+            window.count.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    return window.count.fetch_add(1, std::memory_order_relaxed) < limit;
+}
+
+bool LogSink::push(int level, const char* data, size_t len) {
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Record* cell;
+
+    for (;;) {
+        cell = &m_queue[pos & (kQueueSize - 1)];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+        if (diff == 0) {
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false; // Fila cheia
+        } else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    cell->level = level;
+    cell->length = static_cast<uint16_t>(len);
+    memcpy(cell->text, data, len);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool LogSink::pop(Record& out) {
+    Record& cell = m_queue[m_dequeuePos & (kQueueSize - 1)];
+    size_t seq = cell.sequence.load(std::memory_order_acquire);
+    if (seq != m_dequeuePos + 1) {
+        return false;
+    }
+
+    out.level = cell.level;
+    out.length = cell.length;
+    memcpy(out.text, cell.text, cell.length);
+
+    cell.sequence.store(m_dequeuePos + kQueueSize, std::memory_order_release);
+    m_dequeuePos++;
+    return true;
+}
+
+void LogSink::start() {
+    if (m_running.exchange(true)) {
+        return;
+    }
+    m_thread = std::thread(&LogSink::run, this);
+}
+
+void LogSink::stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wakeCv.notify_one();
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(m_configMutex);
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+void LogSink::configure(const LogSinkConfig& config) {
+    std::lock_guard<std::mutex> lock(m_configMutex);
+
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+
+    m_config = config;
+    if (m_config.maxFiles == 0) {
+        m_config.maxFiles = 1;
+    }
+    for (size_t i = 0; i < m_rateWindows.size(); i++) {
+        m_rateWindows[i].limit.store(m_config.rateLimits[i], std::memory_order_relaxed);
+    }
+    openFile();
+}
+
+void LogSink::setRotationCallback(RotationCallback callback) {
+    std::lock_guard<std::mutex> lock(m_configMutex);
+    m_rotationCallback = callback;
+}
+
+LogSinkStats LogSink::getStats() const {
+    LogSinkStats stats;
+    stats.written = m_written.load(std::memory_order_relaxed);
+    stats.dropped = m_dropped.load(std::memory_order_relaxed);
+    stats.rateLimited = m_rateLimited.load(std::memory_order_relaxed);
+    stats.rotations = m_rotations.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void LogSink::run() {
+    // Registro reutilizado pelo thread de escrita
+    std::unique_ptr<Record> record(new Record());
+
+    for (;;) {
+        bool wroteAny = false;
+        {
+            std::lock_guard<std::mutex> lock(m_configMutex);
+            while (pop(*record)) {
+                writeRecord(*record);
+                wroteAny = true;
+            }
+            if (wroteAny) {
+                fflush(m_file ? m_file : stderr);
+            }
+        }
+
+        if (!m_running.load(std::memory_order_acquire)) {
+            // Última passada para esvaziar a fila
+            std::lock_guard<std::mutex> lock(m_configMutex);
+            while (pop(*record)) {
+                writeRecord(*record);
+            }
+            fflush(m_file ? m_file : stderr);
+            break;
+        }
+
+        if (!wroteAny) {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_waiting.store(true, std::memory_order_release);
+            // O timeout cobre a janela entre o push e a flag de espera
+            m_wakeCv.wait_for(lock, std::chrono::seconds(1));
+            m_waiting.store(false, std::memory_order_release);
+        }
+    }
+}
+
+void LogSink::writeRecord(const Record& record) {
+    FILE* out = m_file ? m_file : stderr;
+    fwrite(record.text, 1, record.length, out);
+    m_written.fetch_add(1, std::memory_order_relaxed);
+
+    if (m_file) {
+        m_fileSize += record.length;
+        if (m_fileSize >= m_config.maxFileSize) {
+            rotate();
+        }
+    }
+}
+
+std::string LogSink::activePath() const {
+    return (std::filesystem::path(m_config.directory) / (m_config.baseName + ".log")).string();
+}
+
+void LogSink::openFile() {
+    if (m_config.directory.empty()) {
+        return;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_config.directory, ec);
+
+    m_file = fopen(activePath().c_str(), "ab");
+    m_fileSize = 0;
+    if (m_file) {
+        fseek(m_file, 0, SEEK_END);
+        long size = ftell(m_file);
+        m_fileSize = size > 0 ? static_cast<uint64_t>(size) : 0;
+    }
+}
+
+void LogSink::rotate() {
+    fclose(m_file);
+    m_file = nullptr;
+
+    // <base>.log -> <base>-<epoch ms>.log (nome único, comprimido depois pelo main process)
+    auto epochMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::filesystem::path rotated = std::filesystem::path(m_config.directory) /
+        (m_config.baseName + "-" + std::to_string(epochMs) + ".log");
+
+    std::error_code ec;
+    std::filesystem::rename(activePath(), rotated, ec);
+    if (!ec) {
+        m_rotations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    pruneRotated();
+    openFile();
+
+    if (!ec && m_rotationCallback) {
+        m_rotationCallback(rotated.string());
+    }
+}
+
+void LogSink::pruneRotated() {
+    namespace fs = std::filesystem;
+
+    std::string prefix = m_config.baseName + "-";
+    std::vector<fs::path> rotated;
+
+    std::error_code ec;
+    for (fs::directory_iterator it(m_config.directory, ec), end; !ec && it != end; it.increment(ec)) {
+        std::string name = it->path().filename().string();
+        if (name.compare(0, prefix.size(), prefix) == 0) {
+            rotated.push_back(it->path());
+        }
+    }
+
+    if (rotated.size() <= m_config.maxFiles) {
+        return;
+    }
+
+    // O timestamp no nome ordena os arquivos do mais antigo ao mais novo
+    std::sort(rotated.begin(), rotated.end());
+    for (size_t i = 0; i + m_config.maxFiles < rotated.size(); i++) {
+        fs::remove(rotated[i], ec);
+    }
+}
+
+} // namespace echo
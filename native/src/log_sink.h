@@ -0,0 +1,157 @@
+/**
+ * @file log_sink.h
+ * @brief Destino assíncrono para o log do PJSIP
+ *
+ * Este arquivo define o LogSink, que recebe as mensagens do PJSIP através
+ * de log_cfg.cb, enfileira-as em uma fila lock-free e as grava em arquivos
+ * rotativos a partir de um thread dedicado. O thread PJSUA nunca bloqueia
+ * em I/O de console ou disco.
+ */
+
+#ifndef LOG_SINK_H
+#define LOG_SINK_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace echo {
+
+/**
+ * @brief Configuração do LogSink
+ */
+struct LogSinkConfig {
+    std::string directory;                  // Vazio = escrever em stderr
+    std::string baseName = "echo-pjsip";    // Arquivo ativo: <baseName>.log
+    uint64_t maxFileSize = 5 * 1024 * 1024; // Rotaciona ao atingir este tamanho
+    unsigned maxFiles = 5;                  // Arquivos rotacionados mantidos (.log ou .log.gz)
+    // Máximo de mensagens por segundo para cada nível (0 = ilimitado)
+    std::array<uint32_t, 7> rateLimits{{0, 0, 200, 200, 100, 50, 50}};
+};
+
+/**
+ * @brief Estatísticas do LogSink
+ */
+struct LogSinkStats {
+    uint64_t written = 0;       // Mensagens gravadas
+    uint64_t dropped = 0;       // Descartadas por fila cheia
+    uint64_t rateLimited = 0;   // Descartadas pelo limite por nível
+    uint64_t rotations = 0;     // Arquivos rotacionados
+};
+
+/**
+ * @brief Destino de log assíncrono e com limite de taxa
+ */
+class LogSink {
+public:
+    /**
+     * @brief Tipo de callback chamado após cada rotação
+     * @param path Caminho do arquivo recém rotacionado (pronto para compressão)
+     */
+    using RotationCallback = std::function<void(const std::string& path)>;
+
+    /**
+     * @brief Obtém a instância singleton
+     */
+    static LogSink& getInstance();
+
+    /**
+     * @brief Função compatível com pjsua_logging_config::cb
+     */
+    static void write(int level, const char* data, int len);
+
+    /**
+     * @brief Inicia o thread de escrita (idempotente)
+     */
+    void start();
+
+    /**
+     * @brief Esvazia a fila e encerra o thread de escrita
+     */
+    void stop();
+
+    /**
+     * @brief Aplica uma nova configuração (reabre o arquivo de destino)
+     */
+    void configure(const LogSinkConfig& config);
+
+    /**
+     * @brief Define o callback de rotação
+     */
+    void setRotationCallback(RotationCallback callback);
+
+    /**
+     * @brief Obtém estatísticas acumuladas
+     */
+    LogSinkStats getStats() const;
+
+private:
+    LogSink();
+    ~LogSink();
+
+    LogSink(const LogSink&) = delete;
+    LogSink& operator=(const LogSink&) = delete;
+
+    static constexpr size_t kQueueSize = 1024;      // Potência de dois
+    static constexpr size_t kRecordPayload = 1000;  // Mensagens maiores são fragmentadas
+
+    struct Record {
+        std::atomic<size_t> sequence{0};
+        int level = 0;
+        uint16_t length = 0;
+        char text[kRecordPayload];
+    };
+
+    struct RateWindow {
+        std::atomic<uint32_t> limit{0};
+        std::atomic<int64_t> windowStart{0};
+        std::atomic<uint32_t> count{0};
+    };
+
+    bool allow(int level);
+    bool push(int level, const char* data, size_t len);
+    bool pop(Record& out);
+    void run();
+    void writeRecord(const Record& record);
+    void openFile();
+    void rotate();
+    void pruneRotated();
+    std::string activePath() const;
+
+    // Fila MPSC limitada (algoritmo de Vyukov)
+    std::unique_ptr<Record[]> m_queue;
+    std::atomic<size_t> m_enqueuePos{0};
+    size_t m_dequeuePos{0};
+
+    std::array<RateWindow, 7> m_rateWindows;
+
+    LogSinkConfig m_config;
+    std::mutex m_configMutex;
+    RotationCallback m_rotationCallback;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_waiting{false};
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCv;
+
+    // Acessados apenas pelo thread de escrita (ou com m_configMutex)
+    FILE* m_file{nullptr};
+    uint64_t m_fileSize{0};
+
+    std::atomic<uint64_t> m_written{0};
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<uint64_t> m_rateLimited{0};
+    std::atomic<uint64_t> m_rotations{0};
+};
+
+} // namespace echo
+
+#endif // LOG_SINK_H
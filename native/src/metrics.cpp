@@ -0,0 +1,193 @@
+/**
+ * @file metrics.cpp
+ * @brief Implementação do registro de métricas
+ */
+
+#include "metrics.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace echo {
+namespace metrics {
+
+namespace {
+
+// Limites dos buckets exportados (segundos)
+const double kBucketBounds[] = {
+    0.0001, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+    0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 30.0
+};
+
+// Cada thread recebe um fragmento fixo na primeira utilização
+int currentShard() {
+    static std::atomic<int> nextShard{0};
+    thread_local int shard = nextShard.fetch_add(1, std::memory_order_relaxed) % Counter::kShards;
+    return shard;
+}
+
+std::string withLabels(const std::string& labels, const std::string& extra = "") {
+    if (labels.empty() && extra.empty()) {
+        return "";
+    }
+    if (labels.empty()) {
+        return "{" + extra + "}";
+    }
+    if (extra.empty()) {
+        return "{" + labels + "}";
+    }
+    return "{" + labels + "," + extra + "}";
+}
+
+// Valor de "le" na forma canônica do OpenMetrics (1.0, 0.005, 2.5)
+std::string formatBound(double bound) {
+    std::ostringstream out;
+    out << bound;
+    std::string text = out.str();
+    if (text.find_first_of(".e") == std::string::npos) {
+        text += ".0";
+    }
+    return text;
+}
+
+} // anonymous namespace
+
+// Counter
+
+Counter::Counter() = default;
+
+void Counter::inc(uint64_t delta) {
+    m_shards[currentShard()].value.fetch_add(delta, std::memory_order_relaxed);
+}
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const auto& shard : m_shards) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+// Registry
+
+Registry& Registry::getInstance() {
+    static Registry instance;
+    return instance;
+}
+
+const void* Registry::find(const std::string& name, const std::string& labels, Type type) const {
+    for (const auto& entry : m_entries) {
+        if (entry.type == type && entry.name == name && entry.labels == labels) {
+            return entry.metric;
+        }
+    }
+    return nullptr;
+}
+
+Counter& Registry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (const void* existing = find(name, labels, Type::Counter)) {
+        return *const_cast<Counter*>(static_cast<const Counter*>(existing));
+    }
+    m_counters.push_back(std::make_unique<Counter>());
+    Counter* metric = m_counters.back().get();
+    m_entries.push_back({name, help, labels, Type::Counter, metric});
+    return *metric;
+}
+
+Gauge& Registry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (const void* existing = find(name, labels, Type::Gauge)) {
+        return *const_cast<Gauge*>(static_cast<const Gauge*>(existing));
+    }
+    m_gauges.push_back(std::make_unique<Gauge>());
+    Gauge* metric = m_gauges.back().get();
+    m_entries.push_back({name, help, labels, Type::Gauge, metric});
+    return *metric;
+}
+
+LatencyHistogram& Registry::histogram(const std::string& name, const std::string& help, const std::string& labels) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (const void* existing = find(name, labels, Type::Histogram)) {
+        return *const_cast<LatencyHistogram*>(static_cast<const LatencyHistogram*>(existing));
+    }
+    m_histograms.push_back(std::make_unique<LatencyHistogram>());
+    LatencyHistogram* metric = m_histograms.back().get();
+    m_entries.push_back({name, help, labels, Type::Histogram, metric});
+    return *metric;
+}
+
+void Registry::addHistogram(const std::string& name, const std::string& help, const std::string& labels,
+                            const LatencyHistogram* histogram) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.push_back({name, help, labels, Type::Histogram, histogram});
+}
+
+void Registry::removeHistogram(const LatencyHistogram* histogram) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [histogram](const Entry& entry) {
+        return entry.type == Type::Histogram && entry.metric == histogram;
+    }), m_entries.end());
+}
+
+std::string Registry::renderOpenMetrics() const {
+    // O mutex fica tomado durante toda a renderização: histogramas de outros
+    // objetos (addHistogram) só podem ser destruídos depois de removeHistogram
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Entry> entries = m_entries;
+
+    // Agrupar amostras da mesma família
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.name < b.name;
+    });
+
+    std::ostringstream out;
+    std::string currentFamily;
+
+    for (const auto& entry : entries) {
+        if (entry.name != currentFamily) {
+            currentFamily = entry.name;
+            const char* type = entry.type == Type::Counter ? "counter"
+                             : entry.type == Type::Gauge ? "gauge"
+                             : "histogram";
+            out << "# TYPE " << entry.name << " " << type << "\n";
+            out << "# HELP " << entry.name << " " << entry.help << "\n";
+        }
+
+        switch (entry.type) {
+            case Type::Counter: {
+                const Counter* counter = static_cast<const Counter*>(entry.metric);
+                out << entry.name << "_total" << withLabels(entry.labels) << " " << counter->value() << "\n";
+                break;
+            }
+
+            case Type::Gauge: {
+                const Gauge* gauge = static_cast<const Gauge*>(entry.metric);
+                out << entry.name << withLabels(entry.labels) << " " << gauge->value() << "\n";
+                break;
+            }
+
+            case Type::Histogram: {
+                const LatencyHistogram* histogram = static_cast<const LatencyHistogram*>(entry.metric);
+                uint64_t count = histogram->count();
+                for (double bound : kBucketBounds) {
+                    uint64_t micros = static_cast<uint64_t>(std::llround(bound * 1e6));
+                    std::string le = "le=\"" + formatBound(bound) + "\"";
+                    out << entry.name << "_bucket" << withLabels(entry.labels, le) << " "
+                        << std::min(histogram->cumulativeCount(micros), count) << "\n";
+                }
+                out << entry.name << "_bucket" << withLabels(entry.labels, "le=\"+Inf\"") << " " << count << "\n";
+                out << entry.name << "_count" << withLabels(entry.labels) << " " << count << "\n";
+                out << entry.name << "_sum" << withLabels(entry.labels) << " "
+                    << static_cast<double>(histogram->sumMicros()) / 1e6 << "\n";
+                break;
+            }
+        }
+    }
+
+    out << "# EOF\n";
+    return out.str();
+}
+
+} // namespace metrics
+} // namespace echo
@@ -0,0 +1,178 @@
+/**
+ * @file metrics.h
+ * @brief Registro de métricas do addon com exportação OpenMetrics
+ *
+ * Este arquivo define contadores, gauges e histogramas de baixo custo
+ * usados pela camada nativa e um registro global que os renderiza no
+ * formato texto OpenMetrics (compatível com Prometheus).
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "call_timing.h"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace echo {
+namespace metrics {
+
+/**
+ * @brief Contador monotônico fragmentado por thread
+ *
+ * Cada thread incrementa o seu próprio fragmento (alinhado à linha de
+ * cache), evitando contenção entre o thread do Node e os threads PJSIP.
+ */
+class Counter {
+public:
+    static constexpr int kShards = 16;
+
+    Counter();
+
+    // Impede cópia
+    Counter(const Counter&) = delete;
+    Counter& operator=(const Counter&) = delete;
+
+    /**
+     * @brief Incrementa o contador
+     * @param delta Valor a somar
+     */
+    void inc(uint64_t delta = 1);
+
+    /**
+     * @brief Soma de todos os fragmentos
+     */
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+
+    Shard m_shards[kShards];
+};
+
+/**
+ * @brief Valor instantâneo que pode subir ou descer
+ */
+class Gauge {
+public:
+    void set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+    void add(int64_t delta) { m_value.fetch_add(delta, std::memory_order_relaxed); }
+    void sub(int64_t delta) { m_value.fetch_sub(delta, std::memory_order_relaxed); }
+    int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> m_value{0};
+};
+
+/**
+ * @brief Mede a duração de um escopo e registra em um histograma
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(LatencyHistogram& histogram)
+        : m_histogram(histogram), m_start(monotonicMicros()) {}
+
+    ~ScopedTimer() {
+        m_histogram.record(monotonicMicros() - m_start);
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    LatencyHistogram& m_histogram;
+    int64_t m_start;
+};
+
+/**
+ * @brief Registro global de métricas
+ *
+ * O registro é feito uma vez (fora do caminho crítico); as referências
+ * retornadas permanecem válidas durante toda a vida do processo.
+ */
+class Registry {
+public:
+    /**
+     * @brief Obtém a instância singleton
+     */
+    static Registry& getInstance();
+
+    /**
+     * @brief Obtém (ou cria) um contador
+     * @param name Nome da família sem o sufixo _total (ex.: echo_events_emitted)
+     * @param help Descrição
+     * @param labels Rótulos já formatados (ex.: outcome="answered") ou vazio
+     */
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    /**
+     * @brief Obtém (ou cria) um gauge
+     */
+    Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    /**
+     * @brief Obtém (ou cria) um histograma de latência (exportado em segundos)
+     */
+    LatencyHistogram& histogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    /**
+     * @brief Publica um histograma pertencente a outro objeto
+     * @param histogram Ponteiro que deve permanecer válido até removeHistogram
+     */
+    void addHistogram(const std::string& name, const std::string& help, const std::string& labels,
+                      const LatencyHistogram* histogram);
+
+    /**
+     * @brief Remove um histograma publicado com addHistogram
+     *
+     * Ao retornar, nenhuma renderização em andamento lê mais o ponteiro.
+     */
+    void removeHistogram(const LatencyHistogram* histogram);
+
+    /**
+     * @brief Renderiza todas as métricas no formato texto OpenMetrics
+     */
+    std::string renderOpenMetrics() const;
+
+private:
+    Registry() = default;
+    ~Registry() = default;
+
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+
+    enum class Type {
+        Counter,
+        Gauge,
+        Histogram
+    };
+
+    struct Entry {
+        std::string name;
+        std::string help;
+        std::string labels;
+        Type type;
+        const void* metric;
+    };
+
+    const void* find(const std::string& name, const std::string& labels, Type type) const;
+
+    std::vector<Entry> m_entries;
+    std::deque<std::unique_ptr<Counter>> m_counters;
+    std::deque<std::unique_ptr<Gauge>> m_gauges;
+    std::deque<std::unique_ptr<LatencyHistogram>> m_histograms;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace metrics
+} // namespace echo
+
+#endif // METRICS_H
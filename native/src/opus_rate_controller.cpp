@@ -0,0 +1,124 @@
+/**
+ * @file opus_rate_controller.cpp
+ * @brief Implementação da adaptação do bitrate do Opus
+ */
+
+#include "opus_rate_controller.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace echo {
+
+namespace {
+
+// Menos pacotes que isso no intervalo (silêncio com DTX) não é amostra
+constexpr uint32_t kMinIntervalPackets = 20;
+
+// Suavização da perda: sobe rápido, desce devagar
+constexpr double kLossRiseWeight = 0.6;
+constexpr double kLossFallWeight = 0.2;
+
+// Perda abaixo disso é ruído de medida
+constexpr double kLowLoss = 0.02;
+
+// Perda acima disso é tratada como congestionamento, não só como perda aleatória
+constexpr double kCongestionLoss = 0.20;
+
+// RTT acima do mínimo observado que indica fila no caminho
+constexpr double kQueueingRttMs = 150.0;
+
+// Piso para a FEC manter banda larga com perda (bps)
+constexpr unsigned kFecFloorBitrate = 24000;
+
+constexpr unsigned kIncreaseStep = 2000;
+constexpr double kDecreaseFactor = 0.8;
+constexpr unsigned kMaxLossPercent = 30;
+
+// Mudanças menores que isso não reconfiguram o codificador
+constexpr unsigned kMinBitrateChange = 2000;
+constexpr unsigned kMinLossPercentChange = 2;
+
+} // namespace
+
+OpusOptions clampOpusOptions(const OpusOptions& options) {
+    OpusOptions clamped = options;
+    clamped.minBitrate = std::clamp(options.minBitrate, kOpusMinBitrate, kOpusMaxBitrate);
+    clamped.maxBitrate = std::clamp(options.maxBitrate, clamped.minBitrate, kOpusMaxBitrate);
+    clamped.startBitrate = std::clamp(options.startBitrate, clamped.minBitrate, clamped.maxBitrate);
+    return clamped;
+}
+
+OpusRateController::OpusRateController(const OpusOptions& options)
+    : m_options(clampOpusOptions(options)) {
+    m_target.bitrate = m_options.startBitrate;
+}
+
+void OpusRateController::setOptions(const OpusOptions& options) {
+    m_options = clampOpusOptions(options);
+    m_target.bitrate = std::clamp(m_target.bitrate, m_options.minBitrate, m_options.maxBitrate);
+    m_dirty = true;
+}
+
+void OpusRateController::reset() {
+    m_hasBaseline = false;
+    m_minRttMs = 0;
+    m_dirty = true;
+}
+
+bool OpusRateController::update(const RtcpTxSample& sample, OpusTarget* target) {
+    if (!m_hasBaseline || sample.packetsSent < m_lastSent) {
+        // Primeiro relatório (ou contadores reiniciados): só a linha de base
+        m_hasBaseline = true;
+        m_lastReports = sample.reports;
+        m_lastSent = sample.packetsSent;
+        m_lastLost = sample.packetsLost;
+    } else if (sample.reports != m_lastReports) {
+        uint32_t sent = sample.packetsSent - m_lastSent;
+        uint32_t lost = sample.packetsLost >= m_lastLost ? sample.packetsLost - m_lastLost : 0;
+        if (sent + lost >= kMinIntervalPackets) {
+            double fraction = static_cast<double>(lost) / static_cast<double>(sent + lost);
+            double weight = fraction > m_loss ? kLossRiseWeight : kLossFallWeight;
+            m_loss += weight * (fraction - m_loss);
+            m_lastReports = sample.reports;
+            m_lastSent = sample.packetsSent;
+            m_lastLost = sample.packetsLost;
+
+            if (sample.rttMs > 0 && (m_minRttMs == 0 || sample.rttMs < m_minRttMs)) {
+                m_minRttMs = sample.rttMs;
+            }
+            bool queueing = sample.rttMs > 0 && m_minRttMs > 0 && sample.rttMs - m_minRttMs > kQueueingRttMs;
+
+            unsigned bitrate = m_target.bitrate;
+            if (m_loss >= kCongestionLoss || queueing) {
+                bitrate = static_cast<unsigned>(bitrate * kDecreaseFactor);
+            } else if (m_loss >= kLowLoss) {
+                // Perda aleatória: a FEC precisa de bits para não cair para banda estreita
+                bitrate = std::max(bitrate + kIncreaseStep, kFecFloorBitrate);
+            } else {
+                bitrate += kIncreaseStep;
+            }
+            m_target.bitrate = std::clamp(bitrate, m_options.minBitrate, m_options.maxBitrate);
+            m_target.packetLossPercent = m_loss < kLowLoss / 2
+                ? 0
+                : std::min(kMaxLossPercent, static_cast<unsigned>(std::ceil(m_loss * 125.0)));
+        }
+    }
+
+    bool changed = m_dirty ||
+        static_cast<unsigned>(std::abs(static_cast<int>(m_target.bitrate) - static_cast<int>(m_applied.bitrate))) >=
+            kMinBitrateChange ||
+        static_cast<unsigned>(std::abs(static_cast<int>(m_target.packetLossPercent) -
+                                       static_cast<int>(m_applied.packetLossPercent))) >= kMinLossPercentChange;
+    if (!changed) {
+        return false;
+    }
+
+    m_dirty = false;
+    m_applied = m_target;
+    if (target) *target = m_target;
+    return true;
+}
+
+} // namespace echo
@@ -0,0 +1,108 @@
+/**
+ * @file opus_rate_controller.h
+ * @brief Adaptação do bitrate do Opus a partir dos relatórios RTCP
+ *
+ * Este arquivo define o OpusRateController, alimentado periodicamente
+ * com os contadores de transmissão que o outro lado devolve nos
+ * Receiver Reports (pacotes enviados, perdidos e RTT). A perda de cada
+ * intervalo é suavizada (sobe rápido, desce devagar) e define:
+ *
+ *   - a perda esperada informada ao codificador, que dimensiona a FEC
+ *     in-band (com folga de 25% sobre a perda medida);
+ *   - o bitrate: cresce aos poucos com perda baixa, é mantido acima do
+ *     piso da FEC com perda aleatória (a FEC do Opus só preserva a banda
+ *     larga com bits suficientes) e cai multiplicativamente quando a
+ *     perda ou o RTT indicam congestionamento.
+ *
+ * Consultas sem Receiver Report novo e intervalos com poucos pacotes
+ * (silêncio com DTX) não alteram a estimativa. O controlador não
+ * depende do PJSIP.
+ */
+
+#ifndef OPUS_RATE_CONTROLLER_H
+#define OPUS_RATE_CONTROLLER_H
+
+#include <cstdint>
+
+namespace echo {
+
+/**
+ * @brief Configuração do Opus
+ */
+struct OpusOptions {
+    bool fec = true;                // FEC in-band (LBRR)
+    bool dtx = true;                // Transmissão descontínua no silêncio
+    unsigned minBitrate = 12000;
+    unsigned maxBitrate = 40000;
+    unsigned startBitrate = 32000;
+};
+
+// Limites aceitos para voz (bps)
+constexpr unsigned kOpusMinBitrate = 8000;
+constexpr unsigned kOpusMaxBitrate = 64000;
+
+/**
+ * @brief Ajusta os limites e garante min <= start <= max
+ */
+OpusOptions clampOpusOptions(const OpusOptions& options);
+
+/**
+ * @brief Contadores de transmissão do último Receiver Report (cumulativos)
+ */
+struct RtcpTxSample {
+    uint32_t reports = 0;           // Receiver Reports recebidos até aqui
+    uint32_t packetsSent = 0;
+    uint32_t packetsLost = 0;
+    double rttMs = 0;               // 0 = ainda sem medida
+};
+
+/**
+ * @brief Parâmetros do codificador decididos pelo controlador
+ */
+struct OpusTarget {
+    unsigned bitrate = 0;
+    unsigned packetLossPercent = 0;
+};
+
+class OpusRateController {
+public:
+    explicit OpusRateController(const OpusOptions& options = OpusOptions());
+
+    /**
+     * @brief Troca os limites; o alvo atual é reenquadrado e reaplicado
+     */
+    void setOptions(const OpusOptions& options);
+
+    /**
+     * @brief Processa um relatório
+     * @param target Recebe o novo alvo quando ele mudou o bastante para ser aplicado
+     * @return true se o alvo deve ser aplicado ao codificador
+     */
+    bool update(const RtcpTxSample& sample, OpusTarget* target);
+
+    /**
+     * @brief Esquece a linha de base (novo stream) mantendo o alvo atual
+     */
+    void reset();
+
+    const OpusTarget& target() const { return m_target; }
+    const OpusOptions& options() const { return m_options; }
+    double lossFraction() const { return m_loss; }
+
+private:
+    OpusOptions m_options;
+    OpusTarget m_target;
+    OpusTarget m_applied;
+    bool m_dirty = true;            // Alvo ainda não aplicado
+
+    bool m_hasBaseline = false;
+    uint32_t m_lastReports = 0;
+    uint32_t m_lastSent = 0;
+    uint32_t m_lastLost = 0;
+    double m_loss = 0;              // Fração suavizada
+    double m_minRttMs = 0;
+};
+
+} // namespace echo
+
+#endif // OPUS_RATE_CONTROLLER_H
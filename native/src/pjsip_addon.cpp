@@ -10,12 +10,62 @@
 #include "sip_engine.h"
 #include "audio_device.h"
 #include "event_emitter.h"
+#include "log_sink.h"
+#include "metrics.h"
+#include "resource_usage.h"
+#include "state_mirror.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
 #include <memory>
+#include <mutex>
 
 namespace {
 
-// Instância global do SipEngine
-std::unique_ptr<echo::SipEngine> g_engine;
+/**
+ * Estado do addon em um ambiente Node (thread principal ou worker_thread)
+ *
+ * Guardado como instance data do ambiente e encerrado pelo cleanup hook
+ * dele. O PJSUA é único no processo: só um ambiente por vez é dono de um
+ * engine; nos demais os comandos retornam false.
+ *
+ * Posse: carregar o addon não toma a posse; o primeiro init/initAsync/
+ * prewarm do ambiente toma, se estiver livre. Ela é devolvida por destroy
+ * ou quando o ambiente dono é encerrado (fim do worker ou do processo): o
+ * cleanup hook encerra o PJSUA antes de liberar a posse, e o próximo init
+ * de qualquer ambiente cria um engine novo.
+ */
+struct AddonData {
+    std::shared_ptr<echo::SipEngine> engine;
+    std::shared_ptr<echo::EventEmitterManager> events = std::make_shared<echo::EventEmitterManager>();
+    
+    // Espelho de estado e o ArrayBuffer em que ele escreve (criados no
+    // primeiro getStateMirror; passam de um engine para o seguinte)
+    std::shared_ptr<echo::StateMirror> stateMirror;
+    Napi::Reference<Napi::ArrayBuffer> stateMirrorBuffer;
+    
+    // Histórico de chamadas e diretório de contatos do ambiente: carregados
+    // uma vez e emprestados a cada engine, sobrevivem ao destroy/init de
+    // uma reconexão
+    std::shared_ptr<echo::CallLog> callLog = std::make_shared<echo::CallLog>();
+    std::shared_ptr<echo::ContactIndex> contacts = std::make_shared<echo::ContactIndex>();
+};
+
+// Ambiente dono do engine
+std::mutex g_engineOwnerMutex;
+AddonData* g_engineOwner = nullptr;
+
+AddonData& addonData(Napi::Env env) {
+    return *env.GetInstanceData<AddonData>();
+}
+
+void releaseEngineOwnership(AddonData& data) {
+    std::lock_guard<std::mutex> lock(g_engineOwnerMutex);
+    if (g_engineOwner == &data) {
+        g_engineOwner = nullptr;
+    }
+}
 
 // Helper para converter SipConnectionState para string
 std::string connectionStateToString(echo::SipConnectionState state) {
@@ -45,378 +95,2029 @@ std::string callStateToString(echo::CallState state) {
     }
 }
 
-// Helper para converter CallDirection para string
-std::string callDirectionToString(echo::CallDirection dir) {
-    switch (dir) {
-        case echo::CallDirection::None: return "none";
-        case echo::CallDirection::Outgoing: return "outgoing";
-        case echo::CallDirection::Incoming: return "incoming";
-        default: return "unknown";
-    }
+// Helper para converter CallDirection para string
+std::string callDirectionToString(echo::CallDirection dir) {
+    switch (dir) {
+        case echo::CallDirection::None: return "none";
+        case echo::CallDirection::Outgoing: return "outgoing";
+        case echo::CallDirection::Incoming: return "incoming";
+        default: return "unknown";
+    }
+}
+
+// Helper para escapar uma string em JSON
+std::string jsonEscape(const std::string& value) {
+    std::string out;
+    out.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: out += c; break;
+        }
+    }
+    return out;
+}
+
+// Helper para converter o resultado vindo do renderer
+echo::CallLogStatus callLogStatusFromString(const std::string& status) {
+    if (status == "answered") return echo::CallLogStatus::Answered;
+    if (status == "completed") return echo::CallLogStatus::Completed;
+    if (status == "missed") return echo::CallLogStatus::Missed;
+    if (status == "rejected") return echo::CallLogStatus::Rejected;
+    return echo::CallLogStatus::Failed;
+}
+
+// Helper para converter um registro do histórico (mesmo formato de CallHistoryEntry)
+Napi::Object callRecordToObject(Napi::Env env, const echo::CallRecord& record) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("id", std::to_string(record.id));
+    obj.Set("number", record.number);
+    if (!record.displayName.empty()) {
+        obj.Set("displayName", record.displayName);
+    }
+    obj.Set("direction", record.direction == echo::CallLogDirection::Incoming ? "incoming" : "outgoing");
+    obj.Set("status", echo::callLogStatusName(record.status));
+    obj.Set("startTime", static_cast<double>(record.startTimeMs));
+    if (record.ringTimeMs != 0) {
+        obj.Set("ringTime", static_cast<double>(record.ringTimeMs));
+    }
+    if (record.answerTimeMs != 0) {
+        obj.Set("answerTime", static_cast<double>(record.answerTimeMs));
+    }
+    if (record.endTimeMs != 0) {
+        obj.Set("endTime", static_cast<double>(record.endTimeMs));
+        obj.Set("duration", static_cast<double>((record.endTimeMs - record.startTimeMs) / 1000));
+    }
+    obj.Set("sipStatus", record.sipStatus);
+    if (!record.codec.empty()) {
+        obj.Set("codec", record.codec);
+    }
+    if (!record.account.empty()) {
+        obj.Set("account", record.account);
+    }
+    if (record.transfer != echo::CallTransfer::None) {
+        obj.Set("transfer", echo::callTransferName(record.transfer));
+        obj.Set("transferStatus", record.transferStatus);
+    }
+    return obj;
+}
+
+// Helper para ler um número opcional de um objeto JS
+int64_t optionalInt64(const Napi::Object& obj, const char* key) {
+    Napi::Value value = obj.Get(key);
+    return value.IsNumber() ? value.As<Napi::Number>().Int64Value() : 0;
+}
+
+// Helper para ler uma string opcional de um objeto JS
+std::string optionalString(const Napi::Object& obj, const char* key) {
+    Napi::Value value = obj.Get(key);
+    return value.IsString() ? value.As<Napi::String>().Utf8Value() : std::string();
+}
+
+// Helper para converter snapshot para objeto JS
+Napi::Object snapshotToObject(Napi::Env env, const echo::SipSnapshot& snap) {
+    Napi::Object obj = Napi::Object::New(env);
+    
+    obj.Set("connection", connectionStateToString(snap.connection));
+    obj.Set("callStatus", callStateToString(snap.callStatus));
+    obj.Set("callDirection", callDirectionToString(snap.callDirection));
+    obj.Set("muted", snap.muted);
+    obj.Set("lastError", snap.lastError.c_str());
+    obj.Set("username", snap.username.c_str());
+    obj.Set("domain", snap.domain.c_str());
+    
+    if (!snap.remoteUri.empty()) {
+        obj.Set("remoteUri", snap.remoteUri.c_str());
+    }
+    
+    if (snap.timings.dialStart != 0 || snap.timings.inviteReceived != 0) {
+        Napi::Object timings = Napi::Object::New(env);
+        timings.Set("postDialDelayMs", snap.timings.postDialDelayMs());
+        timings.Set("setupTimeMs", snap.timings.setupTimeMs());
+        timings.Set("answerToMediaMs", snap.timings.answerToMediaMs());
+        timings.Set("alertingDelayMs", snap.timings.alertingDelayMs());
+        obj.Set("timings", timings);
+    }
+    
+    if (!snap.incoming.user.empty()) {
+        Napi::Object incoming = Napi::Object::New(env);
+        incoming.Set("displayName", snap.incoming.displayName.c_str());
+        incoming.Set("user", snap.incoming.user.c_str());
+        incoming.Set("uri", snap.incoming.uri.c_str());
+        if (!snap.incoming.contactName.empty()) {
+            incoming.Set("contactName", snap.incoming.contactName.c_str());
+        }
+        obj.Set("incoming", incoming);
+    }
+    
+    return obj;
+}
+
+// Helper para converter resumo de histograma para objeto JS
+Napi::Object histogramSummaryToObject(Napi::Env env, const echo::LatencyHistogram::Summary& summary) {
+    Napi::Object obj = Napi::Object::New(env);
+    
+    obj.Set("count", static_cast<double>(summary.count));
+    obj.Set("minMs", summary.minMs);
+    obj.Set("maxMs", summary.maxMs);
+    obj.Set("meanMs", summary.meanMs);
+    obj.Set("p50Ms", summary.p50Ms);
+    obj.Set("p90Ms", summary.p90Ms);
+    obj.Set("p99Ms", summary.p99Ms);
+    
+    return obj;
+}
+
+/**
+ * Comando para o thread SIP do engine
+ *
+ * As variantes síncronas aguardam o resultado, as variantes *Async
+ * retornam uma Promise. Comando inválido = argumentos inválidos (exceção
+ * JavaScript já lançada).
+ *
+ * Sem toValue o resultado é o bool de action; com ele, o valor é montado no
+ * thread principal a partir do que action deixou em estado compartilhado.
+ */
+struct SipCommand {
+    std::shared_ptr<echo::SipEngine> engine;
+    std::function<bool(echo::SipEngine&)> action;
+    std::function<Napi::Value(Napi::Env, bool)> toValue;
+    bool valid = false;
+};
+
+// Resultado de um comando assíncrono, entregue ao thread principal
+struct AsyncCommandResult {
+    std::shared_ptr<echo::SipEngine> engine;
+    std::function<Napi::Value(Napi::Env, bool)> toValue;
+    bool value = false;
+};
+
+Napi::Value commandValue(Napi::Env env, const std::function<Napi::Value(Napi::Env, bool)>& toValue, bool value) {
+    return toValue ? toValue(env, value) : Napi::Boolean::New(env, value);
+}
+
+/**
+ * Executa o comando e retorna o resultado (bloqueia o thread do Node)
+ */
+Napi::Value runCommandSync(Napi::Env env, const SipCommand& command) {
+    if (!command.valid) {
+        return env.Undefined();
+    }
+    if (!command.engine) {
+        return commandValue(env, command.toValue, false);
+    }
+    
+    echo::SipEngine& engine = *command.engine;
+    bool result = engine.execute([&engine, &command]() {
+        return command.action(engine);
+    });
+    return commandValue(env, command.toValue, result);
+}
+
+/**
+ * Enfileira o comando e retorna uma Promise resolvida com o resultado
+ */
+Napi::Value runCommandAsync(Napi::Env env, const SipCommand& command) {
+    if (!command.valid) {
+        return env.Undefined();
+    }
+    
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    if (!command.engine) {
+        deferred.Resolve(commandValue(env, command.toValue, false));
+        return deferred.Promise();
+    }
+    
+    // A Promise só pode ser resolvida no thread principal: cada comando
+    // usa uma ThreadSafeFunction própria para devolver o resultado
+    Napi::ThreadSafeFunction tsfn = Napi::ThreadSafeFunction::New(
+        env,
+        Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+        "SipCommand",
+        0,
+        1
+    );
+    
+    // A referência ao engine viaja com o resultado e é liberada no thread
+    // principal: o engine nunca é destruído pelo próprio thread SIP
+    AsyncCommandResult* result = new AsyncCommandResult();
+    result->engine = command.engine;
+    result->toValue = command.toValue;
+    
+    echo::SipEngine* engine = command.engine.get();
+    std::function<bool(echo::SipEngine&)> action = command.action;
+    
+    bool posted = engine->post([engine, action, result, deferred, tsfn]() mutable {
+        result->value = action(*engine);
+        
+        napi_status status = tsfn.BlockingCall(result, [deferred](Napi::Env env, Napi::Function, AsyncCommandResult* result) {
+            deferred.Resolve(commandValue(env, result->toValue, result->value));
+            delete result;
+        });
+        // Se o ambiente já está sendo finalizado o resultado é abandonado
+        // em vez de liberar o engine neste thread
+        (void)status;
+        tsfn.Release();
+    });
+    
+    if (!posted) {
+        delete result;
+        tsfn.Release();
+        deferred.Reject(Napi::Error::New(env, "Thread SIP encerrado").Value());
+    }
+    
+    return deferred.Promise();
+}
+
+// Obtém o engine do ambiente, criando-o e tomando a posse do PJSUA se
+// necessário (nullptr se outro ambiente é o dono). Só init e prewarm tomam
+// a posse; os demais comandos usam o engine já criado
+std::shared_ptr<echo::SipEngine> claimEngine(Napi::Env env) {
+    AddonData& data = addonData(env);
+    if (!data.engine) {
+        {
+            std::lock_guard<std::mutex> lock(g_engineOwnerMutex);
+            if (g_engineOwner && g_engineOwner != &data) {
+                return nullptr;
+            }
+            g_engineOwner = &data;
+        }
+        data.engine = std::make_shared<echo::SipEngine>(data.callLog, data.contacts);
+        data.engine->setJsonEventSink([events = data.events](const std::string& event, const std::string& json) {
+            events->emit(event, json);
+        });
+        if (data.stateMirror) {
+            data.engine->setStateMirror(data.stateMirror);
+        }
+    }
+    return data.engine;
+}
+
+// Engine atual do ambiente (pode ser nullptr)
+std::shared_ptr<echo::SipEngine> currentEngine(Napi::Env env) {
+    return addonData(env).engine;
+}
+
+// Comando para o engine atual (resultado false se não existir)
+SipCommand engineCommand(Napi::Env env, const std::function<bool(echo::SipEngine&)>& action) {
+    SipCommand command;
+    command.engine = currentEngine(env);
+    command.action = action;
+    command.valid = true;
+    return command;
+}
+
+// Comando que recebe um destino string no primeiro argumento
+SipCommand targetCommand(const Napi::CallbackInfo& info, const char* error,
+                         bool (echo::SipEngine::*method)(const std::string&)) {
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(info.Env(), error).ThrowAsJavaScriptException();
+        return SipCommand();
+    }
+    
+    std::string target = info[0].As<Napi::String>().Utf8Value();
+    return engineCommand(info.Env(), [target, method](echo::SipEngine& engine) {
+        return (engine.*method)(target);
+    });
+}
+
+SipCommand callIdCommand(const Napi::CallbackInfo& info, bool (echo::SipEngine::*method)(int)) {
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(info.Env(), "Id da chamada é obrigatório").ThrowAsJavaScriptException();
+        return SipCommand();
+    }
+    
+    int callId = info[0].As<Napi::Number>().Int32Value();
+    return engineCommand(info.Env(), [callId, method](echo::SipEngine& engine) {
+        return (engine.*method)(callId);
+    });
+}
+
+SipCommand initCommand(const Napi::CallbackInfo& info) {
+    claimEngine(info.Env());
+    return engineCommand(info.Env(), [](echo::SipEngine& engine) {
+        return engine.init();
+    });
+}
+
+SipCommand destroyCommand(const Napi::CallbackInfo& info) {
+    // O engine sai do ambiente imediatamente; a destruição do PJSUA
+    // acontece no thread SIP e o objeto é liberado no thread do ambiente
+    AddonData& data = addonData(info.Env());
+    SipCommand command = engineCommand(info.Env(), [](echo::SipEngine& engine) {
+        engine.destroy();
+        return true;
+    });
+    data.engine.reset();
+    data.events->clear();
+    releaseEngineOwnership(data);
+    
+    return command;
+}
+
+SipCommand registerCommand(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Credenciais são obrigatórias").ThrowAsJavaScriptException();
+        return SipCommand();
+    }
+    
+    
+    Napi::Object creds = info[0].As<Napi::Object>();
+    
+    echo::SipCredentials credentials;
+    credentials.username = creds.Get("username").As<Napi::String>().Utf8Value();
+    credentials.password = creds.Get("password").As<Napi::String>().Utf8Value();
+    credentials.server = creds.Get("server").As<Napi::String>().Utf8Value();
+    credentials.port = creds.Has("port") ? creds.Get("port").As<Napi::Number>().Int32Value() : 5060;
+    credentials.transport = creds.Has("transport") ? creds.Get("transport").As<Napi::String>().Utf8Value() : "udp";
+    
+    return engineCommand(env, [credentials](echo::SipEngine& engine) {
+        return engine.registerAccount(credentials);
+    });
+}
+
+SipCommand unregisterCommand(const Napi::CallbackInfo& info) {
+    return engineCommand(info.Env(), [](echo::SipEngine& engine) { return engine.unregister(); });
+}
+
+SipCommand makeCallCommand(const Napi::CallbackInfo& info) {
+    return targetCommand(info, "Destino é obrigatório", &echo::SipEngine::makeCall);
+}
+
+SipCommand answerCallCommand(const Napi::CallbackInfo& info) {
+    return engineCommand(info.Env(), [](echo::SipEngine& engine) { return engine.answerCall(); });
+}
+
+SipCommand rejectCallCommand(const Napi::CallbackInfo& info) {
+    return engineCommand(info.Env(), [](echo::SipEngine& engine) { return engine.rejectCall(); });
+}
+
+SipCommand hangupCallCommand(const Napi::CallbackInfo& info) {
+    return engineCommand(info.Env(), [](echo::SipEngine& engine) { return engine.hangupCall(); });
+}
+
+// Helper para ler { method, toneMs, gapMs, pauseMs } (ausentes mantêm o padrão)
+bool dtmfOptionsFromObject(Napi::Env env, const Napi::Object& obj, echo::DtmfOptions* options) {
+    if (obj.Has("method") && obj.Get("method").IsString()) {
+        std::string method = obj.Get("method").As<Napi::String>().Utf8Value();
+        if (!echo::dtmfMethodFromName(method, &options->method)) {
+            Napi::TypeError::New(env, "Método DTMF inválido: " + method).ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+    if (obj.Has("toneMs") && obj.Get("toneMs").IsNumber()) {
+        options->toneMs = obj.Get("toneMs").As<Napi::Number>().Uint32Value();
+    }
+    if (obj.Has("gapMs") && obj.Get("gapMs").IsNumber()) {
+        options->gapMs = obj.Get("gapMs").As<Napi::Number>().Uint32Value();
+    }
+    if (obj.Has("pauseMs") && obj.Get("pauseMs").IsNumber()) {
+        options->pauseMs = obj.Get("pauseMs").As<Napi::Number>().Uint32Value();
+    }
+    return true;
+}
+
+SipCommand sendDtmfCommand(const Napi::CallbackInfo& info) {
+    if (info.Length() < 2 || !info[1].IsObject()) {
+        return targetCommand(info, "Dígitos DTMF são obrigatórios", &echo::SipEngine::sendDtmf);
+    }
+    if (!info[0].IsString()) {
+        Napi::TypeError::New(info.Env(), "Dígitos DTMF são obrigatórios").ThrowAsJavaScriptException();
+        return SipCommand();
+    }
+    
+    echo::DtmfOptions options;
+    if (!dtmfOptionsFromObject(info.Env(), info[1].As<Napi::Object>(), &options)) {
+        return SipCommand();
+    }
+    
+    std::string digits = info[0].As<Napi::String>().Utf8Value();
+    return engineCommand(info.Env(), [digits, options](echo::SipEngine& engine) {
+        return engine.playDtmf(digits, options);
+    });
+}
+
+SipCommand transferBlindCommand(const Napi::CallbackInfo& info) {
+    return targetCommand(info, "Destino é obrigatório", &echo::SipEngine::transferBlind);
+}
+
+SipCommand transferAttendedCommand(const Napi::CallbackInfo& info) {
+    return targetCommand(info, "Destino é obrigatório", &echo::SipEngine::transferAttended);
+}
+
+SipCommand startConsultCommand(const Napi::CallbackInfo& info) {
+    return targetCommand(info, "Destino é obrigatório", &echo::SipEngine::startConsult);
+}
+
+SipCommand swapTransferLegsCommand(const Napi::CallbackInfo& info) {
+    return engineCommand(info.Env(), [](echo::SipEngine& engine) { return engine.swapTransferLegs(); });
+}
+
+SipCommand completeTransferCommand(const Napi::CallbackInfo& info) {
+    return engineCommand(info.Env(), [](echo::SipEngine& engine) { return engine.completeTransfer(); });
+}
+
+SipCommand cancelTransferCommand(const Napi::CallbackInfo& info) {
+    return engineCommand(info.Env(), [](echo::SipEngine& engine) { return engine.cancelTransfer(); });
+}
+
+SipCommand holdCommand(const Napi::CallbackInfo& info) {
+    return callIdCommand(info, &echo::SipEngine::holdCall);
+}
+
+SipCommand resumeCommand(const Napi::CallbackInfo& info) {
+    return callIdCommand(info, &echo::SipEngine::resumeCall);
+}
+
+SipCommand setAudioDevicesCommand(const Napi::CallbackInfo& info) {
+    if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+        Napi::TypeError::New(info.Env(), "IDs dos dispositivos são obrigatórios").ThrowAsJavaScriptException();
+        return SipCommand();
+    }
+    
+    int captureId = info[0].As<Napi::Number>().Int32Value();
+    int playbackId = info[1].As<Napi::Number>().Int32Value();
+    
+    return engineCommand(info.Env(), [captureId, playbackId](echo::SipEngine& engine) {
+        return engine.setAudioDevices(captureId, playbackId);
+    });
+}
+
+SipCommand setInbandDtmfDetectionCommand(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsBoolean()) {
+        Napi::TypeError::New(env, "Valor booleano é obrigatório").ThrowAsJavaScriptException();
+        return SipCommand();
+    }
+    
+    bool enabled = info[0].As<Napi::Boolean>().Value();
+    return engineCommand(env, [enabled](echo::SipEngine& engine) {
+        engine.setInbandDtmfDetection(enabled);
+        return true;
+    });
+}
+
+SipCommand setDtmfOptionsCommand(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Objeto de opções é obrigatório").ThrowAsJavaScriptException();
+        return SipCommand();
+    }
+    
+    echo::DtmfOptions options;
+    if (!dtmfOptionsFromObject(env, info[0].As<Napi::Object>(), &options)) {
+        return SipCommand();
+    }
+    
+    return engineCommand(env, [options](echo::SipEngine& engine) {
+        engine.setDtmfOptions(options);
+        return true;
+    });
+}
+
+SipCommand setHoldMusicCommand(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Caminho é obrigatório").ThrowAsJavaScriptException();
+        return SipCommand();
+    }
+    
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    return engineCommand(env, [path](echo::SipEngine& engine) {
+        return engine.setHoldMusic(path);
+    });
+}
+
+SipCommand setMutedCommand(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsBoolean()) {
+        Napi::TypeError::New(env, "Valor boolean é obrigatório").ThrowAsJavaScriptException();
+        return SipCommand();
+    }
+    
+    bool muted = info[0].As<Napi::Boolean>().Value();
+    return engineCommand(env, [muted](echo::SipEngine& engine) {
+        engine.setMuted(muted);
+        return true;
+    });
+}
+
+SipCommand setAudioPowerPolicyCommand(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Objeto de opções é obrigatório").ThrowAsJavaScriptException();
+        return SipCommand();
+    }
+    
+    Napi::Object options = info[0].As<Napi::Object>();
+    echo::AudioPowerPolicy policy;
+    
+    if (options.Has("idleCloseSeconds") && options.Get("idleCloseSeconds").IsNumber()) {
+        policy.idleCloseSeconds = options.Get("idleCloseSeconds").As<Napi::Number>().Int32Value();
+    }
+    if (options.Has("nullDeviceWhenIdle") && options.Get("nullDeviceWhenIdle").IsBoolean()) {
+        policy.nullDeviceWhenIdle = options.Get("nullDeviceWhenIdle").As<Napi::Boolean>().Value();
+    }
+    
+    return engineCommand(env, [policy](echo::SipEngine& engine) {
+        engine.setAudioPowerPolicy(policy);
+        return true;
+    });
+}
+
+SipCommand setCaptureProcessingCommand(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Objeto de opções é obrigatório").ThrowAsJavaScriptException();
+        return SipCommand();
+    }
+    
+    Napi::Object options = info[0].As<Napi::Object>();
+    echo::CaptureStages stages;
+    unsigned budgetPercent = echo::kCaptureDefaultBudgetPercent;
+    
+    if (options.Has("highPass") && options.Get("highPass").IsBoolean()) {
+        stages.highPass = options.Get("highPass").As<Napi::Boolean>().Value();
+    }
+    if (options.Has("noiseSuppression") && options.Get("noiseSuppression").IsBoolean()) {
+        stages.noiseSuppression = options.Get("noiseSuppression").As<Napi::Boolean>().Value();
+    }
+    if (options.Has("agc") && options.Get("agc").IsBoolean()) {
+        stages.agc = options.Get("agc").As<Napi::Boolean>().Value();
+    }
+    if (options.Has("budgetPercent") && options.Get("budgetPercent").IsNumber()) {
+        budgetPercent = options.Get("budgetPercent").As<Napi::Number>().Uint32Value();
+    }
+    
+    return engineCommand(env, [stages, budgetPercent](echo::SipEngine& engine) {
+        return engine.setCaptureProcessing(stages, budgetPercent);
+    });
+}
+
+SipCommand setOpusOptionsCommand(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Objeto de opções é obrigatório").ThrowAsJavaScriptException();
+        return SipCommand();
+    }
+    
+    Napi::Object options = info[0].As<Napi::Object>();
+    echo::OpusOptions opus;
+    
+    if (options.Has("fec") && options.Get("fec").IsBoolean()) {
+        opus.fec = options.Get("fec").As<Napi::Boolean>().Value();
+    }
+    if (options.Has("dtx") && options.Get("dtx").IsBoolean()) {
+        opus.dtx = options.Get("dtx").As<Napi::Boolean>().Value();
+    }
+    if (options.Has("minBitrate") && options.Get("minBitrate").IsNumber()) {
+        opus.minBitrate = options.Get("minBitrate").As<Napi::Number>().Uint32Value();
+    }
+    if (options.Has("maxBitrate") && options.Get("maxBitrate").IsNumber()) {
+        opus.maxBitrate = options.Get("maxBitrate").As<Napi::Number>().Uint32Value();
+    }
+    if (options.Has("startBitrate") && options.Get("startBitrate").IsNumber()) {
+        opus.startBitrate = options.Get("startBitrate").As<Napi::Number>().Uint32Value();
+    }
+    
+    return engineCommand(env, [opus](echo::SipEngine& engine) {
+        return engine.setOpusOptions(opus);
+    });
+}
+
+SipCommand setVadOptionsCommand(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Objeto de opções é obrigatório").ThrowAsJavaScriptException();
+        return SipCommand();
+    }
+    
+    Napi::Object options = info[0].As<Napi::Object>();
+    echo::VadOptions vad;
+    
+    if (options.Has("enabled") && options.Get("enabled").IsBoolean()) {
+        vad.enabled = options.Get("enabled").As<Napi::Boolean>().Value();
+    }
+    if (options.Has("hangoverMs") && options.Get("hangoverMs").IsNumber()) {
+        vad.hangoverMs = options.Get("hangoverMs").As<Napi::Number>().Uint32Value();
+    }
+    if (options.Has("thresholdDb") && options.Get("thresholdDb").IsNumber()) {
+        vad.thresholdDb = options.Get("thresholdDb").As<Napi::Number>().Uint32Value();
+    }
+    if (options.Has("codecs") && options.Get("codecs").IsArray()) {
+        Napi::Array codecs = options.Get("codecs").As<Napi::Array>();
+        for (uint32_t i = 0; i < codecs.Length(); ++i) {
+            Napi::Value codec = codecs.Get(i);
+            if (codec.IsString()) {
+                vad.codecs.push_back(codec.As<Napi::String>().Utf8Value());
+            }
+        }
+    }
+    
+    return engineCommand(env, [vad](echo::SipEngine& engine) {
+        return engine.setVadOptions(vad);
+    });
+}
+
+SipCommand watchExtensionsCommand(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "Lista de ramais é obrigatória").ThrowAsJavaScriptException();
+        return SipCommand();
+    }
+    
+    Napi::Array list = info[0].As<Napi::Array>();
+    std::vector<std::string> extensions;
+    extensions.reserve(list.Length());
+    for (uint32_t i = 0; i < list.Length(); ++i) {
+        Napi::Value extension = list.Get(i);
+        if (extension.IsString()) {
+            extensions.push_back(extension.As<Napi::String>().Utf8Value());
+        }
+    }
+    
+    echo::BlfOptions blf;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (options.Has("listUri") && options.Get("listUri").IsString()) {
+            blf.listUri = options.Get("listUri").As<Napi::String>().Utf8Value();
+        }
+        if (options.Has("batchIntervalMs") && options.Get("batchIntervalMs").IsNumber()) {
+            blf.batchIntervalMs = options.Get("batchIntervalMs").As<Napi::Number>().Uint32Value();
+        }
+        if (options.Has("expiresSeconds") && options.Get("expiresSeconds").IsNumber()) {
+            blf.expiresSeconds = options.Get("expiresSeconds").As<Napi::Number>().Uint32Value();
+        }
+    }
+    
+    return engineCommand(env, [extensions = std::move(extensions), blf](echo::SipEngine& engine) {
+        return engine.watchExtensions(extensions, blf);
+    });
+}
+
+SipCommand setLogLevelCommand(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Nível de log é obrigatório").ThrowAsJavaScriptException();
+        return SipCommand();
+    }
+    
+    int level = info[0].As<Napi::Number>().Int32Value();
+    return engineCommand(env, [level](echo::SipEngine& engine) {
+        return engine.setLogLevel(level);
+    });
+}
+
+SipCommand cancelDtmfCommand(const Napi::CallbackInfo& info) {
+    return engineCommand(info.Env(), [](echo::SipEngine& engine) { return engine.cancelDtmf(); });
+}
+
+SipCommand toggleMutedCommand(const Napi::CallbackInfo& info) {
+    return engineCommand(info.Env(), [](echo::SipEngine& engine) { return engine.toggleMuted(); });
+}
+
+// A lista é obtida no thread SIP e o array montado no thread principal
+SipCommand getAudioDevicesCommand(const Napi::CallbackInfo& info) {
+    auto devices = std::make_shared<std::vector<echo::audio::AudioDeviceInfo>>();
+    SipCommand command = engineCommand(info.Env(), [devices](echo::SipEngine&) {
+        *devices = echo::audio::listAudioDevices();
+        return true;
+    });
+    command.toValue = [devices](Napi::Env env, bool) -> Napi::Value {
+        Napi::Array result = Napi::Array::New(env, devices->size());
+        for (size_t i = 0; i < devices->size(); i++) {
+            const echo::audio::AudioDeviceInfo& device = (*devices)[i];
+            Napi::Object dev = Napi::Object::New(env);
+            dev.Set("id", device.id);
+            dev.Set("name", device.name);
+            dev.Set("inputCount", device.inputCount);
+            dev.Set("outputCount", device.outputCount);
+            dev.Set("isDefault", device.isDefault);
+            result.Set(static_cast<uint32_t>(i), dev);
+        }
+        return result;
+    };
+    return command;
+}
+
+SipCommand loadContactsCommand(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        Napi::TypeError::New(env, "Lista de contatos é obrigatória").ThrowAsJavaScriptException();
+        return SipCommand();
+    }
+    
+    Napi::Array array = info[0].As<Napi::Array>();
+    std::vector<echo::ContactEntry> entries;
+    entries.reserve(array.Length());
+    
+    for (uint32_t i = 0; i < array.Length(); ++i) {
+        Napi::Value item = array.Get(i);
+        if (!item.IsObject()) continue;
+        Napi::Object contact = item.As<Napi::Object>();
+        Napi::Value name = contact.Get("name");
+        Napi::Value number = contact.Get("number");
+        if (!name.IsString() || !number.IsString()) continue;
+        entries.push_back({name.As<Napi::String>().Utf8Value(), number.As<Napi::String>().Utf8Value()});
+    }
+    
+    echo::NumberPlan plan;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (options.Get("countryCode").IsString()) {
+            plan.countryCode = options.Get("countryCode").As<Napi::String>().Utf8Value();
+        }
+        if (options.Get("internationalPrefix").IsString()) {
+            plan.internationalPrefix = options.Get("internationalPrefix").As<Napi::String>().Utf8Value();
+        }
+        if (options.Get("trunkPrefix").IsString()) {
+            plan.trunkPrefix = options.Get("trunkPrefix").As<Napi::String>().Utf8Value();
+        }
+        if (options.Get("carrierCodeLength").IsNumber()) {
+            plan.carrierCodeLength = options.Get("carrierCodeLength").As<Napi::Number>().Int32Value();
+        }
+        if (options.Get("minNationalLength").IsNumber()) {
+            plan.minNationalLength = options.Get("minNationalLength").As<Napi::Number>().Int32Value();
+        }
+        if (options.Get("maxNationalLength").IsNumber()) {
+            plan.maxNationalLength = options.Get("maxNationalLength").As<Napi::Number>().Int32Value();
+        }
+    }
+    
+    auto stats = std::make_shared<echo::ContactIndexStats>();
+    auto load = [entries = std::move(entries), plan, stats, contacts = addonData(env).contacts]() {
+        *stats = contacts->load(entries, plan);
+    };
+    SipCommand command = engineCommand(env, [load](echo::SipEngine&) {
+        load();
+        return true;
+    });
+    // Sem engine (entre destroy e init) o índice é carregado aqui mesmo e
+    // fica pronto para o próximo engine
+    if (!command.engine) {
+        load();
+    }
+    command.toValue = [stats](Napi::Env env, bool) -> Napi::Value {
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("entries", static_cast<double>(stats->entries));
+        obj.Set("skipped", static_cast<double>(stats->skipped));
+        obj.Set("capacity", static_cast<double>(stats->capacity));
+        obj.Set("maxProbe", static_cast<double>(stats->maxProbe));
+        obj.Set("bytes", static_cast<double>(stats->bytes));
+        return obj;
+    };
+    return command;
+}
+
+// Abrir o arquivo e podar rotações antigas pode demorar: roda no thread
+// SIP junto com o nível (ou aqui mesmo, se ainda não há engine)
+SipCommand configureLoggingCommand(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Objeto de opções é obrigatório").ThrowAsJavaScriptException();
+        return SipCommand();
+    }
+    
+    Napi::Object options = info[0].As<Napi::Object>();
+    echo::LogSinkConfig config;
+    
+    if (options.Has("directory") && options.Get("directory").IsString()) {
+        config.directory = options.Get("directory").As<Napi::String>().Utf8Value();
+    }
+    if (options.Has("maxFileSize") && options.Get("maxFileSize").IsNumber()) {
+        config.maxFileSize = static_cast<uint64_t>(options.Get("maxFileSize").As<Napi::Number>().Int64Value());
+    }
+    if (options.Has("maxFiles") && options.Get("maxFiles").IsNumber()) {
+        config.maxFiles = options.Get("maxFiles").As<Napi::Number>().Uint32Value();
+    }
+    if (options.Has("rateLimits") && options.Get("rateLimits").IsArray()) {
+        Napi::Array limits = options.Get("rateLimits").As<Napi::Array>();
+        for (uint32_t i = 0; i < limits.Length() && i < config.rateLimits.size(); i++) {
+            if (limits.Get(i).IsNumber()) {
+                config.rateLimits[i] = limits.Get(i).As<Napi::Number>().Uint32Value();
+            }
+        }
+    }
+    
+    bool hasLevel = options.Has("level") && options.Get("level").IsNumber();
+    int level = hasLevel ? options.Get("level").As<Napi::Number>().Int32Value() : 0;
+    
+    // Arquivos rotacionados são comprimidos pelo processo principal (o
+    // aviso vai para o ambiente que configurou o log, enquanto ele existir)
+    std::weak_ptr<echo::EventEmitterManager> events = addonData(env).events;
+    auto configure = [config, events]() {
+        echo::LogSink& sink = echo::LogSink::getInstance();
+        sink.configure(config);
+        sink.setRotationCallback([events](const std::string& path) {
+            if (auto manager = events.lock()) {
+                manager->emit("logRotated", "{\"path\":\"" + jsonEscape(path) + "\"}");
+            }
+        });
+    };
+    
+    SipCommand command = engineCommand(env, [configure, hasLevel, level](echo::SipEngine& engine) {
+        configure();
+        return !hasLevel || engine.setLogLevel(level);
+    });
+    if (!command.engine) {
+        configure();
+    }
+    return command;
+}
+
+/**
+ * Inicializa o endpoint PJSIP
+ * @returns {boolean} true se sucesso
+ */
+Napi::Value Init(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.init");
+    return runCommandSync(info.Env(), initCommand(info));
+}
+
+/**
+ * Inicializa o endpoint PJSIP sem bloquear o thread do Node
+ * @returns {Promise<boolean>}
+ */
+Napi::Value InitAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.initAsync");
+    return runCommandAsync(info.Env(), initCommand(info));
+}
+
+/**
+ * Destrói o endpoint PJSIP
+ */
+Napi::Value Destroy(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.destroy");
+    Napi::Env env = info.Env();
+    
+    runCommandSync(env, destroyCommand(info));
+    return env.Undefined();
+}
+
+/**
+ * Destrói o endpoint PJSIP sem bloquear o thread do Node
+ * @returns {Promise<boolean>}
+ */
+Napi::Value DestroyAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.destroyAsync");
+    return runCommandAsync(info.Env(), destroyCommand(info));
+}
+
+/**
+ * Antecipa a inicialização: PJSUA, transporte e dispositivo de som
+ * @param {Object} options - { transport: 'udp' | 'tcp', openSoundDevice: boolean }
+ * @returns {Promise<boolean>}
+ */
+Napi::Value Prewarm(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.prewarm");
+    Napi::Env env = info.Env();
+    
+    std::string transport;
+    bool openSoundDevice = false;
+    
+    if (info.Length() >= 1 && info[0].IsObject()) {
+        Napi::Object options = info[0].As<Napi::Object>();
+        if (options.Has("transport") && options.Get("transport").IsString()) {
+            transport = options.Get("transport").As<Napi::String>().Utf8Value();
+        }
+        if (options.Has("openSoundDevice") && options.Get("openSoundDevice").IsBoolean()) {
+            openSoundDevice = options.Get("openSoundDevice").As<Napi::Boolean>().Value();
+        }
+    }
+    
+    claimEngine(env);
+    return runCommandAsync(env, engineCommand(env, [transport, openSoundDevice](echo::SipEngine& engine) {
+        return engine.prewarm(transport, openSoundDevice);
+    }));
+}
+
+/**
+ * Obtém a linha do tempo da inicialização
+ * @returns {Object} Milissegundos desde a carga do addon por etapa (-1 = não ocorreu)
+ */
+Napi::Value GetStartupTimeline(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.getStartupTimeline");
+    Napi::Env env = info.Env();
+    
+    echo::StartupTimeline timeline;
+    if (auto engine = currentEngine(env)) {
+        timeline = engine->getStartupTimeline();
+    }
+    
+    auto sinceLoad = [&timeline](int64_t mark) {
+        return mark != 0 ? static_cast<double>(mark - timeline.engineCreated) / 1000.0 : -1.0;
+    };
+    
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("pjsuaCreatedMs", sinceLoad(timeline.pjsuaCreated));
+    obj.Set("pjsuaInitializedMs", sinceLoad(timeline.pjsuaInitialized));
+    obj.Set("pjsuaStartedMs", sinceLoad(timeline.pjsuaStarted));
+    obj.Set("transportReadyMs", sinceLoad(timeline.transportReady));
+    obj.Set("soundDeviceOpenMs", sinceLoad(timeline.soundDeviceOpen));
+    obj.Set("registeredMs", sinceLoad(timeline.registered));
+    return obj;
+}
+
+/**
+ * Verifica se está inicializado
+ * @returns {boolean}
+ */
+Napi::Value IsInitialized(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.isInitialized");
+    Napi::Env env = info.Env();
+    
+    auto engine = currentEngine(env);
+    if (!engine) {
+        return Napi::Boolean::New(env, false);
+    }
+    
+    return Napi::Boolean::New(env, engine->isInitialized());
+}
+
+/**
+ * Registra no servidor SIP
+ * @param {Object} credentials - { username, password, server, port, transport }
+ * @returns {boolean} true se registro iniciado
+ */
+Napi::Value Register(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.register");
+    return runCommandSync(info.Env(), registerCommand(info));
+}
+
+/**
+ * Registra no servidor SIP sem bloquear o thread do Node
+ * @param {Object} credentials - { username, password, server, port, transport }
+ * @returns {Promise<boolean>}
+ */
+Napi::Value RegisterAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.registerAsync");
+    return runCommandAsync(info.Env(), registerCommand(info));
+}
+
+/**
+ * Desregistra do servidor SIP
+ * @returns {boolean}
+ */
+Napi::Value Unregister(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.unregister");
+    return runCommandSync(info.Env(), unregisterCommand(info));
+}
+
+/**
+ * Desregistra do servidor SIP sem bloquear o thread do Node
+ * @returns {Promise<boolean>}
+ */
+Napi::Value UnregisterAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.unregisterAsync");
+    return runCommandAsync(info.Env(), unregisterCommand(info));
+}
+
+/**
+ * Inicia uma chamada
+ * @param {string} target - Número ou URI de destino
+ * @returns {boolean}
+ */
+Napi::Value MakeCall(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.makeCall");
+    return runCommandSync(info.Env(), makeCallCommand(info));
+}
+
+/**
+ * Inicia uma chamada sem bloquear o thread do Node
+ * @param {string} target - Número ou URI de destino
+ * @returns {Promise<boolean>}
+ */
+Napi::Value MakeCallAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.makeCallAsync");
+    return runCommandAsync(info.Env(), makeCallCommand(info));
+}
+
+/**
+ * Atende uma chamada entrante
+ * @returns {boolean}
+ */
+Napi::Value AnswerCall(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.answerCall");
+    return runCommandSync(info.Env(), answerCallCommand(info));
+}
+
+/**
+ * Atende uma chamada entrante sem bloquear o thread do Node
+ * @returns {Promise<boolean>}
+ */
+Napi::Value AnswerCallAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.answerCallAsync");
+    return runCommandAsync(info.Env(), answerCallCommand(info));
+}
+
+/**
+ * Rejeita uma chamada entrante
+ * @returns {boolean}
+ */
+Napi::Value RejectCall(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.rejectCall");
+    return runCommandSync(info.Env(), rejectCallCommand(info));
+}
+
+/**
+ * Rejeita uma chamada entrante sem bloquear o thread do Node
+ * @returns {Promise<boolean>}
+ */
+Napi::Value RejectCallAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.rejectCallAsync");
+    return runCommandAsync(info.Env(), rejectCallCommand(info));
+}
+
+/**
+ * Encerra a chamada atual
+ * @returns {boolean}
+ */
+Napi::Value HangupCall(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.hangupCall");
+    return runCommandSync(info.Env(), hangupCallCommand(info));
+}
+
+/**
+ * Encerra a chamada atual sem bloquear o thread do Node
+ * @returns {Promise<boolean>}
+ */
+Napi::Value HangupCallAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.hangupCallAsync");
+    return runCommandAsync(info.Env(), hangupCallCommand(info));
+}
+
+/**
+ * Envia DTMF (enfileirado; progresso em "dtmfProgress" e "dtmfDone")
+ * @param {string} digits - Dígitos DTMF (0-9, *, #, A-D) e pausas (',' ou 'p')
+ * @param {Object} [options] - { method: 'rfc2833'|'info'|'inband', toneMs, gapMs, pauseMs }
+ * @returns {boolean}
+ */
+Napi::Value SendDtmf(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.sendDtmf");
+    return runCommandSync(info.Env(), sendDtmfCommand(info));
+}
+
+/**
+ * Envia DTMF sem bloquear o thread do Node
+ * @param {string} digits - Dígitos DTMF e pausas
+ * @param {Object} [options] - { method, toneMs, gapMs, pauseMs }
+ * @returns {Promise<boolean>}
+ */
+Napi::Value SendDtmfAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.sendDtmfAsync");
+    return runCommandAsync(info.Env(), sendDtmfCommand(info));
+}
+
+/**
+ * Interrompe a sequência de DTMF em reprodução
+ * @returns {boolean}
+ */
+Napi::Value CancelDtmf(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.cancelDtmf");
+    return runCommandSync(info.Env(), cancelDtmfCommand(info));
+}
+
+/**
+ * Interrompe a sequência de DTMF em reprodução sem bloquear o thread do Node
+ * @returns {Promise<boolean>}
+ */
+Napi::Value CancelDtmfAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.cancelDtmfAsync");
+    return runCommandAsync(info.Env(), cancelDtmfCommand(info));
+}
+
+/**
+ * Liga/desliga a detecção de DTMF in-band no áudio recebido
+ * @param {boolean} enabled
+ */
+Napi::Value SetInbandDtmfDetection(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setInbandDtmfDetection");
+    runCommandSync(info.Env(), setInbandDtmfDetectionCommand(info));
+    return info.Env().Undefined();
+}
+
+/**
+ * Liga/desliga a detecção de DTMF in-band no áudio recebido sem bloquear o thread do Node
+ * @param {boolean} enabled
+ * @returns {Promise<boolean>}
+ */
+Napi::Value SetInbandDtmfDetectionAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setInbandDtmfDetectionAsync");
+    return runCommandAsync(info.Env(), setInbandDtmfDetectionCommand(info));
+}
+
+/**
+ * Define o método e as durações padrão do DTMF
+ * @param {Object} options - { method: 'rfc2833'|'info'|'inband', toneMs, gapMs, pauseMs }
+ */
+Napi::Value SetDtmfOptions(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setDtmfOptions");
+    runCommandSync(info.Env(), setDtmfOptionsCommand(info));
+    return info.Env().Undefined();
+}
+
+/**
+ * Define o método e as durações padrão do DTMF sem bloquear o thread do Node
+ * @param {Object} options - { method: 'rfc2833'|'info'|'inband', toneMs, gapMs, pauseMs }
+ * @returns {Promise<boolean>}
+ */
+Napi::Value SetDtmfOptionsAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setDtmfOptionsAsync");
+    return runCommandAsync(info.Env(), setDtmfOptionsCommand(info));
+}
+
+/**
+ * Transferência cega
+ * @param {string} target - Destino da transferência
+ * @returns {boolean}
+ */
+Napi::Value TransferBlind(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.transferBlind");
+    return runCommandSync(info.Env(), transferBlindCommand(info));
+}
+
+/**
+ * Transferência cega sem bloquear o thread do Node
+ * @param {string} target - Destino da transferência
+ * @returns {Promise<boolean>}
+ */
+Napi::Value TransferBlindAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.transferBlindAsync");
+    return runCommandAsync(info.Env(), transferBlindCommand(info));
+}
+
+/**
+ * Transferência assistida
+ * @param {string} target - Destino da transferência
+ * @returns {boolean}
+ */
+Napi::Value TransferAttended(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.transferAttended");
+    return runCommandSync(info.Env(), transferAttendedCommand(info));
+}
+
+/**
+ * Transferência assistida sem bloquear o thread do Node
+ * @param {string} target - Destino da transferência
+ * @returns {Promise<boolean>}
+ */
+Napi::Value TransferAttendedAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.transferAttendedAsync");
+    return runCommandAsync(info.Env(), transferAttendedCommand(info));
+}
+
+/**
+ * Inicia a consulta de uma transferência assistida (a original fica fora da ponte)
+ * @param {string} target - Destino da transferência
+ * @returns {boolean}
+ */
+Napi::Value StartConsult(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.startConsult");
+    return runCommandSync(info.Env(), startConsultCommand(info));
+}
+
+/**
+ * Inicia a consulta sem bloquear o thread do Node
+ * @param {string} target - Destino da transferência
+ * @returns {Promise<boolean>}
+ */
+Napi::Value StartConsultAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.startConsultAsync");
+    return runCommandAsync(info.Env(), startConsultCommand(info));
+}
+
+/**
+ * Alterna o áudio entre a original e a consulta (só reconexões na ponte)
+ * @returns {boolean}
+ */
+Napi::Value SwapTransferLegs(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.swapTransferLegs");
+    return runCommandSync(info.Env(), swapTransferLegsCommand(info));
+}
+
+/**
+ * Alterna o áudio entre a original e a consulta sem bloquear o thread do Node
+ * @returns {Promise<boolean>}
+ */
+Napi::Value SwapTransferLegsAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.swapTransferLegsAsync");
+    return runCommandAsync(info.Env(), swapTransferLegsCommand(info));
+}
+
+/**
+ * Completa a transferência assistida (REFER com Replaces)
+ * @returns {boolean}
+ */
+Napi::Value CompleteTransfer(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.completeTransfer");
+    return runCommandSync(info.Env(), completeTransferCommand(info));
+}
+
+/**
+ * Completa a transferência assistida sem bloquear o thread do Node
+ * @returns {Promise<boolean>}
+ */
+Napi::Value CompleteTransferAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.completeTransferAsync");
+    return runCommandAsync(info.Env(), completeTransferCommand(info));
+}
+
+/**
+ * Desiste da transferência: encerra a consulta e volta à original
+ * @returns {boolean}
+ */
+Napi::Value CancelTransfer(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.cancelTransfer");
+    return runCommandSync(info.Env(), cancelTransferCommand(info));
+}
+
+/**
+ * Desiste da transferência sem bloquear o thread do Node
+ * @returns {Promise<boolean>}
+ */
+Napi::Value CancelTransferAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.cancelTransferAsync");
+    return runCommandAsync(info.Env(), cancelTransferCommand(info));
+}
+
+/**
+ * Coloca uma chamada em espera (sai da ponte, toca a música de espera)
+ * @param {number} callId - Id da chamada
+ * @returns {boolean}
+ */
+Napi::Value Hold(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.hold");
+    return runCommandSync(info.Env(), holdCommand(info));
+}
+
+/**
+ * Coloca uma chamada em espera sem bloquear o thread do Node
+ * @param {number} callId - Id da chamada
+ * @returns {Promise<boolean>}
+ */
+Napi::Value HoldAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.holdAsync");
+    return runCommandAsync(info.Env(), holdCommand(info));
+}
+
+/**
+ * Retoma uma chamada em espera (religada à ponte antes da resposta do re-INVITE)
+ * @param {number} callId - Id da chamada
+ * @returns {boolean}
+ */
+Napi::Value Resume(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.resume");
+    return runCommandSync(info.Env(), resumeCommand(info));
+}
+
+/**
+ * Retoma uma chamada em espera sem bloquear o thread do Node
+ * @param {number} callId - Id da chamada
+ * @returns {Promise<boolean>}
+ */
+Napi::Value ResumeAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.resumeAsync");
+    return runCommandAsync(info.Env(), resumeCommand(info));
+}
+
+/**
+ * Define a música de espera
+ * @param {string} path - WAV PCM 16 bits (vazio desliga)
+ * @returns {boolean}
+ */
+Napi::Value SetHoldMusic(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setHoldMusic");
+    return runCommandSync(info.Env(), setHoldMusicCommand(info));
+}
+
+/**
+ * Define a música de espera sem bloquear o thread do Node
+ * @param {string} path - WAV PCM 16 bits (vazio desliga)
+ * @returns {Promise<boolean>}
+ */
+Napi::Value SetHoldMusicAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setHoldMusicAsync");
+    return runCommandAsync(info.Env(), setHoldMusicCommand(info));
+}
+
+/**
+ * Define mute do microfone
+ * @param {boolean} muted
+ */
+Napi::Value SetMuted(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setMuted");
+    runCommandSync(info.Env(), setMutedCommand(info));
+    return info.Env().Undefined();
+}
+
+/**
+ * Define mute do microfone sem bloquear o thread do Node
+ * @param {boolean} muted
+ * @returns {Promise<boolean>}
+ */
+Napi::Value SetMutedAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setMutedAsync");
+    return runCommandAsync(info.Env(), setMutedCommand(info));
+}
+
+/**
+ * Alterna mute
+ * @returns {boolean} novo estado
+ */
+Napi::Value ToggleMuted(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.toggleMuted");
+    return runCommandSync(info.Env(), toggleMutedCommand(info));
+}
+
+/**
+ * Alterna mute sem bloquear o thread do Node
+ * @returns {Promise<boolean>} novo estado
+ */
+Napi::Value ToggleMutedAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.toggleMutedAsync");
+    return runCommandAsync(info.Env(), toggleMutedCommand(info));
+}
+
+/**
+ * Verifica se está em mute
+ * @returns {boolean}
+ */
+Napi::Value IsMuted(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.isMuted");
+    Napi::Env env = info.Env();
+    
+    auto engine = currentEngine(env);
+    if (!engine) {
+        return Napi::Boolean::New(env, false);
+    }
+    
+    return Napi::Boolean::New(env, engine->isMuted());
+}
+
+/**
+ * Obtém lista de dispositivos de áudio
+ * @returns {Array<string>}
+ */
+Napi::Value GetAudioDevices(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.getAudioDevices");
+    return runCommandSync(info.Env(), getAudioDevicesCommand(info));
+}
+
+/**
+ * Obtém lista de dispositivos de áudio sem bloquear o thread do Node
+ * @returns {Promise<Array>}
+ */
+Napi::Value GetAudioDevicesAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.getAudioDevicesAsync");
+    return runCommandAsync(info.Env(), getAudioDevicesCommand(info));
+}
+
+/**
+ * Define dispositivos de áudio
+ * @param {number} captureDeviceId
+ * @param {number} playbackDeviceId
+ * @returns {boolean}
+ */
+Napi::Value SetAudioDevices(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setAudioDevices");
+    return runCommandSync(info.Env(), setAudioDevicesCommand(info));
+}
+
+/**
+ * Define dispositivos de áudio sem bloquear o thread do Node
+ * @param {number} captureDeviceId
+ * @param {number} playbackDeviceId
+ * @returns {Promise<boolean>}
+ */
+Napi::Value SetAudioDevicesAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setAudioDevicesAsync");
+    return runCommandAsync(info.Env(), setAudioDevicesCommand(info));
+}
+
+/**
+ * Define a política de energia do dispositivo de som
+ * @param {Object} options - { idleCloseSeconds, nullDeviceWhenIdle }
+ */
+Napi::Value SetAudioPowerPolicy(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setAudioPowerPolicy");
+    runCommandSync(info.Env(), setAudioPowerPolicyCommand(info));
+    return info.Env().Undefined();
+}
+
+/**
+ * Define a política de energia do dispositivo de som sem bloquear o thread do Node
+ * @param {Object} options - { idleCloseSeconds, nullDeviceWhenIdle }
+ * @returns {Promise<boolean>}
+ */
+Napi::Value SetAudioPowerPolicyAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setAudioPowerPolicyAsync");
+    return runCommandAsync(info.Env(), setAudioPowerPolicyCommand(info));
+}
+
+/**
+ * Configura o processamento do microfone (campos ausentes ficam ligados)
+ * @param {Object} options - { highPass, noiseSuppression, agc, budgetPercent }
+ * @returns {boolean}
+ */
+Napi::Value SetCaptureProcessing(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setCaptureProcessing");
+    return runCommandSync(info.Env(), setCaptureProcessingCommand(info));
+}
+
+/**
+ * Configura o processamento do microfone (campos ausentes ficam ligados) sem bloquear o thread do Node
+ * @param {Object} options - { highPass, noiseSuppression, agc, budgetPercent }
+ * @returns {Promise<boolean>}
+ */
+Napi::Value SetCaptureProcessingAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setCaptureProcessingAsync");
+    return runCommandAsync(info.Env(), setCaptureProcessingCommand(info));
+}
+
+/**
+ * Configura o Opus (campos ausentes mantêm o padrão)
+ * @param {Object} options - { fec, dtx, minBitrate, maxBitrate, startBitrate }
+ * @returns {boolean}
+ */
+Napi::Value SetOpusOptions(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setOpusOptions");
+    return runCommandSync(info.Env(), setOpusOptionsCommand(info));
+}
+
+/**
+ * Configura o Opus (campos ausentes mantêm o padrão) sem bloquear o thread do Node
+ * @param {Object} options - { fec, dtx, minBitrate, maxBitrate, startBitrate }
+ * @returns {Promise<boolean>}
+ */
+Napi::Value SetOpusOptionsAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setOpusOptionsAsync");
+    return runCommandAsync(info.Env(), setOpusOptionsCommand(info));
+}
+
+/**
+ * Configura o VAD do microfone (campos ausentes mantêm o padrão)
+ * @param {Object} options - { enabled, hangoverMs, thresholdDb, codecs }
+ * @returns {boolean}
+ */
+Napi::Value SetVadOptions(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setVadOptions");
+    return runCommandSync(info.Env(), setVadOptionsCommand(info));
+}
+
+/**
+ * Configura o VAD do microfone (campos ausentes mantêm o padrão) sem bloquear o thread do Node
+ * @param {Object} options - { enabled, hangoverMs, thresholdDb, codecs }
+ * @returns {Promise<boolean>}
+ */
+Napi::Value SetVadOptionsAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setVadOptionsAsync");
+    return runCommandAsync(info.Env(), setVadOptionsCommand(info));
 }
 
-// Helper para converter snapshot para objeto JS
-Napi::Object snapshotToObject(Napi::Env env, const echo::SipSnapshot& snap) {
-    Napi::Object obj = Napi::Object::New(env);
-    
-    obj.Set("connection", connectionStateToString(snap.connection));
-    obj.Set("callStatus", callStateToString(snap.callStatus));
-    obj.Set("callDirection", callDirectionToString(snap.callDirection));
-    obj.Set("muted", snap.muted);
-    obj.Set("lastError", snap.lastError);
-    obj.Set("username", snap.username);
-    obj.Set("domain", snap.domain);
+/**
+ * Obtém os pacotes suprimidos pelo VAD nas chamadas em andamento
+ * @returns {Array} [{ callId, codec, active, suppressedPackets }]
+ */
+Napi::Value GetVadStats(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.getVadStats");
+    Napi::Env env = info.Env();
     
-    if (!snap.remoteUri.empty()) {
-        obj.Set("remoteUri", snap.remoteUri);
+    std::vector<echo::CallVadStats> stats;
+    if (auto engine = currentEngine(env)) {
+        stats = engine->getVadStats();
     }
     
-    if (!snap.incoming.user.empty()) {
-        Napi::Object incoming = Napi::Object::New(env);
-        incoming.Set("displayName", snap.incoming.displayName);
-        incoming.Set("user", snap.incoming.user);
-        incoming.Set("uri", snap.incoming.uri);
-        obj.Set("incoming", incoming);
+    Napi::Array result = Napi::Array::New(env, stats.size());
+    for (size_t i = 0; i < stats.size(); ++i) {
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("callId", stats[i].callId);
+        obj.Set("codec", stats[i].codec);
+        obj.Set("active", stats[i].active);
+        obj.Set("suppressedPackets", static_cast<double>(stats[i].suppressedPackets));
+        result.Set(static_cast<uint32_t>(i), obj);
     }
-    
-    return obj;
+    return result;
 }
 
 /**
- * Inicializa o endpoint PJSIP
- * @returns {boolean} true se sucesso
+ * Obtém os contadores do processamento do microfone
+ * @returns {Object} { requested, active, budgetMicros, frames, overruns, downgrades, lastFrameMicros }
  */
-Napi::Value Init(const Napi::CallbackInfo& info) {
+Napi::Value GetCaptureStats(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.getCaptureStats");
     Napi::Env env = info.Env();
     
-    if (!g_engine) {
-        g_engine = std::make_unique<echo::SipEngine>();
+    echo::CaptureProcessorStats stats;
+    if (auto engine = currentEngine(env)) {
+        stats = engine->getCaptureStats();
     }
     
-    bool result = g_engine->init();
-    return Napi::Boolean::New(env, result);
+    auto stagesToObject = [env](const echo::CaptureStages& stages) {
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("highPass", stages.highPass);
+        obj.Set("noiseSuppression", stages.noiseSuppression);
+        obj.Set("agc", stages.agc);
+        return obj;
+    };
+    
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("requested", stagesToObject(stats.requested));
+    obj.Set("active", stagesToObject(stats.active));
+    obj.Set("budgetMicros", static_cast<double>(stats.budgetMicros));
+    obj.Set("frames", static_cast<double>(stats.frames));
+    obj.Set("overruns", static_cast<double>(stats.overruns));
+    obj.Set("downgrades", static_cast<double>(stats.downgrades));
+    obj.Set("lastFrameMicros", static_cast<double>(stats.lastFrameMicros));
+    return obj;
 }
 
 /**
- * Destrói o endpoint PJSIP
+ * Carrega o diretório de contatos usado na identificação de chamadas
+ * @param {Array} entries - [{ name, number }]
+ * @param {Object} [plan] - { countryCode, internationalPrefix, trunkPrefix, carrierCodeLength, minNationalLength, maxNationalLength }
+ * @returns {Object} { entries, skipped, capacity, maxProbe, bytes }
  */
-Napi::Value Destroy(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
-    
-    if (g_engine) {
-        g_engine->destroy();
-        g_engine.reset();
-    }
-    
-    echo::EventEmitterManager::getInstance().clear();
-    
-    return env.Undefined();
+Napi::Value LoadContacts(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.loadContacts");
+    return runCommandSync(info.Env(), loadContactsCommand(info));
 }
 
 /**
- * Verifica se está inicializado
- * @returns {boolean}
+ * Carrega o diretório de contatos sem bloquear o thread do Node (a tabela
+ * é montada no thread SIP e trocada atomicamente)
+ * @param {Array} entries - [{ name, number }]
+ * @param {Object} [plan] - mesmo formato de loadContacts
+ * @returns {Promise<Object>} { entries, skipped, capacity, maxProbe, bytes }
  */
-Napi::Value IsInitialized(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
-    
-    if (!g_engine) {
-        return Napi::Boolean::New(env, false);
-    }
-    
-    return Napi::Boolean::New(env, g_engine->isInitialized());
+Napi::Value LoadContactsAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.loadContactsAsync");
+    return runCommandAsync(info.Env(), loadContactsCommand(info));
 }
 
 /**
- * Registra no servidor SIP
- * @param {Object} credentials - { username, password, server, port, transport }
- * @returns {boolean} true se registro iniciado
+ * Procura o nome de um número no diretório de contatos
+ * @param {string} number
+ * @returns {string|null}
  */
-Napi::Value Register(const Napi::CallbackInfo& info) {
+Napi::Value LookupContact(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.lookupContact");
     Napi::Env env = info.Env();
     
-    if (info.Length() < 1 || !info[0].IsObject()) {
-        Napi::TypeError::New(env, "Credenciais são obrigatórias").ThrowAsJavaScriptException();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Número é obrigatório").ThrowAsJavaScriptException();
         return env.Undefined();
     }
     
-    if (!g_engine) {
-        g_engine = std::make_unique<echo::SipEngine>();
+    std::string name;
+    if (!addonData(env).contacts->lookup(info[0].As<Napi::String>().Utf8Value(), &name)) {
+        return env.Null();
     }
-    
-    Napi::Object creds = info[0].As<Napi::Object>();
-    
-    echo::SipCredentials credentials;
-    credentials.username = creds.Get("username").As<Napi::String>().Utf8Value();
-    credentials.password = creds.Get("password").As<Napi::String>().Utf8Value();
-    credentials.server = creds.Get("server").As<Napi::String>().Utf8Value();
-    credentials.port = creds.Has("port") ? creds.Get("port").As<Napi::Number>().Int32Value() : 5060;
-    credentials.transport = creds.Has("transport") ? creds.Get("transport").As<Napi::String>().Utf8Value() : "udp";
-    
-    bool result = g_engine->registerAccount(credentials);
-    return Napi::Boolean::New(env, result);
+    return Napi::String::New(env, name);
 }
 
 /**
- * Desregistra do servidor SIP
+ * Monitora ramais por BLF (pacote "dialog"); lista vazia encerra
+ * @param {string[]} extensions - Ramais (parte usuário da URI)
+ * @param {Object} [options] - { listUri, batchIntervalMs, expiresSeconds }
  * @returns {boolean}
  */
-Napi::Value Unregister(const Napi::CallbackInfo& info) {
-    Napi::Env env = info.Env();
-    
-    if (!g_engine) {
-        return Napi::Boolean::New(env, false);
-    }
-    
-    bool result = g_engine->unregister();
-    return Napi::Boolean::New(env, result);
+Napi::Value WatchExtensions(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.watchExtensions");
+    return runCommandSync(info.Env(), watchExtensionsCommand(info));
 }
 
 /**
- * Inicia uma chamada
- * @param {string} target - Número ou URI de destino
- * @returns {boolean}
+ * Monitora ramais por BLF (pacote "dialog"); lista vazia encerra sem bloquear o thread do Node
+ * @param {string[]} extensions - Ramais (parte usuário da URI)
+ * @param {Object} [options] - { listUri, batchIntervalMs, expiresSeconds }
+ * @returns {Promise<boolean>}
  */
-Napi::Value MakeCall(const Napi::CallbackInfo& info) {
+Napi::Value WatchExtensionsAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.watchExtensionsAsync");
+    return runCommandAsync(info.Env(), watchExtensionsCommand(info));
+}
+
+/**
+ * Obtém o estado atual de todos os ramais monitorados
+ * @returns {Array} [{ extension, state }] (state: unknown, idle, ringing, busy)
+ */
+Napi::Value GetBlfStates(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.getBlfStates");
     Napi::Env env = info.Env();
     
-    if (info.Length() < 1 || !info[0].IsString()) {
-        Napi::TypeError::New(env, "Destino é obrigatório").ThrowAsJavaScriptException();
-        return env.Undefined();
+    std::vector<echo::BlfEntry> entries;
+    if (auto engine = currentEngine(env)) {
+        entries = engine->getBlfStates();
     }
     
-    if (!g_engine) {
-        return Napi::Boolean::New(env, false);
+    Napi::Array result = Napi::Array::New(env, entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("extension", entries[i].extension);
+        obj.Set("state", echo::blfStateName(entries[i].state));
+        result.Set(static_cast<uint32_t>(i), obj);
     }
-    
-    std::string target = info[0].As<Napi::String>().Utf8Value();
-    bool result = g_engine->makeCall(target);
-    return Napi::Boolean::New(env, result);
+    return result;
 }
 
 /**
- * Atende uma chamada entrante
- * @returns {boolean}
+ * Obtém os contadores das assinaturas de BLF
+ * @returns {Object} { extensions, subscriptions, active, resourceList, notifies, batches }
  */
-Napi::Value AnswerCall(const Napi::CallbackInfo& info) {
+Napi::Value GetBlfStats(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.getBlfStats");
     Napi::Env env = info.Env();
     
-    if (!g_engine) {
-        return Napi::Boolean::New(env, false);
+    echo::BlfStats stats;
+    if (auto engine = currentEngine(env)) {
+        stats = engine->getBlfStats();
     }
     
-    bool result = g_engine->answerCall();
-    return Napi::Boolean::New(env, result);
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("extensions", static_cast<double>(stats.extensions));
+    result.Set("subscriptions", static_cast<double>(stats.subscriptions));
+    result.Set("active", static_cast<double>(stats.active));
+    result.Set("resourceList", stats.resourceList);
+    result.Set("notifies", static_cast<double>(stats.notifies));
+    result.Set("batches", static_cast<double>(stats.batches));
+    return result;
 }
 
 /**
- * Rejeita uma chamada entrante
+ * Abre o histórico de chamadas (o engine grava cada chamada encerrada)
+ * @param {string} path - Caminho do arquivo
  * @returns {boolean}
  */
-Napi::Value RejectCall(const Napi::CallbackInfo& info) {
+Napi::Value OpenCallLog(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.openCallLog");
     Napi::Env env = info.Env();
     
-    if (!g_engine) {
-        return Napi::Boolean::New(env, false);
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "Caminho do histórico é obrigatório").ThrowAsJavaScriptException();
+        return env.Undefined();
     }
     
-    bool result = g_engine->rejectCall();
+    // Com engine, a falha é informada em lastError do snapshot
+    AddonData& data = addonData(env);
+    std::string path = info[0].As<Napi::String>().Utf8Value();
+    bool result = data.engine ? data.engine->openCallLog(path) : data.callLog->open(path, nullptr);
     return Napi::Boolean::New(env, result);
 }
 
 /**
- * Encerra a chamada atual
- * @returns {boolean}
+ * Consulta o histórico (mais recentes primeiro)
+ * @param {Object} [query] - { before, limit, number, since, until }
+ * @returns {Object} { entries, nextCursor, total }
  */
-Napi::Value HangupCall(const Napi::CallbackInfo& info) {
+Napi::Value QueryCallLog(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.queryCallLog");
     Napi::Env env = info.Env();
     
-    if (!g_engine) {
-        return Napi::Boolean::New(env, false);
+    echo::CallLogQuery query;
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object options = info[0].As<Napi::Object>();
+        std::string before = optionalString(options, "before");
+        if (!before.empty()) {
+            query.beforeId = std::strtoull(before.c_str(), nullptr, 10);
+        }
+        if (options.Get("limit").IsNumber()) {
+            query.limit = static_cast<size_t>(std::max<int64_t>(optionalInt64(options, "limit"), 1));
+        }
+        query.number = optionalString(options, "number");
+        query.sinceMs = optionalInt64(options, "since");
+        query.untilMs = optionalInt64(options, "until");
     }
     
-    bool result = g_engine->hangupCall();
-    return Napi::Boolean::New(env, result);
+    Napi::Object result = Napi::Object::New(env);
+    Napi::Array entries = Napi::Array::New(env);
+    result.Set("entries", entries);
+    result.Set("nextCursor", env.Null());
+    
+    echo::CallLog& log = *addonData(env).callLog;
+    echo::CallLogPage page = log.query(query);
+    for (size_t i = 0; i < page.records.size(); ++i) {
+        entries.Set(static_cast<uint32_t>(i), callRecordToObject(env, page.records[i]));
+    }
+    if (page.nextCursor != 0) {
+        result.Set("nextCursor", std::to_string(page.nextCursor));
+    }
+    result.Set("total", static_cast<double>(log.getStats().records));
+    return result;
 }
 
 /**
- * Envia DTMF
- * @param {string} digits - Dígitos DTMF
- * @returns {boolean}
+ * Acrescenta uma chamada ao histórico (backend WebRTC e migração do histórico antigo)
+ * @param {Object} entry - { number, displayName?, direction, status, startTime, ringTime?, answerTime?, endTime?,
+ *                           sipStatus?, codec?, account?, transfer?, transferStatus? }
+ * @returns {string|null} Id atribuído
  */
-Napi::Value SendDtmf(const Napi::CallbackInfo& info) {
+Napi::Value AppendCallRecord(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.appendCallRecord");
     Napi::Env env = info.Env();
     
-    if (info.Length() < 1 || !info[0].IsString()) {
-        Napi::TypeError::New(env, "Dígitos DTMF são obrigatórios").ThrowAsJavaScriptException();
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Registro de chamada é obrigatório").ThrowAsJavaScriptException();
         return env.Undefined();
     }
     
-    if (!g_engine) {
-        return Napi::Boolean::New(env, false);
+    Napi::Object entry = info[0].As<Napi::Object>();
+    echo::CallRecord record;
+    record.number = optionalString(entry, "number");
+    record.displayName = optionalString(entry, "displayName");
+    record.direction = optionalString(entry, "direction") == "incoming"
+        ? echo::CallLogDirection::Incoming : echo::CallLogDirection::Outgoing;
+    record.status = callLogStatusFromString(optionalString(entry, "status"));
+    record.startTimeMs = optionalInt64(entry, "startTime");
+    record.ringTimeMs = optionalInt64(entry, "ringTime");
+    record.answerTimeMs = optionalInt64(entry, "answerTime");
+    record.endTimeMs = optionalInt64(entry, "endTime");
+    record.sipStatus = static_cast<int>(optionalInt64(entry, "sipStatus"));
+    record.codec = optionalString(entry, "codec");
+    record.account = optionalString(entry, "account");
+    std::string transfer = optionalString(entry, "transfer");
+    if (transfer == "blind") {
+        record.transfer = echo::CallTransfer::Blind;
+    } else if (transfer == "attended") {
+        record.transfer = echo::CallTransfer::Attended;
+    }
+    record.transferStatus = static_cast<int>(optionalInt64(entry, "transferStatus"));
+    if (record.endTimeMs == 0) {
+        record.endTimeMs = record.startTimeMs;
     }
     
-    std::string digits = info[0].As<Napi::String>().Utf8Value();
-    bool result = g_engine->sendDtmf(digits);
-    return Napi::Boolean::New(env, result);
+    uint64_t id = addonData(env).callLog->append(record);
+    if (id == 0) {
+        return env.Null();
+    }
+    return Napi::String::New(env, std::to_string(id));
 }
 
 /**
- * Transferência cega
- * @param {string} target - Destino da transferência
+ * Exclui uma chamada do histórico
+ * @param {string} id
  * @returns {boolean}
  */
-Napi::Value TransferBlind(const Napi::CallbackInfo& info) {
+Napi::Value RemoveCallRecord(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.removeCallRecord");
     Napi::Env env = info.Env();
     
     if (info.Length() < 1 || !info[0].IsString()) {
-        Napi::TypeError::New(env, "Destino é obrigatório").ThrowAsJavaScriptException();
+        Napi::TypeError::New(env, "Id é obrigatório").ThrowAsJavaScriptException();
         return env.Undefined();
     }
     
-    if (!g_engine) {
-        return Napi::Boolean::New(env, false);
-    }
-    
-    std::string target = info[0].As<Napi::String>().Utf8Value();
-    bool result = g_engine->transferBlind(target);
+    uint64_t id = std::strtoull(info[0].As<Napi::String>().Utf8Value().c_str(), nullptr, 10);
+    bool result = id != 0 && addonData(env).callLog->remove(id);
     return Napi::Boolean::New(env, result);
 }
 
 /**
- * Transferência assistida
- * @param {string} target - Destino da transferência
+ * Remove todas as chamadas do histórico
  * @returns {boolean}
  */
-Napi::Value TransferAttended(const Napi::CallbackInfo& info) {
+Napi::Value ClearCallLog(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.clearCallLog");
     Napi::Env env = info.Env();
     
-    if (info.Length() < 1 || !info[0].IsString()) {
-        Napi::TypeError::New(env, "Destino é obrigatório").ThrowAsJavaScriptException();
-        return env.Undefined();
-    }
-    
-    if (!g_engine) {
-        return Napi::Boolean::New(env, false);
-    }
-    
-    std::string target = info[0].As<Napi::String>().Utf8Value();
-    bool result = g_engine->transferAttended(target);
+    bool result = addonData(env).callLog->clear();
     return Napi::Boolean::New(env, result);
 }
 
 /**
- * Define mute do microfone
- * @param {boolean} muted
+ * Estatísticas do arquivo de histórico
+ * @returns {Object} { records, deleted, capacity, fileBytes, compactions }
  */
-Napi::Value SetMuted(const Napi::CallbackInfo& info) {
+Napi::Value GetCallLogStats(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.getCallLogStats");
     Napi::Env env = info.Env();
     
-    if (info.Length() < 1 || !info[0].IsBoolean()) {
-        Napi::TypeError::New(env, "Valor boolean é obrigatório").ThrowAsJavaScriptException();
-        return env.Undefined();
-    }
+    echo::CallLogStats stats = addonData(env).callLog->getStats();
     
-    if (!g_engine) {
-        return env.Undefined();
-    }
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("records", static_cast<double>(stats.records));
+    obj.Set("deleted", static_cast<double>(stats.deleted));
+    obj.Set("capacity", static_cast<double>(stats.capacity));
+    obj.Set("fileBytes", static_cast<double>(stats.fileBytes));
+    obj.Set("compactions", static_cast<double>(stats.compactions));
+    return obj;
+}
+
+/**
+ * Obtém o consumo acumulado de CPU e trocas de contexto do processo
+ * @returns {Object} { userCpuMs, systemCpuMs, voluntaryContextSwitches, involuntaryContextSwitches, timestampMs }
+ */
+Napi::Value GetResourceUsage(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.getResourceUsage");
+    Napi::Env env = info.Env();
     
-    bool muted = info[0].As<Napi::Boolean>().Value();
-    g_engine->setMuted(muted);
-    return env.Undefined();
+    echo::ResourceUsage usage = echo::sampleResourceUsage();
+    
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("userCpuMs", usage.userCpuMs);
+    obj.Set("systemCpuMs", usage.systemCpuMs);
+    obj.Set("voluntaryContextSwitches", static_cast<double>(usage.voluntaryContextSwitches));
+    obj.Set("involuntaryContextSwitches", static_cast<double>(usage.involuntaryContextSwitches));
+    obj.Set("timestampMs", static_cast<double>(usage.timestampMicros) / 1000.0);
+    return obj;
 }
 
 /**
- * Alterna mute
- * @returns {boolean} novo estado
+ * Obtém snapshot do estado atual
+ * @returns {Object}
  */
-Napi::Value ToggleMuted(const Napi::CallbackInfo& info) {
+Napi::Value GetSnapshot(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.getSnapshot");
     Napi::Env env = info.Env();
     
-    if (!g_engine) {
-        return Napi::Boolean::New(env, false);
+    auto engine = currentEngine(env);
+    if (!engine) {
+        Napi::Object empty = Napi::Object::New(env);
+        empty.Set("connection", "idle");
+        empty.Set("callStatus", "idle");
+        empty.Set("callDirection", "none");
+        empty.Set("muted", false);
+        return empty;
     }
     
-    bool result = g_engine->toggleMuted();
-    return Napi::Boolean::New(env, result);
+    echo::SipSnapshot snap = engine->getSnapshot();
+    return snapshotToObject(env, snap);
 }
 
 /**
- * Verifica se está em mute
- * @returns {boolean}
+ * Obtém o bloco com o espelho do estado (layout em state_mirror.h)
+ *
+ * Lido com um Int32Array e o protocolo de seqlock descrito no header; é
+ * atualizado antes de cada evento, sem chamadas ao módulo para ler.
+ * @returns {ArrayBuffer} Sempre o mesmo buffer
  */
-Napi::Value IsMuted(const Napi::CallbackInfo& info) {
+Napi::Value GetStateMirror(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.getStateMirror");
     Napi::Env env = info.Env();
     
-    if (!g_engine) {
-        return Napi::Boolean::New(env, false);
+    AddonData& data = addonData(env);
+    if (data.stateMirrorBuffer.IsEmpty()) {
+        // Memória alocada pelo V8: o Electron não aceita ArrayBuffer externo
+        Napi::ArrayBuffer buffer = Napi::ArrayBuffer::New(env, echo::mirror::kBytes);
+        auto mirror = std::make_shared<echo::StateMirror>();
+        if (!mirror->attach(buffer.Data(), buffer.ByteLength())) {
+            Napi::Error::New(env, "Falha ao criar o espelho de estado").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+        data.stateMirrorBuffer = Napi::Persistent(buffer);
+        data.stateMirror = mirror;
+        if (data.engine) {
+            data.engine->setStateMirror(mirror);
+        }
     }
     
-    return Napi::Boolean::New(env, g_engine->isMuted());
+    return data.stateMirrorBuffer.Value();
 }
 
 /**
- * Obtém lista de dispositivos de áudio
- * @returns {Array<string>}
+ * Obtém os histogramas de estabelecimento de chamada
+ * @returns {Object} { postDialDelay, setupTime, answerToMedia, alertingDelay }
  */
-Napi::Value GetAudioDevices(const Napi::CallbackInfo& info) {
+Napi::Value GetCallTimingStats(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.getCallTimingStats");
     Napi::Env env = info.Env();
     
-    std::vector<echo::audio::AudioDeviceInfo> devices = echo::audio::listAudioDevices();
-    
-    Napi::Array result = Napi::Array::New(env, devices.size());
-    for (size_t i = 0; i < devices.size(); i++) {
-        Napi::Object dev = Napi::Object::New(env);
-        dev.Set("id", devices[i].id);
-        dev.Set("name", devices[i].name);
-        dev.Set("inputCount", devices[i].inputCount);
-        dev.Set("outputCount", devices[i].outputCount);
-        dev.Set("isDefault", devices[i].isDefault);
-        result.Set(static_cast<uint32_t>(i), dev);
+    echo::CallTimingStats stats;
+    if (auto engine = currentEngine(env)) {
+        stats = engine->getCallTimingStats();
     }
     
-    return result;
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("postDialDelay", histogramSummaryToObject(env, stats.postDialDelay));
+    obj.Set("setupTime", histogramSummaryToObject(env, stats.setupTime));
+    obj.Set("answerToMedia", histogramSummaryToObject(env, stats.answerToMedia));
+    obj.Set("alertingDelay", histogramSummaryToObject(env, stats.alertingDelay));
+    return obj;
 }
 
 /**
- * Define dispositivos de áudio
- * @param {number} captureDeviceId
- * @param {number} playbackDeviceId
- * @returns {boolean}
+ * Exporta todas as métricas do addon
+ * @returns {string} Texto no formato OpenMetrics
  */
-Napi::Value SetAudioDevices(const Napi::CallbackInfo& info) {
+Napi::Value GetMetrics(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.getMetrics");
     Napi::Env env = info.Env();
     
-    if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
-        Napi::TypeError::New(env, "IDs dos dispositivos são obrigatórios").ThrowAsJavaScriptException();
+    std::string text = echo::metrics::Registry::getInstance().renderOpenMetrics();
+    return Napi::String::New(env, text);
+}
+
+/**
+ * Habilita ou desabilita o tracer de callbacks
+ * @param {boolean} enabled
+ */
+Napi::Value SetTraceEnabled(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (info.Length() < 1 || !info[0].IsBoolean()) {
+        Napi::TypeError::New(env, "Valor boolean é obrigatório").ThrowAsJavaScriptException();
         return env.Undefined();
     }
     
-    int captureId = info[0].As<Napi::Number>().Int32Value();
-    int playbackId = info[1].As<Napi::Number>().Int32Value();
+    echo::trace::setEnabled(info[0].As<Napi::Boolean>().Value());
+    return env.Undefined();
+}
+
+/**
+ * Exporta o buffer do tracer
+ * @returns {string} JSON no formato Chrome Trace
+ */
+Napi::Value DumpTrace(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
     
-    bool result = echo::audio::setAudioDevices(captureId, playbackId);
-    return Napi::Boolean::New(env, result);
+    return Napi::String::New(env, echo::trace::dumpChromeTrace());
 }
 
 /**
- * Obtém snapshot do estado atual
- * @returns {Object}
+ * Descarta os eventos do tracer
  */
-Napi::Value GetSnapshot(const Napi::CallbackInfo& info) {
+Napi::Value ClearTrace(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
-    if (!g_engine) {
-        Napi::Object empty = Napi::Object::New(env);
-        empty.Set("connection", "idle");
-        empty.Set("callStatus", "idle");
-        empty.Set("callDirection", "none");
-        empty.Set("muted", false);
-        return empty;
-    }
+    echo::trace::clear();
+    return env.Undefined();
+}
+
+/**
+ * Configura o destino de log do PJSIP
+ * @param {Object} options - { directory, maxFileSize, maxFiles, rateLimits, level }
+ */
+Napi::Value ConfigureLogging(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.configureLogging");
+    runCommandSync(info.Env(), configureLoggingCommand(info));
+    return info.Env().Undefined();
+}
+
+/**
+ * Configura o destino de log do PJSIP sem bloquear o thread do Node
+ * @param {Object} options - { directory, maxFileSize, maxFiles, rateLimits, level }
+ * @returns {Promise<boolean>}
+ */
+Napi::Value ConfigureLoggingAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.configureLoggingAsync");
+    return runCommandAsync(info.Env(), configureLoggingCommand(info));
+}
+
+/**
+ * Altera o nível de log do PJSIP em tempo de execução
+ * @param {number} level - 0 (desligado) a 6 (trace)
+ * @returns {boolean} Sucesso
+ */
+Napi::Value SetLogLevel(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setLogLevel");
+    return runCommandSync(info.Env(), setLogLevelCommand(info));
+}
+
+/**
+ * Altera o nível de log do PJSIP em tempo de execução sem bloquear o thread do Node
+ * @param {number} level - 0 (desligado) a 6 (trace)
+ * @returns {Promise<boolean>}
+ */
+Napi::Value SetLogLevelAsync(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setLogLevelAsync");
+    return runCommandAsync(info.Env(), setLogLevelCommand(info));
+}
+
+/**
+ * Obtém estatísticas do destino de log
+ * @returns {Object} { written, dropped, rateLimited, rotations, level }
+ */
+Napi::Value GetLogStats(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.getLogStats");
+    Napi::Env env = info.Env();
     
-    echo::SipSnapshot snap = g_engine->getSnapshot();
-    return snapshotToObject(env, snap);
+    echo::LogSinkStats stats = echo::LogSink::getInstance().getStats();
+    
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("written", Napi::Number::New(env, static_cast<double>(stats.written)));
+    obj.Set("dropped", Napi::Number::New(env, static_cast<double>(stats.dropped)));
+    obj.Set("rateLimited", Napi::Number::New(env, static_cast<double>(stats.rateLimited)));
+    obj.Set("rotations", Napi::Number::New(env, static_cast<double>(stats.rotations)));
+    auto engine = currentEngine(env);
+    obj.Set("level", Napi::Number::New(env, engine ? engine->getLogLevel() : 1));
+    return obj;
 }
 
 /**
@@ -424,6 +2125,7 @@ Napi::Value GetSnapshot(const Napi::CallbackInfo& info) {
  * @param {Function} callback - Função (eventName, payload) => void
  */
 Napi::Value SetEventCallback(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.setEventCallback");
     Napi::Env env = info.Env();
     
     if (info.Length() < 1 || !info[0].IsFunction()) {
@@ -433,9 +2135,9 @@ Napi::Value SetEventCallback(const Napi::CallbackInfo& info) {
     
     Napi::Function callback = info[0].As<Napi::Function>();
     
-    // Criar EventEmitter e registrar no manager global
+    // Criar EventEmitter e registrar no manager do ambiente
     auto emitter = std::make_shared<echo::EventEmitter>(env, callback);
-    echo::EventEmitterManager::getInstance().setEmitter(emitter);
+    addonData(env).events->setEmitter(emitter);
     
     return env.Undefined();
 }
@@ -444,9 +2146,10 @@ Napi::Value SetEventCallback(const Napi::CallbackInfo& info) {
  * Remove callback de eventos
  */
 Napi::Value ClearEventCallback(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.clearEventCallback");
     Napi::Env env = info.Env();
     
-    echo::EventEmitterManager::getInstance().clear();
+    addonData(env).events->clear();
     
     return env.Undefined();
 }
@@ -455,50 +2158,163 @@ Napi::Value ClearEventCallback(const Napi::CallbackInfo& info) {
  * Processa eventos pendentes
  */
 Napi::Value ProcessEvents(const Napi::CallbackInfo& info) {
+    ECHO_TRACE_SCOPE("napi.processEvents");
     Napi::Env env = info.Env();
     
-    if (g_engine) {
-        g_engine->processEvents();
+    if (auto engine = currentEngine(env)) {
+        engine->processEvents();
     }
     
     return env.Undefined();
 }
 
 /**
- * Inicialização do módulo
+ * Encerramento do ambiente (saída do processo ou término do worker)
+ *
+ * Roda antes dos dados de instância serem liberados: encerra o PJSUA de
+ * forma síncrona, libera o emissor de eventos e a posse do engine.
+ */
+void CleanupEnvironment(AddonData* data) {
+    data->events->clear();
+    if (data->engine) {
+        data->engine->setJsonEventSink(nullptr);
+        data->engine->setStateMirror(nullptr);
+        data->engine->destroy();
+        data->engine.reset();
+    }
+    releaseEngineOwnership(*data);
+    
+    data->stateMirror.reset();
+    data->stateMirrorBuffer.Reset();
+}
+
+/**
+ * Inicialização do módulo (uma vez por ambiente)
  */
 Napi::Object InitModule(Napi::Env env, Napi::Object exports) {
+    AddonData* data = new AddonData();
+    env.SetInstanceData<AddonData>(data);
+    env.AddCleanupHook(CleanupEnvironment, data);
+    
+    // A posse do PJSUA não é tomada na carga: o ambiente que vai usar o SIP
+    // (processo principal ou worker) chama prewarm/init logo em seguida
+    
     // Lifecycle
     exports.Set("init", Napi::Function::New(env, Init));
     exports.Set("destroy", Napi::Function::New(env, Destroy));
     exports.Set("isInitialized", Napi::Function::New(env, IsInitialized));
     
+    exports.Set("initAsync", Napi::Function::New(env, InitAsync));
+    exports.Set("prewarm", Napi::Function::New(env, Prewarm));
+    exports.Set("getStartupTimeline", Napi::Function::New(env, GetStartupTimeline));
+    exports.Set("destroyAsync", Napi::Function::New(env, DestroyAsync));
+    
     // Registration
     exports.Set("register", Napi::Function::New(env, Register));
     exports.Set("unregister", Napi::Function::New(env, Unregister));
+    exports.Set("registerAsync", Napi::Function::New(env, RegisterAsync));
+    exports.Set("unregisterAsync", Napi::Function::New(env, UnregisterAsync));
     
     // Calls
     exports.Set("makeCall", Napi::Function::New(env, MakeCall));
     exports.Set("answerCall", Napi::Function::New(env, AnswerCall));
     exports.Set("rejectCall", Napi::Function::New(env, RejectCall));
     exports.Set("hangupCall", Napi::Function::New(env, HangupCall));
+    exports.Set("makeCallAsync", Napi::Function::New(env, MakeCallAsync));
+    exports.Set("answerCallAsync", Napi::Function::New(env, AnswerCallAsync));
+    exports.Set("rejectCallAsync", Napi::Function::New(env, RejectCallAsync));
+    exports.Set("hangupCallAsync", Napi::Function::New(env, HangupCallAsync));
     
     // DTMF
     exports.Set("sendDtmf", Napi::Function::New(env, SendDtmf));
+    exports.Set("sendDtmfAsync", Napi::Function::New(env, SendDtmfAsync));
+    exports.Set("cancelDtmf", Napi::Function::New(env, CancelDtmf));
+    exports.Set("cancelDtmfAsync", Napi::Function::New(env, CancelDtmfAsync));
+    exports.Set("setDtmfOptions", Napi::Function::New(env, SetDtmfOptions));
+    exports.Set("setDtmfOptionsAsync", Napi::Function::New(env, SetDtmfOptionsAsync));
+    exports.Set("setInbandDtmfDetection", Napi::Function::New(env, SetInbandDtmfDetection));
+    exports.Set("setInbandDtmfDetectionAsync", Napi::Function::New(env, SetInbandDtmfDetectionAsync));
     
     // Transfer
     exports.Set("transferBlind", Napi::Function::New(env, TransferBlind));
     exports.Set("transferAttended", Napi::Function::New(env, TransferAttended));
+    exports.Set("transferBlindAsync", Napi::Function::New(env, TransferBlindAsync));
+    exports.Set("transferAttendedAsync", Napi::Function::New(env, TransferAttendedAsync));
+    exports.Set("startConsult", Napi::Function::New(env, StartConsult));
+    exports.Set("startConsultAsync", Napi::Function::New(env, StartConsultAsync));
+    exports.Set("swapTransferLegs", Napi::Function::New(env, SwapTransferLegs));
+    exports.Set("completeTransfer", Napi::Function::New(env, CompleteTransfer));
+    exports.Set("cancelTransfer", Napi::Function::New(env, CancelTransfer));
+    exports.Set("swapTransferLegsAsync", Napi::Function::New(env, SwapTransferLegsAsync));
+    exports.Set("completeTransferAsync", Napi::Function::New(env, CompleteTransferAsync));
+    exports.Set("cancelTransferAsync", Napi::Function::New(env, CancelTransferAsync));
+    exports.Set("hold", Napi::Function::New(env, Hold));
+    exports.Set("resume", Napi::Function::New(env, Resume));
+    exports.Set("holdAsync", Napi::Function::New(env, HoldAsync));
+    exports.Set("resumeAsync", Napi::Function::New(env, ResumeAsync));
+    exports.Set("setHoldMusic", Napi::Function::New(env, SetHoldMusic));
+    exports.Set("setHoldMusicAsync", Napi::Function::New(env, SetHoldMusicAsync));
     
     // Audio
     exports.Set("setMuted", Napi::Function::New(env, SetMuted));
+    exports.Set("setMutedAsync", Napi::Function::New(env, SetMutedAsync));
     exports.Set("toggleMuted", Napi::Function::New(env, ToggleMuted));
+    exports.Set("toggleMutedAsync", Napi::Function::New(env, ToggleMutedAsync));
     exports.Set("isMuted", Napi::Function::New(env, IsMuted));
     exports.Set("getAudioDevices", Napi::Function::New(env, GetAudioDevices));
+    exports.Set("getAudioDevicesAsync", Napi::Function::New(env, GetAudioDevicesAsync));
     exports.Set("setAudioDevices", Napi::Function::New(env, SetAudioDevices));
+    exports.Set("setAudioDevicesAsync", Napi::Function::New(env, SetAudioDevicesAsync));
+    exports.Set("setAudioPowerPolicy", Napi::Function::New(env, SetAudioPowerPolicy));
+    exports.Set("setAudioPowerPolicyAsync", Napi::Function::New(env, SetAudioPowerPolicyAsync));
+    exports.Set("setCaptureProcessing", Napi::Function::New(env, SetCaptureProcessing));
+    exports.Set("setCaptureProcessingAsync", Napi::Function::New(env, SetCaptureProcessingAsync));
+    exports.Set("getCaptureStats", Napi::Function::New(env, GetCaptureStats));
+    exports.Set("setOpusOptions", Napi::Function::New(env, SetOpusOptions));
+    exports.Set("setOpusOptionsAsync", Napi::Function::New(env, SetOpusOptionsAsync));
+    exports.Set("setVadOptions", Napi::Function::New(env, SetVadOptions));
+    exports.Set("setVadOptionsAsync", Napi::Function::New(env, SetVadOptionsAsync));
+    exports.Set("getVadStats", Napi::Function::New(env, GetVadStats));
+    
+    // Contacts
+    exports.Set("loadContacts", Napi::Function::New(env, LoadContacts));
+    exports.Set("loadContactsAsync", Napi::Function::New(env, LoadContactsAsync));
+    exports.Set("lookupContact", Napi::Function::New(env, LookupContact));
+    
+    // BLF
+    exports.Set("watchExtensions", Napi::Function::New(env, WatchExtensions));
+    exports.Set("watchExtensionsAsync", Napi::Function::New(env, WatchExtensionsAsync));
+    exports.Set("getBlfStates", Napi::Function::New(env, GetBlfStates));
+    exports.Set("getBlfStats", Napi::Function::New(env, GetBlfStats));
+    
+    // Call history
+    exports.Set("openCallLog", Napi::Function::New(env, OpenCallLog));
+    exports.Set("queryCallLog", Napi::Function::New(env, QueryCallLog));
+    exports.Set("appendCallRecord", Napi::Function::New(env, AppendCallRecord));
+    exports.Set("removeCallRecord", Napi::Function::New(env, RemoveCallRecord));
+    exports.Set("clearCallLog", Napi::Function::New(env, ClearCallLog));
+    exports.Set("getCallLogStats", Napi::Function::New(env, GetCallLogStats));
     
     // State
     exports.Set("getSnapshot", Napi::Function::New(env, GetSnapshot));
+    exports.Set("getStateMirror", Napi::Function::New(env, GetStateMirror));
+    exports.Set("getCallTimingStats", Napi::Function::New(env, GetCallTimingStats));
+    
+    // Metrics
+    exports.Set("getMetrics", Napi::Function::New(env, GetMetrics));
+    exports.Set("getResourceUsage", Napi::Function::New(env, GetResourceUsage));
+    
+    // Tracing
+    exports.Set("setTraceEnabled", Napi::Function::New(env, SetTraceEnabled));
+    exports.Set("dumpTrace", Napi::Function::New(env, DumpTrace));
+    exports.Set("clearTrace", Napi::Function::New(env, ClearTrace));
+    
+    // Logging
+    exports.Set("configureLogging", Napi::Function::New(env, ConfigureLogging));
+    exports.Set("configureLoggingAsync", Napi::Function::New(env, ConfigureLoggingAsync));
+    exports.Set("setLogLevel", Napi::Function::New(env, SetLogLevel));
+    exports.Set("setLogLevelAsync", Napi::Function::New(env, SetLogLevelAsync));
+    exports.Set("getLogStats", Napi::Function::New(env, GetLogStats));
     
     // Events
     exports.Set("setEventCallback", Napi::Function::New(env, SetEventCallback));
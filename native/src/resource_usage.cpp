@@ -0,0 +1,58 @@
+/**
+ * @file resource_usage.cpp
+ * @brief Implementação da amostragem de consumo do processo
+ */
+
+#include "resource_usage.h"
+#include "call_timing.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+namespace echo {
+
+namespace {
+
+#ifdef _WIN32
+double fileTimeToMs(const FILETIME& time) {
+    ULARGE_INTEGER value;
+    value.LowPart = time.dwLowDateTime;
+    value.HighPart = time.dwHighDateTime;
+    return static_cast<double>(value.QuadPart) / 10000.0; // Unidades de 100 ns
+}
+#else
+double timevalToMs(const struct timeval& time) {
+    return static_cast<double>(time.tv_sec) * 1000.0 + static_cast<double>(time.tv_usec) / 1000.0;
+}
+#endif
+
+} // anonymous namespace
+
+ResourceUsage sampleResourceUsage() {
+    ResourceUsage usage;
+    usage.timestampMicros = monotonicMicros();
+
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        usage.userCpuMs = fileTimeToMs(user);
+        usage.systemCpuMs = fileTimeToMs(kernel);
+    }
+#else
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0) {
+        usage.userCpuMs = timevalToMs(ru.ru_utime);
+        usage.systemCpuMs = timevalToMs(ru.ru_stime);
+        usage.voluntaryContextSwitches = static_cast<uint64_t>(ru.ru_nvcsw);
+        usage.involuntaryContextSwitches = static_cast<uint64_t>(ru.ru_nivcsw);
+    }
+#endif
+
+    return usage;
+}
+
+} // namespace echo
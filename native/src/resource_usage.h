@@ -0,0 +1,36 @@
+/**
+ * @file resource_usage.h
+ * @brief Amostragem do consumo de CPU e de trocas de contexto do processo
+ *
+ * Usado para medir o custo ocioso do addon (CPU e despertares por segundo
+ * entre chamadas) comparando duas amostras.
+ */
+
+#ifndef RESOURCE_USAGE_H
+#define RESOURCE_USAGE_H
+
+#include <cstdint>
+
+namespace echo {
+
+/**
+ * @brief Consumo acumulado do processo desde o início
+ */
+struct ResourceUsage {
+    double userCpuMs = 0;               // Tempo de CPU em modo usuário
+    double systemCpuMs = 0;             // Tempo de CPU em modo kernel
+    uint64_t voluntaryContextSwitches = 0;   // Bloqueios voluntários (≈ despertares)
+    uint64_t involuntaryContextSwitches = 0; // Preempções
+    int64_t timestampMicros = 0;        // monotonicMicros() da amostra
+};
+
+/**
+ * @brief Lê o consumo atual do processo
+ *
+ * No Windows as trocas de contexto não estão disponíveis e ficam em zero.
+ */
+ResourceUsage sampleResourceUsage();
+
+} // namespace echo
+
+#endif // RESOURCE_USAGE_H
@@ -0,0 +1,106 @@
+/**
+ * @file seqlock.h
+ * @brief Publicação de um valor trivialmente copiável por seqlock
+ *
+ * Este arquivo define SeqLock<T>: um escritor publica cópias completas do
+ * valor e qualquer número de leitores as lê sem travas e sem alocação. O
+ * leitor nunca bloqueia o escritor; se uma escrita acontece durante a
+ * leitura, o leitor repete a cópia.
+ *
+ * O valor é guardado em palavras atômicas (acessos relaxed) entre os
+ * incrementos do contador de sequência: leituras concorrentes são bem
+ * definidas e o T devolvido nunca mistura duas versões.
+ */
+
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace echo {
+
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock exige tipo trivialmente copiável");
+    static_assert(std::is_default_constructible<T>::value, "SeqLock exige tipo com construtor padrão");
+
+public:
+    SeqLock() {
+        for (auto& word : m_words) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    explicit SeqLock(const T& value) : SeqLock() { store(value); }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    /**
+     * @brief Publica um novo valor
+     *
+     * Um escritor por vez: escritores concorrentes precisam ser
+     * serializados pelo chamador.
+     */
+    void store(const T& value) {
+        Word words[kWords] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; ++i) {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Lê o último valor publicado (sem travas, pode repetir a cópia)
+     */
+    T load() const {
+        T value;
+        auto* out = reinterpret_cast<unsigned char*>(&value);
+        for (unsigned attempt = 0;; ++attempt) {
+            uint32_t before = m_sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                for (size_t i = 0; i < kWords; ++i) {
+                    Word word = m_words[i].load(std::memory_order_relaxed);
+                    size_t offset = i * sizeof(Word);
+                    std::memcpy(out + offset, &word, std::min(sizeof(Word), sizeof(T) - offset));
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_sequence.load(std::memory_order_relaxed) == before) {
+                    return value;
+                }
+            }
+            // Escritor preemptado no meio da cópia: ceder o processador
+            if (attempt >= 64) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    /**
+     * @brief Número de publicações até agora
+     */
+    uint32_t version() const { return m_sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+    using Word = uintptr_t;
+    static constexpr size_t kWords = (sizeof(T) + sizeof(Word) - 1) / sizeof(Word);
+    static_assert(std::atomic<Word>::is_always_lock_free, "palavras atômicas precisam ser lock-free");
+
+    alignas(64) std::atomic<uint32_t> m_sequence{0};
+    std::atomic<Word> m_words[kWords];
+};
+
+} // namespace echo
+
+#endif // SEQLOCK_H
@@ -4,29 +4,164 @@
  */
 
 #include "sip_engine.h"
-#include "event_emitter.h"
+#include "log_sink.h"
+#include "metrics.h"
+#include "sip_uri.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <sstream>
-#include <algorithm>
 
 namespace echo {
 
+namespace {
+
+// Métricas do engine (registradas uma única vez no registro global)
+struct EngineMetrics {
+    metrics::Counter& registrationsOk;
+    metrics::Counter& registrationsFailed;
+    metrics::Counter& rtpPacketsReceived;
+    metrics::Counter& rtpPacketsLost;
+    LatencyHistogram& onCallStateDuration;
+    LatencyHistogram& onIncomingCallDuration;
+    metrics::Gauge& soundDeviceIdle;
+    metrics::Counter& contactLookupsHit;
+    metrics::Counter& contactLookupsMiss;
+    metrics::Counter& dtmfRfc2833;
+    metrics::Counter& dtmfSipInfo;
+    metrics::Counter& dtmfInBand;
+    metrics::Counter& dtmfReceivedRfc2833;
+    metrics::Counter& dtmfReceivedInBand;
+    LatencyHistogram& captureFrameTime;
+    metrics::Counter& captureDowngrades;
+    metrics::Counter& opusAdaptations;
+    metrics::Gauge& opusBitrate;
+    metrics::Counter& vadSuppressedPackets;
+    metrics::Gauge& callsHeld;
+};
+
+// Escreve uma string JSON (nomes de exibição podem conter aspas e barras)
+void writeJsonString(std::ostream& out, std::string_view value) {
+    out << '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default: out << c; break;
+        }
+    }
+    out << '"';
+}
+
+EngineMetrics& engineMetrics() {
+    auto& registry = metrics::Registry::getInstance();
+    static EngineMetrics m{
+        registry.counter("echo_registrations", "Respostas de REGISTER recebidas", "result=\"success\""),
+        registry.counter("echo_registrations", "Respostas de REGISTER recebidas", "result=\"failure\""),
+        registry.counter("echo_rtp_packets_received", "Pacotes RTP recebidos em streams encerrados"),
+        registry.counter("echo_rtp_packets_lost", "Pacotes RTP perdidos em streams encerrados"),
+        registry.histogram("echo_callback_duration_seconds", "Duração dos callbacks PJSUA", "callback=\"onCallState\""),
+        registry.histogram("echo_callback_duration_seconds", "Duração dos callbacks PJSUA", "callback=\"onIncomingCall\""),
+        registry.gauge("echo_sound_device_idle", "1 quando o dispositivo nulo substitui o de som fora de chamadas"),
+        registry.counter("echo_contact_lookups", "Consultas ao diretório em chamadas entrantes", "result=\"hit\""),
+        registry.counter("echo_contact_lookups", "Consultas ao diretório em chamadas entrantes", "result=\"miss\""),
+        registry.counter("echo_dtmf_digits_sent", "Dígitos DTMF enviados", "method=\"rfc2833\""),
+        registry.counter("echo_dtmf_digits_sent", "Dígitos DTMF enviados", "method=\"info\""),
+        registry.counter("echo_dtmf_digits_sent", "Dígitos DTMF enviados", "method=\"inband\""),
+        registry.counter("echo_dtmf_digits_received", "Dígitos DTMF recebidos", "source=\"rfc2833\""),
+        registry.counter("echo_dtmf_digits_received", "Dígitos DTMF recebidos", "source=\"inband\""),
+        registry.histogram("echo_capture_frame_seconds", "Processamento de cada quadro do microfone"),
+        registry.counter("echo_capture_downgrades", "Estágios de captura desligados por estouro de orçamento"),
+        registry.counter("echo_opus_adaptations", "Reconfigurações do codificador Opus pelo RTCP"),
+        registry.gauge("echo_opus_bitrate", "Último bitrate aplicado ao codificador Opus (bps)"),
+        registry.counter("echo_vad_suppressed_packets", "Pacotes RTP não enviados pelo VAD (chamadas encerradas)"),
+        registry.gauge("echo_calls_held", "Chamadas em espera (fora da ponte de conferência)"),
+    };
+    return m;
+}
+
+// Intervalo do controlador do Opus (Receiver Reports chegam a cada ~5 s)
+constexpr unsigned kOpusControlIntervalMs = 2500;
+
+// Amostragem dos níveis de áudio para o espelho (apenas com chamadas ativas)
+constexpr unsigned kMirrorLevelIntervalMs = 100;
+
+// Classifica o resultado de uma chamada encerrada
+const char* callOutcome(const CallTimings& timings, int lastStatus) {
+    if (timings.confirmed != 0) return "answered";
+    switch (lastStatus) {
+        case 486:
+        case 600: return "busy";
+        case 603: return "rejected";
+        case 487: return "cancelled";
+        case 408:
+        case 480: return "no_answer";
+        default: return "failed";
+    }
+}
+
+} // anonymous namespace
+
 // Instância singleton para callbacks estáticos
 SipEngine* SipEngine::s_instance = nullptr;
 
-SipEngine::SipEngine() {
+SipEngine::SipEngine() : SipEngine(std::make_shared<CallLog>(), std::make_shared<ContactIndex>()) {
+}
+
+SipEngine::SipEngine(std::shared_ptr<CallLog> callLog, std::shared_ptr<ContactIndex> contacts)
+    : m_contacts(std::move(contacts)), m_callLog(std::move(callLog)) {
+    m_startup.engineCreated = monotonicMicros();
+
     m_snapshot.connection = SipConnectionState::Idle;
     m_snapshot.callStatus = CallState::Idle;
     m_snapshot.callDirection = CallDirection::None;
     m_snapshot.muted = false;
-    m_snapshot.remoteUri = "";
+    m_publishedSnapshot.store(m_snapshot);
+
+    // Nível de log: 1 em produção, ECHO_PJSIP_LOG_LEVEL para diagnóstico
+    if (const char* envLevel = std::getenv("ECHO_PJSIP_LOG_LEVEL")) {
+        int level = std::atoi(envLevel);
+        if (level >= 0 && level <= 6) {
+            m_logLevel = level;
+        }
+    }
+
+    // Publicar histogramas de estabelecimento no registro de métricas
+    auto& registry = metrics::Registry::getInstance();
+    registry.addHistogram("echo_call_post_dial_delay_seconds", "makeCall até a primeira resposta provisória", "",
+                          &m_timingHistograms.postDialDelay);
+    registry.addHistogram("echo_call_setup_seconds", "Início da chamada até CONFIRMED", "",
+                          &m_timingHistograms.setupTime);
+    registry.addHistogram("echo_call_answer_to_media_seconds", "Atendimento até mídia ativa", "",
+                          &m_timingHistograms.answerToMedia);
+    registry.addHistogram("echo_call_alerting_delay_seconds", "INVITE recebido até 180 enviado", "",
+                          &m_timingHistograms.alertingDelay);
+
+    m_sipThread.start();
 }
 
 SipEngine::~SipEngine() {
     destroy();
+
+    auto& registry = metrics::Registry::getInstance();
+    registry.removeHistogram(&m_timingHistograms.postDialDelay);
+    registry.removeHistogram(&m_timingHistograms.setupTime);
+    registry.removeHistogram(&m_timingHistograms.answerToMedia);
+    registry.removeHistogram(&m_timingHistograms.alertingDelay);
+
+    // Executa os callbacks ainda enfileirados antes de liberar o estado
+    m_sipThread.stop();
 }
 
 bool SipEngine::init() {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return init(); }, false);
+    }
+
     if (m_initialized) {
         return true;
     }
@@ -35,6 +170,7 @@ bool SipEngine::init() {
     s_instance = this;
 
     pj_status_t status;
+    int64_t phaseStart = monotonicMicros();
 
     // Criar PJSUA
     status = pjsua_create();
@@ -45,6 +181,7 @@ bool SipEngine::init() {
         });
         return false;
     }
+    markStartup(&StartupTimeline::pjsuaCreated, phaseStart, "create");
 
     // Configurar PJSUA
     pjsua_config cfg;
@@ -62,19 +199,28 @@ bool SipEngine::init() {
     cfg.cb.on_call_media_state = &SipEngine::onCallMediaState;
     cfg.cb.on_call_transfer_status = &SipEngine::onCallTransferStatus;
     cfg.cb.on_dtmf_digit = &SipEngine::onDtmfDigit;
+    cfg.cb.on_stream_created2 = &SipEngine::onStreamCreated2;
+    cfg.cb.on_stream_destroyed = &SipEngine::onStreamDestroyed;
 
-    // Configurar logging
-    log_cfg.level = 4;
-    log_cfg.console_level = 4;
+    // Configurar logging: mensagens vão para o LogSink (fila + thread de escrita),
+    // nunca para o console no thread PJSUA
+    LogSink::getInstance().start();
+    log_cfg.cb = &LogSink::write;
+    log_cfg.level = static_cast<unsigned>(m_logLevel.load());
+    log_cfg.console_level = static_cast<unsigned>(m_logLevel.load());
 
     // Configurar mídia
     media_cfg.clock_rate = 16000;
     media_cfg.snd_clock_rate = 16000;
     media_cfg.ec_tail_len = 200;
     media_cfg.quality = 10;
-    media_cfg.no_vad = PJ_TRUE;
+    // no_vad zeraria setting.vad em todos os streams, desligando o DTX do
+    // Opus; o VAD do codec é desligado por codec em disableCodecVad
+    media_cfg.no_vad = PJ_FALSE;
+    media_cfg.snd_auto_close_time = m_powerPolicy.idleCloseSeconds;
 
     // Inicializar PJSUA
+    phaseStart = monotonicMicros();
     status = pjsua_init(&cfg, &log_cfg, &media_cfg);
     if (status != PJ_SUCCESS) {
         pjsua_destroy();
@@ -84,8 +230,14 @@ bool SipEngine::init() {
         });
         return false;
     }
+    markStartup(&StartupTimeline::pjsuaInitialized, phaseStart, "init");
+
+    // Nos demais codecs o silêncio fica com o VAD da captura; no Opus, com o DTX
+    disableCodecVad();
+    configureOpus();
 
     // Iniciar PJSUA
+    phaseStart = monotonicMicros();
     status = pjsua_start();
     if (status != PJ_SUCCESS) {
         pjsua_destroy();
@@ -95,31 +247,94 @@ bool SipEngine::init() {
         });
         return false;
     }
+    markStartup(&StartupTimeline::pjsuaStarted, phaseStart, "start");
 
     m_initialized = true;
     updateSnapshot([](SipSnapshot& s) {
         s.connection = SipConnectionState::Idle;
     });
 
+    scheduleAudioIdle();
+
     return true;
 }
 
 void SipEngine::destroy() {
+    if (!onSipThread()) {
+        m_sipThread.call<bool>([&]() { destroy(); return true; }, false);
+        return;
+    }
+
     if (!m_initialized) {
         return;
     }
 
-    // Encerrar chamadas ativas
+    if (m_dtmfPlaying) {
+        finishDtmf(true);
+    }
+    m_opusCalls.clear();
+    m_opusTimerActive = false;
+    m_opusGeneration++;
+    m_levelTimerActive = false;
+    m_levelGeneration++;
+
+    // Encerrar chamadas ativas (os callbacks de desconexão não serão tratados)
     pjsua_call_hangup_all();
+    while (!m_inbandDetectors.empty()) {
+        retireInbandDetector(m_inbandDetectors.begin()->first);
+    }
+    while (!m_activeCalls.empty()) {
+        finishCallRecord(m_activeCalls.begin()->first, 0);
+    }
+    if (m_capturePort) {
+        m_capturePort->detach();
+    }
+    m_captureSourceConnected = false;
+    m_micSources.clear();
+    m_transfer = AttendedTransfer();
+    m_drainingConsults.clear();
+    if (m_holdMusic) {
+        m_holdMusic->detach();
+    }
 
-    // Desregistrar conta
+    // Desregistrar conta (antes, encerrar as assinaturas de BLF feitas com ela)
+    m_blf.clearAccount();
+    m_blfAccount = BlfAccount();
     if (m_accountId != PJSUA_INVALID_ID) {
         pjsua_acc_del(m_accountId);
         m_accountId = PJSUA_INVALID_ID;
     }
 
-    // Destruir PJSUA
+    // Destruir PJSUA (os transportes são destruídos junto)
     pjsua_destroy();
+    m_blf.shutdown();
+    m_transports.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_audioStreamsMutex);
+        m_audioStreams.clear();
+    }
+    for (auto& retired : m_retiredDetectors) {
+        retired.second->abandonPool();
+    }
+    m_retiredDetectors.clear();
+    if (m_capturePort) {
+        m_capturePort->abandonPool();
+        m_capturePort.reset();
+    }
+    for (auto& retired : m_retiredHoldMusic) {
+        retired.second->abandonPool();
+    }
+    m_retiredHoldMusic.clear();
+    if (m_holdMusic) {
+        m_holdMusic->abandonPool();
+        m_holdMusic.reset();
+    }
+    m_audioIdle = false;
+    m_idleGeneration++;
+    engineMetrics().soundDeviceIdle.set(0);
+
+    // Esvaziar a fila de log após as últimas mensagens do PJSIP
+    LogSink::getInstance().stop();
 
     m_initialized = false;
     s_instance = nullptr;
@@ -128,6 +343,116 @@ void SipEngine::destroy() {
         s.connection = SipConnectionState::Idle;
         s.callStatus = CallState::Idle;
     });
+    m_currentCallId = PJSUA_INVALID_ID;
+    publishStateMirror();
+}
+
+bool SipEngine::setLogLevel(int level) {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return setLogLevel(level); }, false);
+    }
+
+    if (level < 0 || level > 6) {
+        return false;
+    }
+
+    m_logLevel = level;
+    if (!m_initialized) {
+        return true;
+    }
+
+    pjsua_logging_config log_cfg;
+    pjsua_logging_config_default(&log_cfg);
+    log_cfg.cb = &LogSink::write;
+    log_cfg.level = static_cast<unsigned>(level);
+    log_cfg.console_level = static_cast<unsigned>(level);
+
+    return pjsua_reconfigure_logging(&log_cfg) == PJ_SUCCESS;
+}
+
+bool SipEngine::prewarm(const std::string& transport, bool openSoundDevice) {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return prewarm(transport, openSoundDevice); }, false);
+    }
+
+    if (!init()) {
+        return false;
+    }
+
+    if (!transport.empty()) {
+        pjsua_transport_id tp_id;
+        if (!ensureTransport(transport, &tp_id)) {
+            return false;
+        }
+    }
+
+    // pjsua_set_snd_dev abre o dispositivo imediatamente
+    if (openSoundDevice && (m_audioIdle || !pjsua_snd_is_active())) {
+        int64_t phaseStart = monotonicMicros();
+        m_idleGeneration++;
+        m_audioIdle = false;
+        engineMetrics().soundDeviceIdle.set(0);
+        if (pjsua_set_snd_dev(m_captureDevice, m_playbackDevice) != PJ_SUCCESS) {
+            return false;
+        }
+        markStartup(&StartupTimeline::soundDeviceOpen, phaseStart, "sound_device");
+    }
+
+    return true;
+}
+
+StartupTimeline SipEngine::getStartupTimeline() const {
+    std::lock_guard<std::mutex> lock(m_startupMutex);
+    return m_startup;
+}
+
+bool SipEngine::ensureTransport(const std::string& transport, pjsua_transport_id* id) {
+    pjsip_transport_type_e tp_type;
+    if (transport == "tcp") {
+        tp_type = PJSIP_TRANSPORT_TCP;
+    } else {
+        tp_type = PJSIP_TRANSPORT_UDP;
+    }
+
+    auto it = m_transports.find(tp_type);
+    if (it != m_transports.end()) {
+        *id = it->second;
+        return true;
+    }
+
+    int64_t phaseStart = monotonicMicros();
+
+    pjsua_transport_config tp_cfg;
+    pjsua_transport_config_default(&tp_cfg);
+    tp_cfg.port = 0; // Porta aleatória
+
+    if (pjsua_transport_create(tp_type, &tp_cfg, id) != PJ_SUCCESS) {
+        return false;
+    }
+
+    m_transports[tp_type] = *id;
+    markStartup(&StartupTimeline::transportReady, phaseStart, "transport");
+    return true;
+}
+
+void SipEngine::markStartup(int64_t StartupTimeline::*phase, int64_t since, const char* label) {
+    int64_t now = monotonicMicros();
+    {
+        std::lock_guard<std::mutex> lock(m_startupMutex);
+        if (m_startup.*phase != 0) {
+            return;
+        }
+        m_startup.*phase = now;
+    }
+
+    metrics::Registry::getInstance()
+        .histogram("echo_startup_phase_seconds", "Duração das etapas de inicialização",
+                   std::string("phase=\"") + label + "\"")
+        .record(now - since);
+}
+
+int SipEngine::getLogLevel() const {
+    return m_logLevel;
 }
 
 bool SipEngine::isInitialized() const {
@@ -135,6 +460,10 @@ bool SipEngine::isInitialized() const {
 }
 
 bool SipEngine::registerAccount(const SipCredentials& credentials) {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return registerAccount(credentials); }, false);
+    }
+
     if (!m_initialized) {
         if (!init()) {
             return false;
@@ -142,6 +471,8 @@ bool SipEngine::registerAccount(const SipCredentials& credentials) {
     }
 
     // Remover conta anterior se existir
+    m_blf.clearAccount();
+    m_blfAccount = BlfAccount();
     if (m_accountId != PJSUA_INVALID_ID) {
         pjsua_acc_del(m_accountId);
         m_accountId = PJSUA_INVALID_ID;
@@ -156,21 +487,9 @@ bool SipEngine::registerAccount(const SipCredentials& credentials) {
         s.domain = credentials.server;
     });
 
-    // Criar transporte
-    pjsua_transport_config tp_cfg;
-    pjsua_transport_config_default(&tp_cfg);
-    tp_cfg.port = 0; // Porta aleatória
-
-    pjsip_transport_type_e tp_type;
-    if (credentials.transport == "tcp") {
-        tp_type = PJSIP_TRANSPORT_TCP;
-    } else {
-        tp_type = PJSIP_TRANSPORT_UDP;
-    }
-
+    // Obter transporte (criado por prewarm() ou em um registro anterior)
     pjsua_transport_id tp_id;
-    pj_status_t status = pjsua_transport_create(tp_type, &tp_cfg, &tp_id);
-    if (status != PJ_SUCCESS) {
+    if (!ensureTransport(credentials.transport, &tp_id)) {
         updateSnapshot([](SipSnapshot& s) {
             s.connection = SipConnectionState::Error;
             s.lastError = "Falha ao criar transporte";
@@ -215,7 +534,7 @@ bool SipEngine::registerAccount(const SipCredentials& credentials) {
     acc_cfg.register_on_acc_add = PJ_TRUE;
 
     // Adicionar conta
-    status = pjsua_acc_add(&acc_cfg, PJ_TRUE, &m_accountId);
+    pj_status_t status = pjsua_acc_add(&acc_cfg, PJ_TRUE, &m_accountId);
     if (status != PJ_SUCCESS) {
         updateSnapshot([](SipSnapshot& s) {
             s.connection = SipConnectionState::Error;
@@ -224,14 +543,30 @@ bool SipEngine::registerAccount(const SipCredentials& credentials) {
         return false;
     }
 
+    // Assinaturas de BLF com esta conta saem no primeiro registro bem sucedido
+    m_blfAccount.accountId = m_accountId;
+    m_blfAccount.localUri = sipUri;
+    m_blfAccount.domain = credentials.server;
+    if (credentials.port != 5060) {
+        m_blfAccount.domain += ":" + std::to_string(credentials.port);
+    }
+    m_blfAccount.uriParams = transportParam;
+    m_blfAccount.username = credentials.username;
+    m_blfAccount.password = credentials.password;
+
     return true;
 }
 
 bool SipEngine::unregister() {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return unregister(); }, false);
+    }
+
     if (m_accountId == PJSUA_INVALID_ID) {
         return false;
     }
 
+    m_blf.clearAccount();
     pj_status_t status = pjsua_acc_set_registration(m_accountId, PJ_FALSE);
     if (status != PJ_SUCCESS) {
         return false;
@@ -245,6 +580,12 @@ bool SipEngine::unregister() {
 }
 
 bool SipEngine::makeCall(const std::string& target) {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return makeCall(target); }, false);
+    }
+
+    int64_t dialStart = monotonicMicros();
+
     if (m_accountId == PJSUA_INVALID_ID) {
         updateSnapshot([](SipSnapshot& s) {
             s.lastError = "Conta não registrada";
@@ -259,14 +600,19 @@ bool SipEngine::makeCall(const std::string& target) {
         return false;
     }
 
+    // Reabrir o dispositivo real enquanto o INVITE é enviado
+    wakeAudio();
+
     std::string targetUri = makeTargetUri(target);
     pj_str_t uri = pj_str(const_cast<char*>(targetUri.c_str()));
 
-    updateSnapshot([&target](SipSnapshot& s) {
+    updateSnapshot([&target, dialStart](SipSnapshot& s) {
         s.callStatus = CallState::Dialing;
         s.callDirection = CallDirection::Outgoing;
         s.remoteUri = target;  // Salvar número chamado
         s.lastError = "";
+        s.timings = CallTimings();
+        s.timings.dialStart = dialStart;
     });
 
     pj_status_t status = pjsua_call_make_call(m_accountId, &uri, nullptr, nullptr, nullptr, &m_currentCallId);
@@ -276,18 +622,36 @@ bool SipEngine::makeCall(const std::string& target) {
             s.callStatus = CallState::Failed;
             s.lastError = "Falha ao iniciar chamada";
         });
+        scheduleAudioIdle();
         return false;
     }
 
+    int64_t inviteSent = monotonicMicros();
+    updateSnapshot([inviteSent](SipSnapshot& s) {
+        s.timings.inviteSent = inviteSent;
+    });
+    beginCallRecord(m_currentCallId, CallLogDirection::Outgoing, target, "");
+
     emitEvent("callStarted");
     return true;
 }
 
 bool SipEngine::answerCall() {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return answerCall(); }, false);
+    }
+
     if (m_currentCallId == PJSUA_INVALID_ID) {
         return false;
     }
 
+    int64_t answerRequested = monotonicMicros();
+    updateSnapshot([answerRequested](SipSnapshot& s) {
+        if (s.timings.answerRequested == 0) {
+            s.timings.answerRequested = answerRequested;
+        }
+    });
+
     pj_status_t status = pjsua_call_answer(m_currentCallId, 200, nullptr, nullptr);
     if (status != PJ_SUCCESS) {
         updateSnapshot([](SipSnapshot& s) {
@@ -300,6 +664,10 @@ bool SipEngine::answerCall() {
 }
 
 bool SipEngine::rejectCall() {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return rejectCall(); }, false);
+    }
+
     if (m_currentCallId == PJSUA_INVALID_ID) {
         return false;
     }
@@ -309,6 +677,11 @@ bool SipEngine::rejectCall() {
         return false;
     }
 
+    auto active = m_activeCalls.find(m_currentCallId);
+    if (active != m_activeCalls.end()) {
+        active->second.rejectedLocally = true;
+    }
+
     updateSnapshot([](SipSnapshot& s) {
         s.callStatus = CallState::Terminated;
     });
@@ -319,6 +692,10 @@ bool SipEngine::rejectCall() {
 }
 
 bool SipEngine::hangupCall() {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return hangupCall(); }, false);
+    }
+
     if (m_currentCallId == PJSUA_INVALID_ID) {
         return false;
     }
@@ -332,180 +709,1614 @@ bool SipEngine::hangupCall() {
 }
 
 bool SipEngine::sendDtmf(const std::string& digits) {
-    if (m_currentCallId == PJSUA_INVALID_ID) {
-        return false;
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return sendDtmf(digits); }, false);
     }
 
-    pj_str_t dtmf = pj_str(const_cast<char*>(digits.c_str()));
-    pj_status_t status = pjsua_call_dial_dtmf(m_currentCallId, &dtmf);
-
-    return status == PJ_SUCCESS;
+    return playDtmf(digits, m_dtmfOptions);
 }
 
-bool SipEngine::transferBlind(const std::string& target) {
+bool SipEngine::playDtmf(const std::string& digits, const DtmfOptions& options) {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return playDtmf(digits, options); }, false);
+    }
+
     if (m_currentCallId == PJSUA_INVALID_ID) {
         return false;
     }
 
-    std::string targetUri = makeTargetUri(target);
-    pj_str_t uri = pj_str(const_cast<char*>(targetUri.c_str()));
+    // Fila de outra chamada (consulta que virou a atual, por exemplo)
+    if (m_dtmfPlaying && m_dtmfCallId != m_currentCallId) {
+        finishDtmf(true);
+    }
 
-    pj_status_t status = pjsua_call_xfer(m_currentCallId, &uri, nullptr);
-    if (status != PJ_SUCCESS) {
+    std::vector<DtmfStep> steps;
+    if (!parseDtmfSequence(digits, clampDtmfOptions(options), &steps) ||
+        m_dtmfQueue.size() + steps.size() > kDtmfMaxSteps) {
         updateSnapshot([](SipSnapshot& s) {
-            s.lastError = "Falha na transferência";
+            s.lastError = "Sequência DTMF inválida";
         });
         return false;
     }
 
-    emitEvent("transferStarted");
+    for (const DtmfStep& step : steps) {
+        if (step.digit != 0) {
+            m_dtmfTotal++;
+        }
+        m_dtmfQueue.push_back(step);
+    }
+
+    // Primeiro dígito sai imediatamente; os demais nos timers
+    if (!m_dtmfPlaying && !m_dtmfQueue.empty()) {
+        m_dtmfPlaying = true;
+        m_dtmfCallId = m_currentCallId;
+        playNextDtmfStep();
+    }
     return true;
 }
 
-bool SipEngine::transferAttended(const std::string& target) {
-    if (m_currentCallId == PJSUA_INVALID_ID) {
-        return false;
+bool SipEngine::cancelDtmf() {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return cancelDtmf(); }, false);
     }
 
-    // Para transferência assistida, primeiro fazemos uma chamada de consulta
-    std::string targetUri = makeTargetUri(target);
-    pj_str_t uri = pj_str(const_cast<char*>(targetUri.c_str()));
-
-    // Colocar chamada atual em hold
-    pjsua_call_set_hold(m_currentCallId, nullptr);
+    if (m_dtmfPlaying) {
+        finishDtmf(true);
+    }
+    return true;
+}
 
-    // Fazer chamada de consulta
-    pj_status_t status = pjsua_call_make_call(m_accountId, &uri, nullptr, nullptr, nullptr, &m_consultCallId);
-    if (status != PJ_SUCCESS) {
-        // Retomar chamada original
-        pjsua_call_reinvite(m_currentCallId, PJSUA_CALL_UNHOLD, nullptr);
-        updateSnapshot([](SipSnapshot& s) {
-            s.lastError = "Falha ao iniciar consulta";
-        });
-        return false;
+void SipEngine::setDtmfOptions(const DtmfOptions& options) {
+    if (!onSipThread()) {
+        m_sipThread.call<bool>([&]() { setDtmfOptions(options); return true; }, false);
+        return;
     }
 
-    // A transferência será completada quando a chamada de consulta for estabelecida
-    // (tratado no callback onCallState)
-    
-    emitEvent("consultStarted");
-    return true;
+    m_dtmfOptions = clampDtmfOptions(options);
 }
 
-void SipEngine::setMuted(bool muted) {
-    m_muted = muted;
+void SipEngine::playNextDtmfStep() {
+    if (m_dtmfQueue.empty()) {
+        finishDtmf(false);
+        return;
+    }
+    if (m_dtmfCallId != m_currentCallId) {
+        finishDtmf(true);
+        return;
+    }
 
-    if (m_currentCallId != PJSUA_INVALID_ID) {
-        pjsua_call_info ci;
-        pjsua_call_get_info(m_currentCallId, &ci);
+    DtmfStep step = m_dtmfQueue.front();
+    m_dtmfQueue.pop_front();
 
-        if (ci.media_status == PJSUA_CALL_MEDIA_ACTIVE) {
-            if (muted) {
-                // Desconectar microfone da conferência
-                pjsua_conf_disconnect(0, ci.conf_slot);
-            } else {
-                // Reconectar microfone à conferência
-                pjsua_conf_connect(0, ci.conf_slot);
-            }
+    unsigned delayMs = step.durationMs;
+    if (step.digit != 0) {
+        if (!sendDtmfDigit(step)) {
+            updateSnapshot([](SipSnapshot& s) {
+                s.lastError = "Falha ao enviar DTMF";
+            });
+            finishDtmf(true);
+            return;
         }
-    }
 
-    updateSnapshot([muted](SipSnapshot& s) {
-        s.muted = muted;
-    });
+        m_dtmfSent++;
+        delayMs += step.gapMs;
 
-    emitEvent("muteChanged");
-}
+        std::stringstream ss;
+        ss << "{\"digit\":\"" << step.digit << "\"";
+        ss << ",\"method\":\"" << dtmfMethodName(step.method) << "\"";
+        ss << ",\"sent\":" << m_dtmfSent;
+        ss << ",\"total\":" << m_dtmfTotal << "}";
+        emitJson("dtmfProgress", ss.str());
+    }
 
-bool SipEngine::toggleMuted() {
-    setMuted(!m_muted);
-    return m_muted;
+    pjsua_schedule_timer2(&SipEngine::onDtmfTimer,
+                          reinterpret_cast<void*>(static_cast<uintptr_t>(m_dtmfGeneration)), delayMs);
 }
 
-bool SipEngine::isMuted() const {
-    return m_muted;
-}
+bool SipEngine::sendDtmfDigit(const DtmfStep& step) {
+    char digit[2] = {step.digit, '\0'};
 
-std::vector<std::string> SipEngine::getAudioDevices() {
-    std::vector<std::string> devices;
-    
-    unsigned count = PJMEDIA_AUD_MAX_DEVS;
-    pjmedia_aud_dev_info info[PJMEDIA_AUD_MAX_DEVS];
-    
-    pj_status_t status = pjsua_enum_aud_devs(info, &count);
-    if (status == PJ_SUCCESS) {
-        for (unsigned i = 0; i < count; i++) {
-            devices.push_back(std::string(info[i].name));
+    if (step.method == DtmfMethod::InBand) {
+        if (!ensureToneGenerator(m_dtmfCallId)) {
+            return false;
+        }
+        pjmedia_tone_digit tone;
+        tone.digit = step.digit;
+        tone.on_msec = static_cast<short>(step.durationMs);
+        tone.off_msec = static_cast<short>(step.gapMs);
+        tone.volume = 0;    // Volume padrão do gerador
+        if (pjmedia_tonegen_play_digits(m_toneGenPort, 1, &tone, 0) != PJ_SUCCESS) {
+            return false;
         }
+        engineMetrics().dtmfInBand.inc();
+        return true;
     }
-    
-    return devices;
-}
 
-bool SipEngine::setAudioDevices(int captureDeviceId, int playbackDeviceId) {
-    pj_status_t status = pjsua_set_snd_dev(captureDeviceId, playbackDeviceId);
-    return status == PJ_SUCCESS;
-}
+    // RFC 2833 e SIP INFO: o PJSUA monta o evento/INFO com a duração pedida
+    pjsua_call_send_dtmf_param param;
+    pjsua_call_send_dtmf_param_default(&param);
+    param.method = step.method == DtmfMethod::SipInfo ? PJSUA_DTMF_METHOD_SIP_INFO : PJSUA_DTMF_METHOD_RFC2833;
+    param.duration = step.durationMs;
+    param.digits = pj_str(digit);
+    if (pjsua_call_send_dtmf(m_dtmfCallId, &param) != PJ_SUCCESS) {
+        return false;
+    }
 
-SipSnapshot SipEngine::getSnapshot() const {
-    std::lock_guard<std::mutex> lock(const_cast<std::mutex&>(m_snapshotMutex));
-    return m_snapshot;
+    if (step.method == DtmfMethod::SipInfo) {
+        engineMetrics().dtmfSipInfo.inc();
+    } else {
+        engineMetrics().dtmfRfc2833.inc();
+    }
+    return true;
 }
 
-void SipEngine::setEventCallback(EventCallback callback) {
-    std::lock_guard<std::mutex> lock(m_callbackMutex);
-    m_eventCallback = callback;
+void SipEngine::finishDtmf(bool cancelled) {
+    std::stringstream ss;
+    ss << "{\"sent\":" << m_dtmfSent;
+    ss << ",\"total\":" << m_dtmfTotal;
+    ss << ",\"cancelled\":" << (cancelled ? "true" : "false") << "}";
+
+    m_dtmfQueue.clear();
+    m_dtmfPlaying = false;
+    m_dtmfCallId = PJSUA_INVALID_ID;
+    m_dtmfGeneration++;
+    m_dtmfSent = 0;
+    m_dtmfTotal = 0;
+    releaseToneGenerator();
+
+    emitJson("dtmfDone", ss.str());
 }
 
-void SipEngine::processEvents() {
-    std::lock_guard<std::mutex> lock(m_eventQueueMutex);
-    
-    while (!m_eventQueue.empty()) {
-        auto& event = m_eventQueue.front();
-        
-        std::lock_guard<std::mutex> cbLock(m_callbackMutex);
-        if (m_eventCallback) {
-            m_eventCallback(event.first, event.second);
-        }
-        
-        m_eventQueue.pop();
+bool SipEngine::ensureToneGenerator(pjsua_call_id callId) {
+    if (m_toneGenPort) {
+        return true;
+    }
+
+    pjsua_conf_port_id callSlot = pjsua_call_get_conf_port(callId);
+    if (callSlot == PJSUA_INVALID_ID) {
+        return false;
+    }
+
+    // 8 kHz, 20 ms: a ponte de conferência reamostra para a taxa da chamada
+    m_toneGenPool = pjsua_pool_create("echo-dtmf", 512, 512);
+    if (!m_toneGenPool) {
+        return false;
+    }
+
+    pj_str_t name = pj_str(const_cast<char*>("echo-dtmf"));
+    if (pjmedia_tonegen_create2(m_toneGenPool, &name, 8000, 1, 160, 16, 0, &m_toneGenPort) != PJ_SUCCESS ||
+        pjsua_conf_add_port(m_toneGenPool, m_toneGenPort, &m_toneGenSlot) != PJ_SUCCESS) {
+        releaseToneGenerator();
+        return false;
     }
+
+    pjsua_conf_connect(m_toneGenSlot, callSlot);
+    return true;
 }
 
-void SipEngine::updateSnapshot(const std::function<void(SipSnapshot&)>& updater) {
-    std::lock_guard<std::mutex> lock(m_snapshotMutex);
-    updater(m_snapshot);
+void SipEngine::releaseToneGenerator() {
+    if (m_toneGenSlot != PJSUA_INVALID_ID) {
+        pjsua_conf_remove_port(m_toneGenSlot);
+        m_toneGenSlot = PJSUA_INVALID_ID;
+    }
+    if (m_toneGenPort) {
+        pjmedia_port_destroy(m_toneGenPort);
+        m_toneGenPort = nullptr;
+    }
+    if (m_toneGenPool) {
+        pj_pool_release(m_toneGenPool);
+        m_toneGenPool = nullptr;
+    }
+}
+
+void SipEngine::handleDtmfTimer(unsigned generation) {
+    // Timer de uma sequência já cancelada
+    if (!m_initialized || !m_dtmfPlaying || generation != m_dtmfGeneration) {
+        return;
+    }
+    playNextDtmfStep();
+}
+
+void SipEngine::setInbandDtmfDetection(bool enabled) {
+    if (!onSipThread()) {
+        m_sipThread.call<bool>([&]() { setInbandDtmfDetection(enabled); return true; }, false);
+        return;
+    }
+
+    m_inbandDtmfDetection = enabled;
+    if (!enabled) {
+        while (!m_inbandDetectors.empty()) {
+            retireInbandDetector(m_inbandDetectors.begin()->first);
+        }
+    } else if (m_currentCallId != PJSUA_INVALID_ID) {
+        attachInbandDetector(m_currentCallId);
+    }
+}
+
+void SipEngine::attachInbandDetector(pjsua_call_id callId) {
+    if (!m_inbandDtmfDetection || m_inbandDetectors.count(callId) != 0) {
+        return;
+    }
+
+    purgeRetiredDetectors(monotonicMicros() - 1000000);
+
+    // Thread de mídia: apenas repassa para o thread SIP
+    auto port = InbandDtmfPort::attach(callId, [](pjsua_call_id id, char digit) {
+        SipEngine* engine = s_instance;
+        if (!engine) return;
+        engine->post([engine, id, digit]() {
+            engine->handleDtmfDigit(id, digit, true);
+        });
+    });
+    if (port) {
+        m_inbandDetectors[callId] = std::move(port);
+    }
+}
+
+void SipEngine::retireInbandDetector(pjsua_call_id callId) {
+    auto it = m_inbandDetectors.find(callId);
+    if (it == m_inbandDetectors.end()) {
+        return;
+    }
+
+    it->second->detach();
+    m_retiredDetectors.emplace_back(monotonicMicros(), std::move(it->second));
+    m_inbandDetectors.erase(it);
+}
+
+void SipEngine::purgeRetiredDetectors(int64_t olderThan) {
+    auto end = std::remove_if(m_retiredDetectors.begin(), m_retiredDetectors.end(),
+                              [olderThan](const auto& retired) { return retired.first < olderThan; });
+    m_retiredDetectors.erase(end, m_retiredDetectors.end());
+}
+
+void SipEngine::handleDtmfDigit(pjsua_call_id callId, char digit, bool inband) {
+    if (!m_initialized) return;
+
+    if (inband) {
+        // Detector já desligado (RFC 2833 chegou ou a chamada terminou)
+        if (m_inbandDetectors.count(callId) == 0) {
+            return;
+        }
+        engineMetrics().dtmfReceivedInBand.inc();
+    } else {
+        // O tronco envia telephone-event: o áudio não precisa mais ser analisado
+        retireInbandDetector(callId);
+        engineMetrics().dtmfReceivedRfc2833.inc();
+    }
+
+    std::string json = "{\"digit\":\"";
+    json += digit;
+    json += "\",\"source\":\"";
+    json += inband ? "inband" : "rfc2833";
+    json += "\"}";
+    emitJson("dtmfReceived", json);
+}
+
+bool SipEngine::transferBlind(const std::string& target) {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return transferBlind(target); }, false);
+    }
+
+    if (m_currentCallId == PJSUA_INVALID_ID) {
+        return false;
+    }
+
+    std::string targetUri = makeTargetUri(target);
+    pj_str_t uri = pj_str(const_cast<char*>(targetUri.c_str()));
+
+    pj_status_t status = pjsua_call_xfer(m_currentCallId, &uri, nullptr);
+    if (status != PJ_SUCCESS) {
+        updateSnapshot([](SipSnapshot& s) {
+            s.lastError = "Falha na transferência";
+        });
+        return false;
+    }
+
+    auto active = m_activeCalls.find(m_currentCallId);
+    if (active != m_activeCalls.end()) {
+        active->second.record.transfer = CallTransfer::Blind;
+    }
+
+    emitEvent("transferStarted");
+    return true;
+}
+
+bool SipEngine::transferAttended(const std::string& target) {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return transferAttended(target); }, false);
+    }
+
+    if (!startConsult(target)) {
+        return false;
+    }
+
+    // Completada assim que a consulta for estabelecida (handleTransferLegState)
+    m_transfer.autoComplete = true;
+    return true;
+}
+
+bool SipEngine::startConsult(const std::string& target) {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return startConsult(target); }, false);
+    }
+
+    if (m_currentCallId == PJSUA_INVALID_ID || m_transfer.phase != TransferPhase::Idle) {
+        updateSnapshot([](SipSnapshot& s) {
+            s.lastError = "Nenhuma chamada disponível para transferir";
+        });
+        return false;
+    }
+
+    auto original = m_activeCalls.find(m_currentCallId);
+    if (original == m_activeCalls.end() || original->second.held) {
+        updateSnapshot([](SipSnapshot& s) {
+            s.lastError = "Chamada em espera não pode ser transferida";
+        });
+        return false;
+    }
+
+    std::string targetUri = makeTargetUri(target);
+    pj_str_t uri = pj_str(const_cast<char*>(targetUri.c_str()));
+
+    // Espera local: a original sai da ponte (com música), sem re-INVITE
+    pjsua_call_id originalCallId = m_currentCallId;
+    detachHeldCall(originalCallId);
+
+    pjsua_call_id consultCallId = PJSUA_INVALID_ID;
+    pj_status_t status = pjsua_call_make_call(m_accountId, &uri, nullptr, nullptr, nullptr, &consultCallId);
+    if (status != PJ_SUCCESS) {
+        attachResumedCall(originalCallId);
+        updateSnapshot([](SipSnapshot& s) {
+            s.lastError = "Falha ao iniciar consulta";
+        });
+        return false;
+    }
+
+    beginCallRecord(consultCallId, CallLogDirection::Outgoing, target, "");
+
+    m_transfer = AttendedTransfer();
+    m_transfer.phase = TransferPhase::Dialing;
+    m_transfer.originalCallId = originalCallId;
+    m_transfer.consultCallId = consultCallId;
+    m_transfer.talkingCallId = consultCallId;
+
+    emitEvent("consultStarted");
+    emitTransferState("", 0);
+    return true;
+}
+
+bool SipEngine::swapTransferLegs() {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return swapTransferLegs(); }, false);
+    }
+
+    if (m_transfer.phase != TransferPhase::Dialing && m_transfer.phase != TransferPhase::Consulting) {
+        updateSnapshot([](SipSnapshot& s) {
+            s.lastError = "Nenhuma consulta em andamento";
+        });
+        return false;
+    }
+
+    talkOn(m_transfer.talkingCallId == m_transfer.originalCallId ? m_transfer.consultCallId
+                                                                 : m_transfer.originalCallId);
+    emitTransferState("", 0);
+    return true;
+}
+
+bool SipEngine::completeTransfer() {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return completeTransfer(); }, false);
+    }
+
+    if (m_transfer.phase != TransferPhase::Consulting) {
+        updateSnapshot([](SipSnapshot& s) {
+            s.lastError = "Consulta ainda não estabelecida";
+        });
+        return false;
+    }
+
+    // REFER com Replaces na original: o transferido liga direto para o destino
+    pj_status_t status = pjsua_call_xfer_replaces(m_transfer.originalCallId, m_transfer.consultCallId,
+                                                  PJSUA_XFER_NO_REQUIRE_REPLACES, nullptr);
+    if (status != PJ_SUCCESS) {
+        updateSnapshot([](SipSnapshot& s) {
+            s.lastError = "Falha ao completar transferência";
+        });
+        return false;
+    }
+
+    auto active = m_activeCalls.find(m_transfer.originalCallId);
+    if (active != m_activeCalls.end()) {
+        active->second.record.transfer = CallTransfer::Attended;
+    }
+
+    m_transfer.phase = TransferPhase::Completing;
+    emitTransferState("", 0);
+    return true;
+}
+
+bool SipEngine::cancelTransfer() {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return cancelTransfer(); }, false);
+    }
+
+    if (m_transfer.phase != TransferPhase::Dialing && m_transfer.phase != TransferPhase::Consulting) {
+        updateSnapshot([](SipSnapshot& s) {
+            s.lastError = "Nenhuma consulta em andamento";
+        });
+        return false;
+    }
+
+    // O áudio volta para a original já; o BYE da consulta segue em paralelo
+    pjsua_call_id consultCallId = m_transfer.consultCallId;
+    talkOn(m_transfer.originalCallId);
+    endTransfer("cancelled", 0);
+    hangupConsult(consultCallId);
+    return true;
+}
+
+bool SipEngine::inTransfer(pjsua_call_id callId) const {
+    return m_transfer.phase != TransferPhase::Idle &&
+        (callId == m_transfer.originalCallId || callId == m_transfer.consultCallId);
+}
+
+void SipEngine::talkOn(pjsua_call_id callId) {
+    if (callId == PJSUA_INVALID_ID) {
+        return;
+    }
+    pjsua_call_id other = callId == m_transfer.originalCallId ? m_transfer.consultCallId : m_transfer.originalCallId;
+    auto otherCall = m_activeCalls.find(other);
+    if (otherCall != m_activeCalls.end() && !otherCall->second.held) {
+        detachHeldCall(other);
+    }
+    auto call = m_activeCalls.find(callId);
+    if (call != m_activeCalls.end() && call->second.held) {
+        attachResumedCall(callId);
+    }
+    m_transfer.talkingCallId = callId;
+}
+
+void SipEngine::endTransfer(const char* result, int statusCode) {
+    emitTransferState(result, statusCode);
+    m_transfer = AttendedTransfer();
+}
+
+void SipEngine::hangupConsult(pjsua_call_id callId) {
+    m_drainingConsults.push_back(callId);
+    pjsua_call_hangup(callId, 0, nullptr, nullptr);
+}
+
+void SipEngine::emitTransferState(const char* result, int statusCode) {
+    static const char* const kPhases[] = {"idle", "dialing", "consulting", "completing"};
+    bool finished = result[0] != '\0';
+
+    std::stringstream ss;
+    ss << "{\"phase\":\"" << kPhases[finished ? 0 : static_cast<int>(m_transfer.phase)] << "\"";
+    ss << ",\"originalCallId\":" << m_transfer.originalCallId;
+    ss << ",\"consultCallId\":" << m_transfer.consultCallId;
+    ss << ",\"talkingCallId\":" << m_transfer.talkingCallId;
+    if (finished) {
+        ss << ",\"result\":\"" << result << "\"";
+    }
+    if (statusCode != 0) {
+        ss << ",\"statusCode\":" << statusCode;
+    }
+    ss << "}";
+    emitJson("transferState", ss.str());
+}
+
+void SipEngine::handleTransferLegState(pjsua_call_id callId, pjsip_inv_state state, int lastStatus) {
+    if (state == PJSIP_INV_STATE_CONFIRMED && callId == m_transfer.consultCallId &&
+        m_transfer.phase == TransferPhase::Dialing) {
+        m_transfer.phase = TransferPhase::Consulting;
+        emitTransferState("", 0);
+        if (m_transfer.autoComplete && !completeTransfer()) {
+            talkOn(m_transfer.originalCallId);
+            pjsua_call_id consultCallId = m_transfer.consultCallId;
+            endTransfer("failed", 0);
+            hangupConsult(consultCallId);
+        }
+        return;
+    }
+
+    if (state != PJSIP_INV_STATE_DISCONNECTED) {
+        return;
+    }
+
+    if (callId == m_transfer.consultCallId) {
+        if (m_transfer.phase == TransferPhase::Completing) {
+            // O destino encerra a consulta ao aceitar o Replaces; o resultado vem no NOTIFY
+            m_transfer.consultCallId = PJSUA_INVALID_ID;
+            return;
+        }
+        // Destino recusou ou desligou: volta para a original
+        talkOn(m_transfer.originalCallId);
+        endTransfer("consultEnded", lastStatus);
+        return;
+    }
+
+    if (callId == m_transfer.originalCallId) {
+        if (m_transfer.phase == TransferPhase::Completing) {
+            // Encerrada após o NOTIFY de sucesso (ou pelo transferido)
+            endTransfer("completed", 0);
+            return;
+        }
+        // O transferido desligou: a consulta vira a chamada atual
+        talkOn(m_transfer.consultCallId);
+        m_currentCallId = m_transfer.consultCallId;
+        endTransfer("originalEnded", lastStatus);
+    }
+}
+
+bool SipEngine::holdCall(int callId) {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return holdCall(callId); }, false);
+    }
+
+    auto active = m_activeCalls.find(callId);
+    pjsua_call_info ci;
+    if (active == m_activeCalls.end() || pjsua_call_get_info(callId, &ci) != PJ_SUCCESS ||
+        ci.state != PJSIP_INV_STATE_CONFIRMED) {
+        updateSnapshot([](SipSnapshot& s) {
+            s.lastError = "Chamada não estabelecida";
+        });
+        return false;
+    }
+    if (inTransfer(callId)) {
+        updateSnapshot([](SipSnapshot& s) {
+            s.lastError = "Chamada em transferência";
+        });
+        return false;
+    }
+    if (active->second.held) {
+        return true;
+    }
+
+    // Sai da ponte antes do re-INVITE: a mixagem para a chamada para na hora
+    detachHeldCall(callId);
+    if (pjsua_call_set_hold(callId, nullptr) != PJ_SUCCESS) {
+        attachResumedCall(callId);
+        updateSnapshot([](SipSnapshot& s) {
+            s.lastError = "Falha ao colocar em espera";
+        });
+        return false;
+    }
+
+    // Só a espera pedida pelo usuário conta no gauge (a espera local da
+    // transferência assistida usa os mesmos helpers)
+    active->second.userHeld = true;
+    engineMetrics().callsHeld.add(1);
+    emitHoldChanged(callId, true);
+    return true;
+}
+
+bool SipEngine::resumeCall(int callId) {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return resumeCall(callId); }, false);
+    }
+
+    auto active = m_activeCalls.find(callId);
+    if (active == m_activeCalls.end()) {
+        updateSnapshot([](SipSnapshot& s) {
+            s.lastError = "Chamada não encontrada";
+        });
+        return false;
+    }
+    if (inTransfer(callId)) {
+        updateSnapshot([](SipSnapshot& s) {
+            s.lastError = "Chamada em transferência";
+        });
+        return false;
+    }
+    if (!active->second.held) {
+        return true;
+    }
+
+    // Conexões refeitas antes da resposta: o áudio flui assim que o stream
+    // volta a sendrecv
+    attachResumedCall(callId);
+    if (pjsua_call_reinvite(callId, PJSUA_CALL_UNHOLD, nullptr) != PJ_SUCCESS) {
+        detachHeldCall(callId);
+        updateSnapshot([](SipSnapshot& s) {
+            s.lastError = "Falha ao retomar chamada";
+        });
+        return false;
+    }
+
+    if (active->second.userHeld) {
+        active->second.userHeld = false;
+        engineMetrics().callsHeld.sub(1);
+    }
+    emitHoldChanged(callId, false);
+    return true;
+}
+
+bool SipEngine::setHoldMusic(const std::string& path) {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return setHoldMusic(path); }, false);
+    }
+
+    // A ponte remove portas no ciclo seguinte: a anterior não é liberada já
+    int64_t now = monotonicMicros();
+    auto end = std::remove_if(m_retiredHoldMusic.begin(), m_retiredHoldMusic.end(),
+                              [now](const auto& retired) { return retired.first < now - 1000000; });
+    m_retiredHoldMusic.erase(end, m_retiredHoldMusic.end());
+    if (m_holdMusic) {
+        m_holdMusic->detach();
+        m_retiredHoldMusic.emplace_back(now, std::move(m_holdMusic));
+    }
+
+    m_holdMusicPath = path;
+    if (path.empty() || !m_initialized) {
+        // Sem ponte ainda: o arquivo é aberto no primeiro hold
+        return true;
+    }
+
+    std::string error;
+    m_holdMusic = HoldMusicPort::create(path, &error);
+    if (!m_holdMusic) {
+        m_holdMusicPath.clear();
+        updateSnapshot([error](SipSnapshot& s) {
+            s.lastError = error;
+        });
+        return false;
+    }
+
+    for (const auto& active : m_activeCalls) {
+        if (active.second.held) {
+            connectHoldMusic(active.first);
+        }
+    }
+    return true;
+}
+
+void SipEngine::detachHeldCall(pjsua_call_id callId) {
+    auto active = m_activeCalls.find(callId);
+    if (active == m_activeCalls.end()) {
+        return;
+    }
+    ActiveCall& call = active->second;
+    call.held = true;
+
+    pjsua_conf_port_id callSlot = pjsua_call_get_conf_port(callId);
+    if (callSlot != PJSUA_INVALID_ID) {
+        pjsua_conf_disconnect(callSlot, 0);
+    }
+
+    // Microfone: a contagem do VAD para enquanto a chamada está fora
+    auto source = m_micSources.find(callId);
+    if (source != m_micSources.end()) {
+        if (call.vadGated) {
+            call.vadSuppressed = vadSuppressedFrames(callId);
+            call.vadGated = false;
+        }
+        if (callSlot != PJSUA_INVALID_ID) {
+            pjsua_conf_disconnect(source->second, callSlot);
+        }
+        m_micSources.erase(source);
+        releaseCaptureSource();
+    }
+
+    retireInbandDetector(callId);
+    connectHoldMusic(callId);
+}
+
+void SipEngine::attachResumedCall(pjsua_call_id callId) {
+    auto active = m_activeCalls.find(callId);
+    if (active == m_activeCalls.end()) {
+        return;
+    }
+    active->second.held = false;
+
+    pjsua_conf_port_id callSlot = pjsua_call_get_conf_port(callId);
+    if (callSlot == PJSUA_INVALID_ID) {
+        return;
+    }
+    if (m_holdMusic) {
+        pjsua_conf_disconnect(m_holdMusic->slot(), callSlot);
+    }
+    pjsua_conf_connect(callSlot, 0);
+    routeMic(callId);
+    attachInbandDetector(callId);
+}
+
+void SipEngine::connectHoldMusic(pjsua_call_id callId) {
+    if (!m_holdMusic && !m_holdMusicPath.empty()) {
+        std::string error;
+        m_holdMusic = HoldMusicPort::create(m_holdMusicPath, &error);
+        if (!m_holdMusic) {
+            // Não tenta de novo a cada hold
+            m_holdMusicPath.clear();
+            updateSnapshot([error](SipSnapshot& s) {
+                s.lastError = error;
+            });
+        }
+    }
+
+    pjsua_conf_port_id callSlot = pjsua_call_get_conf_port(callId);
+    if (m_holdMusic && callSlot != PJSUA_INVALID_ID) {
+        pjsua_conf_connect(m_holdMusic->slot(), callSlot);
+    }
+}
+
+void SipEngine::emitHoldChanged(pjsua_call_id callId, bool held) {
+    std::stringstream ss;
+    ss << "{\"callId\":" << callId;
+    ss << ",\"held\":" << (held ? "true" : "false");
+    ss << ",\"music\":" << (held && m_holdMusic ? "true" : "false");
+    ss << "}";
+    emitJson("holdChanged", ss.str());
+}
+
+void SipEngine::setMuted(bool muted) {
+    if (!onSipThread()) {
+        m_sipThread.call<bool>([&]() { setMuted(muted); return true; }, false);
+        return;
+    }
+
+    m_muted = muted;
+
+    // Desconecta ou reconecta o microfone conforme m_muted (a perna que está
+    // com o áudio pode ser a consulta de uma transferência)
+    for (const auto& source : std::map<pjsua_call_id, pjsua_conf_port_id>(m_micSources)) {
+        routeMic(source.first);
+    }
+
+    updateSnapshot([muted](SipSnapshot& s) {
+        s.muted = muted;
+    });
+
+    emitEvent("muteChanged");
+}
+
+bool SipEngine::toggleMuted() {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return toggleMuted(); }, false);
+    }
+
+    setMuted(!m_muted);
+    return m_muted;
+}
+
+bool SipEngine::isMuted() const {
+    return m_muted;
+}
+
+bool SipEngine::setCaptureProcessing(const CaptureStages& stages, unsigned budgetPercent) {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return setCaptureProcessing(stages, budgetPercent); }, false);
+    }
+
+    m_captureStages = stages;
+    m_captureBudgetPercent = std::clamp(budgetPercent, kCaptureMinBudgetPercent, kCaptureMaxBudgetPercent);
+    if (m_capturePort) {
+        m_capturePort->processor().setStages(stages);
+        m_capturePort->processor().setBudgetPercent(m_captureBudgetPercent);
+    }
+
+    // Sem chamadas a nova configuração vale a partir da próxima mídia ativa
+    if (!m_initialized || m_activeCalls.empty()) {
+        return true;
+    }
+
+    // Chamadas em espera também mudam: voltam a transmitir pela nova origem
+    for (const auto& source : std::map<pjsua_call_id, pjsua_conf_port_id>(m_micSources)) {
+        routeMic(source.first);
+    }
+    releaseCaptureSource();
+    return true;
+}
+
+CaptureProcessorStats SipEngine::getCaptureStats() {
+    if (!onSipThread()) {
+        return m_sipThread.call<CaptureProcessorStats>([&]() { return getCaptureStats(); }, CaptureProcessorStats());
+    }
+
+    if (m_capturePort) {
+        return m_capturePort->processor().stats();
+    }
+
+    CaptureProcessorStats stats;
+    stats.requested = m_captureStages;
+    stats.active = m_captureStages;
+    return stats;
+}
+
+pjsua_conf_port_id SipEngine::captureSource(bool gated) {
+    if (!gated && !m_captureStages.any()) {
+        return 0;
+    }
+
+    if (!m_capturePort) {
+        // Thread de mídia: apenas repassa para o thread SIP
+        m_capturePort = CapturePort::create(&engineMetrics().captureFrameTime,
+                                            [](const CaptureStages& active, int64_t frameMicros) {
+            SipEngine* engine = s_instance;
+            if (!engine) return;
+            engine->post([engine, active, frameMicros]() {
+                engine->handleCaptureDowngraded(active, frameMicros);
+            });
+        });
+        if (!m_capturePort) {
+            // Sem a porta o microfone segue direto para a chamada
+            return 0;
+        }
+        m_capturePort->processor().setStages(m_captureStages);
+        m_capturePort->processor().setBudgetPercent(m_captureBudgetPercent);
+        m_capturePort->configureVad(m_vadOptions.hangoverMs, m_vadOptions.thresholdDb);
+    }
+
+    if (!m_captureSourceConnected) {
+        if (pjsua_conf_connect(0, m_capturePort->slot()) != PJ_SUCCESS) {
+            return 0;
+        }
+        m_captureSourceConnected = true;
+    }
+    return gated ? m_capturePort->gatedSlot() : m_capturePort->slot();
+}
+
+void SipEngine::releaseCaptureSource() {
+    if (!m_captureSourceConnected) {
+        return;
+    }
+
+    // Alguma chamada ainda recebe o microfone pela porta de captura
+    for (const auto& source : m_micSources) {
+        if (source.second != 0) {
+            return;
+        }
+    }
+
+    pjsua_conf_disconnect(0, m_capturePort->slot());
+    m_captureSourceConnected = false;
+}
+
+void SipEngine::routeMic(pjsua_call_id callId) {
+    pjsua_conf_port_id callSlot = pjsua_call_get_conf_port(callId);
+    if (callSlot == PJSUA_INVALID_ID) {
+        return;
+    }
+
+    auto active = m_activeCalls.find(callId);
+    if (active != m_activeCalls.end() && active->second.held) {
+        // Em espera o microfone fica desligado até o resume
+        return;
+    }
+    bool wantVad = active != m_activeCalls.end() && vadAppliesToCodec(m_vadOptions, active->second.record.codec);
+    pjsua_conf_port_id source = captureSource(wantVad);
+
+    auto previous = m_micSources.find(callId);
+    if (previous != m_micSources.end() && previous->second != source) {
+        pjsua_conf_disconnect(previous->second, callSlot);
+    }
+    m_micSources[callId] = source;
+
+    if (m_muted) {
+        pjsua_conf_disconnect(source, callSlot);
+    } else {
+        pjsua_conf_connect(source, callSlot);
+    }
+
+    // Pacotes suprimidos contam só enquanto a chamada usa a saída com VAD
+    if (active != m_activeCalls.end()) {
+        bool gated = m_capturePort && source == m_capturePort->gatedSlot();
+        ActiveCall& call = active->second;
+        if (gated != call.vadGated) {
+            if (gated) {
+                call.vadBase = m_capturePort->suppressedFrames();
+            } else {
+                call.vadSuppressed = vadSuppressedFrames(callId);
+            }
+            call.vadGated = gated;
+        }
+    }
+}
+
+uint64_t SipEngine::vadSuppressedFrames(pjsua_call_id callId) const {
+    auto it = m_activeCalls.find(callId);
+    if (it == m_activeCalls.end()) {
+        return 0;
+    }
+    const ActiveCall& call = it->second;
+    if (!call.vadGated || !m_capturePort) {
+        return call.vadSuppressed;
+    }
+    // A saída com VAD é compartilhada: conta o que foi suprimido desde a entrada
+    return call.vadSuppressed + (m_capturePort->suppressedFrames() - call.vadBase);
+}
+
+bool SipEngine::setVadOptions(const VadOptions& options) {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return setVadOptions(options); }, false);
+    }
+
+    m_vadOptions = clampVadOptions(options);
+    if (m_capturePort) {
+        m_capturePort->configureVad(m_vadOptions.hangoverMs, m_vadOptions.thresholdDb);
+    }
+
+    // Chamadas em andamento passam para a saída com ou sem VAD
+    for (const auto& source : std::map<pjsua_call_id, pjsua_conf_port_id>(m_micSources)) {
+        routeMic(source.first);
+    }
+    releaseCaptureSource();
+    return true;
+}
+
+std::vector<CallVadStats> SipEngine::getVadStats() {
+    if (!onSipThread()) {
+        return m_sipThread.call<std::vector<CallVadStats>>([&]() { return getVadStats(); },
+                                                           std::vector<CallVadStats>());
+    }
+
+    std::vector<CallVadStats> stats;
+    for (const auto& active : m_activeCalls) {
+        CallVadStats call;
+        call.callId = active.first;
+        call.codec = active.second.record.codec;
+        call.active = active.second.vadGated;
+        call.suppressedPackets = vadSuppressedFrames(active.first);
+        stats.push_back(call);
+    }
+    return stats;
+}
+
+void SipEngine::handleCaptureDowngraded(const CaptureStages& active, int64_t frameMicros) {
+    if (!m_initialized) return;
+
+    engineMetrics().captureDowngrades.inc();
+
+    std::stringstream ss;
+    ss << "{\"highPass\":" << (active.highPass ? "true" : "false")
+       << ",\"noiseSuppression\":" << (active.noiseSuppression ? "true" : "false")
+       << ",\"agc\":" << (active.agc ? "true" : "false")
+       << ",\"frameMicros\":" << frameMicros << "}";
+    emitJson("captureDowngraded", ss.str());
+}
+
+bool SipEngine::setOpusOptions(const OpusOptions& options) {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return setOpusOptions(options); }, false);
+    }
+
+    m_opusOptions = clampOpusOptions(options);
+    for (auto& entry : m_opusCalls) {
+        entry.second.controller.setOptions(m_opusOptions);
+    }
+
+    // Antes do init a configuração é aplicada junto com o PJSUA
+    if (!m_initialized) {
+        return true;
+    }
+    if (!configureOpus()) {
+        updateSnapshot([](SipSnapshot& s) {
+            s.lastError = "Opus indisponível";
+        });
+        return false;
+    }
+    return true;
+}
+
+void SipEngine::disableCodecVad() {
+    pjsua_codec_info codecs[32];
+    unsigned count = PJ_ARRAY_SIZE(codecs);
+    if (pjsua_enum_codecs(codecs, &count) != PJ_SUCCESS) {
+        return;
+    }
+
+    for (unsigned i = 0; i < count; ++i) {
+        // No Opus setting.vad é o DTX (configureOpus)
+        if (pj_strnicmp2(&codecs[i].codec_id, "opus/", 5) == 0) {
+            continue;
+        }
+        pjmedia_codec_param param;
+        if (pjsua_codec_get_param(&codecs[i].codec_id, &param) == PJ_SUCCESS && param.setting.vad) {
+            param.setting.vad = 0;
+            pjsua_codec_set_param(&codecs[i].codec_id, &param);
+        }
+    }
+}
+
+bool SipEngine::configureOpus() {
+#if defined(PJMEDIA_HAS_OPUS_CODEC) && PJMEDIA_HAS_OPUS_CODEC
+    pj_str_t codecId = pj_str(const_cast<char*>("opus/48000/2"));
+    pjmedia_codec_param param;
+    if (pjsua_codec_get_param(&codecId, &param) != PJ_SUCCESS) {
+        return false;
+    }
+
+    // Banda larga mono na taxa da ponte (sem reamostragem)
+    pjmedia_codec_opus_config cfg;
+    pjmedia_codec_opus_get_config(&cfg);
+    cfg.sample_rate = 16000;
+    cfg.channel_cnt = 1;
+    cfg.bit_rate = m_opusOptions.startBitrate;
+    cfg.packet_loss = m_opusLossPercent;
+    cfg.cbr = PJ_FALSE;
+
+    param.setting.vad = m_opusOptions.dtx ? 1 : 0;
+    param.setting.plc = m_opusOptions.fec ? 1 : 0;
+    if (pjmedia_codec_opus_set_default_param(&cfg, &param) != PJ_SUCCESS) {
+        return false;
+    }
+
+    pjsua_codec_set_priority(&codecId, PJMEDIA_CODEC_PRIO_HIGHEST);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void SipEngine::startOpusControl(pjsua_call_id callId, unsigned mediaIndex) {
+    auto it = m_opusCalls.find(callId);
+    if (it != m_opusCalls.end()) {
+        // Re-INVITE: stream novo, contadores RTCP recomeçam
+        it->second.mediaIndex = mediaIndex;
+        it->second.controller.reset();
+    } else {
+        OpusCall call{OpusRateController(m_opusOptions), mediaIndex};
+        m_opusCalls.emplace(callId, std::move(call));
+    }
+
+    if (!m_opusTimerActive) {
+        m_opusTimerActive = true;
+        pjsua_schedule_timer2(&SipEngine::onOpusTimer,
+                              reinterpret_cast<void*>(static_cast<uintptr_t>(m_opusGeneration)),
+                              kOpusControlIntervalMs);
+    }
+}
+
+void SipEngine::stopOpusControl(pjsua_call_id callId) {
+    auto it = m_opusCalls.find(callId);
+    if (it == m_opusCalls.end()) {
+        return;
+    }
+
+    // A rede costuma ser a mesma na próxima chamada
+    unsigned lossPercent = it->second.controller.target().packetLossPercent;
+    m_opusCalls.erase(it);
+    if (lossPercent != m_opusLossPercent) {
+        m_opusLossPercent = lossPercent;
+        configureOpus();
+    }
+}
+
+bool SipEngine::applyOpusTarget(pjsua_call_id callId, const OpusTarget& target) {
+    std::lock_guard<std::mutex> lock(m_audioStreamsMutex);
+    auto it = m_audioStreams.find(callId);
+    if (it == m_audioStreams.end()) {
+        return false;
+    }
+
+    pjmedia_stream_info info;
+    if (pjmedia_stream_get_info(it->second, &info) != PJ_SUCCESS || !info.param) {
+        return false;
+    }
+
+    pjmedia_codec_param param = *info.param;
+    param.info.avg_bps = target.bitrate;
+    param.setting.packet_loss = target.packetLossPercent;
+    param.setting.vad = m_opusOptions.dtx ? 1 : 0;
+    param.setting.plc = m_opusOptions.fec ? 1 : 0;
+    return pjmedia_stream_modify_codec_param(it->second, &param) == PJ_SUCCESS;
+}
+
+void SipEngine::handleOpusTimer(unsigned generation) {
+    if (!m_initialized || generation != m_opusGeneration) {
+        return;
+    }
+    if (m_opusCalls.empty()) {
+        m_opusTimerActive = false;
+        return;
+    }
+
+    for (auto& entry : m_opusCalls) {
+        pjsua_stream_stat stat;
+        if (pjsua_call_get_stream_stat(entry.first, entry.second.mediaIndex, &stat) != PJ_SUCCESS) {
+            continue;
+        }
+
+        // Contadores de transmissão como vistos pelo outro lado (Receiver Reports)
+        RtcpTxSample sample;
+        sample.reports = stat.rtcp.tx.update_cnt;
+        sample.packetsSent = stat.rtcp.tx.pkt;
+        sample.packetsLost = stat.rtcp.tx.loss;
+        sample.rttMs = stat.rtcp.rtt.last / 1000.0;
+
+        OpusRateController& controller = entry.second.controller;
+        OpusTarget target;
+        if (!controller.update(sample, &target) || !applyOpusTarget(entry.first, target)) {
+            continue;
+        }
+
+        engineMetrics().opusAdaptations.inc();
+        engineMetrics().opusBitrate.set(target.bitrate);
+
+        std::stringstream ss;
+        ss << "{\"callId\":" << entry.first
+           << ",\"bitrate\":" << target.bitrate
+           << ",\"packetLossPercent\":" << target.packetLossPercent
+           << ",\"measuredLoss\":" << static_cast<int>(controller.lossFraction() * 1000.0 + 0.5) / 10.0
+           << ",\"rttMs\":" << static_cast<int64_t>(sample.rttMs) << "}";
+        emitJson("opusAdapted", ss.str());
+    }
+
+    pjsua_schedule_timer2(&SipEngine::onOpusTimer,
+                          reinterpret_cast<void*>(static_cast<uintptr_t>(generation)), kOpusControlIntervalMs);
+}
+
+std::vector<std::string> SipEngine::getAudioDevices() {
+    if (!onSipThread()) {
+        std::vector<std::string> devices;
+        m_sipThread.call<bool>([&]() { devices = getAudioDevices(); return true; }, false);
+        return devices;
+    }
+
+    std::vector<std::string> devices;
+    
+    unsigned count = PJMEDIA_AUD_MAX_DEVS;
+    pjmedia_aud_dev_info info[PJMEDIA_AUD_MAX_DEVS];
+    
+    pj_status_t status = pjsua_enum_aud_devs(info, &count);
+    if (status == PJ_SUCCESS) {
+        for (unsigned i = 0; i < count; i++) {
+            devices.push_back(std::string(info[i].name));
+        }
+    }
+    
+    return devices;
+}
+
+bool SipEngine::setAudioDevices(int captureDeviceId, int playbackDeviceId) {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return setAudioDevices(captureDeviceId, playbackDeviceId); }, false);
+    }
+
+    m_captureDevice = captureDeviceId;
+    m_playbackDevice = playbackDeviceId;
+
+    // Ocioso: a escolha é aplicada quando o dispositivo for reaberto
+    if (m_audioIdle) {
+        return true;
+    }
+
+    pj_status_t status = pjsua_set_snd_dev(captureDeviceId, playbackDeviceId);
+    return status == PJ_SUCCESS;
+}
+
+void SipEngine::setAudioPowerPolicy(const AudioPowerPolicy& policy) {
+    if (!onSipThread()) {
+        m_sipThread.call<bool>([&]() { setAudioPowerPolicy(policy); return true; }, false);
+        return;
+    }
+
+    m_powerPolicy = policy;
+
+    if (!m_initialized) {
+        return;
+    }
+
+    if (policy.nullDeviceWhenIdle) {
+        scheduleAudioIdle();
+    } else {
+        wakeAudio();
+    }
+}
+
+ContactIndexStats SipEngine::loadContacts(const std::vector<ContactEntry>& entries, const NumberPlan& plan) {
+    // A tabela é montada no thread chamador e trocada atomicamente
+    return m_contacts->load(entries, plan);
+}
+
+bool SipEngine::lookupContact(const std::string& number, std::string* name) const {
+    return m_contacts->lookup(number, name);
+}
+
+ContactIndexStats SipEngine::getContactStats() const {
+    return m_contacts->getStats();
+}
+
+bool SipEngine::watchExtensions(const std::vector<std::string>& extensions, const BlfOptions& options) {
+    if (!onSipThread()) {
+        return m_sipThread.call<bool>([&]() { return watchExtensions(extensions, options); }, false);
+    }
+
+    if (!options.listUri.empty() && options.listUri.find("sip:") != 0 && options.listUri.find("sips:") != 0) {
+        updateSnapshot([](SipSnapshot& s) {
+            s.lastError = "URI de lista inválida";
+        });
+        return false;
+    }
+
+    m_blf.watch(extensions, options);
+    return true;
+}
+
+std::vector<BlfEntry> SipEngine::getBlfStates() {
+    if (!onSipThread()) {
+        return m_sipThread.call<std::vector<BlfEntry>>([&]() { return getBlfStates(); }, std::vector<BlfEntry>());
+    }
+    return m_blf.entries();
+}
+
+BlfStats SipEngine::getBlfStats() {
+    if (!onSipThread()) {
+        return m_sipThread.call<BlfStats>([&]() { return getBlfStats(); }, BlfStats());
+    }
+    return m_blf.stats();
+}
+
+void SipEngine::setStateMirror(std::shared_ptr<StateMirror> mirror) {
+    {
+        std::lock_guard<std::mutex> lock(m_stateMirrorMutex);
+        m_stateMirror = std::move(mirror);
+    }
+    // Chamadas e níveis são do thread SIP
+    post([this]() { publishStateMirror(); });
+}
+
+void SipEngine::publishStateMirror() {
+    if (!onSipThread()) {
+        post([this]() { publishStateMirror(); });
+        return;
+    }
+
+    std::shared_ptr<StateMirror> mirror;
+    {
+        std::lock_guard<std::mutex> lock(m_stateMirrorMutex);
+        mirror = m_stateMirror;
+    }
+    if (!mirror) {
+        return;
+    }
+
+    SipSnapshot snap = getSnapshot();
+    MirrorState& state = m_mirrorState;
+    state.connection = static_cast<int32_t>(snap.connection);
+    state.callStatus = static_cast<int32_t>(snap.callStatus);
+    state.callDirection = static_cast<int32_t>(snap.callDirection);
+    state.muted = snap.muted ? 1 : 0;
+    state.currentCall = m_currentCallId;
+
+    state.callCount = 0;
+    for (const auto& entry : m_activeCalls) {
+        if (state.callCount == mirror::kMaxCalls) {
+            break;
+        }
+        MirrorCall& call = state.calls[state.callCount++];
+        call.callId = entry.first;
+        call.state = static_cast<int32_t>(entry.second.state);
+        call.lastStatus = entry.second.lastStatus;
+        call.flags = 0;
+        if (entry.second.record.direction == CallLogDirection::Incoming) call.flags |= mirror::kCallIncoming;
+        if (entry.second.held) call.flags |= mirror::kCallHeld;
+        if (entry.first == m_currentCallId) call.flags |= mirror::kCallCurrent;
+    }
+    if (m_currentCallId == PJSUA_INVALID_ID) {
+        state.txLevel = -1;
+        state.rxLevel = -1;
+    }
+
+    mirror->publish(state);
+
+    // Níveis só são amostrados com uma chamada ativa
+    if (m_initialized && !m_levelTimerActive && m_currentCallId != PJSUA_INVALID_ID) {
+        m_levelTimerActive = true;
+        pjsua_schedule_timer2(&SipEngine::onLevelTimer,
+                              reinterpret_cast<void*>(static_cast<uintptr_t>(m_levelGeneration)),
+                              kMirrorLevelIntervalMs);
+    }
+}
+
+void SipEngine::handleLevelTimer(unsigned generation) {
+    if (!m_initialized || generation != m_levelGeneration) {
+        return;
+    }
+    bool mirrored;
+    {
+        std::lock_guard<std::mutex> lock(m_stateMirrorMutex);
+        mirrored = m_stateMirror != nullptr;
+    }
+    if (m_currentCallId == PJSUA_INVALID_ID || !mirrored) {
+        m_levelTimerActive = false;
+        publishStateMirror();
+        return;
+    }
+
+    // tx: enviado à porta da chamada (microfone); rx: recebido dela (remoto)
+    unsigned txLevel = 0;
+    unsigned rxLevel = 0;
+    pjsua_conf_port_id callSlot = pjsua_call_get_conf_port(m_currentCallId);
+    if (callSlot != PJSUA_INVALID_ID && pjsua_conf_get_signal_level(callSlot, &txLevel, &rxLevel) == PJ_SUCCESS) {
+        m_mirrorState.txLevel = static_cast<int32_t>(txLevel);
+        m_mirrorState.rxLevel = static_cast<int32_t>(rxLevel);
+    } else {
+        m_mirrorState.txLevel = -1;
+        m_mirrorState.rxLevel = -1;
+    }
+    publishStateMirror();
+
+    pjsua_schedule_timer2(&SipEngine::onLevelTimer,
+                          reinterpret_cast<void*>(static_cast<uintptr_t>(generation)), kMirrorLevelIntervalMs);
+}
+
+void SipEngine::emitBlfUpdate(const std::vector<BlfEntry>& changes) {
+    std::stringstream ss;
+    ss << "{\"updates\":[";
+    for (size_t i = 0; i < changes.size(); ++i) {
+        if (i) ss << ',';
+        ss << "{\"extension\":";
+        writeJsonString(ss, changes[i].extension);
+        ss << ",\"state\":\"" << blfStateName(changes[i].state) << "\"}";
+    }
+    ss << "]}";
+    emitJson("blfUpdate", ss.str());
+}
+
+bool SipEngine::openCallLog(const std::string& path) {
+    std::string error;
+    if (!m_callLog->open(path, &error)) {
+        updateSnapshot([&error](SipSnapshot& s) {
+            s.lastError = error;
+        });
+        return false;
+    }
+    return true;
+}
+
+CallLog& SipEngine::callLog() {
+    return *m_callLog;
+}
+
+void SipEngine::beginCallRecord(pjsua_call_id callId, CallLogDirection direction, const std::string& number,
+                                const std::string& displayName) {
+    ActiveCall& active = m_activeCalls[callId];
+    active = ActiveCall();
+    active.record.startTimeMs = wallClockMillis();
+    active.record.direction = direction;
+    active.record.number = number;
+    active.record.displayName = displayName;
+    active.state = direction == CallLogDirection::Incoming ? CallState::Incoming : CallState::Dialing;
+    m_mirrorState.callsStarted++;
+
+    std::lock_guard<std::mutex> lock(m_snapshotMutex);
+    if (!m_snapshot.username.empty()) {
+        active.record.account = m_snapshot.username.str() + "@" + m_snapshot.domain.str();
+    }
+}
+
+void SipEngine::finishCallRecord(pjsua_call_id callId, int lastStatus) {
+    auto it = m_activeCalls.find(callId);
+    if (it == m_activeCalls.end()) {
+        return;
+    }
+
+    CallRecord& record = it->second.record;
+    record.endTimeMs = wallClockMillis();
+    record.sipStatus = lastStatus;
+    if (record.answerTimeMs != 0) {
+        record.status = record.direction == CallLogDirection::Incoming ? CallLogStatus::Answered : CallLogStatus::Completed;
+    } else if (record.direction == CallLogDirection::Incoming) {
+        record.status = it->second.rejectedLocally ? CallLogStatus::Rejected : CallLogStatus::Missed;
+    } else {
+        record.status = CallLogStatus::Failed;
+    }
+
+    // Cópia para a região mapeada: custo constante, sem reescrever o histórico
+    if (it->second.userHeld) {
+        engineMetrics().callsHeld.sub(1);
+    }
+    uint64_t vadSuppressed = vadSuppressedFrames(callId);
+    engineMetrics().vadSuppressedPackets.inc(vadSuppressed);
+    record.id = m_callLog->append(record);
+    m_mirrorState.callsEnded++;
+    emitCallEnded(callId, record, vadSuppressed);
+    m_activeCalls.erase(it);
+}
+
+void SipEngine::emitCallEnded(pjsua_call_id callId, const CallRecord& record, uint64_t vadSuppressed) {
+    // Um único evento por chamada, já com as durações calculadas
+    std::stringstream ss;
+    ss << "{\"id\":\"" << record.id << "\"";
+    ss << ",\"callId\":" << callId;
+    ss << ",\"direction\":\"" << (record.direction == CallLogDirection::Incoming ? "incoming" : "outgoing") << "\"";
+    ss << ",\"status\":\"" << callLogStatusName(record.status) << "\"";
+    ss << ",\"number\":";
+    writeJsonString(ss, record.number);
+    if (!record.displayName.empty()) {
+        ss << ",\"displayName\":";
+        writeJsonString(ss, record.displayName);
+    }
+    if (!record.account.empty()) {
+        ss << ",\"account\":";
+        writeJsonString(ss, record.account);
+    }
+    if (!record.codec.empty()) {
+        ss << ",\"codec\":";
+        writeJsonString(ss, record.codec);
+    }
+    ss << ",\"startTime\":" << record.startTimeMs;
+    ss << ",\"ringTime\":" << record.ringTimeMs;
+    ss << ",\"answerTime\":" << record.answerTimeMs;
+    ss << ",\"endTime\":" << record.endTimeMs;
+    ss << ",\"durationMs\":" << (record.endTimeMs - record.startTimeMs);
+    ss << ",\"talkMs\":" << (record.answerTimeMs != 0 ? record.endTimeMs - record.answerTimeMs : 0);
+    ss << ",\"sipStatus\":" << record.sipStatus;
+    ss << ",\"transfer\":\"" << callTransferName(record.transfer) << "\"";
+    ss << ",\"transferStatus\":" << record.transferStatus;
+    ss << ",\"vadSuppressedPackets\":" << vadSuppressed;
+    ss << "}";
+
+    emitJson("callEnded", ss.str());
+}
+
+void SipEngine::wakeAudio() {
+    // Invalida um fechamento já agendado
+    m_idleGeneration++;
+
+    if (!m_audioIdle) {
+        return;
+    }
+
+    m_audioIdle = false;
+    engineMetrics().soundDeviceIdle.set(0);
+    pjsua_set_snd_dev(m_captureDevice, m_playbackDevice);
+}
+
+void SipEngine::scheduleAudioIdle() {
+    if (!m_initialized || !m_powerPolicy.nullDeviceWhenIdle || m_audioIdle) {
+        return;
+    }
+    if (m_currentCallId != PJSUA_INVALID_ID || m_transfer.consultCallId != PJSUA_INVALID_ID) {
+        return;
+    }
+
+    // Nova geração invalida um timer pendente; -1 = nunca fechar, 0 = fechar já
+    unsigned generation = ++m_idleGeneration;
+    if (m_powerPolicy.idleCloseSeconds < 0) {
+        return;
+    }
+    unsigned delayMs = static_cast<unsigned>(m_powerPolicy.idleCloseSeconds) * 1000;
+
+    pjsua_schedule_timer2(&SipEngine::onAudioIdleTimer,
+                          reinterpret_cast<void*>(static_cast<uintptr_t>(generation)), delayMs);
+}
+
+void SipEngine::handleAudioIdleTimer(unsigned generation) {
+    // Timer antigo (chamada iniciada ou política alterada desde o agendamento)
+    if (!m_initialized || generation != m_idleGeneration || m_audioIdle) {
+        return;
+    }
+    if (m_currentCallId != PJSUA_INVALID_ID || m_transfer.consultCallId != PJSUA_INVALID_ID) {
+        return;
+    }
+
+    if (pjsua_set_null_snd_dev() == PJ_SUCCESS) {
+        m_audioIdle = true;
+        engineMetrics().soundDeviceIdle.set(1);
+    }
+}
+
+SipSnapshot SipEngine::getSnapshot() const {
+    return m_publishedSnapshot.load();
+}
+
+CallTimingStats SipEngine::getCallTimingStats() const {
+    CallTimingStats stats;
+    stats.postDialDelay = m_timingHistograms.postDialDelay.summary();
+    stats.setupTime = m_timingHistograms.setupTime.summary();
+    stats.answerToMedia = m_timingHistograms.answerToMedia.summary();
+    stats.alertingDelay = m_timingHistograms.alertingDelay.summary();
+    return stats;
+}
+
+bool SipEngine::execute(const std::function<bool()>& function) {
+    return m_sipThread.call<bool>(function, false);
+}
+
+bool SipEngine::post(std::function<void()> command) {
+    return m_sipThread.post(std::move(command));
+}
+
+bool SipEngine::onSipThread() const {
+    return m_sipThread.isCurrentThread();
+}
+
+void SipEngine::setJsonEventSink(JsonEventSink sink) {
+    std::lock_guard<std::mutex> lock(m_jsonSinkMutex);
+    m_jsonSink = sink;
+}
+
+void SipEngine::setEventCallback(EventCallback callback) {
+    std::lock_guard<std::mutex> lock(m_callbackMutex);
+    m_eventCallback = callback;
+}
+
+void SipEngine::processEvents() {
+    std::lock_guard<std::mutex> lock(m_eventQueueMutex);
+    
+    while (!m_eventQueue.empty()) {
+        auto& event = m_eventQueue.front();
+        
+        std::lock_guard<std::mutex> cbLock(m_callbackMutex);
+        if (m_eventCallback) {
+            m_eventCallback(event.first, event.second);
+        }
+        
+        m_eventQueue.pop();
+    }
+}
+
+void SipEngine::updateSnapshot(const std::function<void(SipSnapshot&)>& updater) {
+    std::lock_guard<std::mutex> lock(m_snapshotMutex);
+    updater(m_snapshot);
+    m_publishedSnapshot.store(m_snapshot);
 }
 
 void SipEngine::emitEvent(const std::string& event) {
     SipSnapshot snap = getSnapshot();
     queueEvent(event, snap);
     
-    // Também emitir via EventEmitter global (para N-API)
+    // Também emitir serializado em JSON (EventEmitter do N-API)
     std::stringstream ss;
     ss << "{";
     ss << "\"connection\":\"" << static_cast<int>(snap.connection) << "\",";
     ss << "\"callStatus\":\"" << static_cast<int>(snap.callStatus) << "\",";
     ss << "\"callDirection\":\"" << static_cast<int>(snap.callDirection) << "\",";
     ss << "\"muted\":" << (snap.muted ? "true" : "false") << ",";
-    ss << "\"username\":\"" << snap.username << "\",";
-    ss << "\"domain\":\"" << snap.domain << "\"";
+    ss << "\"username\":";
+    writeJsonString(ss, snap.username);
+    ss << ",\"domain\":";
+    writeJsonString(ss, snap.domain);
     if (!snap.remoteUri.empty()) {
-        ss << ",\"remoteUri\":\"" << snap.remoteUri << "\"";
+        ss << ",\"remoteUri\":";
+        writeJsonString(ss, snap.remoteUri);
     }
     if (!snap.lastError.empty()) {
-        ss << ",\"lastError\":\"" << snap.lastError << "\"";
+        ss << ",\"lastError\":";
+        writeJsonString(ss, snap.lastError);
+    }
+    if (snap.timings.dialStart != 0 || snap.timings.inviteReceived != 0) {
+        ss << ",\"timings\":{";
+        ss << "\"postDialDelayMs\":" << snap.timings.postDialDelayMs() << ",";
+        ss << "\"setupTimeMs\":" << snap.timings.setupTimeMs() << ",";
+        ss << "\"answerToMediaMs\":" << snap.timings.answerToMediaMs() << ",";
+        ss << "\"alertingDelayMs\":" << snap.timings.alertingDelayMs();
+        ss << "}";
     }
     if (!snap.incoming.user.empty()) {
         ss << ",\"incoming\":{";
-        ss << "\"user\":\"" << snap.incoming.user << "\",";
-        ss << "\"displayName\":\"" << snap.incoming.displayName << "\",";
-        ss << "\"uri\":\"" << snap.incoming.uri << "\"";
+        ss << "\"user\":";
+        writeJsonString(ss, snap.incoming.user);
+        ss << ",\"displayName\":";
+        writeJsonString(ss, snap.incoming.displayName);
+        ss << ",\"uri\":";
+        writeJsonString(ss, snap.incoming.uri);
+        if (!snap.incoming.contactName.empty()) {
+            ss << ",\"contactName\":";
+            writeJsonString(ss, snap.incoming.contactName);
+        }
         ss << "}";
     }
     ss << "}";
     
-    EventEmitterManager::getInstance().emit(event, ss.str());
+    emitJson(event, ss.str());
+}
+
+void SipEngine::emitJson(const std::string& event, const std::string& json) {
+    // O espelho já reflete a transição quando o evento chega ao JS
+    publishStateMirror();
+    
+    JsonEventSink sink;
+    {
+        std::lock_guard<std::mutex> lock(m_jsonSinkMutex);
+        sink = m_jsonSink;
+    }
+    
+    if (sink) {
+        sink(event, json);
+    }
 }
 
 void SipEngine::queueEvent(const std::string& event, const SipSnapshot& snapshot) {
@@ -531,95 +2342,334 @@ std::string SipEngine::makeTargetUri(const std::string& target) {
 }
 
 // Callbacks estáticos PJSUA
+//
+// Executados em threads do PJSUA: apenas copiam os dados do evento (as
+// strings de pjsua_call_info apontam para o próprio struct) e enfileiram
+// o tratamento no thread SIP, que é o único a acessar o estado do engine.
 
 void SipEngine::onRegState(pjsua_acc_id acc_id) {
-    if (!s_instance) return;
+    ECHO_TRACE_SCOPE("onRegState");
+    
+    SipEngine* engine = s_instance;
+    if (!engine) return;
     
     pjsua_acc_info info;
     pjsua_acc_get_info(acc_id, &info);
     
-    s_instance->updateSnapshot([&info](SipSnapshot& s) {
-        if (info.status == PJSIP_SC_OK) {
-            s.connection = SipConnectionState::Registered;
-            s.lastError = "";
-        } else {
-            s.connection = SipConnectionState::Unregistered;
-            s.lastError = "Registro falhou: " + std::to_string(info.status);
-        }
+    int status = info.status;
+    engine->post([engine, status]() {
+        engine->handleRegState(status);
     });
-    
-    if (info.status == PJSIP_SC_OK) {
-        s_instance->emitEvent("registered");
-    } else {
-        s_instance->emitEvent("unregistered");
-    }
 }
 
 void SipEngine::onIncomingCall(pjsua_acc_id acc_id, pjsua_call_id call_id, pjsip_rx_data* rdata) {
     (void)acc_id;
     (void)rdata;
     
-    if (!s_instance) return;
-    
-    // Se já existe chamada, rejeitar
-    if (s_instance->m_currentCallId != PJSUA_INVALID_ID) {
-        pjsua_call_answer(call_id, 486, nullptr, nullptr);
-        return;
-    }
+    int64_t inviteReceived = monotonicMicros();
+    metrics::ScopedTimer timer(engineMetrics().onIncomingCallDuration);
+    ECHO_TRACE_SCOPE("onIncomingCall");
     
-    s_instance->m_currentCallId = call_id;
+    SipEngine* engine = s_instance;
+    if (!engine) return;
     
-    // Obter informações do chamador
     pjsua_call_info ci;
     pjsua_call_get_info(call_id, &ci);
     
     std::string remoteUri(ci.remote_info.ptr, ci.remote_info.slen);
+    
+    // Extrair display name e user do URI (views sobre remoteUri)
+    SipUriView parsed;
     std::string displayName;
     std::string user;
+    if (parseSipNameAddr(remoteUri, parsed)) {
+        displayName = decodeDisplayName(parsed.displayName);
+        user = std::string(parsed.identity());
+    }
+    
+    engine->post([engine, call_id, remoteUri, displayName, user, inviteReceived]() {
+        engine->handleIncomingCall(call_id, remoteUri, displayName, user, inviteReceived);
+    });
+}
+
+void SipEngine::onCallState(pjsua_call_id call_id, pjsip_event* e) {
+    (void)e;
+    
+    int64_t now = monotonicMicros();
+    metrics::ScopedTimer timer(engineMetrics().onCallStateDuration);
+    ECHO_TRACE_SCOPE("onCallState");
+    
+    SipEngine* engine = s_instance;
+    if (!engine) return;
+    
+    pjsua_call_info ci;
+    pjsua_call_get_info(call_id, &ci);
+    
+    // Apenas a identidade curta (número/usuário) cruza para o thread SIP;
+    // remote_info é interpretado aqui, sobre o próprio pjsua_call_info
+    std::string remoteIdentity;
+    if (ci.remote_info.ptr && ci.remote_info.slen > 0) {
+        std::string_view remoteInfo(ci.remote_info.ptr, static_cast<size_t>(ci.remote_info.slen));
+        SipUriView parsed;
+        if (parseSipNameAddr(remoteInfo, parsed)) {
+            remoteIdentity = std::string(parsed.identity());
+        } else {
+            // Sem URI reconhecível: usar como está (pode ser só o número)
+            remoteIdentity = std::string(remoteInfo);
+        }
+    }
+    
+    pjsip_inv_state state = ci.state;
+    pjsip_role_e role = ci.role;
+    int lastStatus = ci.last_status;
+    engine->post([engine, call_id, state, role, lastStatus, remoteIdentity, now]() {
+        engine->handleCallState(call_id, state, role, lastStatus, remoteIdentity, now);
+    });
+}
+
+void SipEngine::onCallMediaState(pjsua_call_id call_id) {
+    ECHO_TRACE_SCOPE("onCallMediaState");
+    
+    SipEngine* engine = s_instance;
+    if (!engine) return;
+    
+    pjsua_call_info ci;
+    pjsua_call_get_info(call_id, &ci);
+    
+    pjsua_call_media_status mediaStatus = ci.media_status;
+    pjsua_conf_port_id confSlot = ci.conf_slot;
+    engine->post([engine, call_id, mediaStatus, confSlot]() {
+        engine->handleCallMediaState(call_id, mediaStatus, confSlot);
+    });
+}
+
+void SipEngine::onCallTransferStatus(pjsua_call_id call_id, int st_code, 
+                                      const pj_str_t* st_text, pj_bool_t final_,
+                                      pj_bool_t* p_cont) {
+    ECHO_TRACE_SCOPE("onCallTransferStatus");
+    
+    (void)st_text;
+    (void)p_cont;
+    
+    SipEngine* engine = s_instance;
+    if (!engine) return;
+    
+    bool isFinal = final_ != PJ_FALSE;
+    engine->post([engine, call_id, st_code, isFinal]() {
+        engine->handleTransferStatus(call_id, st_code, isFinal);
+    });
+}
+
+void SipEngine::onStreamDestroyed(pjsua_call_id call_id, pjmedia_stream* strm, unsigned stream_idx) {
+    ECHO_TRACE_SCOPE("onStreamDestroyed");
+    
+    (void)stream_idx;
+    
+    // Chamado antes da destruição: depois daqui o stream não pode mais ser reconfigurado
+    if (SipEngine* engine = s_instance) {
+        std::lock_guard<std::mutex> lock(engine->m_audioStreamsMutex);
+        auto it = engine->m_audioStreams.find(call_id);
+        if (it != engine->m_audioStreams.end() && it->second == strm) {
+            engine->m_audioStreams.erase(it);
+        }
+    }
+    
+    // O stream só é válido durante o callback; apenas métricas
+    pjmedia_rtcp_stat stat;
+    if (pjmedia_stream_get_stat(strm, &stat) == PJ_SUCCESS) {
+        engineMetrics().rtpPacketsReceived.inc(stat.rx.pkt);
+        engineMetrics().rtpPacketsLost.inc(stat.rx.loss);
+    }
+}
+
+void SipEngine::onStreamCreated2(pjsua_call_id call_id, pjsua_on_stream_created_param* param) {
+    SipEngine* engine = s_instance;
+    if (!engine) return;
+    
+    // Síncrono de propósito: o controlador do Opus só usa streams presentes no mapa
+    std::lock_guard<std::mutex> lock(engine->m_audioStreamsMutex);
+    engine->m_audioStreams[call_id] = param->stream;
+}
+
+void SipEngine::onAudioIdleTimer(void* user_data) {
+    SipEngine* engine = s_instance;
+    if (!engine) return;
+    
+    unsigned generation = static_cast<unsigned>(reinterpret_cast<uintptr_t>(user_data));
+    engine->post([engine, generation]() {
+        engine->handleAudioIdleTimer(generation);
+    });
+}
+
+void SipEngine::onDtmfTimer(void* user_data) {
+    SipEngine* engine = s_instance;
+    if (!engine) return;
+    
+    unsigned generation = static_cast<unsigned>(reinterpret_cast<uintptr_t>(user_data));
+    engine->post([engine, generation]() {
+        engine->handleDtmfTimer(generation);
+    });
+}
+
+void SipEngine::onOpusTimer(void* user_data) {
+    SipEngine* engine = s_instance;
+    if (!engine) return;
+    
+    unsigned generation = static_cast<unsigned>(reinterpret_cast<uintptr_t>(user_data));
+    engine->post([engine, generation]() {
+        engine->handleOpusTimer(generation);
+    });
+}
+
+void SipEngine::onLevelTimer(void* user_data) {
+    SipEngine* engine = s_instance;
+    if (!engine) return;
+    
+    unsigned generation = static_cast<unsigned>(reinterpret_cast<uintptr_t>(user_data));
+    engine->post([engine, generation]() {
+        engine->handleLevelTimer(generation);
+    });
+}
+
+void SipEngine::onDtmfDigit(pjsua_call_id call_id, int digit) {
+    ECHO_TRACE_SCOPE("onDtmfDigit");
+    
+    SipEngine* engine = s_instance;
+    if (!engine) return;
+    
+    char digitChar = static_cast<char>(digit);
+    
+    // Mesmo thread dos demais eventos para preservar a ordem
+    engine->post([engine, call_id, digitChar]() {
+        engine->handleDtmfDigit(call_id, digitChar, false);
+    });
+}
+
+// Tratamento dos callbacks (thread SIP)
+
+void SipEngine::handleRegState(int status) {
+    ECHO_TRACE_SCOPE("handleRegState");
+    
+    if (!m_initialized) return;
+    
+    updateSnapshot([status](SipSnapshot& s) {
+        if (status == PJSIP_SC_OK) {
+            s.connection = SipConnectionState::Registered;
+            s.lastError = "";
+        } else {
+            s.connection = SipConnectionState::Unregistered;
+            s.lastError = "Registro falhou: " + std::to_string(status);
+        }
+    });
+    
+    if (status == PJSIP_SC_OK) {
+        engineMetrics().registrationsOk.inc();
+        m_mirrorState.registrations++;
+        // Leitura sob m_startupMutex: o Node lê a linha do tempo em paralelo
+        markStartup(&StartupTimeline::registered, getStartupTimeline().engineCreated, "registered");
+    } else {
+        engineMetrics().registrationsFailed.inc();
+        m_mirrorState.registrationFailures++;
+    }
+    
+    if (status == PJSIP_SC_OK && m_blfAccount.accountId == m_accountId) {
+        m_blf.setAccount(m_blfAccount);
+    }
+    
+    if (status == PJSIP_SC_OK) {
+        emitEvent("registered");
+    } else {
+        emitEvent("unregistered");
+    }
+}
+
+void SipEngine::handleIncomingCall(pjsua_call_id callId, const std::string& remoteUri, const std::string& displayName,
+                                   const std::string& user, int64_t inviteReceived) {
+    ECHO_TRACE_SCOPE("handleIncomingCall");
     
-    // Extrair display name e user do URI
-    size_t ltPos = remoteUri.find('<');
-    if (ltPos != std::string::npos) {
-        displayName = remoteUri.substr(0, ltPos);
-        // Remover aspas e espaços
-        displayName.erase(std::remove(displayName.begin(), displayName.end(), '"'), displayName.end());
-        displayName.erase(std::remove(displayName.begin(), displayName.end(), ' '), displayName.end());
+    if (!m_initialized) return;
+    
+    // Identificação pelo diretório de contatos (tabela hash, sem lock)
+    std::string contactName;
+    if (m_contacts->lookup(user, &contactName)) {
+        engineMetrics().contactLookupsHit.inc();
+    } else {
+        engineMetrics().contactLookupsMiss.inc();
     }
     
-    size_t sipPos = remoteUri.find("sip:");
-    size_t atPos = remoteUri.find('@');
-    if (sipPos != std::string::npos && atPos != std::string::npos) {
-        user = remoteUri.substr(sipPos + 4, atPos - sipPos - 4);
+    // Também as recusadas por ocupado entram no histórico (como perdidas)
+    beginCallRecord(callId, CallLogDirection::Incoming, user, contactName.empty() ? displayName : contactName);
+    
+    // Se já existe chamada, rejeitar
+    if (m_currentCallId != PJSUA_INVALID_ID) {
+        pjsua_call_answer(callId, 486, nullptr, nullptr);
+        return;
     }
     
-    s_instance->updateSnapshot([&](SipSnapshot& s) {
+    m_currentCallId = callId;
+    
+    // Reabrir o dispositivo real enquanto toca (pronto ao atender)
+    wakeAudio();
+    
+    updateSnapshot([&](SipSnapshot& s) {
         s.callStatus = CallState::Incoming;
         s.callDirection = CallDirection::Incoming;
         s.incoming.displayName = displayName;
         s.incoming.user = user;
         s.incoming.uri = remoteUri;
-        s.incoming.callId = call_id;
+        s.incoming.contactName = contactName;
+        s.incoming.callId = callId;
+        s.timings = CallTimings();
+        s.timings.inviteReceived = inviteReceived;
     });
     
     // Responder com 180 Ringing
-    pjsua_call_answer(call_id, 180, nullptr, nullptr);
+    pjsua_call_answer(callId, 180, nullptr, nullptr);
+    m_activeCalls[callId].record.ringTimeMs = wallClockMillis();
+    
+    int64_t ringingSent = monotonicMicros();
+    m_timingHistograms.alertingDelay.record(ringingSent - inviteReceived);
+    updateSnapshot([ringingSent](SipSnapshot& s) {
+        s.timings.ringingSent = ringingSent;
+    });
     
-    s_instance->emitEvent("incomingCall");
+    emitEvent("incomingCall");
 }
 
-void SipEngine::onCallState(pjsua_call_id call_id, pjsip_event* e) {
-    (void)e;
+void SipEngine::handleCallState(pjsua_call_id callId, pjsip_inv_state state, pjsip_role_e role, int lastStatus,
+                                const std::string& remoteIdentity, int64_t now) {
+    ECHO_TRACE_SCOPE("handleCallState");
     
-    if (!s_instance) return;
+    if (!m_initialized) return;
     
-    pjsua_call_info ci;
-    pjsua_call_get_info(call_id, &ci);
+    // Contabilizar resultado da chamada principal
+    if (state == PJSIP_INV_STATE_DISCONNECTED && callId == m_currentCallId) {
+        SipSnapshot snap = getSnapshot();
+        std::string labels = std::string("direction=\"") +
+            (role == PJSIP_ROLE_UAC ? "outgoing" : "incoming") +
+            "\",outcome=\"" + callOutcome(snap.timings, lastStatus) + "\"";
+        metrics::Registry::getInstance().counter("echo_calls", "Chamadas encerradas por resultado", labels).inc();
+    }
+    
+    // Marcas temporais apenas para a chamada principal (não para a consulta)
+    bool isCurrentCall = callId == m_currentCallId;
+    
+    // A consulta de uma transferência não altera o snapshot (vai em transferState);
+    // se o transferido desliga durante a consulta, ela assume o snapshot
+    bool transferLeg = inTransfer(callId);
+    auto draining = std::find(m_drainingConsults.begin(), m_drainingConsults.end(), callId);
+    bool consultLeg = (transferLeg && callId == m_transfer.consultCallId) || draining != m_drainingConsults.end();
+    if (draining != m_drainingConsults.end() && state == PJSIP_INV_STATE_DISCONNECTED) {
+        m_drainingConsults.erase(draining);
+    }
+    bool handOver = transferLeg && state == PJSIP_INV_STATE_DISCONNECTED && callId == m_transfer.originalCallId &&
+        m_transfer.phase != TransferPhase::Completing;
     
     // Mapear estado PJSIP para nosso estado
     CallState newState = CallState::Idle;
     std::string event;
     
-    switch (ci.state) {
+    switch (state) {
         case PJSIP_INV_STATE_CALLING:
             newState = CallState::Dialing;
             event = "dialing";
@@ -630,31 +2680,49 @@ void SipEngine::onCallState(pjsua_call_id call_id, pjsip_event* e) {
             event = "incoming";
             break;
             
-        case PJSIP_INV_STATE_EARLY:
+        case PJSIP_INV_STATE_EARLY: {
             newState = CallState::Ringing;
             event = "ringing";
+            
+            // Primeira resposta provisória da chamada saindo
+            auto active = m_activeCalls.find(callId);
+            if (active != m_activeCalls.end() && active->second.record.ringTimeMs == 0) {
+                active->second.record.ringTimeMs = wallClockMillis();
+            }
             break;
+        }
             
         case PJSIP_INV_STATE_CONNECTING:
             newState = CallState::Establishing;
             event = "connecting";
             break;
             
-        case PJSIP_INV_STATE_CONFIRMED:
+        case PJSIP_INV_STATE_CONFIRMED: {
             newState = CallState::Established;
             event = "established";
+            
+            auto active = m_activeCalls.find(callId);
+            if (active != m_activeCalls.end() && active->second.record.answerTimeMs == 0) {
+                active->second.record.answerTimeMs = wallClockMillis();
+            }
             break;
+        }
             
         case PJSIP_INV_STATE_DISCONNECTED:
             newState = CallState::Terminated;
             event = "terminated";
             
-            // Limpar referência da chamada
-            if (call_id == s_instance->m_currentCallId) {
-                s_instance->m_currentCallId = PJSUA_INVALID_ID;
+            finishCallRecord(callId, lastStatus);
+            
+            if (m_dtmfPlaying && callId == m_dtmfCallId) {
+                finishDtmf(true);
             }
-            if (call_id == s_instance->m_consultCallId) {
-                s_instance->m_consultCallId = PJSUA_INVALID_ID;
+            retireInbandDetector(callId);
+            stopOpusControl(callId);
+            
+            // Limpar referência da chamada
+            if (callId == m_currentCallId) {
+                m_currentCallId = PJSUA_INVALID_ID;
             }
             break;
             
@@ -662,135 +2730,195 @@ void SipEngine::onCallState(pjsua_call_id call_id, pjsip_event* e) {
             break;
     }
     
-    // Extrair informações da chamada
-    std::string remoteInfo;
-    if (ci.remote_info.ptr && ci.remote_info.slen > 0) {
-        remoteInfo = std::string(ci.remote_info.ptr, ci.remote_info.slen);
+    auto tracked = m_activeCalls.find(callId);
+    if (tracked != m_activeCalls.end()) {
+        tracked->second.state = newState;
+        tracked->second.lastStatus = lastStatus;
     }
     
-    // Determinar direção da chamada
-    CallDirection direction = s_instance->m_snapshot.callDirection;
-    if (direction == CallDirection::None) {
-        // Se não temos direção salva, determinar pela chamada
-        if (ci.role == PJSIP_ROLE_UAC) {
-            direction = CallDirection::Outgoing;
-        } else if (ci.role == PJSIP_ROLE_UAS) {
-            direction = CallDirection::Incoming;
-        }
+    if (transferLeg) {
+        handleTransferLegState(callId, state, lastStatus);
+    }
+    
+    if (handOver) {
+        auto consult = m_activeCalls.find(m_currentCallId);
+        bool answered = consult != m_activeCalls.end() && consult->second.record.answerTimeMs != 0;
+        std::string number = consult != m_activeCalls.end() ? consult->second.record.number : std::string();
+        updateSnapshot([answered, number](SipSnapshot& s) {
+            s.callStatus = answered ? CallState::Established : CallState::Dialing;
+            s.callDirection = CallDirection::Outgoing;
+            s.remoteUri = number;
+        });
+        event = answered ? "established" : "dialing";
     }
     
-    s_instance->updateSnapshot([newState, remoteInfo, direction](SipSnapshot& s) {
-        s.callStatus = newState;
-        s.callDirection = direction;
+    CallTimingHistograms* histograms = &m_timingHistograms;
+    
+    if (!consultLeg && !handOver) {
+        updateSnapshot([newState, &remoteIdentity, role, isCurrentCall, now, histograms](SipSnapshot& s) {
+            // Determinar direção da chamada (lida sob o lock do snapshot)
+            CallDirection direction = s.callDirection;
+            if (direction == CallDirection::None) {
+                // Se não temos direção salva, determinar pela chamada
+                if (role == PJSIP_ROLE_UAC) {
+                    direction = CallDirection::Outgoing;
+                } else if (role == PJSIP_ROLE_UAS) {
+                    direction = CallDirection::Incoming;
+                }
+            }
+        
+            s.callStatus = newState;
+            s.callDirection = direction;
         
-        // Preservar remoteUri para chamadas saindo
-        if (direction == CallDirection::Outgoing) {
-            // Se ainda não temos remoteUri, tentar extrair do remote_info
-            if (s.remoteUri.empty() && !remoteInfo.empty()) {
-                // Tentar extrair número do URI
-                // Formato pode ser: "Display Name" <sip:numero@domain> ou sip:numero@domain
-                size_t ltPos = remoteInfo.find('<');
-                size_t gtPos = remoteInfo.find('>');
-                std::string uriPart = remoteInfo;
-                
-                // Se tem < >, extrair parte dentro
-                if (ltPos != std::string::npos && gtPos != std::string::npos && gtPos > ltPos) {
-                    uriPart = remoteInfo.substr(ltPos + 1, gtPos - ltPos - 1);
+            if (isCurrentCall) {
+                if (newState == CallState::Ringing && s.timings.firstProvisional == 0 && s.timings.dialStart != 0) {
+                    s.timings.firstProvisional = now;
+                    histograms->postDialDelay.record(now - s.timings.dialStart);
                 }
-                
-                // Extrair número (parte antes do @)
-                size_t sipPos = uriPart.find("sip:");
-                size_t atPos = uriPart.find('@');
-                if (sipPos != std::string::npos) {
-                    if (atPos != std::string::npos && atPos > sipPos) {
-                        s.remoteUri = uriPart.substr(sipPos + 4, atPos - sipPos - 4);
-                    } else {
-                        // Se não tem @, pegar tudo depois de sip:
-                        s.remoteUri = uriPart.substr(sipPos + 4);
+                if (newState == CallState::Established && s.timings.confirmed == 0) {
+                    s.timings.confirmed = now;
+                    int64_t start = s.timings.dialStart != 0 ? s.timings.dialStart : s.timings.inviteReceived;
+                    if (start != 0) {
+                        histograms->setupTime.record(now - start);
                     }
-                } else {
-                    // Se não tem sip:, usar como está (pode ser só o número)
-                    s.remoteUri = uriPart;
                 }
             }
-            // Se já temos remoteUri, preservar (não sobrescrever)
-        }
         
-        if (newState == CallState::Terminated || newState == CallState::Idle) {
-            s.callDirection = CallDirection::None;
-            s.incoming = IncomingCallInfo();
-            s.remoteUri = "";  // Limpar quando chamada termina
-        }
-    });
+            // Preservar remoteUri para chamadas saindo
+            if (direction == CallDirection::Outgoing) {
+                // Se ainda não temos remoteUri, usar o número/usuário do remote_info
+                if (s.remoteUri.empty()) {
+                    s.remoteUri = remoteIdentity;
+                }
+                // Se já temos remoteUri, preservar (não sobrescrever)
+            }
+        
+            if (newState == CallState::Terminated || newState == CallState::Idle) {
+                s.callDirection = CallDirection::None;
+                s.incoming = IncomingCallInfo();
+                s.remoteUri = "";  // Limpar quando chamada termina
+            }
+        });
+    }
     
-    if (!event.empty()) {
-        s_instance->emitEvent(event);
+    if (!event.empty() && !consultLeg) {
+        emitEvent(event);
     }
     
-    // Se a chamada de consulta foi estabelecida, completar transferência assistida
-    if (call_id == s_instance->m_consultCallId && ci.state == PJSIP_INV_STATE_CONFIRMED) {
-        // Transferir chamada original para a chamada de consulta
-        pjsua_call_xfer_replaces(
-            s_instance->m_currentCallId,
-            s_instance->m_consultCallId,
-            PJSUA_XFER_NO_REQUIRE_REPLACES,
-            nullptr
-        );
+    if (state == PJSIP_INV_STATE_DISCONNECTED) {
+        // Sem chamadas na porta de captura o microfone deixa de alimentá-la
+        m_micSources.erase(callId);
+        releaseCaptureSource();
+        scheduleAudioIdle();
     }
 }
 
-void SipEngine::onCallMediaState(pjsua_call_id call_id) {
-    if (!s_instance) return;
+void SipEngine::handleCallMediaState(pjsua_call_id callId, pjsua_call_media_status mediaStatus,
+                                     pjsua_conf_port_id confSlot) {
+    ECHO_TRACE_SCOPE("handleCallMediaState");
     
-    pjsua_call_info ci;
-    pjsua_call_get_info(call_id, &ci);
+    if (!m_initialized) return;
     
-    if (ci.media_status == PJSUA_CALL_MEDIA_ACTIVE) {
+    // Em espera a chamada fica fora da ponte; o stream pode ter sido recriado
+    // pelo re-INVITE, então só a música é religada
+    auto held = m_activeCalls.find(callId);
+    if (held != m_activeCalls.end() && held->second.held) {
+        connectHoldMusic(callId);
+        return;
+    }
+    
+    if (mediaStatus == PJSUA_CALL_MEDIA_ACTIVE) {
         // Conectar áudio
-        pjsua_conf_connect(ci.conf_slot, 0);
+        pjsua_conf_connect(confSlot, 0);
+        
+        if (callId == m_currentCallId) {
+            int64_t now = monotonicMicros();
+            CallTimingHistograms* histograms = &m_timingHistograms;
+            updateSnapshot([now, histograms](SipSnapshot& s) {
+                // Apenas a primeira ativação (re-INVITEs de hold não contam)
+                if (s.timings.mediaActive != 0) return;
+                s.timings.mediaActive = now;
+                int64_t start = s.timings.answerRequested != 0 ? s.timings.answerRequested : s.timings.confirmed;
+                if (start != 0) {
+                    histograms->answerToMedia.record(now - start);
+                }
+            });
+        }
+        
+        attachInbandDetector(callId);
         
-        // Conectar microfone apenas se não estiver em mute
-        if (!s_instance->m_muted) {
-            pjsua_conf_connect(0, ci.conf_slot);
+        // Codec negociado para o CDR e controle do Opus (o último re-INVITE prevalece)
+        pjsua_call_info ci;
+        if (pjsua_call_get_info(callId, &ci) == PJ_SUCCESS) {
+            for (unsigned i = 0; i < ci.media_cnt; ++i) {
+                pjsua_stream_info si;
+                if (pjsua_call_get_stream_info(callId, i, &si) == PJ_SUCCESS && si.type == PJMEDIA_TYPE_AUDIO) {
+                    const pj_str_t& name = si.info.aud.fmt.encoding_name;
+                    auto active = m_activeCalls.find(callId);
+                    if (active != m_activeCalls.end()) {
+                        active->second.record.codec.assign(name.ptr, static_cast<size_t>(name.slen));
+                    }
+                    if (pj_stricmp2(&name, "opus") == 0) {
+                        startOpusControl(callId, i);
+                    } else {
+                        stopOpusControl(callId);
+                    }
+                    break;
+                }
+            }
         }
         
-        s_instance->emitEvent("mediaActive");
+        // Conectar microfone (processamento e VAD conforme o codec) se não estiver em mute
+        routeMic(callId);
+        
+        emitEvent("mediaActive");
     }
 }
 
-void SipEngine::onCallTransferStatus(pjsua_call_id call_id, int st_code, 
-                                      const pj_str_t* st_text, pj_bool_t final_,
-                                      pj_bool_t* p_cont) {
-    (void)call_id;
-    (void)st_text;
-    (void)p_cont;
+void SipEngine::handleTransferStatus(pjsua_call_id callId, int statusCode, bool final) {
+    ECHO_TRACE_SCOPE("handleTransferStatus");
     
-    if (!s_instance) return;
+    if (!m_initialized) return;
     
-    if (final_) {
-        if (st_code >= 200 && st_code < 300) {
-            s_instance->emitEvent("transferSuccess");
+    // NOTIFY do REFER enviado na original; na assistida também identifica a consulta
+    bool attended = m_transfer.phase == TransferPhase::Completing && callId == m_transfer.originalCallId;
+    std::stringstream ss;
+    ss << "{\"callId\":" << callId;
+    ss << ",\"consultCallId\":" << (attended ? m_transfer.consultCallId : PJSUA_INVALID_ID);
+    ss << ",\"statusCode\":" << statusCode;
+    ss << ",\"final\":" << (final ? "true" : "false");
+    ss << "}";
+    emitJson("transferStatus", ss.str());
+    
+    if (final) {
+        auto active = m_activeCalls.find(callId);
+        if (active != m_activeCalls.end()) {
+            active->second.record.transferStatus = statusCode;
+        }
+        
+        if (statusCode >= 200 && statusCode < 300) {
+            emitEvent("transferSuccess");
             // Encerrar chamada após transferência bem sucedida
-            s_instance->hangupCall();
+            pjsua_call_hangup(callId, 0, nullptr, nullptr);
         } else {
-            s_instance->updateSnapshot([st_code](SipSnapshot& s) {
-                s.lastError = "Transferência falhou: " + std::to_string(st_code);
+            updateSnapshot([statusCode](SipSnapshot& s) {
+                s.lastError = "Transferência falhou: " + std::to_string(statusCode);
             });
-            s_instance->emitEvent("transferFailed");
+            emitEvent("transferFailed");
+            
+            if (attended) {
+                // A original não fica em espera: o áudio volta para ela e a
+                // consulta (se ainda ativa) aguarda nova tentativa ou cancelamento
+                talkOn(m_transfer.originalCallId);
+                if (m_transfer.consultCallId != PJSUA_INVALID_ID) {
+                    m_transfer.phase = TransferPhase::Consulting;
+                    emitTransferState("", statusCode);
+                } else {
+                    endTransfer("failed", statusCode);
+                }
+            }
         }
     }
 }
 
-void SipEngine::onDtmfDigit(pjsua_call_id call_id, int digit) {
-    (void)call_id;
-    
-    if (!s_instance) return;
-    
-    char digitChar = static_cast<char>(digit);
-    std::string digitStr(1, digitChar);
-    
-    EventEmitterManager::getInstance().emit("dtmfReceived", 
-        "{\"digit\":\"" + digitStr + "\"}");
-}
-
 } // namespace echo
@@ -14,7 +14,24 @@
 #include <memory>
 #include <mutex>
 #include <atomic>
+#include <deque>
+#include <map>
 #include <queue>
+#include <vector>
+
+#include "blf_watcher.h"
+#include "call_log.h"
+#include "call_timing.h"
+#include "capture_port.h"
+#include "command_thread.h"
+#include "contact_index.h"
+#include "dtmf_sequence.h"
+#include "fixed_string.h"
+#include "hold_music.h"
+#include "inband_dtmf_port.h"
+#include "opus_rate_controller.h"
+#include "seqlock.h"
+#include "state_mirror.h"
 
 // PJSIP headers
 extern "C" {
@@ -34,14 +51,36 @@ struct SipCredentials {
     std::string transport; // "udp" ou "tcp"
 };
 
+/**
+ * @brief Política de energia do dispositivo de som
+ */
+struct AudioPowerPolicy {
+    // Segundos sem uso até fechar o dispositivo (snd_auto_close_time; -1 = nunca)
+    int idleCloseSeconds = 1;
+    // Usar o dispositivo nulo fora de chamadas (o driver real fica fechado,
+    // ao custo do clock do dispositivo nulo)
+    bool nullDeviceWhenIdle = false;
+};
+
 /**
  * @brief Informações de uma chamada entrante
  */
 struct IncomingCallInfo {
-    std::string displayName;
-    std::string user;
-    std::string uri;
+    FixedString<96> displayName;
+    FixedString<64> user;
+    FixedString<192> uri;
+    FixedString<96> contactName;    // Nome no diretório de contatos (vazio se não encontrado)
+    int callId = PJSUA_INVALID_ID;
+};
+
+/**
+ * @brief VAD do microfone em uma chamada
+ */
+struct CallVadStats {
     int callId;
+    std::string codec;
+    bool active;                    // Microfone pela saída com VAD
+    uint64_t suppressedPackets;     // Quadros (pacotes RTP) não enviados
 };
 
 /**
@@ -82,17 +121,35 @@ enum class CallDirection {
 
 /**
  * @brief Snapshot do estado atual do cliente SIP
+ *
+ * Strings de capacidade fixa (valores maiores são truncados): o snapshot é
+ * trivialmente copiável e publicado por SeqLock, lido sem travas nem
+ * alocação por getSnapshot.
  */
 struct SipSnapshot {
-    SipConnectionState connection;
-    CallState callStatus;
-    CallDirection callDirection;
+    SipConnectionState connection = SipConnectionState::Idle;
+    CallState callStatus = CallState::Idle;
+    CallDirection callDirection = CallDirection::None;
     IncomingCallInfo incoming;
-    std::string lastError;
-    std::string username;
-    std::string domain;
-    std::string remoteUri;  // URI/número da chamada saindo
-    bool muted;
+    FixedString<160> lastError;
+    FixedString<64> username;
+    FixedString<128> domain;
+    FixedString<192> remoteUri; // URI/número da chamada saindo
+    bool muted = false;
+    CallTimings timings;        // Marcas temporais da chamada atual (ou da última)
+};
+
+/**
+ * @brief Marcas temporais da inicialização do engine (monotonicMicros, 0 = não ocorreu)
+ */
+struct StartupTimeline {
+    int64_t engineCreated = 0;      // Construção do engine (carga do addon)
+    int64_t pjsuaCreated = 0;       // pjsua_create concluído
+    int64_t pjsuaInitialized = 0;   // pjsua_init concluído
+    int64_t pjsuaStarted = 0;       // pjsua_start concluído
+    int64_t transportReady = 0;     // Primeiro transporte SIP criado
+    int64_t soundDeviceOpen = 0;    // Dispositivo de som aberto antecipadamente
+    int64_t registered = 0;         // Primeiro registro bem sucedido
 };
 
 /**
@@ -100,12 +157,34 @@ struct SipSnapshot {
  */
 using EventCallback = std::function<void(const std::string& event, const SipSnapshot& snapshot)>;
 
+/**
+ * @brief Tipo de destino para eventos serializados em JSON
+ *
+ * O addon encaminha para o EventEmitter; benchmarks e ferramentas usam o
+ * engine sem Node.
+ */
+using JsonEventSink = std::function<void(const std::string& event, const std::string& json)>;
+
 /**
  * @brief Classe principal que encapsula PJSIP
+ *
+ * Todo o estado do engine pertence a um único thread SIP. Os métodos
+ * públicos que alteram estado ou chamam o PJSUA são executados como
+ * comandos nesse thread (o chamador aguarda o resultado) e os callbacks
+ * PJSUA apenas copiam os dados do evento e enfileiram o tratamento nele.
  */
 class SipEngine {
 public:
     SipEngine();
+    
+    /**
+     * @brief Cria o engine com histórico e diretório de contatos de outro dono
+     *
+     * O addon os guarda por ambiente: o arquivo aberto e os contatos
+     * carregados sobrevivem ao destroy/init de uma reconexão, que cria um
+     * engine novo.
+     */
+    SipEngine(std::shared_ptr<CallLog> callLog, std::shared_ptr<ContactIndex> contacts);
     ~SipEngine();
 
     // Impede cópia
@@ -167,12 +246,43 @@ public:
     bool hangupCall();
 
     /**
-     * @brief Envia DTMF
-     * @param digits Dígitos DTMF (0-9, *, #)
-     * @return true se sucesso
+     * @brief Envia DTMF com as opções padrão (ver setDtmfOptions)
+     * @param digits Dígitos DTMF (0-9, *, #, A-D) e pausas (',' ou 'p')
+     * @return true se a sequência foi enfileirada
      */
     bool sendDtmf(const std::string& digits);
 
+    /**
+     * @brief Enfileira uma sequência de DTMF
+     *
+     * Os passos são reproduzidos em timers do PJSUA: cada dígito emite
+     * "dtmfProgress" e o fim da fila emite "dtmfDone". Sequências enviadas
+     * durante a reprodução entram no fim da fila.
+     *
+     * @param digits Dígitos DTMF e pausas
+     * @param options Método e durações desta sequência
+     * @return true se a sequência foi enfileirada
+     */
+    bool playDtmf(const std::string& digits, const DtmfOptions& options);
+
+    /**
+     * @brief Interrompe a sequência em reprodução e descarta a fila
+     */
+    bool cancelDtmf();
+
+    /**
+     * @brief Define as opções usadas por sendDtmf
+     */
+    void setDtmfOptions(const DtmfOptions& options);
+
+    /**
+     * @brief Liga/desliga a detecção de DTMF in-band no áudio recebido
+     *
+     * Ligada por padrão. Em cada chamada a detecção é desligada ao chegar
+     * o primeiro dígito RFC 2833 (evita dígitos duplicados).
+     */
+    void setInbandDtmfDetection(bool enabled);
+
     /**
      * @brief Transferência cega
      * @param target Destino da transferência
@@ -181,12 +291,79 @@ public:
     bool transferBlind(const std::string& target);
 
     /**
-     * @brief Transferência assistida
+     * @brief Transferência assistida automática
+     *
+     * Abre a consulta e completa a transferência assim que o destino atende
+     * (sem conversa com o destino). Equivale a startConsult + completeTransfer.
+     *
      * @param target Destino da transferência
      * @return true se sucesso
      */
     bool transferAttended(const std::string& target);
 
+    /**
+     * @brief Inicia a consulta de uma transferência assistida
+     *
+     * A chamada atual sai da ponte localmente (música de espera, sem
+     * re-INVITE) e a consulta é discada. O áudio passa a ser da consulta.
+     *
+     * @param target Destino da transferência
+     * @return true se a consulta foi discada
+     */
+    bool startConsult(const std::string& target);
+
+    /**
+     * @brief Alterna o áudio entre a chamada original e a consulta
+     *
+     * Apenas reconexões na ponte: a perna que sai fica com a música de
+     * espera, sem round trip de sinalização.
+     *
+     * @return true se sucesso
+     */
+    bool swapTransferLegs();
+
+    /**
+     * @brief Completa a transferência (REFER com Replaces na chamada original)
+     * @return true se o REFER foi enviado (o resultado vem em transferState)
+     */
+    bool completeTransfer();
+
+    /**
+     * @brief Desiste da transferência: encerra a consulta e volta à original
+     * @return true se sucesso
+     */
+    bool cancelTransfer();
+
+    /**
+     * @brief Coloca uma chamada em espera
+     *
+     * A chamada sai da ponte de conferência na hora (sem mixagem para ela)
+     * e recebe a música de espera, se configurada; depois vai o re-INVITE
+     * sendonly.
+     *
+     * @param callId Chamada estabelecida
+     * @return true se sucesso (ou se já estava em espera)
+     */
+    bool holdCall(int callId);
+
+    /**
+     * @brief Retoma uma chamada em espera
+     *
+     * Religa a chamada à ponte localmente antes de enviar o re-INVITE: o
+     * áudio volta assim que o outro lado responde, sem esperar a resposta
+     * para refazer as conexões.
+     *
+     * @return true se sucesso (ou se não estava em espera)
+     */
+    bool resumeCall(int callId);
+
+    /**
+     * @brief Define a música de espera (WAV PCM 16 bits mapeado em memória)
+     * @param path Caminho do arquivo; vazio desliga a música
+     * @return true se sucesso
+     */
+    bool setHoldMusic(const std::string& path);
+
     /**
      * @brief Define mute do microfone
      * @param muted true para silenciar
@@ -204,6 +381,53 @@ public:
      */
     bool isMuted() const;
 
+    /**
+     * @brief Configura o processamento do microfone (passa-altas, supressão de ruído, AGC)
+     *
+     * Os estágios valem imediatamente, inclusive em chamadas em andamento,
+     * e desfazem rebaixamentos anteriores. Com todos desligados o
+     * microfone volta a ir direto para as chamadas. Quadros que passam do
+     * orçamento desligam estágios e emitem "captureDowngraded".
+     *
+     * @param stages Estágios desejados
+     * @param budgetPercent Orçamento por quadro em porcentagem da duração do quadro
+     * @return true se sucesso
+     */
+    bool setCaptureProcessing(const CaptureStages& stages, unsigned budgetPercent);
+
+    /**
+     * @brief Obtém os contadores do processamento do microfone
+     */
+    CaptureProcessorStats getCaptureStats();
+
+    /**
+     * @brief Configura o VAD do microfone (por codec, com hangover)
+     *
+     * Chamadas cujo codec está na lista recebem o microfone pela saída com
+     * VAD da porta de captura: no silêncio o stream não envia RTP. Vale
+     * imediatamente para as chamadas em andamento.
+     *
+     * @return true se sucesso
+     */
+    bool setVadOptions(const VadOptions& options);
+
+    /**
+     * @brief Pacotes suprimidos pelo VAD em cada chamada em andamento
+     */
+    std::vector<CallVadStats> getVadStats();
+
+    /**
+     * @brief Configura o Opus (FEC in-band, DTX e faixa de bitrate)
+     *
+     * FEC e DTX valem para as próximas chamadas e são reaplicados às
+     * chamadas em Opus no próximo ciclo do controlador, que ajusta
+     * bitrate e perda esperada pelos Receiver Reports e emite
+     * "opusAdapted" a cada mudança.
+     *
+     * @return true se sucesso
+     */
+    bool setOpusOptions(const OpusOptions& options);
+
     /**
      * @brief Obtém lista de dispositivos de áudio
      * @return Vector com nomes dos dispositivos
@@ -218,16 +442,141 @@ public:
      */
     bool setAudioDevices(int captureDeviceId, int playbackDeviceId);
 
+    /**
+     * @brief Define a política de energia do dispositivo de som
+     *
+     * idleCloseSeconds é aplicado na próxima inicialização do PJSUA;
+     * nullDeviceWhenIdle tem efeito imediato.
+     */
+    void setAudioPowerPolicy(const AudioPowerPolicy& policy);
+    
+    /**
+     * @brief Substitui o diretório usado na identificação de chamadas entrantes
+     * @param entries Contatos (nome e número)
+     * @param plan Plano de numeração para normalizar os números
+     * @return Estatísticas da carga
+     */
+    ContactIndexStats loadContacts(const std::vector<ContactEntry>& entries, const NumberPlan& plan);
+    
+    /**
+     * @brief Procura o nome de um número no diretório de contatos
+     * @return true se encontrado
+     */
+    bool lookupContact(const std::string& number, std::string* name) const;
+    
+    /**
+     * @brief Estatísticas do diretório de contatos
+     */
+    ContactIndexStats getContactStats() const;
+    
+    /**
+     * @brief Monitora ramais pelo pacote "dialog" (BLF)
+     *
+     * Com listUri, uma assinatura de lista (RLS) cobre todos os ramais;
+     * sem ela, ou se o servidor recusar a lista, cada ramal tem a sua. As
+     * mudanças chegam em lotes no evento "blfUpdate", no máximo um a cada
+     * batchIntervalMs. As assinaturas saem após o registro da conta.
+     *
+     * @param extensions Ramais (parte usuário da URI); vazio encerra o BLF
+     * @return true se sucesso
+     */
+    bool watchExtensions(const std::vector<std::string>& extensions, const BlfOptions& options);
+    
+    /**
+     * @brief Estado atual de todos os ramais monitorados
+     */
+    std::vector<BlfEntry> getBlfStates();
+    
+    /**
+     * @brief Contadores das assinaturas de BLF
+     */
+    BlfStats getBlfStats();
+    
+    /**
+     * @brief Define o espelho de estado (nullptr desliga)
+     *
+     * O espelho é atualizado antes de cada evento e, com uma chamada ativa,
+     * a cada 100 ms com os níveis de áudio. Pode ser compartilhado com o
+     * engine seguinte após destroy: as escritas são serializadas por ele.
+     */
+    void setStateMirror(std::shared_ptr<StateMirror> mirror);
+    
+    /**
+     * @brief Abre o histórico de chamadas (gravado pelo engine ao fim de cada chamada)
+     * @param path Caminho do arquivo
+     * @return true se aberto
+     */
+    bool openCallLog(const std::string& path);
+    
+    /**
+     * @brief Histórico de chamadas (thread-safe; consultas não passam pelo thread SIP)
+     */
+    CallLog& callLog();
+
     /**
      * @brief Obtém snapshot do estado atual
+     *
+     * Sem travas e sem alocação (seguro para polling frequente da UI).
      */
     SipSnapshot getSnapshot() const;
 
+    /**
+     * @brief Obtém o resumo dos histogramas de estabelecimento de chamada
+     */
+    CallTimingStats getCallTimingStats() const;
+
+    /**
+     * @brief Antecipa as etapas lentas da inicialização
+     *
+     * Inicializa o PJSUA (se necessário), cria o transporte que será usado
+     * pelo registro e, opcionalmente, abre o dispositivo de som para que a
+     * primeira chamada não pague a abertura do driver.
+     *
+     * @param transport "udp" ou "tcp" (vazio = apenas inicializar)
+     * @param openSoundDevice true para abrir o dispositivo de som
+     * @return true se sucesso
+     */
+    bool prewarm(const std::string& transport, bool openSoundDevice);
+
+    /**
+     * @brief Obtém as marcas temporais da inicialização
+     */
+    StartupTimeline getStartupTimeline() const;
+
+    /**
+     * @brief Altera o nível de log do PJSIP em tempo de execução
+     * @param level Nível de 0 (desligado) a 6 (trace)
+     * @return true se sucesso
+     */
+    bool setLogLevel(int level);
+
+    /**
+     * @brief Obtém o nível de log atual
+     */
+    int getLogLevel() const;
+
+    /**
+     * @brief Executa uma função no thread SIP e aguarda o resultado
+     * @return Resultado da função, ou false se o thread foi encerrado
+     */
+    bool execute(const std::function<bool()>& function);
+
+    /**
+     * @brief Enfileira uma função no thread SIP sem aguardar
+     * @return false se o thread foi encerrado
+     */
+    bool post(std::function<void()> command);
+
     /**
      * @brief Define callback de eventos
      */
     void setEventCallback(EventCallback callback);
 
+    /**
+     * @brief Define o destino dos eventos em JSON (chamado no thread SIP)
+     */
+    void setJsonEventSink(JsonEventSink sink);
+
     /**
      * @brief Processa eventos pendentes (chamado periodicamente)
      */
@@ -237,20 +586,149 @@ private:
     // Estado interno
     std::atomic<bool> m_initialized{false};
     std::atomic<bool> m_muted{false};
+    std::atomic<int> m_logLevel{1};
     
     pjsua_acc_id m_accountId{PJSUA_INVALID_ID};
     pjsua_call_id m_currentCallId{PJSUA_INVALID_ID};
-    pjsua_call_id m_consultCallId{PJSUA_INVALID_ID}; // Para transferência assistida
     
+    // Transferência assistida: consulta discada → conversando → REFER enviado.
+    // A perna que não está com o áudio fica fora da ponte (held)
+    enum class TransferPhase {
+        Idle,
+        Dialing,
+        Consulting,
+        Completing
+    };
+    struct AttendedTransfer {
+        TransferPhase phase = TransferPhase::Idle;
+        pjsua_call_id originalCallId = PJSUA_INVALID_ID;
+        pjsua_call_id consultCallId = PJSUA_INVALID_ID;
+        pjsua_call_id talkingCallId = PJSUA_INVALID_ID;    // Perna ligada à ponte
+        bool autoComplete = false;                          // transferAttended
+    };
+    AttendedTransfer m_transfer;
+    // Consultas desligadas após o fim da transferência (cancelada ou falha)
+    // até o DISCONNECTED: não mexem no snapshot da original nem emitem eventos
+    std::vector<pjsua_call_id> m_drainingConsults;
+    
+    // Cópia de trabalho dos escritores (m_snapshotMutex), publicada a cada
+    // updateSnapshot; getSnapshot lê a publicação sem travar
     SipSnapshot m_snapshot;
     std::mutex m_snapshotMutex;
+    SeqLock<SipSnapshot> m_publishedSnapshot;
     
     EventCallback m_eventCallback;
     std::mutex m_callbackMutex;
     
+    JsonEventSink m_jsonSink;
+    std::mutex m_jsonSinkMutex;
+    
+    CallTimingHistograms m_timingHistograms;
+    
     std::string m_domain;
     std::string m_transport;
     
+    // Dispositivos de som escolhidos e estado ocioso (dispositivo nulo ativo)
+    int m_captureDevice{PJMEDIA_AUD_DEFAULT_CAPTURE_DEV};
+    int m_playbackDevice{PJMEDIA_AUD_DEFAULT_PLAYBACK_DEV};
+    AudioPowerPolicy m_powerPolicy;
+    bool m_audioIdle{false};
+    unsigned m_idleGeneration{0};
+    
+    // Transportes já criados, reutilizados entre registros (chave: pjsip_transport_type_e)
+    std::map<int, pjsua_transport_id> m_transports;
+    
+    // Diretório de contatos (consultado sem lock no thread SIP)
+    const std::shared_ptr<ContactIndex> m_contacts;
+    
+    // Registro em andamento de cada chamada (gravado no histórico ao desconectar)
+    struct ActiveCall {
+        CallRecord record;
+        bool rejectedLocally = false;
+        bool held = false;              // Em espera (fora da ponte)
+        bool userHeld = false;          // Em espera pelo usuário (não pela transferência)
+        CallState state = CallState::Idle;  // Último estado (espelho)
+        int lastStatus = 0;
+        bool vadGated = false;          // Microfone pela saída com VAD
+        uint64_t vadBase = 0;           // suppressedFrames() ao entrar no VAD
+        uint64_t vadSuppressed = 0;     // Acumulado de períodos anteriores
+    };
+    std::map<pjsua_call_id, ActiveCall> m_activeCalls;
+    const std::shared_ptr<CallLog> m_callLog;
+    
+    // Sequência de DTMF em reprodução (thread SIP)
+    DtmfOptions m_dtmfOptions;
+    std::deque<DtmfStep> m_dtmfQueue;
+    pjsua_call_id m_dtmfCallId{PJSUA_INVALID_ID};
+    bool m_dtmfPlaying{false};
+    unsigned m_dtmfGeneration{0};       // Invalida timers após cancelamento
+    unsigned m_dtmfSent{0};
+    unsigned m_dtmfTotal{0};
+    
+    // Gerador de tons para DTMF in-band (criado sob demanda)
+    pj_pool_t* m_toneGenPool{nullptr};
+    pjmedia_port* m_toneGenPort{nullptr};
+    pjsua_conf_port_id m_toneGenSlot{PJSUA_INVALID_ID};
+    
+    // Detectores de DTMF in-band por chamada; os removidos da ponte aguardam
+    // alguns ciclos de mídia antes de serem liberados
+    bool m_inbandDtmfDetection{true};
+    std::map<pjsua_call_id, std::unique_ptr<InbandDtmfPort>> m_inbandDetectors;
+    std::vector<std::pair<int64_t, std::unique_ptr<InbandDtmfPort>>> m_retiredDetectors;
+    
+    // Processamento do microfone: slot 0 → m_capturePort → chamadas. A porta
+    // é criada na primeira chamada e o slot 0 só fica ligado a ela durante
+    // chamadas (o dispositivo de som pode ser fechado fora delas)
+    CaptureStages m_captureStages;
+    unsigned m_captureBudgetPercent{kCaptureDefaultBudgetPercent};
+    std::unique_ptr<CapturePort> m_capturePort;
+    bool m_captureSourceConnected{false};
+    
+    // VAD e origem do microfone de cada chamada (slot 0, porta de captura ou
+    // saída com VAD), mantida mesmo em mute
+    VadOptions m_vadOptions;
+    std::map<pjsua_call_id, pjsua_conf_port_id> m_micSources;
+    
+    // Música de espera, compartilhada pelas chamadas em espera (criada no
+    // primeiro hold); as substituídas aguardam alguns ciclos de mídia
+    std::string m_holdMusicPath;
+    std::unique_ptr<HoldMusicPort> m_holdMusic;
+    std::vector<std::pair<int64_t, std::unique_ptr<HoldMusicPort>>> m_retiredHoldMusic;
+    
+    // Opus: controlador por chamada (thread SIP). A perda esperada da última
+    // chamada é o ponto de partida da próxima
+    struct OpusCall {
+        OpusRateController controller;
+        unsigned mediaIndex = 0;
+    };
+    OpusOptions m_opusOptions;
+    unsigned m_opusLossPercent{0};
+    std::map<pjsua_call_id, OpusCall> m_opusCalls;
+    unsigned m_opusGeneration{0};
+    bool m_opusTimerActive{false};
+    
+    // BLF: assinaturas e estado dos ramais; a conta é entregue a cada registro
+    BlfWatcher m_blf{[this](std::function<void()> command) { return post(std::move(command)); },
+                     [this](const std::vector<BlfEntry>& changes) { emitBlfUpdate(changes); }};
+    BlfAccount m_blfAccount;
+    
+    // Espelho do estado em memória lida pelo JS; m_mirrorState (thread SIP)
+    // acumula os contadores entre publicações
+    std::shared_ptr<StateMirror> m_stateMirror;
+    std::mutex m_stateMirrorMutex;
+    MirrorState m_mirrorState;
+    unsigned m_levelGeneration{0};
+    bool m_levelTimerActive{false};
+    
+    // Streams de áudio vivos, mantidos pelos callbacks de criação/destruição
+    // do PJSUA (thread do PJSUA); o lock garante que o stream não é destruído
+    // enquanto o thread SIP o reconfigura
+    std::map<pjsua_call_id, pjmedia_stream*> m_audioStreams;
+    std::mutex m_audioStreamsMutex;
+    
+    StartupTimeline m_startup;
+    mutable std::mutex m_startupMutex;
+    
     // Fila de eventos para processar no thread principal
     std::queue<std::pair<std::string, SipSnapshot>> m_eventQueue;
     std::mutex m_eventQueueMutex;
@@ -258,8 +736,62 @@ private:
     // Métodos auxiliares
     void updateSnapshot(const std::function<void(SipSnapshot&)>& updater);
     void emitEvent(const std::string& event);
+    void emitJson(const std::string& event, const std::string& json);
     void queueEvent(const std::string& event, const SipSnapshot& snapshot);
     std::string makeTargetUri(const std::string& target);
+    bool onSipThread() const;
+    bool ensureTransport(const std::string& transport, pjsua_transport_id* id);
+    void wakeAudio();
+    void scheduleAudioIdle();
+    void handleAudioIdleTimer(unsigned generation);
+    void markStartup(int64_t StartupTimeline::*phase, int64_t since, const char* label);
+    void beginCallRecord(pjsua_call_id callId, CallLogDirection direction, const std::string& number,
+                         const std::string& displayName);
+    void finishCallRecord(pjsua_call_id callId, int lastStatus);
+    void emitCallEnded(pjsua_call_id callId, const CallRecord& record, uint64_t vadSuppressed);
+    void playNextDtmfStep();
+    bool sendDtmfDigit(const DtmfStep& step);
+    void finishDtmf(bool cancelled);
+    bool ensureToneGenerator(pjsua_call_id callId);
+    void releaseToneGenerator();
+    void handleDtmfTimer(unsigned generation);
+    void attachInbandDetector(pjsua_call_id callId);
+    void retireInbandDetector(pjsua_call_id callId);
+    void purgeRetiredDetectors(int64_t olderThan);
+    void handleDtmfDigit(pjsua_call_id callId, char digit, bool inband);
+    pjsua_conf_port_id captureSource(bool gated);
+    void releaseCaptureSource();
+    void routeMic(pjsua_call_id callId);
+    void detachHeldCall(pjsua_call_id callId);
+    void attachResumedCall(pjsua_call_id callId);
+    void connectHoldMusic(pjsua_call_id callId);
+    void emitHoldChanged(pjsua_call_id callId, bool held);
+    bool inTransfer(pjsua_call_id callId) const;
+    void talkOn(pjsua_call_id callId);
+    void endTransfer(const char* result, int statusCode);
+    void hangupConsult(pjsua_call_id callId);
+    void emitTransferState(const char* result, int statusCode);
+    void handleTransferLegState(pjsua_call_id callId, pjsip_inv_state state, int lastStatus);
+    uint64_t vadSuppressedFrames(pjsua_call_id callId) const;
+    void emitBlfUpdate(const std::vector<BlfEntry>& changes);
+    void handleCaptureDowngraded(const CaptureStages& active, int64_t frameMicros);
+    void disableCodecVad();
+    bool configureOpus();
+    void startOpusControl(pjsua_call_id callId, unsigned mediaIndex);
+    void stopOpusControl(pjsua_call_id callId);
+    bool applyOpusTarget(pjsua_call_id callId, const OpusTarget& target);
+    void handleOpusTimer(unsigned generation);
+    void publishStateMirror();
+    void handleLevelTimer(unsigned generation);
+    
+    // Tratamento dos callbacks PJSUA (executados no thread SIP)
+    void handleRegState(int status);
+    void handleIncomingCall(pjsua_call_id callId, const std::string& remoteUri, const std::string& displayName,
+                            const std::string& user, int64_t inviteReceived);
+    void handleCallState(pjsua_call_id callId, pjsip_inv_state state, pjsip_role_e role, int lastStatus,
+                         const std::string& remoteIdentity, int64_t now);
+    void handleCallMediaState(pjsua_call_id callId, pjsua_call_media_status mediaStatus, pjsua_conf_port_id confSlot);
+    void handleTransferStatus(pjsua_call_id callId, int statusCode, bool final);
     
     // Callbacks PJSUA (static para compatibilidade com C)
     static void onRegState(pjsua_acc_id acc_id);
@@ -268,9 +800,18 @@ private:
     static void onCallMediaState(pjsua_call_id call_id);
     static void onCallTransferStatus(pjsua_call_id call_id, int st_code, const pj_str_t* st_text, pj_bool_t final_, pj_bool_t* p_cont);
     static void onDtmfDigit(pjsua_call_id call_id, int digit);
+    static void onStreamCreated2(pjsua_call_id call_id, pjsua_on_stream_created_param* param);
+    static void onStreamDestroyed(pjsua_call_id call_id, pjmedia_stream* strm, unsigned stream_idx);
+    static void onAudioIdleTimer(void* user_data);
+    static void onDtmfTimer(void* user_data);
+    static void onOpusTimer(void* user_data);
+    static void onLevelTimer(void* user_data);
     
     // Instância singleton para callbacks estáticos
     static SipEngine* s_instance;
+    
+    // Thread dono do estado (declarado por último: encerrado antes dos demais membros)
+    CommandThread m_sipThread{"echo-sip"};
 };
 
 } // namespace echo
@@ -0,0 +1,195 @@
+/**
+ * @file sip_uri.cpp
+ * @brief Implementação do parser de identidades SIP
+ */
+
+#include "sip_uri.h"
+
+namespace echo {
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+std::string_view trim(std::string_view value) {
+    while (!value.empty() && isSpace(value.front())) value.remove_prefix(1);
+    while (!value.empty() && isSpace(value.back())) value.remove_suffix(1);
+    return value;
+}
+
+char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (lower(a[i]) != lower(b[i])) return false;
+    }
+    return true;
+}
+
+// Separa "texto;params" no primeiro ';'
+std::string_view splitParams(std::string_view value, std::string_view* params) {
+    size_t semi = value.find(';');
+    if (semi == std::string_view::npos) {
+        *params = std::string_view();
+        return value;
+    }
+    *params = value.substr(semi + 1);
+    return value.substr(0, semi);
+}
+
+// Interpreta um addr-spec (sem < >)
+bool parseAddrSpec(std::string_view spec, SipUriView& out) {
+    out.uri = spec;
+
+    size_t colon = spec.find(':');
+    if (colon == 0 || colon == std::string_view::npos) {
+        return false;
+    }
+    out.scheme = spec.substr(0, colon);
+    std::string_view rest = spec.substr(colon + 1);
+
+    size_t question = rest.find('?');
+    if (question != std::string_view::npos) {
+        out.uriHeaders = rest.substr(question + 1);
+        rest = rest.substr(0, question);
+    }
+
+    if (equalsIgnoreCase(out.scheme, "tel")) {
+        // tel:+55119999;phone-context=... (o número faz o papel do usuário)
+        out.user = splitParams(rest, &out.uriParams);
+        return !out.user.empty();
+    }
+
+    if (!equalsIgnoreCase(out.scheme, "sip") && !equalsIgnoreCase(out.scheme, "sips")) {
+        return false;
+    }
+
+    // userinfo termina no último '@' antes dos parâmetros do host
+    std::string_view hostPart = rest;
+    size_t at = rest.find('@');
+    if (at != std::string_view::npos) {
+        std::string_view userinfo = rest.substr(0, at);
+        size_t passwordColon = userinfo.find(':');
+        if (passwordColon != std::string_view::npos) {
+            out.password = userinfo.substr(passwordColon + 1);
+            userinfo = userinfo.substr(0, passwordColon);
+        }
+        out.user = userinfo;
+        hostPart = rest.substr(at + 1);
+    }
+
+    std::string_view hostport = splitParams(hostPart, &out.uriParams);
+
+    if (!hostport.empty() && hostport.front() == '[') {
+        size_t close = hostport.find(']');
+        if (close == std::string_view::npos) {
+            return false;
+        }
+        out.host = hostport.substr(1, close - 1);
+        std::string_view after = hostport.substr(close + 1);
+        if (!after.empty()) {
+            if (after.front() != ':') return false;
+            out.port = after.substr(1);
+        }
+    } else {
+        size_t portColon = hostport.find(':');
+        out.host = hostport.substr(0, portColon);
+        if (portColon != std::string_view::npos) {
+            out.port = hostport.substr(portColon + 1);
+        }
+    }
+
+    return !out.host.empty();
+}
+
+} // namespace
+
+bool parseSipNameAddr(std::string_view input, SipUriView& out) {
+    out = SipUriView();
+    std::string_view text = trim(input);
+    if (text.empty()) {
+        return false;
+    }
+
+    std::string_view afterDisplay = text;
+
+    if (text.front() == '"') {
+        // quoted-string: termina na próxima aspa não escapada
+        size_t i = 1;
+        while (i < text.size() && text[i] != '"') {
+            i += (text[i] == '\\' && i + 1 < text.size()) ? 2 : 1;
+        }
+        if (i >= text.size()) {
+            return false;
+        }
+        out.displayName = text.substr(1, i - 1);
+        out.quotedDisplayName = true;
+        afterDisplay = trim(text.substr(i + 1));
+        if (afterDisplay.empty() || afterDisplay.front() != '<') {
+            return false;
+        }
+    }
+
+    size_t lt = afterDisplay.find('<');
+    if (lt == std::string_view::npos) {
+        // addr-spec: parâmetros após ';' pertencem ao header (RFC 3261, 20.10)
+        std::string_view spec = splitParams(afterDisplay, &out.headerParams);
+        return parseAddrSpec(trim(spec), out);
+    }
+
+    if (!out.quotedDisplayName) {
+        out.displayName = trim(afterDisplay.substr(0, lt));
+    }
+
+    size_t gt = afterDisplay.find('>', lt + 1);
+    if (gt == std::string_view::npos) {
+        return false;
+    }
+
+    std::string_view tail = trim(afterDisplay.substr(gt + 1));
+    if (!tail.empty()) {
+        if (tail.front() != ';') {
+            return false;
+        }
+        out.headerParams = tail.substr(1);
+    }
+
+    return parseAddrSpec(trim(afterDisplay.substr(lt + 1, gt - lt - 1)), out);
+}
+
+bool findSipParam(std::string_view params, std::string_view name, std::string_view* value) {
+    while (!params.empty()) {
+        size_t semi = params.find(';');
+        std::string_view param = trim(params.substr(0, semi));
+        params = semi == std::string_view::npos ? std::string_view() : params.substr(semi + 1);
+
+        size_t equals = param.find('=');
+        std::string_view paramName = trim(param.substr(0, equals));
+        if (equalsIgnoreCase(paramName, name)) {
+            if (value) {
+                *value = equals == std::string_view::npos ? std::string_view() : trim(param.substr(equals + 1));
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string decodeDisplayName(std::string_view displayName) {
+    std::string out;
+    out.reserve(displayName.size());
+    for (size_t i = 0; i < displayName.size(); ++i) {
+        if (displayName[i] == '\\' && i + 1 < displayName.size()) {
+            ++i;
+        }
+        out += displayName[i];
+    }
+    return out;
+}
+
+} // namespace echo
@@ -0,0 +1,73 @@
+/**
+ * @file sip_uri.h
+ * @brief Parser de identidades SIP sem alocação
+ *
+ * Este arquivo define o parser usado nos callbacks de chamada para extrair
+ * nome de exibição, usuário e host de valores como remote_info:
+ *
+ *   "John Smith" <sip:2000@pbx.local:5060;transport=tcp>;tag=abc
+ *   John Smith <sips:2000@pbx.local>
+ *   <tel:+5511999998888;phone-context=example.com>
+ *   sip:2000@pbx.local;tag=abc
+ *
+ * O resultado são std::string_view apontando para a entrada, que deve
+ * permanecer válida enquanto o resultado for usado.
+ */
+
+#ifndef SIP_URI_H
+#define SIP_URI_H
+
+#include <string>
+#include <string_view>
+
+namespace echo {
+
+/**
+ * @brief Partes de um name-addr / addr-spec SIP (views sobre a entrada)
+ */
+struct SipUriView {
+    std::string_view displayName;   // Sem aspas; escapes (\") preservados
+    std::string_view uri;           // addr-spec completo (sem < >)
+    std::string_view scheme;        // "sip", "sips", "tel" (como na entrada)
+    std::string_view user;          // Usuário (sip/sips) ou número (tel)
+    std::string_view password;      // user:password (raro, mas válido)
+    std::string_view host;          // Sem colchetes para IPv6
+    std::string_view port;
+    std::string_view uriParams;     // Após o primeiro ';' da URI, sem o ';'
+    std::string_view uriHeaders;    // Após '?', sem o '?'
+    std::string_view headerParams;  // Parâmetros fora da URI (tag=...), sem o ';'
+    bool quotedDisplayName = false;
+
+    /**
+     * @brief Identidade curta para exibição: usuário ou, na falta, host
+     */
+    std::string_view identity() const {
+        return user.empty() ? host : user;
+    }
+};
+
+/**
+ * @brief Interpreta um name-addr ou addr-spec SIP/SIPS/TEL
+ * @param input Texto a interpretar (espaços nas pontas são ignorados)
+ * @param out Recebe as partes encontradas
+ * @return false se a entrada não contém uma URI reconhecível
+ */
+bool parseSipNameAddr(std::string_view input, SipUriView& out);
+
+/**
+ * @brief Procura um parâmetro em uma lista "a=b;c;d=e" (nome sem distinção de caixa)
+ * @param params Lista de parâmetros (uriParams ou headerParams)
+ * @param name Nome do parâmetro
+ * @param value Recebe o valor (vazio para parâmetros sem '=')
+ * @return true se o parâmetro existe
+ */
+bool findSipParam(std::string_view params, std::string_view name, std::string_view* value);
+
+/**
+ * @brief Converte o nome de exibição para texto (remove escapes \x)
+ */
+std::string decodeDisplayName(std::string_view displayName);
+
+} // namespace echo
+
+#endif // SIP_URI_H
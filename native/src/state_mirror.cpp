@@ -0,0 +1,81 @@
+/**
+ * @file state_mirror.cpp
+ * @brief Implementação do espelho de estado
+ */
+
+#include "state_mirror.h"
+
+#include <new>
+
+namespace echo {
+
+static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t), "atomic<int32_t> precisa ter 4 bytes");
+static_assert(std::atomic<int32_t>::is_always_lock_free, "atomic<int32_t> precisa ser lock-free");
+
+bool StateMirror::attach(void* data, size_t size) {
+    if (!data || size < mirror::kBytes || reinterpret_cast<uintptr_t>(data) % alignof(int32_t) != 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto* words = new (data) std::atomic<int32_t>[mirror::kWords];
+    for (size_t i = 0; i < mirror::kWords; ++i) {
+        words[i].store(0, std::memory_order_relaxed);
+    }
+    words[mirror::Magic].store(mirror::kMagic, std::memory_order_relaxed);
+    words[mirror::LayoutVersion].store(mirror::kLayoutVersion, std::memory_order_relaxed);
+    m_words = words;
+    write(m_last);
+    return true;
+}
+
+void StateMirror::publish(const MirrorState& state) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_last = state;
+    if (m_words) {
+        write(state);
+    }
+}
+
+void StateMirror::write(const MirrorState& state) {
+    std::atomic<int32_t>* words = m_words;
+    if (!words) {
+        return;
+    }
+
+    auto set = [words](size_t slot, int32_t value) {
+        words[slot].store(value, std::memory_order_relaxed);
+    };
+
+    auto sequence = static_cast<uint32_t>(words[mirror::Sequence].load(std::memory_order_relaxed));
+    words[mirror::Sequence].store(static_cast<int32_t>(sequence + 1), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    set(mirror::Connection, state.connection);
+    set(mirror::CallStatus, state.callStatus);
+    set(mirror::CallDirection, state.callDirection);
+    set(mirror::Muted, state.muted);
+    set(mirror::CurrentCall, state.currentCall);
+    set(mirror::TxLevel, state.txLevel);
+    set(mirror::RxLevel, state.rxLevel);
+    set(mirror::Registrations, static_cast<int32_t>(state.registrations));
+    set(mirror::RegistrationFailures, static_cast<int32_t>(state.registrationFailures));
+    set(mirror::CallsStarted, static_cast<int32_t>(state.callsStarted));
+    set(mirror::CallsEnded, static_cast<int32_t>(state.callsEnded));
+
+    size_t count = state.callCount < mirror::kMaxCalls ? state.callCount : mirror::kMaxCalls;
+    set(mirror::CallCount, static_cast<int32_t>(count));
+    for (size_t i = 0; i < mirror::kMaxCalls; ++i) {
+        MirrorCall call = i < count ? state.calls[i] : MirrorCall();
+        size_t base = mirror::Calls + i * mirror::CallWords;
+        set(base + mirror::CallFieldId, call.callId);
+        set(base + mirror::CallFieldState, call.state);
+        set(base + mirror::CallFieldFlags, call.flags);
+        set(base + mirror::CallFieldLastStatus, call.lastStatus);
+    }
+
+    // Volta a par (pode dar a volta: o leitor só compara igualdade)
+    words[mirror::Sequence].store(static_cast<int32_t>(sequence + 2), std::memory_order_release);
+}
+
+} // namespace echo
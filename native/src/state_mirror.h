@@ -0,0 +1,139 @@
+/**
+ * @file state_mirror.h
+ * @brief Espelho do estado do engine em um bloco de memória de layout fixo
+ *
+ * Este arquivo define o StateMirror, que escreve o estado corrente
+ * (conexão, chamadas, mudo, níveis de áudio e contadores) em palavras int32
+ * de posições fixas. O addon entrega o bloco ao JavaScript como
+ * ArrayBuffer: o estado é lido com um Int32Array, sem chamar o módulo
+ * nativo e sem montar objetos; os eventos ficam só para as transições.
+ *
+ * As escritas seguem um seqlock: a palavra Sequence fica ímpar durante a
+ * escrita e avança 2 a cada publicação. O leitor lê Sequence com
+ * Atomics.load, copia os campos e relê Sequence; se estava ímpar ou mudou,
+ * repete a cópia.
+ */
+
+#ifndef STATE_MIRROR_H
+#define STATE_MIRROR_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace echo {
+
+namespace mirror {
+
+constexpr int32_t kMagic = 0x4543484F;         // "ECHO"
+constexpr int32_t kLayoutVersion = 1;
+constexpr size_t kMaxCalls = 8;
+
+/**
+ * @brief Posições (índices no Int32Array) do cabeçalho e do estado geral
+ */
+enum Slot : size_t {
+    Magic = 0,
+    LayoutVersion,
+    Sequence,               // Ímpar durante a escrita
+    Connection,             // SipConnectionState
+    CallStatus,             // CallState da chamada atual
+    CallDirection,          // CallDirection
+    Muted,                  // 0/1
+    CurrentCall,            // pjsua_call_id ou -1
+    TxLevel,                // Nível enviado na chamada atual (0..255), -1 sem chamada
+    RxLevel,                // Nível recebido na chamada atual (0..255), -1 sem chamada
+    Registrations,          // Registros bem sucedidos
+    RegistrationFailures,
+    CallsStarted,
+    CallsEnded,
+    CallCount,              // Registros válidos em Calls
+    Reserved,
+    Calls,                  // kMaxCalls registros de CallWords palavras
+};
+
+/**
+ * @brief Campos de cada registro de chamada (deslocamento a partir de Calls + i * CallWords)
+ */
+enum CallField : size_t {
+    CallFieldId = 0,
+    CallFieldState,         // CallState
+    CallFieldFlags,         // kCall*
+    CallFieldLastStatus,    // Último código SIP
+    CallWords,
+};
+
+constexpr int32_t kCallIncoming = 1 << 0;
+constexpr int32_t kCallHeld = 1 << 1;
+constexpr int32_t kCallCurrent = 1 << 2;
+
+constexpr size_t kWords = Calls + kMaxCalls * CallWords;
+constexpr size_t kBytes = kWords * sizeof(int32_t);
+
+} // namespace mirror
+
+/**
+ * @brief Uma chamada no espelho
+ */
+struct MirrorCall {
+    int32_t callId = -1;
+    int32_t state = 0;
+    int32_t flags = 0;
+    int32_t lastStatus = 0;
+};
+
+/**
+ * @brief Estado publicado no espelho
+ */
+struct MirrorState {
+    int32_t connection = 0;
+    int32_t callStatus = 0;
+    int32_t callDirection = 0;
+    int32_t muted = 0;
+    int32_t currentCall = -1;
+    int32_t txLevel = -1;
+    int32_t rxLevel = -1;
+    uint32_t registrations = 0;
+    uint32_t registrationFailures = 0;
+    uint32_t callsStarted = 0;
+    uint32_t callsEnded = 0;
+    std::array<MirrorCall, mirror::kMaxCalls> calls{};
+    size_t callCount = 0;
+};
+
+class StateMirror {
+public:
+    StateMirror() = default;
+    StateMirror(const StateMirror&) = delete;
+    StateMirror& operator=(const StateMirror&) = delete;
+
+    /**
+     * @brief Passa a escrever em data (mirror::kBytes, alinhado a 4 bytes)
+     *
+     * Escreve o cabeçalho e o último estado publicado. A memória precisa
+     * continuar válida enquanto o espelho existir.
+     *
+     * @return false se o bloco é pequeno ou desalinhado
+     */
+    bool attach(void* data, size_t size);
+
+    /**
+     * @brief Publica o estado (guardado para um attach posterior)
+     *
+     * Thread-safe: publicações concorrentes são serializadas.
+     */
+    void publish(const MirrorState& state);
+
+private:
+    void write(const MirrorState& state);
+
+    std::mutex m_mutex;
+    std::atomic<int32_t>* m_words{nullptr};
+    MirrorState m_last;
+};
+
+} // namespace echo
+
+#endif // STATE_MIRROR_H
@@ -0,0 +1,179 @@
+/**
+ * @file trace.cpp
+ * @brief Implementação do tracer em ring buffer
+ */
+
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace echo {
+namespace trace {
+
+namespace {
+
+// Capacidade do buffer de cada thread (potência de dois)
+constexpr uint64_t kCapacity = 1 << 13;
+constexpr uint64_t kMask = kCapacity - 1;
+
+/**
+ * Slot do ring buffer. O campo seq é publicado por último (release) e
+ * permite ao leitor descartar slots sobrescritos durante a cópia.
+ */
+struct Slot {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<int64_t> timestamp{0};
+    std::atomic<char> phase{0};
+};
+
+/**
+ * Ring buffer de um thread. Apenas o thread dono escreve, portanto o
+ * registro de um evento não precisa de operações read-modify-write.
+ */
+struct ThreadBuffer {
+    uint32_t tid = 0;
+    std::atomic<uint64_t> head{0};
+    std::atomic<uint64_t> base{0};  // Eventos anteriores foram descartados por clear()
+    Slot slots[kCapacity];
+};
+
+std::atomic<bool> g_enabled{false};
+
+// Buffers nunca são liberados: threads PJSIP/Node são poucos e de longa duração
+std::mutex g_buffersMutex;
+std::vector<ThreadBuffer*> g_buffers;
+
+ThreadBuffer* createThreadBuffer() {
+    static std::atomic<uint32_t> nextId{1};
+    ThreadBuffer* buffer = new ThreadBuffer();
+    buffer->tid = nextId.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(g_buffersMutex);
+    g_buffers.push_back(buffer);
+    return buffer;
+}
+
+ThreadBuffer& currentBuffer() {
+    thread_local ThreadBuffer* buffer = createThreadBuffer();
+    return *buffer;
+}
+
+int64_t nowNanos() {
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+} // anonymous namespace
+
+void setEnabled(bool enabled) {
+    g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool isEnabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void record(const char* name, Phase phase) {
+    if (!g_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    ThreadBuffer& buffer = currentBuffer();
+    uint64_t index = buffer.head.load(std::memory_order_relaxed);
+    Slot& slot = buffer.slots[index & kMask];
+
+    // Invalidar o slot enquanto os campos são escritos
+    slot.seq.store(0, std::memory_order_relaxed);
+    // Impede que os campos sejam vistos antes da invalidação (o leitor
+    // juntaria dados novos ao seq antigo)
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.timestamp.store(nowNanos(), std::memory_order_relaxed);
+    slot.phase.store(static_cast<char>(phase), std::memory_order_relaxed);
+    slot.seq.store(index + 1, std::memory_order_release);
+    buffer.head.store(index + 1, std::memory_order_release);
+}
+
+void clear() {
+    std::lock_guard<std::mutex> lock(g_buffersMutex);
+    for (ThreadBuffer* buffer : g_buffers) {
+        buffer->base.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+std::string dumpChromeTrace() {
+    struct Event {
+        const char* name;
+        int64_t timestamp;
+        uint32_t tid;
+        char phase;
+    };
+
+    std::vector<ThreadBuffer*> buffers;
+    {
+        std::lock_guard<std::mutex> lock(g_buffersMutex);
+        buffers = g_buffers;
+    }
+
+    std::vector<Event> events;
+    for (ThreadBuffer* buffer : buffers) {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t first = head > kCapacity ? head - kCapacity : 0;
+        uint64_t base = buffer->base.load(std::memory_order_relaxed);
+        if (first < base) first = base;
+
+        for (uint64_t index = first; index < head; index++) {
+            const Slot& slot = buffer->slots[index & kMask];
+            uint64_t seq = slot.seq.load(std::memory_order_acquire);
+            if (seq != index + 1) {
+                continue;
+            }
+
+            Event ev;
+            ev.name = slot.name.load(std::memory_order_relaxed);
+            ev.timestamp = slot.timestamp.load(std::memory_order_relaxed);
+            ev.tid = buffer->tid;
+            ev.phase = slot.phase.load(std::memory_order_relaxed);
+
+            // Descartar se o slot foi sobrescrito durante a leitura
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != seq || ev.name == nullptr) {
+                continue;
+            }
+            events.push_back(ev);
+        }
+    }
+
+    std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.timestamp < b.timestamp;
+    });
+    int64_t origin = events.empty() ? 0 : events.front().timestamp;
+
+    // ts em microssegundos com resolução de ns: notação fixa, senão a
+    // precisão padrão (6 dígitos) funde eventos depois de ~1 s de trace
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); i++) {
+        const Event& ev = events[i];
+        if (i > 0) out << ",";
+        out << "{\"name\":\"" << ev.name << "\",";
+        out << "\"ph\":\"" << ev.phase << "\",";
+        if (ev.phase == static_cast<char>(Phase::Instant)) {
+            out << "\"s\":\"t\",";
+        }
+        out << "\"ts\":" << static_cast<double>(ev.timestamp - origin) / 1000.0 << ",";
+        out << "\"pid\":1,\"tid\":" << ev.tid << "}";
+    }
+    out << "]}";
+
+    return out.str();
+}
+
+} // namespace trace
+} // namespace echo
@@ -0,0 +1,91 @@
+/**
+ * @file trace.h
+ * @brief Tracer de baixo custo baseado em ring buffer
+ *
+ * Este arquivo define um tracer binário que registra entrada e saída dos
+ * callbacks PJSUA e das funções N-API em um buffer circular de tamanho fixo,
+ * exportável sob demanda no formato JSON do Chrome Trace (chrome://tracing,
+ * Perfetto).
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace echo {
+namespace trace {
+
+/**
+ * @brief Fase de um evento de trace (mesma semântica do Chrome Trace)
+ */
+enum class Phase : char {
+    Begin = 'B',
+    End = 'E',
+    Instant = 'i'
+};
+
+/**
+ * @brief Habilita ou desabilita a coleta
+ *
+ * Com a coleta desabilitada cada ponto de trace custa apenas uma leitura
+ * atômica relaxada.
+ */
+void setEnabled(bool enabled);
+
+/**
+ * @brief Verifica se a coleta está habilitada
+ */
+bool isEnabled();
+
+/**
+ * @brief Registra um evento
+ * @param name Nome do evento (deve ser um literal ou ter duração estática)
+ * @param phase Fase do evento
+ */
+void record(const char* name, Phase phase);
+
+/**
+ * @brief Descarta todos os eventos registrados
+ */
+void clear();
+
+/**
+ * @brief Exporta o conteúdo do buffer no formato Chrome Trace JSON
+ */
+std::string dumpChromeTrace();
+
+/**
+ * @brief Registra Begin no construtor e End no destrutor
+ */
+class Scope {
+public:
+    explicit Scope(const char* name) : m_name(name) {
+        record(m_name, Phase::Begin);
+    }
+
+    ~Scope() {
+        record(m_name, Phase::End);
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* m_name;
+};
+
+} // namespace trace
+} // namespace echo
+
+#define ECHO_TRACE_CONCAT_INNER(a, b) a##b
+#define ECHO_TRACE_CONCAT(a, b) ECHO_TRACE_CONCAT_INNER(a, b)
+
+/**
+ * @brief Registra a duração do escopo atual com o nome informado
+ */
+#define ECHO_TRACE_SCOPE(name) ::echo::trace::Scope ECHO_TRACE_CONCAT(echoTraceScope_, __LINE__)(name)
+
+#endif // TRACE_H
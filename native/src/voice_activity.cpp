@@ -0,0 +1,101 @@
+/**
+ * @file voice_activity.cpp
+ * @brief Implementação da detecção de atividade de voz
+ */
+
+#include "voice_activity.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+namespace echo {
+
+namespace {
+
+constexpr double kSilenceDb = -96.0;            // Quadro digitalmente nulo
+constexpr double kMinSpeechDb = -50.0;          // Voz abaixo disso não é considerada
+constexpr double kInitialNoiseFloorDb = -60.0;
+constexpr double kNoiseFloorRiseDbPerSecond = 2.5;
+
+bool equalsIgnoreCase(const std::string& a, const std::string& b) {
+    return a.size() == b.size() &&
+        std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+            return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+        });
+}
+
+} // namespace
+
+VadOptions clampVadOptions(const VadOptions& options) {
+    VadOptions clamped = options;
+    clamped.hangoverMs = std::clamp(options.hangoverMs, kVadMinHangoverMs, kVadMaxHangoverMs);
+    clamped.thresholdDb = std::clamp(options.thresholdDb, kVadMinThresholdDb, kVadMaxThresholdDb);
+    return clamped;
+}
+
+bool vadAppliesToCodec(const VadOptions& options, const std::string& codec) {
+    if (!options.enabled || codec.empty()) {
+        return false;
+    }
+    if (options.codecs.empty()) {
+        return !equalsIgnoreCase(codec, "opus");
+    }
+    return std::any_of(options.codecs.begin(), options.codecs.end(),
+                       [&codec](const std::string& name) { return equalsIgnoreCase(name, codec); });
+}
+
+VoiceActivityDetector::VoiceActivityDetector(unsigned clockRate, unsigned samplesPerFrame)
+    : m_frameMs(std::max(1u, samplesPerFrame * 1000 / std::max(1u, clockRate))),
+      m_hangoverFrames(0),
+      m_thresholdDb(VadOptions().thresholdDb) {
+    configure(VadOptions().hangoverMs, VadOptions().thresholdDb);
+    reset();
+}
+
+void VoiceActivityDetector::configure(unsigned hangoverMs, unsigned thresholdDb) {
+    m_hangoverFrames.store((hangoverMs + m_frameMs - 1) / m_frameMs, std::memory_order_relaxed);
+    m_thresholdDb.store(thresholdDb, std::memory_order_relaxed);
+}
+
+void VoiceActivityDetector::reset() {
+    m_hangoverLeft = 0;
+    m_noiseFloorDb = kInitialNoiseFloorDb;
+    m_lastLevelDb = kSilenceDb;
+}
+
+bool VoiceActivityDetector::process(const int16_t* samples, size_t count) {
+    if (count == 0) {
+        return m_hangoverLeft > 0;
+    }
+
+    double sum = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        double x = samples[i];
+        sum += x * x;
+    }
+    double meanSquare = sum / (static_cast<double>(count) * 32768.0 * 32768.0);
+    double level = meanSquare > 0.0 ? std::max(kSilenceDb, 10.0 * std::log10(meanSquare)) : kSilenceDb;
+    m_lastLevelDb = level;
+
+    // Piso de ruído: desce na hora, sobe devagar (voz contínua não o arrasta)
+    if (level < m_noiseFloorDb) {
+        m_noiseFloorDb = level;
+    } else {
+        m_noiseFloorDb = std::min(level, m_noiseFloorDb + kNoiseFloorRiseDbPerSecond * m_frameMs / 1000.0);
+    }
+
+    double threshold = static_cast<double>(m_thresholdDb.load(std::memory_order_relaxed));
+    bool voice = level > kMinSpeechDb && level > m_noiseFloorDb + threshold;
+    if (voice) {
+        m_hangoverLeft = m_hangoverFrames.load(std::memory_order_relaxed);
+        return true;
+    }
+    if (m_hangoverLeft > 0) {
+        --m_hangoverLeft;
+        return true;
+    }
+    return false;
+}
+
+} // namespace echo
@@ -0,0 +1,97 @@
+/**
+ * @file voice_activity.h
+ * @brief Detecção de atividade de voz (VAD) com hangover para o microfone
+ *
+ * Este arquivo define o VoiceActivityDetector, usado na saída com VAD da
+ * CapturePort: quadros de silêncio não são entregues à chamada e o
+ * stream deixa de enviar RTP até a voz voltar (o primeiro pacote sai com
+ * o bit marker). Economiza banda em codecs sem DTX próprio (G.711, GSM,
+ * iLBC...).
+ *
+ * A decisão é por energia: o nível de cada quadro (dBFS) é comparado a
+ * um piso de ruído que desce imediatamente e sobe devagar (2,5 dB/s).
+ * Voz é nível acima do piso mais o limiar e acima de -50 dBFS. Depois da
+ * última voz o quadro continua sendo enviado por hangoverMs, o que evita
+ * cortar finais de palavra e pausas curtas.
+ */
+
+#ifndef VOICE_ACTIVITY_H
+#define VOICE_ACTIVITY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace echo {
+
+/**
+ * @brief Configuração do VAD
+ */
+struct VadOptions {
+    bool enabled = false;
+    unsigned hangoverMs = 300;
+    unsigned thresholdDb = 9;       // Acima do piso de ruído
+    // Codecs (nome de encoding, ex. "PCMU") com VAD; vazio = todos sem DTX próprio
+    std::vector<std::string> codecs;
+};
+
+// Limites aceitos
+constexpr unsigned kVadMinHangoverMs = 60;
+constexpr unsigned kVadMaxHangoverMs = 2000;
+constexpr unsigned kVadMinThresholdDb = 3;
+constexpr unsigned kVadMaxThresholdDb = 30;
+
+/**
+ * @brief Ajusta hangover e limiar aos limites
+ */
+VadOptions clampVadOptions(const VadOptions& options);
+
+/**
+ * @brief Se o VAD vale para o codec negociado
+ *
+ * Com a lista vazia vale para todos, exceto os que já fazem DTX (Opus).
+ * A comparação ignora maiúsculas.
+ */
+bool vadAppliesToCodec(const VadOptions& options, const std::string& codec);
+
+class VoiceActivityDetector {
+public:
+    /**
+     * @param clockRate Taxa de amostragem do áudio
+     * @param samplesPerFrame Tamanho do quadro (define a resolução do hangover)
+     */
+    VoiceActivityDetector(unsigned clockRate, unsigned samplesPerFrame);
+
+    /**
+     * @brief Define hangover e limiar (qualquer thread)
+     */
+    void configure(unsigned hangoverMs, unsigned thresholdDb);
+
+    /**
+     * @brief Analisa um quadro PCM 16 bits mono
+     * @return true se o quadro deve ser transmitido (voz ou hangover)
+     */
+    bool process(const int16_t* samples, size_t count);
+
+    /**
+     * @brief Volta ao estado inicial (piso de ruído e hangover)
+     */
+    void reset();
+
+    double noiseFloorDb() const { return m_noiseFloorDb; }
+    double lastLevelDb() const { return m_lastLevelDb; }
+
+private:
+    unsigned m_frameMs;
+    std::atomic<unsigned> m_hangoverFrames;
+    std::atomic<unsigned> m_thresholdDb;
+    unsigned m_hangoverLeft = 0;
+    double m_noiseFloorDb;
+    double m_lastLevelDb;
+};
+
+} // namespace echo
+
+#endif // VOICE_ACTIVITY_H
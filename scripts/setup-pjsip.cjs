@@ -113,6 +113,17 @@ function checkLinuxDependencies() {
               'Ou no Ubuntu/Debian: sudo apt-get install libasound2-dev');
     }
     
+    // Opus: o configure do PJSIP só habilita o codec se encontrar a libopus
+    try {
+        execSync('pkg-config --exists opus', { stdio: 'pipe' });
+        log('✓ Opus encontrado (pkg-config)');
+    } catch (e) {
+        log('✗ Opus não encontrado');
+        error('libopus é necessária para o codec Opus.\n' +
+              'Instale com: sudo dnf install opus-devel\n' +
+              'Ou no Ubuntu/Debian: sudo apt-get install libopus-dev');
+    }
+    
     // Verificar outros requisitos básicos
     const requiredCommands = ['gcc', 'make'];
     for (const cmd of requiredCommands) {
@@ -6,6 +6,7 @@ type InfoChamadaEntrante = {
   displayName?: string
   user?: string
   uri?: string
+  contactName?: string
 }
 
 type PropsEstadoEntrante = {
@@ -16,7 +17,7 @@ type PropsEstadoEntrante = {
 
 export function IncomingState({ incomingCall, onAnswer, onReject }: PropsEstadoEntrante) {
   const displayName =
-    incomingCall?.displayName ?? incomingCall?.user ?? 'Desconhecido'
+    incomingCall?.contactName || (incomingCall?.displayName ?? incomingCall?.user ?? 'Desconhecido')
   const number = incomingCall?.user ?? incomingCall?.uri ?? ''
 
   return (
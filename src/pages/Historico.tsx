@@ -4,7 +4,7 @@ import { TopBar } from '../components/ui/BarraSuperior'
 import { Card } from '../components/ui/Cartao'
 import { useSip } from '../sip/react/useSip'
 import { clearStorage } from '../services/servicoArmazenamento'
-import { getCallHistory, clearCallHistory, type CallHistoryEntry } from '../services/servicoHistorico'
+import { getCallHistoryPage, clearCallHistory, type CallHistoryEntry } from '../services/servicoHistorico'
 import { CallHistoryTable } from '../components/historico/TabelaHistoricoChamadas'
 import { addContact } from '../services/servicoContatos'
 import { AddContactModal } from '../components/contacts/ModalAdicionarContato'
@@ -46,13 +46,23 @@ function ClearIcon() {
   )
 }
 
+// Entradas por página do histórico
+const PAGE_SIZE = 100
+
 export default function Historico() {
   const navigate = useNavigate()
   const sip = useSip()
   const [history, setHistory] = useState<CallHistoryEntry[]>([])
+  const [total, setTotal] = useState(0)
+  const [nextCursor, setNextCursor] = useState<string | null>(null)
+  const [loadingMore, setLoadingMore] = useState(false)
+  const historyRef = useRef<CallHistoryEntry[]>([])
+  const nextCursorRef = useRef<string | null>(null)
+  const extraPagesRef = useRef(false)
   const [loading, setLoading] = useState(true)
   const [searchQuery, setSearchQuery] = useState('')
   const isFirstLoadRef = useRef(true)
+  const loadHistoryRef = useRef<(() => Promise<void>) | null>(null)
   const [addContactModalOpen, setAddContactModalOpen] = useState(false)
   const [contactToAdd, setContactToAdd] = useState<{ number: string; name?: string } | null>(null)
 
@@ -69,11 +79,34 @@ export default function Historico() {
   async function handleClearHistory() {
     if (window.confirm('Tem certeza que deseja limpar todo o histórico de chamadas?')) {
       await clearCallHistory()
-      setHistory([])
+      extraPagesRef.current = false
+      applyHistory([], null)
+      setTotal(0)
       setSearchQuery('')
     }
   }
 
+  function applyHistory(entries: CallHistoryEntry[], cursor: string | null) {
+    historyRef.current = entries
+    nextCursorRef.current = cursor
+    setHistory(entries)
+    setNextCursor(cursor)
+  }
+
+  async function handleLoadMore() {
+    if (!nextCursorRef.current || loadingMore) return
+    setLoadingMore(true)
+    try {
+      const page = await getCallHistoryPage({ before: nextCursorRef.current, limit: PAGE_SIZE })
+      extraPagesRef.current = true
+      applyHistory([...historyRef.current, ...page.entries], page.nextCursor)
+    } catch (error) {
+      console.error('Erro ao carregar histórico:', error)
+    } finally {
+      setLoadingMore(false)
+    }
+  }
+
   function handleAddContact(number: string, name?: string) {
     setContactToAdd({ number, name })
     setAddContactModalOpen(true)
@@ -104,8 +137,22 @@ export default function Historico() {
         setLoading(true)
       }
       try {
-        const entries = await getCallHistory()
-        setHistory(entries)
+        // Apenas a primeira página é recarregada
+        const page = await getCallHistoryPage({ limit: PAGE_SIZE })
+        setTotal(page.total)
+
+        if (extraPagesRef.current) {
+          const lastId = page.entries[page.entries.length - 1]?.id
+          const index = historyRef.current.findIndex((entry) => entry.id === lastId)
+          if (index !== -1) {
+            // Mantém as páginas mais antigas já carregadas
+            applyHistory([...page.entries, ...historyRef.current.slice(index + 1)], nextCursorRef.current)
+            return
+          }
+        }
+
+        extraPagesRef.current = false
+        applyHistory(page.entries, page.nextCursor)
       } catch (error) {
         console.error('Erro ao carregar histórico:', error)
       } finally {
@@ -115,6 +162,7 @@ export default function Historico() {
         }
       }
     }
+    loadHistoryRef.current = loadHistory
     void loadHistory()
 
     // Atualiza o histórico periodicamente (a cada 5 segundos) para pegar novas chamadas
@@ -125,6 +173,13 @@ export default function Historico() {
     return () => clearInterval(interval)
   }, [])
 
+  // Backend nativo: recarrega assim que o engine grava o CDR da chamada
+  useEffect(() => {
+    if (sip.lastCallRecord) {
+      void loadHistoryRef.current?.()
+    }
+  }, [sip.lastCallRecord])
+
 
   const isIncoming = sip.snapshot.callStatus === 'incoming'
 
@@ -153,7 +208,7 @@ export default function Historico() {
                 ? 'Nenhuma chamada registrada'
                 : searchQuery
                   ? `${filteredHistory.length} de ${history.length} ${history.length === 1 ? 'chamada' : 'chamadas'}`
-                  : `${history.length} ${history.length === 1 ? 'chamada' : 'chamadas'} registrada${history.length === 1 ? '' : 's'}`}
+                  : `${total} ${total === 1 ? 'chamada' : 'chamadas'} registrada${total === 1 ? '' : 's'}`}
             </p>
           </div>
 
@@ -256,6 +311,18 @@ export default function Historico() {
                   onCall={handleCall}
                   onAddContact={handleAddContact}
                 />
+                {nextCursor && (
+                  <div className="mt-3 flex justify-center">
+                    <button
+                      type="button"
+                      onClick={() => void handleLoadMore()}
+                      disabled={loadingMore}
+                      className="rounded-xl border border-white/10 px-3 py-2 text-xs font-semibold text-muted transition-colors hover:text-text disabled:opacity-50"
+                    >
+                      {loadingMore ? 'Carregando...' : 'Carregar mais'}
+                    </button>
+                  </div>
+                )}
               </div>
             </div>
           )}
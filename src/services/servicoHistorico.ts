@@ -7,13 +7,76 @@ export type EntradaHistoricoChamadas = {
   startTime: number
   endTime?: number
   duration?: number
+  answerTime?: number
+  sipStatus?: number
+  // CDR do backend nativo
+  ringTime?: number
+  codec?: string
+  account?: string
+  transfer?: 'blind' | 'attended'
+  transferStatus?: number
 }
 
+export type ConsultaHistorico = {
+  before?: string   // Cursor (nextCursor da página anterior)
+  limit?: number
+  number?: string
+  since?: number
+  until?: number
+}
+
+export type PaginaHistorico = {
+  entries: EntradaHistoricoChamadas[]
+  nextCursor: string | null
+  total: number
+}
+
+// Limite apenas do armazenamento JSON (sem o módulo nativo)
 const MAX_HISTORY_ENTRIES = 1000
 const STORAGE_KEY = 'callHistory'
+const TAMANHO_PAGINA = 100
+
+// Histórico nativo (arquivo somente de acréscimo no processo principal)
+function historicoNativo(): Window['sipNative'] | undefined {
+  return typeof window !== 'undefined' ? window.sipNative : undefined
+}
+
+export async function obterPaginaHistorico(consulta: ConsultaHistorico = {}): Promise<PaginaHistorico> {
+  try {
+    const pagina = await historicoNativo()?.queryCallHistory(consulta)
+    if (pagina) {
+      return pagina
+    }
+  } catch (error) {
+    console.error('Erro ao consultar histórico nativo:', error)
+  }
+
+  // Fallback: array JSON no armazenamento
+  const historico = (await obterHistoricoArmazenado()).filter(
+    (entrada) => !consulta.number || entrada.number === consulta.number
+  )
+  let inicio = 0
+  if (consulta.before) {
+    const indice = historico.findIndex((entrada) => entrada.id === consulta.before)
+    inicio = indice === -1 ? historico.length : indice + 1
+  }
+  const limite = consulta.limit ?? TAMANHO_PAGINA
+  const entries = historico.slice(inicio, inicio + limite)
+  const nextCursor = inicio + limite < historico.length ? entries[entries.length - 1].id : null
+  return { entries, nextCursor, total: historico.length }
+}
 
 export async function adicionarEntradaChamada(entrada: EntradaHistoricoChamadas): Promise<void> {
-  const historico = await obterHistoricoChamadas()
+  try {
+    const { id: _id, ...registro } = entrada
+    if (await historicoNativo()?.appendCallHistory(registro)) {
+      return
+    }
+  } catch (error) {
+    console.error('Erro ao gravar histórico nativo:', error)
+  }
+
+  const historico = await obterHistoricoArmazenado()
   historico.unshift(entrada) // Adiciona no início (mais recente primeiro)
   
   // Limita o histórico ao máximo definido
@@ -23,6 +86,11 @@ export async function adicionarEntradaChamada(entrada: EntradaHistoricoChamadas)
 }
 
 export async function obterHistoricoChamadas(): Promise<EntradaHistoricoChamadas[]> {
+  const pagina = await obterPaginaHistorico({ limit: MAX_HISTORY_ENTRIES })
+  return pagina.entries
+}
+
+async function obterHistoricoArmazenado(): Promise<EntradaHistoricoChamadas[]> {
   try {
     const historico = await getStorage<EntradaHistoricoChamadas[]>(STORAGE_KEY)
     return historico || []
@@ -33,20 +101,34 @@ export async function obterHistoricoChamadas(): Promise<EntradaHistoricoChamadas
 }
 
 export async function limparHistoricoChamadas(): Promise<void> {
+  try {
+    await historicoNativo()?.clearCallHistory()
+  } catch (error) {
+    console.error('Erro ao limpar histórico nativo:', error)
+  }
   await setStorage(STORAGE_KEY, [])
 }
 
 export async function excluirEntradaChamada(id: string): Promise<void> {
-  const historico = await obterHistoricoChamadas()
+  try {
+    if (await historicoNativo()?.deleteCallHistory(id)) {
+      return
+    }
+  } catch (error) {
+    console.error('Erro ao excluir do histórico nativo:', error)
+  }
+
+  const historico = await obterHistoricoArmazenado()
   const filtrado = historico.filter((entrada) => entrada.id !== id)
   await setStorage(STORAGE_KEY, filtrado)
 }
 
+// Apenas no armazenamento JSON: registros nativos são gravados completos ao fim da chamada
 export async function atualizarEntradaChamada(
   id: string,
   updates: Partial<EntradaHistoricoChamadas>
 ): Promise<void> {
-  const historico = await obterHistoricoChamadas()
+  const historico = await obterHistoricoArmazenado()
   const indice = historico.findIndex((entrada) => entrada.id === id)
   
   if (indice === -1) {
@@ -64,7 +146,10 @@ export const addCallEntry = adicionarEntradaChamada
 export const clearCallHistory = limparHistoricoChamadas
 export const deleteCallEntry = excluirEntradaChamada
 export const updateCallEntry = atualizarEntradaChamada
+export const getCallHistoryPage = obterPaginaHistorico
 export type CallHistoryEntry = EntradaHistoricoChamadas
+export type CallHistoryQuery = ConsultaHistorico
+export type CallHistoryPage = PaginaHistorico
 
 // Funções auxiliares de storage (reutilizando do servicoArmazenamento)
 import { obterArmazenamento as getStorage, definirArmazenamento as setStorage } from './servicoArmazenamento'
@@ -12,8 +12,23 @@ import type {
   SipConnectionState,
   CallStatus,
   SipCallDirection,
+  CallDetailRecord,
+  DtmfOptions,
+  DtmfProgress,
+  CaptureStages,
+  CaptureProcessingOptions,
+  OpusOptions,
+  VadOptions,
+  CallVadStats,
+  HoldChange,
+  TransferState,
+  BlfEntry,
+  BlfOptions,
+  BlfStats,
+  SipLiveState,
 } from '../types'
 import type { ISipClient, SipClientEvents } from '../core/sipClientInterface'
+import type { CallHistoryEntry } from '../../services/servicoHistorico'
 
 // Declaração global para o window.sipNative
 declare global {
@@ -34,9 +49,19 @@ declare global {
       answerCall(): Promise<{ success: boolean; error?: string }>
       rejectCall(): Promise<{ success: boolean; error?: string }>
       hangupCall(): Promise<{ success: boolean; error?: string }>
-      sendDtmf(digits: string): Promise<{ success: boolean; error?: string }>
+      sendDtmf(digits: string, options?: DtmfOptions): Promise<{ success: boolean; error?: string }>
+      cancelDtmf(): Promise<{ success: boolean; error?: string }>
+      setDtmfOptions(options: DtmfOptions): Promise<{ success: boolean; error?: string }>
+      setInbandDtmfDetection(enabled: boolean): Promise<{ success: boolean; error?: string }>
       transferBlind(target: string): Promise<{ success: boolean; error?: string }>
       transferAttended(target: string): Promise<{ success: boolean; error?: string }>
+      startConsult(target: string): Promise<{ success: boolean; error?: string }>
+      swapTransferLegs(): Promise<{ success: boolean; error?: string }>
+      completeTransfer(): Promise<{ success: boolean; error?: string }>
+      cancelTransfer(): Promise<{ success: boolean; error?: string }>
+      hold(callId: number): Promise<{ success: boolean; error?: string }>
+      resume(callId: number): Promise<{ success: boolean; error?: string }>
+      setHoldMusic(path: string): Promise<{ success: boolean; error?: string }>
       setMuted(muted: boolean): Promise<void>
       toggleMuted(): Promise<boolean>
       isMuted(): Promise<boolean>
@@ -49,6 +74,55 @@ declare global {
       }>>
       setAudioDevices(captureId: number, playbackId: number): Promise<{ success: boolean; error?: string }>
       getSnapshot(): Promise<NativeSnapshot>
+      getCallTimingStats(): Promise<Record<string, {
+        count: number
+        minMs: number
+        maxMs: number
+        meanMs: number
+        p50Ms: number
+        p90Ms: number
+        p99Ms: number
+      }> | null>
+      setAudioPowerPolicy(policy: { idleCloseSeconds?: number; nullDeviceWhenIdle?: boolean }): Promise<{ success: boolean; error?: string }>
+      setCaptureProcessing(options: CaptureProcessingOptions): Promise<{ success: boolean; error?: string }>
+      setOpusOptions(options: OpusOptions): Promise<{ success: boolean; error?: string }>
+      setVadOptions(options: VadOptions): Promise<{ success: boolean; error?: string }>
+      getVadStats(): Promise<CallVadStats[] | null>
+      getCaptureStats(): Promise<{
+        requested: CaptureStages
+        active: CaptureStages
+        budgetMicros: number
+        frames: number
+        overruns: number
+        downgrades: number
+        lastFrameMicros: number
+      } | null>
+      queryCallHistory(query?: {
+        before?: string
+        limit?: number
+        number?: string
+        since?: number
+        until?: number
+      }): Promise<{ entries: CallHistoryEntry[]; nextCursor: string | null; total: number } | null>
+      appendCallHistory(entry: Omit<CallHistoryEntry, 'id'>): Promise<string | null>
+      deleteCallHistory(id: string): Promise<boolean>
+      clearCallHistory(): Promise<boolean>
+      setContactDirectory(entries: Array<{ name: string; number: string }>): Promise<{ success: boolean; error?: string }>
+      lookupContact(number: string): Promise<string | null>
+      watchExtensions(extensions: string[], options?: BlfOptions): Promise<{ success: boolean; error?: string }>
+      getBlfStates(): Promise<BlfEntry[] | null>
+      getBlfStats(): Promise<BlfStats | null>
+      getLiveState(): Promise<NativeLiveState | null>
+      measureIdleUsage(durationMs?: number): Promise<{ cpuPercent: number; wakeupsPerSecond: number; durationMs: number } | null>
+      getStartupTimeline(): Promise<Record<string, number> | null>
+      setLogLevel(level: number): Promise<{ success: boolean; error?: string }>
+      getLogStats(): Promise<{
+        written: number
+        dropped: number
+        rateLimited: number
+        rotations: number
+        level: number
+      } | null>
       setEventCallback(): Promise<{ success: boolean; error?: string }>
       clearEventCallback(): Promise<{ success: boolean }>
       onEvent(callback: (data: { event: string; payload: string }) => void): () => void
@@ -70,6 +144,13 @@ interface NativeSnapshot {
     displayName: string
     user: string
     uri: string
+    contactName?: string  // Nome resolvido no diretório de contatos
+  }
+  timings?: {
+    postDialDelayMs: number  // -1 quando indisponível
+    setupTimeMs: number
+    answerToMediaMs: number
+    alertingDelayMs: number
   }
 }
 
@@ -165,6 +246,53 @@ function mapCallDirection(direction: string | number): SipCallDirection | undefi
   return undefined
 }
 
+// Estado lido do espelho no main process (nomes do engine, como em getSnapshot)
+interface NativeLiveState {
+  connection: string
+  callStatus: string
+  callDirection: string
+  muted: boolean
+  currentCallId: number | null
+  txLevel: number | null
+  rxLevel: number | null
+  registrations: number
+  registrationFailures: number
+  callsStarted: number
+  callsEnded: number
+  calls: Array<{
+    callId: number
+    state: string
+    incoming: boolean
+    held: boolean
+    current: boolean
+    lastStatus: number
+  }>
+}
+
+function nativeToLiveState(native: NativeLiveState): SipLiveState {
+  return {
+    connection: mapConnectionState(native.connection),
+    callStatus: mapCallStatus(native.callStatus),
+    callDirection: mapCallDirection(native.callDirection),
+    muted: native.muted,
+    currentCallId: native.currentCallId,
+    txLevel: native.txLevel,
+    rxLevel: native.rxLevel,
+    registrations: native.registrations,
+    registrationFailures: native.registrationFailures,
+    callsStarted: native.callsStarted,
+    callsEnded: native.callsEnded,
+    calls: native.calls.map((call) => ({
+      callId: call.callId,
+      callStatus: mapCallStatus(call.state),
+      incoming: call.incoming,
+      held: call.held,
+      current: call.current,
+      lastStatus: call.lastStatus,
+    })),
+  }
+}
+
 function nativeToSnapshot(native: NativeSnapshot): SipClientSnapshot {
   const snapshot: SipClientSnapshot = {
     connection: mapConnectionState(native.connection),
@@ -192,6 +320,7 @@ function nativeToSnapshot(native: NativeSnapshot): SipClientSnapshot {
       displayName: native.incoming.displayName,
       user: native.incoming.user,
       uri: native.incoming.uri,
+      contactName: native.incoming.contactName,
     }
   }
 
@@ -213,6 +342,8 @@ export class NativeSipClient implements ISipClient {
   private eventUnsubscribe: (() => void) | null = null
   private domain = ''
   private currentCallTarget: string = ''  // Preservar número chamado durante a chamada
+  private heldCalls = new Set<number>()  // Chamadas em espera (evento holdChanged)
+  private registrationPoll: ReturnType<typeof setInterval> | null = null
 
   constructor(events: SipClientEvents) {
     this.events = events
@@ -484,8 +615,55 @@ export class NativeSipClient implements ISipClient {
           this.emit({ lastError: payload.lastError || 'Transferência falhou' })
           break
 
+        case 'callEnded':
+          // CDR já gravado no histórico pelo engine; não altera o snapshot
+          this.heldCalls.delete((payload as CallDetailRecord).callId)
+          this.events.onCallEnded?.(payload as CallDetailRecord)
+          break
+
+        case 'dtmfProgress':
+          this.events.onDtmfProgress?.({ ...(payload as Omit<DtmfProgress, 'done'>), done: false })
+          break
+
+        case 'dtmfDone':
+          this.events.onDtmfProgress?.({ ...(payload as Omit<DtmfProgress, 'done'>), done: true })
+          break
+
         case 'dtmfReceived':
-          console.log('[NativeSIP] DTMF recebido:', payload.digit)
+          console.log('[NativeSIP] DTMF recebido:', payload.digit, payload.source)
+          break
+
+        case 'opusAdapted':
+          // Controlador do Opus reconfigurou bitrate/perda esperada pelo RTCP
+          console.log('[NativeSIP] Opus adaptado:', payload)
+          break
+
+        case 'transferState':
+          this.events.onTransferState?.(payload as TransferState)
+          break
+
+        case 'blfUpdate':
+          this.events.onBlfUpdate?.((payload.updates ?? []) as BlfEntry[])
+          break
+
+        case 'transferStatus':
+          // NOTIFY do REFER; o fim da transferência assistida chega em transferState
+          console.log('[NativeSIP] Status da transferência:', payload)
+          break
+
+        case 'holdChanged': {
+          const change = payload as HoldChange
+          if (change.held) {
+            this.heldCalls.add(change.callId)
+          } else {
+            this.heldCalls.delete(change.callId)
+          }
+          break
+        }
+
+        case 'captureDowngraded':
+          // Processamento do microfone passou do orçamento; um estágio foi desligado
+          console.warn('[NativeSIP] Processamento de captura rebaixado:', payload)
           break
 
         case 'mediaActive':
@@ -552,22 +730,53 @@ export class NativeSipClient implements ISipClient {
       throw new Error(registerResult.error || 'Falha no registro')
     }
 
-    // Aguardar um pouco e verificar snapshot (o evento pode já ter chegado)
-    await new Promise(resolve => setTimeout(resolve, 100))
-    
-    // Buscar snapshot atualizado do módulo nativo
+    // O estado chega pelos eventos; enquanto o registro não conclui, o
+    // espelho é lido como fallback (caso um evento se perca)
+    await this.syncLiveState()
+    this.startRegistrationPoll()
+  }
+
+  /**
+   * Aplica ao snapshot o estado lido do espelho (sem montar o snapshot
+   * completo no módulo nativo)
+   */
+  private async syncLiveState(): Promise<void> {
     try {
-      const snapshot = await window.sipNative.getSnapshot()
-      const mapped = nativeToSnapshot(snapshot)
-      this.emit(mapped)
+      const live = await this.getLiveState()
+      if (!live) return
+      this.emit({
+        connection: live.connection,
+        callStatus: live.callStatus,
+        callDirection: live.callDirection,
+        muted: live.muted,
+      })
     } catch (e) {
-      console.warn('[NativeSIP] Erro ao buscar snapshot após registro:', e)
+      console.warn('[NativeSIP] Erro ao ler estado do espelho:', e)
     }
+  }
+
+  private startRegistrationPoll(): void {
+    this.stopRegistrationPoll()
+    const deadline = Date.now() + 15000
+    this.registrationPoll = setInterval(() => {
+      const pending = this.snapshot.connection === 'connecting' || this.snapshot.connection === 'connected'
+      if (!pending || Date.now() > deadline) {
+        this.stopRegistrationPoll()
+        return
+      }
+      void this.syncLiveState()
+    }, 500)
+  }
 
-    // O estado também será atualizado via eventos quando chegar
+  private stopRegistrationPoll(): void {
+    if (this.registrationPoll) {
+      clearInterval(this.registrationPoll)
+      this.registrationPoll = null
+    }
   }
 
   async unregisterAndDisconnect(): Promise<void> {
+    this.stopRegistrationPoll()
     this.emit({ connection: 'unregistered', identity: undefined, muted: false })
 
     try {
@@ -683,11 +892,140 @@ export class NativeSipClient implements ISipClient {
     }
   }
 
+  /**
+   * Liga para o destino deixando a chamada atual fora da ponte; as fases
+   * chegam em onTransferState até completeTransfer ou cancelTransfer.
+   */
+  async startConsult(target: string): Promise<void> {
+    const result = await window.sipNative.startConsult(target)
+    if (!result.success) {
+      this.emit({ lastError: result.error || 'Falha ao iniciar consulta' })
+      throw new Error(result.error || 'Falha ao iniciar consulta')
+    }
+  }
+
+  async swapTransferLegs(): Promise<boolean> {
+    const result = await window.sipNative.swapTransferLegs()
+    return result.success
+  }
+
+  async completeTransfer(): Promise<void> {
+    const result = await window.sipNative.completeTransfer()
+    if (!result.success) {
+      this.emit({ lastError: result.error || 'Falha ao completar transferência' })
+      throw new Error(result.error || 'Falha ao completar transferência')
+    }
+  }
+
+  async cancelTransfer(): Promise<boolean> {
+    const result = await window.sipNative.cancelTransfer()
+    return result.success
+  }
+
+  /**
+   * Coloca a chamada em espera; ela deixa a ponte de conferência até o resume.
+   */
+  async hold(callId: number): Promise<void> {
+    const result = await window.sipNative.hold(callId)
+    if (!result.success) {
+      this.emit({ lastError: result.error || 'Falha ao colocar em espera' })
+      throw new Error(result.error || 'Falha ao colocar em espera')
+    }
+  }
+
+  async resume(callId: number): Promise<void> {
+    const result = await window.sipNative.resume(callId)
+    if (!result.success) {
+      this.emit({ lastError: result.error || 'Falha ao retomar chamada' })
+      throw new Error(result.error || 'Falha ao retomar chamada')
+    }
+  }
+
+  isHeld(callId: number): boolean {
+    return this.heldCalls.has(callId)
+  }
+
+  async setHoldMusic(path: string): Promise<boolean> {
+    const result = await window.sipNative.setHoldMusic(path)
+    return result.success
+  }
+
   sendDtmf(tones: string): boolean {
     window.sipNative.sendDtmf(tones)
     return true
   }
 
+  /**
+   * Envia uma sequência longa (PIN, conta em URA) com método e durações próprios.
+   * Aceita pausas (',' ou 'p'); o progresso chega em onDtmfProgress.
+   */
+  async sendDtmfSequence(digits: string, options?: DtmfOptions): Promise<boolean> {
+    const result = await window.sipNative.sendDtmf(digits, options)
+    return result.success
+  }
+
+  async cancelDtmf(): Promise<void> {
+    await window.sipNative.cancelDtmf()
+  }
+
+  async setDtmfOptions(options: DtmfOptions): Promise<void> {
+    await window.sipNative.setDtmfOptions(options)
+  }
+
+  /**
+   * Liga/desliga os estágios do processamento do microfone, inclusive durante a chamada.
+   */
+  async setCaptureProcessing(options: CaptureProcessingOptions): Promise<boolean> {
+    const result = await window.sipNative.setCaptureProcessing(options)
+    return result.success
+  }
+
+  async setOpusOptions(options: OpusOptions): Promise<boolean> {
+    const result = await window.sipNative.setOpusOptions(options)
+    return result.success
+  }
+
+  /**
+   * Configura o VAD; chamadas em andamento passam a usá-lo conforme o codec negociado.
+   */
+  async setVadOptions(options: VadOptions): Promise<boolean> {
+    const result = await window.sipNative.setVadOptions(options)
+    return result.success
+  }
+
+  async getVadStats(): Promise<CallVadStats[]> {
+    return (await window.sipNative.getVadStats()) ?? []
+  }
+
+  /**
+   * Substitui os ramais monitorados (BLF); as mudanças chegam em lotes em onBlfUpdate.
+   * Lista vazia encerra as assinaturas.
+   */
+  async watchExtensions(extensions: string[], options: BlfOptions = {}): Promise<boolean> {
+    const result = await window.sipNative.watchExtensions(extensions, options)
+    if (!result.success) {
+      console.error('[NativeSIP] Falha ao monitorar ramais:', result.error)
+    }
+    return result.success
+  }
+
+  async getBlfStates(): Promise<BlfEntry[]> {
+    return (await window.sipNative.getBlfStates()) ?? []
+  }
+
+  async getBlfStats(): Promise<BlfStats | null> {
+    return window.sipNative.getBlfStats()
+  }
+
+  /**
+   * Estado corrente (chamadas, níveis de áudio, contadores) lido do espelho
+   * de estado, sem montar o snapshot completo no módulo nativo.
+   */
+  async getLiveState(): Promise<SipLiveState | null> {
+    const native = await window.sipNative.getLiveState()
+    return native ? nativeToLiveState(native) : null
+  }
+
   getDomain(): string | undefined {
     return this.domain
   }
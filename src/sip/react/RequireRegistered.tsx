@@ -66,27 +66,6 @@ export function RequireRegistered({ children }: PropsWithChildren) {
     })()
   }, [shouldRenderChildren, navigate, sip])
 
-  // Polling para verificar estado quando estiver conectando (fallback caso eventos não cheguem)
-  useEffect(() => {
-    if (shouldRenderChildren) return
-    if (!isConnecting) return
-
-    const interval = setInterval(async () => {
-      // Se estiver usando backend nativo, tentar buscar snapshot diretamente
-      if (sip.isNativeBackend && window.sipNative) {
-        try {
-          // Se o módulo nativo diz que está registrado, o snapshot será atualizado pelo evento
-          // Não forçar atualização aqui para evitar loops
-          await window.sipNative.getSnapshot()
-        } catch {
-          // Ignorar erros no polling
-        }
-      }
-    }, 2000) // Verificar a cada 2 segundos (menos frequente para evitar spam)
-
-    return () => clearInterval(interval)
-  }, [shouldRenderChildren, isConnecting, sip])
-
   // Navegar para /discador quando uma chamada é iniciada (apenas uma vez)
   const hasNavigatedRef = useRef(false)
   useEffect(() => {
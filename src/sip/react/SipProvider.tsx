@@ -1,6 +1,6 @@
 import { createContext, useEffect, useMemo, useRef, useState, useCallback } from 'react'
 import type { PropsWithChildren } from 'react'
-import type { SipClientSnapshot, SipCredentials, SipTransportProtocol } from '../types'
+import type { CallDetailRecord, SipClientSnapshot, SipCredentials, SipTransportProtocol } from '../types'
 import type { ISipClient } from '../core/sipClientInterface'
 import { createSipClient, requiresNative } from '../core/sipClientFactory'
 import { bindRemoteAudio } from '../media/audioBinding'
@@ -15,6 +15,8 @@ export type SipContextValue = {
   speakerOn: boolean
   /** Indica se está usando o backend nativo (PJSIP) */
   isNativeBackend: boolean
+  /** CDR da última chamada encerrada (backend nativo) */
+  lastCallRecord: CallDetailRecord | null
 
   connectAndRegister: (credentials: SipCredentials) => Promise<void>
   unregisterAndDisconnect: () => Promise<void>
@@ -36,6 +38,7 @@ export function SipProvider({ children }: PropsWithChildren) {
   const [callDurationSec, setCallDurationSec] = useState(0)
   const [speakerOn, setSpeakerOn] = useState(false)
   const [currentProtocol, setCurrentProtocol] = useState<SipTransportProtocol>('wss')
+  const [lastCallRecord, setLastCallRecord] = useState<CallDetailRecord | null>(null)
 
   const remoteAudioRef = useRef<HTMLAudioElement | null>(null)
   const clientRef = useRef<ISipClient | null>(null)
@@ -62,6 +65,9 @@ export function SipProvider({ children }: PropsWithChildren) {
           })
           setSnapshot(snap)
         },
+        onCallEnded: (record) => {
+          setLastCallRecord(record)
+        },
       })
       setCurrentProtocol(protocol)
     }
@@ -123,7 +129,7 @@ export function SipProvider({ children }: PropsWithChildren) {
   useCallAudioFeedback(snapshot)
 
   // Histórico de chamadas
-  useCallHistory({ snapshot })
+  useCallHistory({ snapshot, recordedByEngine: isNativeBackend })
 
   // Restaura e foca a janela quando uma chamada entrante for recebida
   useEffect(() => {
@@ -141,6 +147,7 @@ export function SipProvider({ children }: PropsWithChildren) {
       callDurationSec,
       speakerOn,
       isNativeBackend,
+      lastCallRecord,
 
       connectAndRegister: async (credentials) => {
         const protocol = credentials.protocol ?? 'wss'
@@ -224,7 +231,7 @@ export function SipProvider({ children }: PropsWithChildren) {
         await client.transferAttended(target)
       },
     }
-  }, [snapshot, callDurationSec, speakerOn, isNativeBackend, getOrCreateClient])
+  }, [snapshot, callDurationSec, speakerOn, isNativeBackend, lastCallRecord, getOrCreateClient])
 
   return (
     <SipContext.Provider value={value}>
@@ -1,10 +1,12 @@
 import { useEffect, useRef } from 'react'
 import type { SipClientSnapshot } from '../types'
-import { addCallEntry, updateCallEntry, type CallHistoryEntry } from '../../services/servicoHistorico'
+import { addCallEntry, type CallHistoryEntry } from '../../services/servicoHistorico'
 
 type UseCallHistoryOptions = {
   snapshot: SipClientSnapshot
   currentDialNumber?: string
+  // Backend nativo: o engine grava o histórico ao fim de cada chamada
+  recordedByEngine?: boolean
 }
 
 // Módulo compartilhado para armazenar o número atual sendo discado
@@ -14,10 +16,10 @@ export function setCurrentDialNumber(number: string | null): void {
   currentDialNumber = number
 }
 
-let currentCallEntryId: string | null = null
-let callStartTime: number | null = null
+// Chamada em andamento (gravada uma única vez, ao terminar)
+let currentEntry: CallHistoryEntry | null = null
 
-export function useCallHistory({ snapshot, currentDialNumber: dialNumber }: UseCallHistoryOptions): void {
+export function useCallHistory({ snapshot, currentDialNumber: dialNumber, recordedByEngine = false }: UseCallHistoryOptions): void {
   const prevSnapshotRef = useRef<SipClientSnapshot>(snapshot)
   const prevCallStatusRef = useRef(snapshot.callStatus)
 
@@ -25,27 +27,27 @@ export function useCallHistory({ snapshot, currentDialNumber: dialNumber }: UseC
     const prevCallStatus = prevCallStatusRef.current
     const currentCallStatus = snapshot.callStatus
 
+    // Atualiza referências
+    prevSnapshotRef.current = snapshot
+    prevCallStatusRef.current = currentCallStatus
+
+    if (recordedByEngine) {
+      return
+    }
+
     // Detecta início de chamada de saída
     if (
       prevCallStatus === 'idle' &&
       currentCallStatus === 'dialing' &&
       snapshot.callDirection === 'outgoing'
     ) {
-      const entryId = `call-${Date.now()}-${Math.random().toString(36).slice(2, 11)}`
-      currentCallEntryId = entryId
-      callStartTime = Date.now()
-
-      const number = dialNumber || currentDialNumber || 'Desconhecido'
-
-      const entry: CallHistoryEntry = {
-        id: entryId,
-        number,
+      currentEntry = {
+        id: `call-${Date.now()}-${Math.random().toString(36).slice(2, 11)}`,
+        number: dialNumber || currentDialNumber || 'Desconhecido',
         direction: 'outgoing',
         status: 'failed', // Status inicial, será atualizado
-        startTime: callStartTime,
+        startTime: Date.now(),
       }
-
-      void addCallEntry(entry)
     }
 
     // Detecta início de chamada de entrada
@@ -54,85 +56,61 @@ export function useCallHistory({ snapshot, currentDialNumber: dialNumber }: UseC
       currentCallStatus === 'incoming' &&
       snapshot.callDirection === 'incoming'
     ) {
-      const entryId = `call-${Date.now()}-${Math.random().toString(36).slice(2, 11)}`
-      currentCallEntryId = entryId
-      callStartTime = Date.now()
-
-      const entry: CallHistoryEntry = {
-        id: entryId,
+      currentEntry = {
+        id: `call-${Date.now()}-${Math.random().toString(36).slice(2, 11)}`,
         number: snapshot.incoming?.user || snapshot.incoming?.uri || 'Desconhecido',
-        displayName: snapshot.incoming?.displayName,
+        displayName: snapshot.incoming?.contactName || snapshot.incoming?.displayName,
         direction: 'incoming',
         status: 'missed', // Status inicial, será atualizado se atender
-        startTime: callStartTime,
+        startTime: Date.now(),
       }
-
-      void addCallEntry(entry)
     }
 
     // Atualiza quando chamada é estabelecida
     if (
       prevCallStatus !== 'established' &&
       currentCallStatus === 'established' &&
-      currentCallEntryId
+      currentEntry
     ) {
-      const updates: Partial<CallHistoryEntry> = {
-        status: snapshot.callDirection === 'incoming' ? 'answered' : 'completed',
-      }
+      currentEntry.status = snapshot.callDirection === 'incoming' ? 'answered' : 'completed'
+      currentEntry.answerTime = Date.now()
 
       // Se for chamada de saída e o número ainda não foi definido, atualiza
-      if (snapshot.callDirection === 'outgoing' && (dialNumber || currentDialNumber)) {
-        const number = dialNumber || currentDialNumber
-        if (number) {
-          updates.number = number
-        }
+      const number = dialNumber || currentDialNumber
+      if (snapshot.callDirection === 'outgoing' && number) {
+        currentEntry.number = number
       }
-
-      void updateCallEntry(currentCallEntryId, updates)
     }
 
-    // Finaliza quando chamada termina
+    // Finaliza quando chamada termina: uma única gravação por chamada
     if (
       prevCallStatus !== 'idle' &&
       currentCallStatus === 'idle' &&
-      currentCallEntryId &&
-      callStartTime
+      currentEntry
     ) {
-      const endTime = Date.now()
-      const duration = Math.floor((endTime - callStartTime) / 1000)
-
-      const updates: Partial<CallHistoryEntry> = {
-        endTime,
-        duration,
-      }
+      const entry = currentEntry
+      entry.endTime = Date.now()
+      entry.duration = Math.floor((entry.endTime - entry.startTime) / 1000)
 
       // Se a chamada não foi estabelecida, marca como falhou ou perdida/rejeitada
-      if (prevCallStatus !== 'established') {
-        if (snapshot.callDirection === 'incoming') {
+      if (entry.answerTime === undefined) {
+        if (entry.direction === 'incoming') {
           // Se estava em incoming e voltou para idle sem estabelecer, foi rejeitada ou perdida
-          updates.status = prevCallStatus === 'incoming' ? 'rejected' : 'missed'
+          entry.status = prevCallStatus === 'incoming' ? 'rejected' : 'missed'
         } else {
-          updates.status = 'failed'
+          entry.status = 'failed'
         }
       }
 
       // Atualiza o número se ainda não foi definido (para chamadas de saída)
-      if (snapshot.callDirection === 'outgoing' && (dialNumber || currentDialNumber)) {
-        const number = dialNumber || currentDialNumber
-        if (number) {
-          updates.number = number
-        }
+      const number = dialNumber || currentDialNumber
+      if (entry.direction === 'outgoing' && number) {
+        entry.number = number
       }
 
-      void updateCallEntry(currentCallEntryId, updates)
-      currentCallEntryId = null
-      callStartTime = null
+      void addCallEntry(entry)
+      currentEntry = null
       currentDialNumber = null // Limpa após finalizar
     }
-
-    // Atualiza referências
-    prevSnapshotRef.current = snapshot
-    prevCallStatusRef.current = currentCallStatus
-  }, [snapshot, dialNumber])
+  }, [snapshot, dialNumber, recordedByEngine])
 }
-
@@ -33,6 +33,187 @@ export type IncomingCallInfo = {
   displayName?: string
   user?: string
   uri?: string
+  contactName?: string
+}
+
+/** Registro de chamada (CDR) emitido uma única vez ao fim da chamada (horários em ms, 0 = não ocorreu) */
+export type CallDetailRecord = {
+  id: string
+  callId: number
+  direction: SipCallDirection
+  status: 'answered' | 'completed' | 'missed' | 'rejected' | 'failed'
+  number: string
+  displayName?: string
+  /** usuario@dominio da conta registrada */
+  account?: string
+  /** Codec de áudio negociado (ex: "opus", "PCMA") */
+  codec?: string
+  startTime: number
+  ringTime: number
+  answerTime: number
+  endTime: number
+  durationMs: number
+  talkMs: number
+  /** last_status da chamada (causa do término) */
+  sipStatus: number
+  transfer: 'none' | 'blind' | 'attended'
+  /** Código final do NOTIFY da transferência (0 = sem resposta) */
+  transferStatus: number
+  /** Pacotes RTP não enviados pelo VAD (silêncio) */
+  vadSuppressedPackets?: number
+}
+
+/** Mudança de espera de uma chamada (music = música de espera tocando) */
+export type HoldChange = {
+  callId: number
+  held: boolean
+  music: boolean
+}
+
+/** Fase da transferência assistida (idle quando não há transferência) */
+export type TransferPhase = 'idle' | 'dialing' | 'consulting' | 'completing'
+
+/** Como terminou uma transferência assistida */
+export type TransferResult = 'completed' | 'cancelled' | 'failed' | 'consultEnded' | 'originalEnded'
+
+/** Estado da transferência assistida (talkingCallId = perna ligada à ponte) */
+export type TransferState = {
+  phase: TransferPhase
+  originalCallId: number
+  consultCallId: number
+  talkingCallId: number
+  /** Presente só no fim da transferência */
+  result?: TransferResult
+  statusCode?: number
+}
+
+/** NOTIFY do REFER (consultCallId = -1 na transferência cega) */
+export type TransferStatus = {
+  callId: number
+  consultCallId: number
+  statusCode: number
+  final: boolean
+}
+
+/** Método de envio de DTMF do backend nativo */
+export type DtmfMethod = 'rfc2833' | 'info' | 'inband'
+
+/** Opções de DTMF (durações em ms, limitadas pelo engine a 40..2000) */
+export type DtmfOptions = {
+  method?: DtmfMethod
+  toneMs?: number
+  gapMs?: number
+  /** Duração de cada ',' ou 'p' na sequência */
+  pauseMs?: number
+}
+
+/** Progresso de uma sequência de DTMF (done = fila encerrada) */
+export type DtmfProgress = {
+  digit?: string
+  method?: DtmfMethod
+  sent: number
+  total: number
+  done: boolean
+  cancelled?: boolean
+}
+
+/** Opus: FEC in-band, DTX e faixa do controlador de bitrate (bps) */
+export type OpusOptions = {
+  fec?: boolean
+  dtx?: boolean
+  minBitrate?: number
+  maxBitrate?: number
+  startBitrate?: number
+}
+
+/**
+ * VAD do microfone: no silêncio o RTP não é enviado (o outro lado gera o ruído de conforto).
+ * codecs vazio = todos sem DTX próprio (o Opus usa o DTX do codec).
+ */
+export type VadOptions = {
+  enabled?: boolean
+  /** Tempo que a transmissão continua após a última voz (60..2000 ms) */
+  hangoverMs?: number
+  /** Margem sobre o piso de ruído para considerar voz (3..30 dB) */
+  thresholdDb?: number
+  /** Nomes de encoding, ex: ["PCMU", "PCMA"] */
+  codecs?: string[]
+}
+
+/** VAD em uma chamada em andamento */
+export type CallVadStats = {
+  callId: number
+  codec: string
+  active: boolean
+  suppressedPackets: number
+}
+
+/** Chamada no espelho de estado do módulo nativo */
+export type SipLiveCall = {
+  callId: number
+  callStatus: CallStatus
+  incoming: boolean
+  held: boolean
+  current: boolean
+  /** Último código SIP recebido */
+  lastStatus: number
+}
+
+/** Estado corrente lido do espelho do módulo nativo (sem montar o snapshot completo) */
+export type SipLiveState = {
+  connection: SipConnectionState
+  callStatus: CallStatus
+  callDirection?: SipCallDirection
+  muted: boolean
+  currentCallId: number | null
+  /** Níveis de áudio da chamada atual (0..255), null sem chamada */
+  txLevel: number | null
+  rxLevel: number | null
+  registrations: number
+  registrationFailures: number
+  callsStarted: number
+  callsEnded: number
+  calls: SipLiveCall[]
+}
+
+/** Estado BLF de um ramal (RFC 4235) */
+export type BlfState = 'unknown' | 'idle' | 'ringing' | 'busy'
+
+export type BlfEntry = {
+  extension: string
+  state: BlfState
+}
+
+/** Monitoramento de ramais (BLF) */
+export type BlfOptions = {
+  /** Lista no servidor (RLS, RFC 4662); vazio = um SUBSCRIBE por ramal */
+  listUri?: string
+  /** Intervalo mínimo entre eventos onBlfUpdate (50..5000 ms) */
+  batchIntervalMs?: number
+  /** Expires dos SUBSCRIBE (60..3600 s) */
+  expiresSeconds?: number
+}
+
+export type BlfStats = {
+  extensions: number
+  subscriptions: number
+  active: number
+  resourceList: boolean
+  notifies: number
+  batches: number
+}
+
+/** Estágios do processamento do microfone */
+export type CaptureStages = {
+  highPass: boolean
+  noiseSuppression: boolean
+  agc: boolean
+}
+
+/** Configuração do processamento do microfone (campos ausentes ficam ligados) */
+export type CaptureProcessingOptions = Partial<CaptureStages> & {
+  /** Orçamento por quadro em % da duração do quadro (5 a 90) */
+  budgetPercent?: number
 }
 
 export type SipIdentity = {
@@ -64,6 +245,14 @@ export type SipRuntime = {
 
 export type SipClientEvents = {
   onSnapshot: (snap: SipClientSnapshot) => void
+  /** Fim de chamada com o CDR (apenas backend nativo) */
+  onCallEnded?: (record: CallDetailRecord) => void
+  /** Progresso das sequências de DTMF (apenas backend nativo) */
+  onDtmfProgress?: (progress: DtmfProgress) => void
+  /** Fases da transferência assistida (apenas backend nativo) */
+  onTransferState?: (state: TransferState) => void
+  /** Lote de mudanças de estado dos ramais monitorados (apenas backend nativo) */
+  onBlfUpdate?: (updates: BlfEntry[]) => void
 }
 
 